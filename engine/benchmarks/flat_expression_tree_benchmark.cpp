@@ -0,0 +1,117 @@
+#include "parser/expression_tree.hpp"
+#include "parser/flat_expression_tree.hpp"
+#include <benchmark/benchmark.h>
+
+using namespace ral::parser;
+
+/**
+ * Build, clone and transform of the flat_tree compared to the parse_tree made of ral::parser::node,
+ * over the project and filter expressions calcite generates for TPC-H queries.
+ * The benchmark argument is the index of the expression.
+ */
+
+namespace {
+
+const std::vector<std::string> tpch_expressions{
+	// Q1
+	"*(*($5, -(1, $6)), +(1, $7))",
+	"AND(<=($10, -(1998-12-01, 7776000000:INTERVAL DAY)), IS_NOT_NULL($4))",
+	// Q3
+	"*($5, -(1, $6))",
+	"AND(=($6, 'BUILDING'), <($12, 1995-03-15), >($20, 1995-03-15))",
+	// Q6
+	"AND(>=($10, 1994-01-01), <($10, 1995-01-01), >=($6, 0.05), <=($6, 0.07), <($4, 24))",
+	// Q12
+	"CASE(OR(=($5, '1-URGENT'), =($5, '2-HIGH')), 1, 0)",
+	"CASE(AND(<>($5, '1-URGENT'), <>($5, '2-HIGH')), 1, 0)",
+	// Q14
+	"CASE(LIKE($4, 'PROMO%'), *($5, -(1, $6)), 0:DOUBLE)",
+	"/(*(100.00:DOUBLE, CAST($0):DOUBLE), CAST($1):DOUBLE)",
+	// Q19
+	"OR(AND(=($1, 'Brand#12'), >=($4, 1), <=($4, +(1, 10)), >=(CAST($2):INTEGER, 1), <=(CAST($2):INTEGER, 5)), "
+	"AND(=($1, 'Brand#23'), >=($4, 10), <=($4, +(10, 10)), >=(CAST($2):INTEGER, 1), <=(CAST($2):INTEGER, 10)), "
+	"AND(=($1, 'Brand#34'), >=($4, 20), <=($4, +(20, 10)), >=(CAST($2):INTEGER, 1), <=(CAST($2):INTEGER, 15)))",
+	// Custom ops
+	"ROUND(+($0, CAST(4:INTEGER):BIGINT))",
+	"Reinterpret(+($0, CASE(<($0, 5), CASE(<($0, 2), 0, 1), 2)))",
+};
+
+const std::string & expression_of(const benchmark::State & state) {
+	return tpch_expressions[state.range(0)];
+}
+
+void all_expressions(benchmark::internal::Benchmark * benchmark) {
+	benchmark->DenseRange(0, tpch_expressions.size() - 1);
+}
+
+} // namespace
+
+static void BM_parse_tree_build(benchmark::State & state) {
+	const std::string & expression = expression_of(state);
+	for (auto _ : state) {
+		parse_tree tree;
+		tree.build(expression);
+		benchmark::DoNotOptimize(tree.root());
+	}
+}
+BENCHMARK(BM_parse_tree_build)->Apply(all_expressions);
+
+static void BM_flat_tree_build(benchmark::State & state) {
+	const std::string & expression = expression_of(state);
+	for (auto _ : state) {
+		flat_tree flat = flat_tree::build(expression);
+		benchmark::DoNotOptimize(flat.root());
+	}
+}
+BENCHMARK(BM_flat_tree_build)->Apply(all_expressions);
+
+static void BM_flat_tree_build_shared_pool(benchmark::State & state) {
+	const std::string & expression = expression_of(state);
+	auto pool = std::make_shared<string_pool>();
+	for (auto _ : state) {
+		flat_tree flat = flat_tree::build(expression, pool);
+		benchmark::DoNotOptimize(flat.root());
+	}
+}
+BENCHMARK(BM_flat_tree_build_shared_pool)->Apply(all_expressions);
+
+static void BM_parse_tree_clone(benchmark::State & state) {
+	parse_tree tree;
+	tree.build(expression_of(state));
+	for (auto _ : state) {
+		parse_tree clone = tree.clone();
+		benchmark::DoNotOptimize(clone.root());
+	}
+}
+BENCHMARK(BM_parse_tree_clone)->Apply(all_expressions);
+
+static void BM_flat_tree_clone(benchmark::State & state) {
+	flat_tree flat = flat_tree::build(expression_of(state));
+	for (auto _ : state) {
+		flat_tree clone = flat.clone();
+		benchmark::DoNotOptimize(clone.root());
+	}
+}
+BENCHMARK(BM_flat_tree_clone)->Apply(all_expressions);
+
+// the clone is part of the measure, the transform rewrites the tree in place
+static void BM_parse_tree_transform(benchmark::State & state) {
+	parse_tree tree;
+	tree.build(expression_of(state));
+	for (auto _ : state) {
+		parse_tree clone = tree.clone();
+		clone.transform_to_custom_op();
+		benchmark::DoNotOptimize(clone.root());
+	}
+}
+BENCHMARK(BM_parse_tree_transform)->Apply(all_expressions);
+
+static void BM_flat_tree_transform(benchmark::State & state) {
+	flat_tree flat = flat_tree::build(expression_of(state));
+	for (auto _ : state) {
+		flat_tree clone = flat.clone();
+		clone.transform_to_custom_op();
+		benchmark::DoNotOptimize(clone.root());
+	}
+}
+BENCHMARK(BM_flat_tree_transform)->Apply(all_expressions);
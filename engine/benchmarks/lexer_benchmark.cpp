@@ -0,0 +1,27 @@
+#include "parser/expression_tree.hpp"
+#include <benchmark/benchmark.h>
+
+using ral::parser::detail::lexer;
+
+/**
+ * Throughput of the expression lexer, in tokens per second, over an expression made of
+ * the argument number of nested CASE terms.
+ */
+
+static void BM_lexer_tokens(benchmark::State & state) {
+	std::string expression = "$0";
+	for (int64_t i = 0; i < state.range(0); i++) {
+		expression = "+(" + expression + ", CASE(>($" + std::to_string(i) + ", 1.5), 'abc', 2020-01-01))";
+	}
+
+	int64_t num_tokens = 0;
+	for (auto _ : state) {
+		lexer lex(expression);
+		for (auto token = lex.next_token(); token.type != lexer::token_type::EOF_; token = lex.next_token()) {
+			num_tokens++;
+		}
+	}
+	state.SetItemsProcessed(num_tokens);
+	state.SetBytesProcessed(state.iterations() * expression.size());
+}
+BENCHMARK(BM_lexer_tokens)->Arg(10)->Arg(2000);
@@ -44,6 +44,7 @@ cdef extern from "../include/engine/errors.h":
     cdef void raiseRegisterFileSystemS3Error()
     cdef void raiseRegisterFileSystemLocalError()
     cdef void raiseInferFolderPartitionMetadataError()
+    cdef void raisePrunePartitionsError()
 
 
 from cudf._lib.cpp.column cimport *
@@ -133,6 +134,7 @@ cdef extern from "../include/io/io.h" nogil:
     TableSchema parseSchema(vector[string] files, string file_format_hint, vector[string] arg_keys, vector[string] arg_values, vector[pair[string,type_id]] types, bool ignore_missing_paths) except +raiseParseSchemaError
     unique_ptr[ResultSet] parseMetadata(vector[string] files, pair[int,int] offsets, TableSchema schema, string file_format_hint, vector[string] arg_keys, vector[string] arg_values) except +raiseParseSchemaError
     vector[FolderPartitionMetadata] inferFolderPartitionMetadata(string folder_path) except +raiseInferFolderPartitionMetadataError
+    vector[int] prunePartitions(vector[map[string, string]] partitions, vector[string] column_names, vector[type_id] column_types, string table_scan) except +raisePrunePartitionsError
 
 
 cdef extern from "../src/execution_graph/logic_controllers/LogicPrimitives.h" namespace "ral::frame":
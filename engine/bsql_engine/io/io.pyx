@@ -138,6 +138,10 @@ class InferFolderPartitionMetadataError(BlazingError):
     """InferFolderPartitionMetadata Error."""
 cdef public PyObject * InferFolderPartitionMetadataError_ = <PyObject *>InferFolderPartitionMetadataError
 
+class PrunePartitionsError(BlazingError):
+    """PrunePartitions Error."""
+cdef public PyObject * PrunePartitionsError_ = <PyObject *>PrunePartitionsError
+
 cdef cio.TableSchema parseSchemaPython(vector[string] files, string file_format_hint, vector[string] arg_keys, vector[string] arg_values,vector[pair[string,type_id]] extra_columns, bool ignore_missing_paths) nogil except *:
     with nogil:
         return cio.parseSchema(files, file_format_hint, arg_keys, arg_values, extra_columns, ignore_missing_paths)
@@ -203,6 +207,10 @@ cdef vector[cio.FolderPartitionMetadata] inferFolderPartitionMetadataPython(stri
     with nogil:
         return cio.inferFolderPartitionMetadata(folder_path)
 
+cdef vector[int] prunePartitionsPython(vector[map[string, string]] partitions, vector[string] column_names, vector[type_id] column_types, string table_scan) nogil except *:
+    with nogil:
+        return cio.prunePartitions(partitions, column_names, column_types, table_scan)
+
 cpdef pair[bool, string] registerFileSystemCaller(fs, root, authority):
     cdef HDFS hdfs
     cdef S3 s3
@@ -451,6 +459,28 @@ cpdef inferFolderPartitionMetadataCaller(folder_path):
 
     return return_array
 
+cpdef prunePartitionsCaller(partitions, table, table_scan):
+    cdef vector[map[string, string]] partitions_values
+    cdef map[string, string] partition_values
+    cdef vector[string] column_names
+    cdef vector[type_id] column_types
+
+    for partition in partitions:
+      partition_values.clear()
+      for col_name, col_value in partition:
+        partition_values[str(col_name).encode()] = str(col_value).encode()
+      partitions_values.push_back(partition_values)
+
+    for col_name in table.column_names:
+      if type(col_name) == np.str:
+        column_names.push_back(col_name.encode())
+      else: # from file
+        column_names.push_back(col_name)
+    for col_type in table.column_types:
+      column_types.push_back(<type_id>(<underlying_type_t_type_id>(col_type)))
+
+    return prunePartitionsPython(partitions_values, column_names, column_types, table_scan.encode())
+
 
 cdef class PyBlazingGraph:
     cdef shared_ptr[cio.graph] ptr
@@ -549,6 +579,11 @@ cpdef runGenerateGraphCaller(uint32_t masterIndex, worker_ids, tables,  table_sc
           blazingTableViews.push_back(BlazingTableView(table_view(column_views), names))
         currentTableSchemaCpp.blazingTableViews = blazingTableViews
 
+      if table.fileType == 6: # if pyarrow Table, its buffers are scanned without copying them
+        currentTableSchemaCpp.arrow_table = pyarrow_unwrap_table(table.arrow_table)
+      else:
+        currentTableSchemaCpp.arrow_table.reset()
+
       currentTableSchemaCpp.names = names
       currentTableSchemaCpp.types = types
 
@@ -103,6 +103,13 @@ std::pair<bool, std::string> registerFileSystemLocal(std::string root, std::stri
 
 std::vector<FolderPartitionMetadata> inferFolderPartitionMetadata(std::string folder_path);
 
+// Returns the indices of the partitions, given by the values of their partition columns, that may hold rows that pass
+// the filter of the table scan
+std::vector<int> prunePartitions(std::vector<std::map<std::string, std::string>> partitions,
+	std::vector<std::string> column_names,
+	std::vector<cudf::type_id> column_types,
+	std::string table_scan);
+
 extern "C" {
 
 std::pair<TableSchema, error_code_t> parseSchema_C(std::vector<std::string> files,
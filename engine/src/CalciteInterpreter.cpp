@@ -106,8 +106,8 @@ std::shared_ptr<ral::cache::graph> generate_graph(std::vector<ral::io::data_load
 			query_graph->addPair(ral::cache::kpair(query_graph->get_last_kernel(), output, cache_machine_config));
 			// query_graph.show();
 
-			// useful when the Algebra Relacional only contains: ScanTable (or BindableScan) and Limit
-			query_graph->check_for_simple_scan_with_limit_query();
+			// lets the scans under a limit stop loading once they have enough rows
+			query_graph->push_down_limits();
 		}
 		query_graph->check_and_complete_work_flow();
 		query_graph->set_kernels_order();
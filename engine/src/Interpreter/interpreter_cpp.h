@@ -13,18 +13,10 @@
 #include <map>
 #include <memory>
 #include "parser/expression_tree.hpp"
+#include "interpreter_plan.h"
 
 namespace interops {
 
-typedef int16_t column_index_type;
-
-enum column_index : column_index_type {
-	UNARY_INDEX = -1,
-	SCALAR_INDEX = -2,
-	SCALAR_NULL_INDEX = -3,
-	NULLARY_INDEX = -4
-};
-
 /**
  * @brief Encodes an expression tree consisting of simple operations in a GPU
  * friendly format that we can later evaluate in a single GPU kernel call
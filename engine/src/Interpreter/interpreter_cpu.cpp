@@ -0,0 +1,817 @@
+#include "interpreter_cpu.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <limits>
+#include <map>
+#include <random>
+
+#include "CalciteExpressionParsing.h"
+#include "ExceptionHandling/BlazingThread.h"
+#include "error.hpp"
+
+namespace interops {
+namespace detail {
+namespace cpu {
+
+// Tiles start at a multiple of the bitmask word size so threads never write the same word
+constexpr cudf::size_type TILE_SIZE = 2048;
+
+template <typename T>
+T magic_number();
+
+template <>
+int64_t magic_number<int64_t>() {
+	return std::numeric_limits<int64_t>::max() - 13ll;
+}
+
+template <>
+double magic_number<double>() {
+	return 1.7976931348623123e+308;
+}
+
+int64_t nanoseconds_per_tick(cudf::type_id type) {
+	switch (type) {
+	case cudf::type_id::TIMESTAMP_DAYS: return 86400000000000ll;
+	case cudf::type_id::TIMESTAMP_SECONDS: return 1000000000ll;
+	case cudf::type_id::TIMESTAMP_MILLISECONDS: return 1000000ll;
+	case cudf::type_id::TIMESTAMP_MICROSECONDS: return 1000ll;
+	default: return 1;
+	}
+}
+
+int64_t ticks_per_day(cudf::type_id type) {
+	return 86400000000000ll / nanoseconds_per_tick(type);
+}
+
+int64_t floor_div(int64_t a, int64_t b) {
+	int64_t q = a / b;
+	return (a % b != 0 && ((a < 0) != (b < 0))) ? q - 1 : q;
+}
+
+// Days since 1970-01-01 from a proleptic gregorian date, see http://howardhinnant.github.io/date_algorithms.html
+int64_t days_from_civil(int64_t y, unsigned m, unsigned d) {
+	y -= m <= 2;
+	const int64_t era = floor_div(y, 400);
+	const unsigned yoe = static_cast<unsigned>(y - era * 400);
+	const unsigned doy = (153 * (m > 2 ? m - 3 : m + 9) + 2) / 5 + d - 1;
+	const unsigned doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+	return era * 146097 + static_cast<int64_t>(doe) - 719468;
+}
+
+void civil_from_days(int64_t z, int64_t & y, unsigned & m, unsigned & d) {
+	z += 719468;
+	const int64_t era = floor_div(z, 146097);
+	const unsigned doe = static_cast<unsigned>(z - era * 146097);
+	const unsigned yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+	const unsigned doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+	const unsigned mp = (5 * doy + 2) / 153;
+	d = doy - (153 * mp + 2) / 5 + 1;
+	m = mp < 10 ? mp + 3 : mp - 9;
+	y = static_cast<int64_t>(yoe) + era * 400 + (m <= 2);
+}
+
+int64_t extract_component(operator_type op, int64_t ticks, cudf::type_id type) {
+	int64_t per_day = ticks_per_day(type);
+	int64_t days = floor_div(ticks, per_day);
+	int64_t seconds_since_midnight = (ticks - days * per_day) * nanoseconds_per_tick(type) / 1000000000ll;
+
+	int64_t year;
+	unsigned month, day;
+	switch (op) {
+	case operator_type::BLZ_YEAR: civil_from_days(days, year, month, day); return year;
+	case operator_type::BLZ_MONTH: civil_from_days(days, year, month, day); return month;
+	case operator_type::BLZ_DAY: civil_from_days(days, year, month, day); return day;
+	case operator_type::BLZ_DAYOFWEEK: return (((days % 7) + 7) % 7 + 3) % 7 + 1; // 1970-01-01 was a thursday
+	case operator_type::BLZ_HOUR: return seconds_since_midnight / 3600;
+	case operator_type::BLZ_MINUTE: return (seconds_since_midnight % 3600) / 60;
+	case operator_type::BLZ_SECOND: return seconds_since_midnight % 60;
+	default: return 0;
+	}
+}
+
+bool is_supported_type(cudf::type_id type) {
+	return type == cudf::type_id::EMPTY || is_type_bool(type) || is_type_integer(type) || is_type_float(type) ||
+		is_type_timestamp(type) || type == cudf::type_id::UINT8 || type == cudf::type_id::UINT16 ||
+		type == cudf::type_id::UINT32 || type == cudf::type_id::UINT64;
+}
+
+bool is_supported_operator(operator_type op) {
+	switch (op) {
+	case operator_type::BLZ_RAND:
+	case operator_type::BLZ_NOT:
+	case operator_type::BLZ_ABS:
+	case operator_type::BLZ_FLOOR:
+	case operator_type::BLZ_CEIL:
+	case operator_type::BLZ_SIN:
+	case operator_type::BLZ_COS:
+	case operator_type::BLZ_ASIN:
+	case operator_type::BLZ_ACOS:
+	case operator_type::BLZ_TAN:
+	case operator_type::BLZ_COTAN:
+	case operator_type::BLZ_ATAN:
+	case operator_type::BLZ_LN:
+	case operator_type::BLZ_LOG:
+	case operator_type::BLZ_YEAR:
+	case operator_type::BLZ_MONTH:
+	case operator_type::BLZ_DAY:
+	case operator_type::BLZ_DAYOFWEEK:
+	case operator_type::BLZ_HOUR:
+	case operator_type::BLZ_MINUTE:
+	case operator_type::BLZ_SECOND:
+	case operator_type::BLZ_IS_NULL:
+	case operator_type::BLZ_IS_NOT_NULL:
+	case operator_type::BLZ_CAST_TINYINT:
+	case operator_type::BLZ_CAST_SMALLINT:
+	case operator_type::BLZ_CAST_INTEGER:
+	case operator_type::BLZ_CAST_BIGINT:
+	case operator_type::BLZ_CAST_FLOAT:
+	case operator_type::BLZ_CAST_DOUBLE:
+	case operator_type::BLZ_CAST_DATE:
+	case operator_type::BLZ_CAST_TIMESTAMP:
+	case operator_type::BLZ_ADD:
+	case operator_type::BLZ_SUB:
+	case operator_type::BLZ_MUL:
+	case operator_type::BLZ_DIV:
+	case operator_type::BLZ_MOD:
+	case operator_type::BLZ_POW:
+	case operator_type::BLZ_ROUND:
+	case operator_type::BLZ_EQUAL:
+	case operator_type::BLZ_NOT_EQUAL:
+	case operator_type::BLZ_LESS:
+	case operator_type::BLZ_GREATER:
+	case operator_type::BLZ_LESS_EQUAL:
+	case operator_type::BLZ_GREATER_EQUAL:
+	case operator_type::BLZ_LOGICAL_AND:
+	case operator_type::BLZ_LOGICAL_OR:
+	case operator_type::BLZ_FIRST_NON_MAGIC:
+	case operator_type::BLZ_MAGIC_IF_NOT:
+		return true;
+	default:
+		return false;
+	}
+}
+
+/**
+ * @brief Parses a literal into the representation used by the interpreter:
+ * a double for floating point types and an int64_t for any other type
+ */
+void parse_literal(const plan_literal & literal, int64_t & int_value, double & float_value) {
+	cudf::type_id type = literal.type.id();
+	int_value = 0;
+	float_value = 0;
+
+	if (is_type_float(type)) {
+		float_value = std::stod(literal.value);
+	} else if (is_type_bool(type)) {
+		int_value = (literal.value == "true" || literal.value == "1") ? 1 : 0;
+	} else if (is_type_timestamp(type) && literal.value.find('-', 1) != std::string::npos) {
+		int year = 0, month = 0, day = 0, hour = 0, minute = 0, second = 0;
+		int parsed = std::sscanf(literal.value.c_str(), "%d-%d-%d%*[ T]%d:%d:%d", &year, &month, &day, &hour, &minute, &second);
+		RAL_EXPECTS(parsed >= 3, "Invalid timestamp literal");
+		int64_t days = days_from_civil(year, month, day);
+		int64_t seconds = days * 86400 + hour * 3600 + minute * 60 + second;
+		int_value = type == cudf::type_id::TIMESTAMP_DAYS ? days : seconds * (1000000000ll / nanoseconds_per_tick(type));
+	} else {
+		int_value = std::stoll(literal.value);
+	}
+}
+
+struct operand {
+	column_index_type position;
+	cudf::type_id type;
+	bool is_float;
+	int64_t int_value;
+	double float_value;
+};
+
+struct operation {
+	operator_type op;
+	operand left;
+	operand right;
+	column_index_type output;
+	cudf::type_id output_type;
+	bool output_is_float;
+};
+
+/**
+ * @brief The values of all the positions of a plan for the rows of a tile
+ *
+ * Every position has an int64_t and a double buffer, only the one matching the
+ * type of the value held by the position is used.
+ */
+struct tile_state {
+	explicit tile_state(size_t num_positions)
+		: ints(num_positions), floats(num_positions), valids(num_positions, std::vector<uint8_t>(TILE_SIZE)),
+			scalar_ints(2, std::vector<int64_t>(TILE_SIZE)), scalar_floats(2, std::vector<double>(TILE_SIZE)),
+			scalar_valids(2, std::vector<uint8_t>(TILE_SIZE)), rng{std::random_device{}()} {}
+
+	template <typename T>
+	std::vector<std::vector<T>> & buffers();
+
+	template <typename T>
+	std::vector<std::vector<T>> & scalar_buffers();
+
+	template <typename T>
+	T * data(column_index_type position) {
+		std::vector<T> & buffer = buffers<T>()[position];
+		if (buffer.empty()) {
+			buffer.resize(TILE_SIZE);
+		}
+		return buffer.data();
+	}
+
+	template <typename T>
+	const T * operand_data(const operand & op, int side, cudf::size_type size) {
+		if (op.position >= 0) {
+			return data<T>(op.position);
+		}
+
+		// Scalars are broadcasted so every operation reads its operands the same way
+		T * scalar = scalar_buffers<T>()[side].data();
+		std::fill(scalar, scalar + size, op.is_float ? static_cast<T>(op.float_value) : static_cast<T>(op.int_value));
+		return scalar;
+	}
+
+	const uint8_t * operand_valids(const operand & op, int side, cudf::size_type size) {
+		if (op.position >= 0) {
+			return valids[op.position].data();
+		}
+
+		uint8_t * scalar = scalar_valids[side].data();
+		std::fill(scalar, scalar + size, op.position == SCALAR_INDEX ? 1 : 0);
+		return scalar;
+	}
+
+	std::vector<std::vector<int64_t>> ints;
+	std::vector<std::vector<double>> floats;
+	std::vector<std::vector<uint8_t>> valids;
+	std::vector<std::vector<int64_t>> scalar_ints;
+	std::vector<std::vector<double>> scalar_floats;
+	std::vector<std::vector<uint8_t>> scalar_valids;
+	std::mt19937_64 rng;
+};
+
+template <>
+std::vector<std::vector<int64_t>> & tile_state::buffers<int64_t>() { return ints; }
+
+template <>
+std::vector<std::vector<double>> & tile_state::buffers<double>() { return floats; }
+
+template <>
+std::vector<std::vector<int64_t>> & tile_state::scalar_buffers<int64_t>() { return scalar_ints; }
+
+template <>
+std::vector<std::vector<double>> & tile_state::scalar_buffers<double>() { return scalar_floats; }
+
+// Integer arithmetic wraps around as it does on the GPU
+template <typename L, typename R>
+auto add_values(L l, R r) { return l + r; }
+inline int64_t add_values(int64_t l, int64_t r) { return static_cast<int64_t>(static_cast<uint64_t>(l) + static_cast<uint64_t>(r)); }
+
+template <typename L, typename R>
+auto sub_values(L l, R r) { return l - r; }
+inline int64_t sub_values(int64_t l, int64_t r) { return static_cast<int64_t>(static_cast<uint64_t>(l) - static_cast<uint64_t>(r)); }
+
+template <typename L, typename R>
+auto mul_values(L l, R r) { return l * r; }
+inline int64_t mul_values(int64_t l, int64_t r) { return static_cast<int64_t>(static_cast<uint64_t>(l) * static_cast<uint64_t>(r)); }
+
+template <typename L, typename R>
+auto div_values(L l, R r) { return l / r; }
+inline int64_t div_values(int64_t l, int64_t r) { return r == -1 ? sub_values(int64_t{0}, l) : l / r; }
+
+template <typename L, typename R>
+double mod_values(L l, R r) { return std::fmod(static_cast<double>(l), static_cast<double>(r)); }
+inline int64_t mod_values(int64_t l, int64_t r) { return r == -1 ? 0 : l % r; }
+
+template <typename L, typename R, typename Out>
+void binary_kernel(const operation & info, const L * l, const R * r, const uint8_t * lv, const uint8_t * rv, Out * out, uint8_t * ov, cudf::size_type size) {
+	switch (info.op) {
+	case operator_type::BLZ_ADD:
+		for (cudf::size_type i = 0; i < size; i++) {
+			out[i] = static_cast<Out>(add_values(l[i], r[i]));
+			ov[i] = lv[i] & rv[i];
+		}
+		break;
+	case operator_type::BLZ_SUB:
+		for (cudf::size_type i = 0; i < size; i++) {
+			out[i] = static_cast<Out>(sub_values(l[i], r[i]));
+			ov[i] = lv[i] & rv[i];
+		}
+		break;
+	case operator_type::BLZ_MUL:
+		for (cudf::size_type i = 0; i < size; i++) {
+			out[i] = static_cast<Out>(mul_values(l[i], r[i]));
+			ov[i] = lv[i] & rv[i];
+		}
+		break;
+	case operator_type::BLZ_DIV:
+		// Division by zero is null
+		for (cudf::size_type i = 0; i < size; i++) {
+			bool non_zero = r[i] != 0;
+			out[i] = non_zero ? static_cast<Out>(div_values(l[i], r[i])) : Out{0};
+			ov[i] = lv[i] & rv[i] & non_zero;
+		}
+		break;
+	case operator_type::BLZ_MOD:
+		for (cudf::size_type i = 0; i < size; i++) {
+			if (std::is_integral<L>::value && std::is_integral<R>::value) {
+				bool non_zero = r[i] != 0;
+				out[i] = non_zero ? static_cast<Out>(mod_values(l[i], r[i])) : Out{0};
+				ov[i] = lv[i] & rv[i] & non_zero;
+			} else {
+				out[i] = static_cast<Out>(mod_values(l[i], r[i]));
+				ov[i] = lv[i] & rv[i];
+			}
+		}
+		break;
+	case operator_type::BLZ_POW:
+		for (cudf::size_type i = 0; i < size; i++) {
+			out[i] = static_cast<Out>(std::pow(static_cast<double>(l[i]), static_cast<double>(r[i])));
+			ov[i] = lv[i] & rv[i];
+		}
+		break;
+	case operator_type::BLZ_ROUND:
+		for (cudf::size_type i = 0; i < size; i++) {
+			double factor = std::pow(10, r[i]);
+			out[i] = static_cast<Out>(std::round(static_cast<double>(l[i]) * factor) / factor);
+			ov[i] = lv[i] & rv[i];
+		}
+		break;
+	case operator_type::BLZ_EQUAL:
+	case operator_type::BLZ_NOT_EQUAL:
+	case operator_type::BLZ_LESS:
+	case operator_type::BLZ_GREATER:
+	case operator_type::BLZ_LESS_EQUAL:
+	case operator_type::BLZ_GREATER_EQUAL: {
+		// Timestamps with different resolutions are compared in nanoseconds
+		bool timestamps = is_type_timestamp(info.left.type) && is_type_timestamp(info.right.type);
+		int64_t left_scale = timestamps ? nanoseconds_per_tick(info.left.type) : 1;
+		int64_t right_scale = timestamps ? nanoseconds_per_tick(info.right.type) : 1;
+		auto compare = [&](auto cmp) {
+			if (left_scale == right_scale) {
+				for (cudf::size_type i = 0; i < size; i++) {
+					out[i] = static_cast<Out>(cmp(l[i], r[i]));
+					ov[i] = lv[i] & rv[i];
+				}
+			} else {
+				for (cudf::size_type i = 0; i < size; i++) {
+					out[i] = static_cast<Out>(cmp(l[i] * left_scale, r[i] * right_scale));
+					ov[i] = lv[i] & rv[i];
+				}
+			}
+		};
+
+		switch (info.op) {
+		case operator_type::BLZ_EQUAL: compare([](auto a, auto b) { return a == b; }); break;
+		case operator_type::BLZ_NOT_EQUAL: compare([](auto a, auto b) { return a != b; }); break;
+		case operator_type::BLZ_LESS: compare([](auto a, auto b) { return a < b; }); break;
+		case operator_type::BLZ_GREATER: compare([](auto a, auto b) { return a > b; }); break;
+		case operator_type::BLZ_LESS_EQUAL: compare([](auto a, auto b) { return a <= b; }); break;
+		default: compare([](auto a, auto b) { return a >= b; }); break;
+		}
+		break;
+	}
+	case operator_type::BLZ_LOGICAL_AND:
+		for (cudf::size_type i = 0; i < size; i++) {
+			out[i] = static_cast<Out>(l[i] && r[i]);
+			ov[i] = lv[i] & rv[i];
+		}
+		break;
+	case operator_type::BLZ_LOGICAL_OR:
+		// Same null handling as the interpreter kernel
+		for (cudf::size_type i = 0; i < size; i++) {
+			if (lv[i] && rv[i]) {
+				out[i] = static_cast<Out>(l[i] || r[i]);
+				ov[i] = 1;
+			} else if (lv[i]) {
+				out[i] = static_cast<Out>(l[i]);
+				ov[i] = l[i] != 0;
+			} else if (rv[i]) {
+				out[i] = static_cast<Out>(r[i]);
+				ov[i] = 1;
+			} else {
+				out[i] = Out{0};
+				ov[i] = 0;
+			}
+		}
+		break;
+	case operator_type::BLZ_MAGIC_IF_NOT:
+		for (cudf::size_type i = 0; i < size; i++) {
+			if (lv[i] && l[i]) {
+				out[i] = static_cast<Out>(r[i]);
+				ov[i] = rv[i];
+			} else {
+				// Tells FIRST_NON_MAGIC to use its second operand
+				out[i] = static_cast<Out>(magic_number<R>());
+				ov[i] = 1;
+			}
+		}
+		break;
+	case operator_type::BLZ_FIRST_NON_MAGIC:
+		for (cudf::size_type i = 0; i < size; i++) {
+			if (l[i] == magic_number<L>()) {
+				out[i] = static_cast<Out>(r[i]);
+				ov[i] = rv[i];
+			} else {
+				out[i] = static_cast<Out>(l[i]);
+				ov[i] = lv[i];
+			}
+		}
+		break;
+	default:
+		break;
+	}
+}
+
+template <typename L, typename Out>
+void unary_kernel(const operation & info, const L * l, const uint8_t * lv, Out * out, uint8_t * ov, cudf::size_type size) {
+	auto apply = [&](auto fn) {
+		for (cudf::size_type i = 0; i < size; i++) {
+			out[i] = static_cast<Out>(fn(l[i]));
+			ov[i] = lv[i];
+		}
+	};
+
+	cudf::type_id left_type = info.left.type;
+	switch (info.op) {
+	case operator_type::BLZ_IS_NULL:
+		for (cudf::size_type i = 0; i < size; i++) {
+			out[i] = static_cast<Out>(!lv[i]);
+			ov[i] = 1;
+		}
+		break;
+	case operator_type::BLZ_IS_NOT_NULL:
+		for (cudf::size_type i = 0; i < size; i++) {
+			out[i] = static_cast<Out>(lv[i]);
+			ov[i] = 1;
+		}
+		break;
+	case operator_type::BLZ_FLOOR: apply([](L v) { return std::floor(static_cast<double>(v)); }); break;
+	case operator_type::BLZ_CEIL: apply([](L v) { return std::ceil(static_cast<double>(v)); }); break;
+	case operator_type::BLZ_SIN: apply([](L v) { return std::sin(static_cast<double>(v)); }); break;
+	case operator_type::BLZ_COS: apply([](L v) { return std::cos(static_cast<double>(v)); }); break;
+	case operator_type::BLZ_ASIN: apply([](L v) { return std::asin(static_cast<double>(v)); }); break;
+	case operator_type::BLZ_ACOS: apply([](L v) { return std::acos(static_cast<double>(v)); }); break;
+	case operator_type::BLZ_TAN: apply([](L v) { return std::tan(static_cast<double>(v)); }); break;
+	case operator_type::BLZ_COTAN: apply([](L v) { return std::cos(static_cast<double>(v)) / std::sin(static_cast<double>(v)); }); break;
+	case operator_type::BLZ_ATAN: apply([](L v) { return std::atan(static_cast<double>(v)); }); break;
+	case operator_type::BLZ_LN: apply([](L v) { return std::log(static_cast<double>(v)); }); break;
+	case operator_type::BLZ_LOG: apply([](L v) { return std::log10(static_cast<double>(v)); }); break;
+	case operator_type::BLZ_ABS: apply([](L v) { return v < 0 ? sub_values(L{0}, v) : v; }); break;
+	case operator_type::BLZ_NOT: apply([](L v) { return static_cast<int64_t>(!v); }); break;
+	case operator_type::BLZ_YEAR:
+	case operator_type::BLZ_MONTH:
+	case operator_type::BLZ_DAY:
+	case operator_type::BLZ_DAYOFWEEK:
+	case operator_type::BLZ_HOUR:
+	case operator_type::BLZ_MINUTE:
+	case operator_type::BLZ_SECOND: {
+		operator_type op = info.op;
+		apply([op, left_type](L v) { return extract_component(op, static_cast<int64_t>(v), left_type); });
+		break;
+	}
+	case operator_type::BLZ_CAST_TINYINT:
+	case operator_type::BLZ_CAST_SMALLINT:
+	case operator_type::BLZ_CAST_INTEGER:
+	case operator_type::BLZ_CAST_BIGINT:
+		apply([](L v) { return static_cast<int64_t>(v); });
+		break;
+	case operator_type::BLZ_CAST_FLOAT:
+	case operator_type::BLZ_CAST_DOUBLE:
+		apply([](L v) { return static_cast<double>(v); });
+		break;
+	case operator_type::BLZ_CAST_DATE: {
+		// Timestamps are truncated to days, any other value is already a number of days
+		int64_t per_day = is_type_timestamp(left_type) ? ticks_per_day(left_type) : 1;
+		apply([per_day](L v) { return static_cast<int64_t>(v) / per_day; });
+		break;
+	}
+	case operator_type::BLZ_CAST_TIMESTAMP: {
+		int64_t scale = is_type_timestamp(left_type) ? nanoseconds_per_tick(left_type) : 1;
+		apply([scale](L v) { return static_cast<int64_t>(v) * scale; });
+		break;
+	}
+	default:
+		break;
+	}
+}
+
+template <typename L, typename R>
+void run_binary(tile_state & state, const operation & info, cudf::size_type size) {
+	const L * l = state.operand_data<L>(info.left, 0, size);
+	const R * r = state.operand_data<R>(info.right, 1, size);
+	const uint8_t * lv = state.operand_valids(info.left, 0, size);
+	const uint8_t * rv = state.operand_valids(info.right, 1, size);
+	uint8_t * ov = state.valids[info.output].data();
+	if (info.output_is_float) {
+		binary_kernel(info, l, r, lv, rv, state.data<double>(info.output), ov, size);
+	} else {
+		binary_kernel(info, l, r, lv, rv, state.data<int64_t>(info.output), ov, size);
+	}
+}
+
+template <typename L>
+void run_unary(tile_state & state, const operation & info, cudf::size_type size) {
+	const L * l = state.operand_data<L>(info.left, 0, size);
+	const uint8_t * lv = state.operand_valids(info.left, 0, size);
+	uint8_t * ov = state.valids[info.output].data();
+	if (info.output_is_float) {
+		unary_kernel(info, l, lv, state.data<double>(info.output), ov, size);
+	} else {
+		unary_kernel(info, l, lv, state.data<int64_t>(info.output), ov, size);
+	}
+}
+
+void run_operation(tile_state & state, const operation & info, cudf::size_type size) {
+	if (info.right.position == NULLARY_INDEX) {
+		// RAND, the interpreter draws from (0, 1]
+		std::uniform_real_distribution<double> distribution(0.0, 1.0);
+		double * out = state.data<double>(info.output);
+		uint8_t * ov = state.valids[info.output].data();
+		for (cudf::size_type i = 0; i < size; i++) {
+			out[i] = 1.0 - distribution(state.rng);
+			ov[i] = 1;
+		}
+	} else if (info.right.position == UNARY_INDEX) {
+		if (info.left.is_float) {
+			run_unary<double>(state, info, size);
+		} else {
+			run_unary<int64_t>(state, info, size);
+		}
+	} else if (info.left.is_float) {
+		if (info.right.is_float) {
+			run_binary<double, double>(state, info, size);
+		} else {
+			run_binary<double, int64_t>(state, info, size);
+		}
+	} else {
+		if (info.right.is_float) {
+			run_binary<int64_t, double>(state, info, size);
+		} else {
+			run_binary<int64_t, int64_t>(state, info, size);
+		}
+	}
+}
+
+template <typename ColType, typename T>
+void read_values(const void * data, cudf::size_type begin, cudf::size_type size, T * out) {
+	const ColType * values = static_cast<const ColType *>(data) + begin;
+	for (cudf::size_type i = 0; i < size; i++) {
+		out[i] = static_cast<T>(values[i]);
+	}
+}
+
+template <typename ColType, typename T>
+void write_values(void * data, cudf::size_type begin, cudf::size_type size, const T * in) {
+	ColType * values = static_cast<ColType *>(data) + begin;
+	for (cudf::size_type i = 0; i < size; i++) {
+		values[i] = static_cast<ColType>(in[i]);
+	}
+}
+
+template <typename T>
+void read_column(const host_column_view & column, cudf::size_type begin, cudf::size_type size, T * out) {
+	switch (column.type.id()) {
+	case cudf::type_id::BOOL8: read_values<bool>(column.data, begin, size, out); break;
+	case cudf::type_id::INT8: read_values<int8_t>(column.data, begin, size, out); break;
+	case cudf::type_id::INT16: read_values<int16_t>(column.data, begin, size, out); break;
+	case cudf::type_id::INT32: read_values<int32_t>(column.data, begin, size, out); break;
+	case cudf::type_id::UINT8: read_values<uint8_t>(column.data, begin, size, out); break;
+	case cudf::type_id::UINT16: read_values<uint16_t>(column.data, begin, size, out); break;
+	case cudf::type_id::UINT32: read_values<uint32_t>(column.data, begin, size, out); break;
+	case cudf::type_id::UINT64: read_values<uint64_t>(column.data, begin, size, out); break;
+	case cudf::type_id::FLOAT32: read_values<float>(column.data, begin, size, out); break;
+	case cudf::type_id::FLOAT64: read_values<double>(column.data, begin, size, out); break;
+	case cudf::type_id::TIMESTAMP_DAYS: read_values<int32_t>(column.data, begin, size, out); break;
+	default: read_values<int64_t>(column.data, begin, size, out); break;
+	}
+}
+
+template <typename T>
+void write_column(const host_mutable_column_view & column, cudf::size_type begin, cudf::size_type size, const T * in) {
+	switch (column.type.id()) {
+	case cudf::type_id::BOOL8: write_values<bool>(column.data, begin, size, in); break;
+	case cudf::type_id::INT8: write_values<int8_t>(column.data, begin, size, in); break;
+	case cudf::type_id::INT16: write_values<int16_t>(column.data, begin, size, in); break;
+	case cudf::type_id::INT32: write_values<int32_t>(column.data, begin, size, in); break;
+	case cudf::type_id::UINT8: write_values<uint8_t>(column.data, begin, size, in); break;
+	case cudf::type_id::UINT16: write_values<uint16_t>(column.data, begin, size, in); break;
+	case cudf::type_id::UINT32: write_values<uint32_t>(column.data, begin, size, in); break;
+	case cudf::type_id::UINT64: write_values<uint64_t>(column.data, begin, size, in); break;
+	case cudf::type_id::FLOAT32: write_values<float>(column.data, begin, size, in); break;
+	case cudf::type_id::FLOAT64: write_values<double>(column.data, begin, size, in); break;
+	case cudf::type_id::TIMESTAMP_DAYS: write_values<int32_t>(column.data, begin, size, in); break;
+	default: write_values<int64_t>(column.data, begin, size, in); break;
+	}
+}
+
+constexpr cudf::size_type BITS_PER_WORD = sizeof(cudf::bitmask_type) * 8;
+
+void read_valids(const cudf::bitmask_type * null_mask, cudf::size_type begin, cudf::size_type size, uint8_t * out) {
+	if (null_mask == nullptr) {
+		std::fill(out, out + size, 1);
+		return;
+	}
+
+	for (cudf::size_type i = 0; i < size; i++) {
+		cudf::size_type row = begin + i;
+		out[i] = (null_mask[row / BITS_PER_WORD] >> (row % BITS_PER_WORD)) & 1;
+	}
+}
+
+void write_valids(cudf::bitmask_type * null_mask, cudf::size_type begin, cudf::size_type size, const uint8_t * in) {
+	if (null_mask == nullptr) {
+		return;
+	}
+
+	for (cudf::size_type word = 0; word * BITS_PER_WORD < size; word++) {
+		cudf::bitmask_type bits = 0;
+		cudf::size_type word_size = std::min(BITS_PER_WORD, size - word * BITS_PER_WORD);
+		for (cudf::size_type bit = 0; bit < word_size; bit++) {
+			bits |= static_cast<cudf::bitmask_type>(in[word * BITS_PER_WORD + bit] != 0) << bit;
+		}
+		null_mask[(begin / BITS_PER_WORD) + word] = bits;
+	}
+}
+
+class cpu_interpreter {
+public:
+	cpu_interpreter(const std::vector<host_mutable_column_view> & out_columns,
+		const std::vector<host_column_view> & input_columns,
+		const interpreter_plan & plan)
+		: out_columns_{out_columns}, input_columns_{input_columns}, final_output_positions_{plan.final_output_positions} {
+
+		RAL_EXPECTS(out_columns.size() == plan.final_output_positions.size(), "The number of output columns does not match the plan");
+		RAL_EXPECTS(input_columns.size() == static_cast<size_t>(plan.num_inputs), "The number of input columns does not match the plan");
+
+		for (auto & column : input_columns) {
+			RAL_EXPECTS(is_supported_type(column.type.id()), "The CPU interpreter only supports fixed width columns");
+		}
+		for (auto & column : out_columns) {
+			RAL_EXPECTS(is_supported_type(column.type.id()), "The CPU interpreter only supports fixed width columns");
+		}
+
+		num_positions_ = std::max<size_t>(plan.max_position() + 1, 1);
+
+		// Infer the types of all the positions the same way perform_interpreter_operation does
+		std::map<column_index_type, cudf::type_id> output_map_type;
+		auto make_operand = [&](column_index_type position, const plan_literal & literal) {
+			operand op{position, cudf::type_id::EMPTY, false, 0, 0};
+			if (position >= 0 && position < plan.num_inputs) {
+				op.type = input_columns[position].type.id();
+			} else if (position == SCALAR_INDEX) {
+				op.type = literal.type.id();
+				parse_literal(literal, op.int_value, op.float_value);
+			} else if (position >= 0) {
+				op.type = output_map_type[position];
+			}
+			op.is_float = is_type_float(op.type);
+			return op;
+		};
+
+		for (size_t i = 0; i < plan.operators.size(); i++) {
+			RAL_EXPECTS(is_supported_operator(plan.operators[i]), "Operator not supported by the CPU interpreter");
+
+			operation info;
+			info.op = plan.operators[i];
+			info.left = make_operand(plan.left_inputs[i], plan.left_literals[i]);
+			info.right = make_operand(plan.right_inputs[i], plan.right_literals[i]);
+			info.output = plan.outputs[i];
+
+			if (info.right.position == UNARY_INDEX) {
+				RAL_EXPECTS(info.left.position >= 0, "Unary operations on literals is not supported");
+				info.output_type = get_output_type(info.op, info.left.type);
+			} else if (info.right.position == NULLARY_INDEX) {
+				info.output_type = get_output_type(info.op);
+			} else {
+				info.output_type = get_output_type(info.op, info.left.type, info.right.type);
+			}
+			info.output_is_float = is_type_float(info.output_type);
+
+			output_map_type[info.output] = info.output_type;
+			operations_.push_back(info);
+		}
+
+		for (auto position : final_output_positions_) {
+			final_is_float_.push_back(position < plan.num_inputs ? is_type_float(input_columns[position].type.id()) : is_type_float(output_map_type[position]));
+		}
+	}
+
+	void run(cudf::size_type num_rows, size_t num_threads) {
+		cudf::size_type num_tiles = (num_rows + TILE_SIZE - 1) / TILE_SIZE;
+		if (num_tiles == 0) {
+			return;
+		}
+
+		if (num_threads == 0) {
+			num_threads = std::max(1u, BlazingThread::hardware_concurrency());
+		}
+		num_threads = std::min<size_t>(num_threads, num_tiles);
+
+		cudf::size_type tiles_per_thread = (num_tiles + num_threads - 1) / num_threads;
+		auto process_tiles = [this, num_rows, tiles_per_thread](cudf::size_type first_tile) {
+			tile_state state(num_positions_);
+			cudf::size_type last_tile = std::min<cudf::size_type>(first_tile + tiles_per_thread, (num_rows + TILE_SIZE - 1) / TILE_SIZE);
+			for (cudf::size_type tile = first_tile; tile < last_tile; tile++) {
+				cudf::size_type begin = tile * TILE_SIZE;
+				process_tile(state, begin, std::min(TILE_SIZE, num_rows - begin));
+			}
+		};
+
+		if (num_threads == 1) {
+			process_tiles(0);
+			return;
+		}
+
+		std::vector<BlazingThread> threads;
+		for (size_t i = 0; i < num_threads; i++) {
+			threads.push_back(BlazingThread(process_tiles, static_cast<cudf::size_type>(i * tiles_per_thread)));
+		}
+		for (auto & thread : threads) {
+			thread.join();
+		}
+	}
+
+private:
+	void process_tile(tile_state & state, cudf::size_type begin, cudf::size_type size) {
+		for (size_t i = 0; i < input_columns_.size(); i++) {
+			const host_column_view & column = input_columns_[i];
+			if (is_type_float(column.type.id())) {
+				read_column(column, begin, size, state.data<double>(i));
+			} else {
+				read_column(column, begin, size, state.data<int64_t>(i));
+			}
+			read_valids(column.null_mask, begin, size, state.valids[i].data());
+		}
+
+		for (auto & info : operations_) {
+			run_operation(state, info, size);
+		}
+
+		for (size_t i = 0; i < out_columns_.size(); i++) {
+			column_index_type position = final_output_positions_[i];
+			if (final_is_float_[i]) {
+				write_column(out_columns_[i], begin, size, state.data<double>(position));
+			} else {
+				write_column(out_columns_[i], begin, size, state.data<int64_t>(position));
+			}
+			write_valids(out_columns_[i].null_mask, begin, size, state.valids[position].data());
+		}
+	}
+
+	const std::vector<host_mutable_column_view> & out_columns_;
+	const std::vector<host_column_view> & input_columns_;
+	std::vector<column_index_type> final_output_positions_;
+	std::vector<bool> final_is_float_;
+	std::vector<operation> operations_;
+	size_t num_positions_;
+};
+
+} // namespace cpu
+} // namespace detail
+
+bool can_perform_interpreter_operation_cpu(const interpreter_plan & plan,
+	const std::vector<cudf::data_type> & input_types,
+	const std::vector<cudf::data_type> & output_types) {
+
+	for (auto & type : input_types) {
+		if (!detail::cpu::is_supported_type(type.id())) {
+			return false;
+		}
+	}
+	for (auto & type : output_types) {
+		if (!detail::cpu::is_supported_type(type.id())) {
+			return false;
+		}
+	}
+
+	for (size_t i = 0; i < plan.operators.size(); i++) {
+		if (!detail::cpu::is_supported_operator(plan.operators[i])) {
+			return false;
+		}
+		if (plan.right_inputs[i] == UNARY_INDEX && plan.left_inputs[i] < 0) {
+			return false;
+		}
+	}
+
+	return true;
+}
+
+void perform_interpreter_operation_cpu(const std::vector<host_mutable_column_view> & out_columns,
+	const std::vector<host_column_view> & input_columns,
+	const interpreter_plan & plan,
+	cudf::size_type num_rows,
+	size_t num_threads) {
+
+	if (plan.final_output_positions.empty()) {
+		return;
+	}
+
+	detail::cpu::cpu_interpreter interpreter(out_columns, input_columns, plan);
+	interpreter.run(num_rows, num_threads);
+}
+
+} // namespace interops
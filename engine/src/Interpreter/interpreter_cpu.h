@@ -0,0 +1,75 @@
+/*
+ * interpreter_cpu.h
+ *
+ * Host implementation of the interpreter, evaluates the same plans that
+ * perform_interpreter_operation evaluates on the GPU over host resident columns.
+ */
+
+#pragma once
+
+#include <vector>
+#include <cudf/types.hpp>
+#include "interpreter_plan.h"
+
+namespace interops {
+
+/**
+ * @brief A fixed width column in host memory
+ *
+ * null_mask uses the cudf bitmask layout and can be nullptr if all the values are valid.
+ */
+struct host_column_view {
+	cudf::data_type type;
+	const void * data;
+	const cudf::bitmask_type * null_mask;
+};
+
+/**
+ * @brief A fixed width column in host memory where the interpreter writes its results
+ *
+ * null_mask uses the cudf bitmask layout and can be nullptr if the validity of
+ * the results is not needed.
+ */
+struct host_mutable_column_view {
+	cudf::data_type type;
+	void * data;
+	cudf::bitmask_type * null_mask;
+};
+
+/**
+ * @brief Returns true if perform_interpreter_operation_cpu can evaluate the plan
+ * over columns of the given types
+ *
+ * @param plan The plan to evaluate
+ * @param input_types The types of the input columns of the plan
+ * @param output_types The types of the output columns of the plan
+ */
+bool can_perform_interpreter_operation_cpu(const interpreter_plan & plan,
+	const std::vector<cudf::data_type> & input_types,
+	const std::vector<cudf::data_type> & output_types);
+
+/**
+ * @brief Evaluates an interpreter plan on the CPU
+ *
+ * The rows are processed in tiles, every operation of the plan is evaluated for
+ * all the rows of a tile before moving to the next operation so the inner loops
+ * can be vectorized by the compiler. Tiles are distributed among threads.
+ *
+ * The results match perform_interpreter_operation with these differences:
+ * - String columns are not supported
+ * - Integer MOD by zero produces a null instead of an undefined value
+ * - Plans are not limited to 64 positions
+ *
+ * @param out_columns The output columns, one per final output position of the plan
+ * @param input_columns The input columns of the plan
+ * @param plan The plan to evaluate
+ * @param num_rows The number of rows to evaluate
+ * @param num_threads The number of threads to use, 0 uses as many as the hardware supports
+ */
+void perform_interpreter_operation_cpu(const std::vector<host_mutable_column_view> & out_columns,
+	const std::vector<host_column_view> & input_columns,
+	const interpreter_plan & plan,
+	cudf::size_type num_rows,
+	size_t num_threads = 0);
+
+} // namespace interops
@@ -0,0 +1,621 @@
+#include "interpreter_plan.h"
+
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+#include <limits>
+#include <set>
+#include <sstream>
+
+#include "CalciteExpressionParsing.h"
+#include "error.hpp"
+
+namespace interops {
+
+column_index_type interpreter_plan::max_position() const {
+	column_index_type max_pos = static_cast<column_index_type>(num_inputs - 1);
+	for (size_t i = 0; i < operators.size(); i++) {
+		max_pos = std::max({max_pos, left_inputs[i], right_inputs[i], outputs[i]});
+	}
+	return max_pos;
+}
+
+namespace detail {
+
+struct plan_encoding_visitor : public ral::parser::node_visitor {
+public:
+	plan_encoding_visitor(const std::map<column_index_type, column_index_type> & expr_idx_to_col_idx_map, interpreter_plan & plan)
+		: expr_idx_to_col_idx_map{expr_idx_to_col_idx_map}, plan{plan} {}
+
+	void visit(const ral::parser::operad_node& node) override {
+		if (node.type == ral::parser::node_type::LITERAL) {
+			auto & literal_node = static_cast<const ral::parser::literal_node&>(node);
+			node_to_operand_.insert({&node, {is_null(node.value) ? SCALAR_NULL_INDEX : SCALAR_INDEX, {node.value, literal_node.type()}}});
+		} else {
+			column_index_type position = expr_idx_to_col_idx_map.at(static_cast<const ral::parser::variable_node&>(node).index());
+			node_to_operand_.insert({&node, {position, empty_literal()}});
+		}
+	}
+
+	void visit(const ral::parser::operator_node& node) override {
+		operator_type operation = map_to_operator_type(node.value);
+
+		operand left{NULLARY_INDEX, empty_literal()};
+		operand right{NULLARY_INDEX, empty_literal()};
+		if (is_binary_operator(operation)) {
+			left = node_to_operand_.at(node.children[0].get());
+			right = node_to_operand_.at(node.children[1].get());
+		} else if (is_unary_operator(operation)) {
+			left = node_to_operand_.at(node.children[0].get());
+			right = {UNARY_INDEX, empty_literal()};
+		}
+
+		column_index_type position = static_cast<column_index_type>(plan.num_inputs + plan.operators.size());
+
+		plan.operators.push_back(operation);
+		plan.left_inputs.push_back(left.position);
+		plan.right_inputs.push_back(right.position);
+		plan.left_literals.push_back(left.literal);
+		plan.right_literals.push_back(right.literal);
+		plan.outputs.push_back(position);
+
+		node_to_operand_.insert({&node, {position, empty_literal()}});
+		last_position_ = position;
+	}
+
+	column_index_type last_position() const { return last_position_; }
+
+private:
+	struct operand {
+		column_index_type position;
+		plan_literal literal;
+	};
+
+	static plan_literal empty_literal() { return {"", cudf::data_type{cudf::type_id::EMPTY}}; }
+
+	std::map<const ral::parser::node*, operand> node_to_operand_;
+	column_index_type last_position_ = -1;
+
+	const std::map<column_index_type, column_index_type> & expr_idx_to_col_idx_map;
+	interpreter_plan & plan;
+};
+
+bool is_foldable_type(cudf::type_id type) {
+	return is_type_bool(type) || is_type_integer(type) || is_type_float(type);
+}
+
+/**
+ * @brief A numeric literal value, kept the same way the interpreter keeps it
+ * while evaluating an operation: as a double for floating point types and as
+ * an int64_t for any other type
+ */
+struct folded_value {
+	bool is_float;
+	int64_t int_value;
+	double float_value;
+
+	double as_double() const { return is_float ? float_value : static_cast<double>(int_value); }
+	bool as_bool() const { return is_float ? float_value != 0 : int_value != 0; }
+};
+
+bool parse_folded_value(const plan_literal & literal, folded_value & value) {
+	cudf::type_id type = literal.type.id();
+	if (!is_foldable_type(type) || is_null(literal.value)) {
+		return false;
+	}
+
+	try {
+		if (is_type_bool(type)) {
+			value = {false, literal.value == "true" ? 1 : 0, 0};
+		} else if (is_type_integer(type)) {
+			value = {false, std::stoll(literal.value), 0};
+		} else {
+			value = {true, 0, std::stod(literal.value)};
+		}
+	} catch (const std::exception &) {
+		return false;
+	}
+	return true;
+}
+
+/**
+ * @brief Whether an int64 value is kept as is by a literal of this type. The
+ * interpreter evaluates with int64 temporaries, so a folded value that would be
+ * narrowed could differ from the value the unfolded operations compute.
+ */
+bool fits_integer_type(int64_t value, cudf::type_id type) {
+	switch (type) {
+	case cudf::type_id::INT8: return value >= std::numeric_limits<int8_t>::min() && value <= std::numeric_limits<int8_t>::max();
+	case cudf::type_id::INT16: return value >= std::numeric_limits<int16_t>::min() && value <= std::numeric_limits<int16_t>::max();
+	case cudf::type_id::INT32: return value >= std::numeric_limits<int32_t>::min() && value <= std::numeric_limits<int32_t>::max();
+	case cudf::type_id::UINT8: return value >= 0 && value <= std::numeric_limits<uint8_t>::max();
+	case cudf::type_id::UINT16: return value >= 0 && value <= std::numeric_limits<uint16_t>::max();
+	case cudf::type_id::UINT32: return value >= 0 && value <= std::numeric_limits<uint32_t>::max();
+	case cudf::type_id::UINT64: return value >= 0;
+	default: return true;
+	}
+}
+
+bool format_folded_value(const folded_value & value, cudf::type_id type, std::string & out) {
+	std::ostringstream stream;
+	if (is_type_bool(type)) {
+		out = value.as_bool() ? "true" : "false";
+		return true;
+	} else if (is_type_float(type)) {
+		double val = value.as_double();
+		if (!std::isfinite(val)) {
+			return false;
+		}
+		if (type == cudf::type_id::FLOAT32) {
+			// the interpreter keeps double temporaries, a value float can not hold is not folded
+			if (static_cast<double>(static_cast<float>(val)) != val) {
+				return false;
+			}
+			stream << std::setprecision(std::numeric_limits<float>::max_digits10) << static_cast<float>(val);
+		} else {
+			stream << std::setprecision(std::numeric_limits<double>::max_digits10) << val;
+		}
+	} else if (is_type_integer(type)) {
+		if (value.is_float) {
+			return false;
+		}
+		if (!fits_integer_type(value.int_value, type)) {
+			return false;
+		}
+		stream << value.int_value;
+	} else {
+		return false;
+	}
+	out = stream.str();
+	return true;
+}
+
+/**
+ * @brief Evaluates an operation over literals the same way the interpreter
+ * would. Returns false if the operation can not be folded.
+ */
+bool fold_operation(operator_type op, const plan_literal * left, const plan_literal * right, plan_literal & result) {
+	folded_value l, r, res;
+
+	if (op == operator_type::BLZ_IS_NULL || op == operator_type::BLZ_IS_NOT_NULL) {
+		bool null_value = is_null(left->value);
+		res = {false, (op == operator_type::BLZ_IS_NULL) == null_value ? 1 : 0, 0};
+		result.type = cudf::data_type{cudf::type_id::BOOL8};
+		return format_folded_value(res, result.type.id(), result.value);
+	}
+
+	if (!parse_folded_value(*left, l)) {
+		return false;
+	}
+
+	if (right == nullptr) {
+		if (op != operator_type::BLZ_NOT) {
+			return false;
+		}
+		res = {false, l.as_bool() ? 0 : 1, 0};
+		result.type = cudf::data_type{get_output_type(op, left->type.id())};
+		return format_folded_value(res, result.type.id(), result.value);
+	}
+
+	if (!parse_folded_value(*right, r)) {
+		return false;
+	}
+
+	bool use_float = l.is_float || r.is_float;
+	switch (op) {
+	case operator_type::BLZ_ADD:
+	case operator_type::BLZ_SUB:
+	case operator_type::BLZ_MUL:
+		if (use_float) {
+			double val = op == operator_type::BLZ_ADD ? l.as_double() + r.as_double()
+								 : op == operator_type::BLZ_SUB ? l.as_double() - r.as_double()
+								 : l.as_double() * r.as_double();
+			res = {true, 0, val};
+		} else {
+			int64_t val;
+			bool overflow = op == operator_type::BLZ_ADD ? __builtin_add_overflow(l.int_value, r.int_value, &val)
+										: op == operator_type::BLZ_SUB ? __builtin_sub_overflow(l.int_value, r.int_value, &val)
+										: __builtin_mul_overflow(l.int_value, r.int_value, &val);
+			if (overflow) {
+				return false;
+			}
+			res = {false, val, 0};
+		}
+		break;
+	case operator_type::BLZ_DIV:
+	case operator_type::BLZ_MOD:
+		// Division by zero is left to the interpreter
+		if (r.as_double() == 0) {
+			return false;
+		}
+		if (use_float) {
+			res = {true, 0, op == operator_type::BLZ_DIV ? l.as_double() / r.as_double() : std::fmod(l.as_double(), r.as_double())};
+		} else {
+			if (l.int_value == std::numeric_limits<int64_t>::min() && r.int_value == -1) {
+				return false;
+			}
+			res = {false, op == operator_type::BLZ_DIV ? l.int_value / r.int_value : l.int_value % r.int_value, 0};
+		}
+		break;
+	case operator_type::BLZ_EQUAL:
+		res = {false, use_float ? l.as_double() == r.as_double() : l.int_value == r.int_value, 0};
+		break;
+	case operator_type::BLZ_NOT_EQUAL:
+		res = {false, use_float ? l.as_double() != r.as_double() : l.int_value != r.int_value, 0};
+		break;
+	case operator_type::BLZ_LESS:
+		res = {false, use_float ? l.as_double() < r.as_double() : l.int_value < r.int_value, 0};
+		break;
+	case operator_type::BLZ_GREATER:
+		res = {false, use_float ? l.as_double() > r.as_double() : l.int_value > r.int_value, 0};
+		break;
+	case operator_type::BLZ_LESS_EQUAL:
+		res = {false, use_float ? l.as_double() <= r.as_double() : l.int_value <= r.int_value, 0};
+		break;
+	case operator_type::BLZ_GREATER_EQUAL:
+		res = {false, use_float ? l.as_double() >= r.as_double() : l.int_value >= r.int_value, 0};
+		break;
+	case operator_type::BLZ_LOGICAL_AND:
+		res = {false, l.as_bool() && r.as_bool(), 0};
+		break;
+	case operator_type::BLZ_LOGICAL_OR:
+		res = {false, l.as_bool() || r.as_bool(), 0};
+		break;
+	default:
+		return false;
+	}
+
+	result.type = cudf::data_type{get_output_type(op, left->type.id(), right->type.id())};
+	return format_folded_value(res, result.type.id(), result.value);
+}
+
+/**
+ * @brief A plan represented as a graph of values where every distinct value is
+ * stored once.
+ *
+ * Values are added in topological order so the id of a value is always greater
+ * than the ids of its operands.
+ */
+class value_graph {
+public:
+	enum class value_kind { INPUT, LITERAL, OPERATION };
+
+	struct value {
+		value_kind kind;
+		column_index_type input;
+		plan_literal literal;
+		operator_type op;
+		int left;
+		int right;
+		int folded; // the id of the literal this operation evaluates to, -1 if it can't be folded
+	};
+
+	explicit value_graph(const interpreter_plan & plan) {
+		std::map<column_index_type, int> position_to_value;
+
+		auto operand_value = [&](column_index_type position, const plan_literal & literal) -> int {
+			if (position == SCALAR_INDEX || position == SCALAR_NULL_INDEX) {
+				return add_literal(literal);
+			} else if (position < 0) {
+				return -1;
+			}
+
+			auto it = position_to_value.find(position);
+			if (it != position_to_value.end()) {
+				return it->second;
+			}
+
+			RAL_EXPECTS(position < plan.num_inputs, "Interpreter plan reads a position that was not computed before");
+			return add_input(position);
+		};
+
+		for (size_t i = 0; i < plan.operators.size(); i++) {
+			int left = operand_value(plan.left_inputs[i], plan.left_literals[i]);
+			int right = operand_value(plan.right_inputs[i], plan.right_literals[i]);
+			position_to_value[plan.outputs[i]] = add_operation(plan.operators[i], left, right);
+		}
+
+		for (auto position : plan.final_output_positions) {
+			auto it = position_to_value.find(position);
+			RAL_EXPECTS(it != position_to_value.end(), "Interpreter plan final outputs must be computed by an operation");
+			finals_.push_back(it->second);
+		}
+	}
+
+	const std::vector<int> & finals() const { return finals_; }
+
+	/**
+	 * @brief Collects the operations and the inputs needed to compute a value
+	 */
+	void collect_dependencies(int id, std::set<int> & operations, std::set<column_index_type> & inputs) const {
+		const value & val = values_[id];
+		if (val.kind == value_kind::INPUT) {
+			inputs.insert(val.input);
+		} else if (val.kind == value_kind::OPERATION && operations.insert(id).second) {
+			for (int operand : {val.left, val.right}) {
+				if (operand >= 0) {
+					collect_dependencies(operand, operations, inputs);
+				}
+			}
+		}
+	}
+
+	/**
+	 * @brief Encodes the operations needed by some final outputs as a plan,
+	 * reusing every position as soon as possible
+	 *
+	 * @param finals The values of the final outputs
+	 * @param input_indices The inputs of the plan, in order
+	 */
+	interpreter_plan encode(const std::vector<int> & finals, const std::vector<column_index_type> & input_indices) const {
+		interpreter_plan plan;
+		plan.num_inputs = input_indices.size();
+
+		std::map<column_index_type, column_index_type> input_positions;
+		for (size_t i = 0; i < input_indices.size(); i++) {
+			input_positions[input_indices[i]] = i;
+		}
+
+		std::set<int> operations;
+		std::set<column_index_type> inputs;
+		for (int id : finals) {
+			collect_dependencies(id, operations, inputs);
+		}
+
+		// The last operation that reads each value, final outputs must be kept until the end
+		std::map<int, int> last_use;
+		for (int id : operations) {
+			for (int operand : {values_[id].left, values_[id].right}) {
+				if (operand >= 0 && values_[operand].kind == value_kind::OPERATION) {
+					last_use[operand] = id;
+				}
+			}
+		}
+		for (int id : finals) {
+			last_use[id] = std::numeric_limits<int>::max();
+		}
+
+		std::map<int, column_index_type> value_positions;
+		std::set<column_index_type> free_positions;
+		column_index_type next_position = static_cast<column_index_type>(plan.num_inputs);
+
+		auto encode_operand = [&](int operand, column_index_type & position, plan_literal & literal) {
+			literal = plan_literal{"", cudf::data_type{cudf::type_id::EMPTY}};
+			const value & val = values_[operand];
+			if (val.kind == value_kind::INPUT) {
+				position = input_positions.at(val.input);
+			} else if (val.kind == value_kind::LITERAL) {
+				position = is_null(val.literal.value) ? SCALAR_NULL_INDEX : SCALAR_INDEX;
+				literal = val.literal;
+			} else {
+				position = value_positions.at(operand);
+			}
+		};
+
+		for (int id : operations) {
+			const value & val = values_[id];
+
+			column_index_type left_position = NULLARY_INDEX;
+			column_index_type right_position = NULLARY_INDEX;
+			plan_literal left_literal{"", cudf::data_type{cudf::type_id::EMPTY}};
+			plan_literal right_literal{"", cudf::data_type{cudf::type_id::EMPTY}};
+			if (val.left >= 0) {
+				encode_operand(val.left, left_position, left_literal);
+				RAL_EXPECTS(val.right >= 0 || left_position >= 0, "Unary operations on literals is not supported");
+				right_position = UNARY_INDEX;
+			}
+			if (val.right >= 0) {
+				encode_operand(val.right, right_position, right_literal);
+			}
+
+			// Release the operands that are no longer needed before choosing the output
+			// position, the interpreter reads the operands before writing the result
+			for (int operand : {val.left, val.right}) {
+				if (operand >= 0 && values_[operand].kind == value_kind::OPERATION && last_use.at(operand) == id) {
+					free_positions.insert(value_positions.at(operand));
+				}
+			}
+
+			column_index_type position;
+			if (free_positions.empty()) {
+				position = next_position++;
+			} else {
+				position = *free_positions.begin();
+				free_positions.erase(free_positions.begin());
+			}
+			value_positions[id] = position;
+
+			plan.operators.push_back(val.op);
+			plan.left_inputs.push_back(left_position);
+			plan.right_inputs.push_back(right_position);
+			plan.left_literals.push_back(left_literal);
+			plan.right_literals.push_back(right_literal);
+			plan.outputs.push_back(position);
+		}
+
+		for (int id : finals) {
+			plan.final_output_positions.push_back(value_positions.at(id));
+		}
+
+		return plan;
+	}
+
+private:
+	int intern(const std::string & key, value val) {
+		auto it = interned_.find(key);
+		if (it != interned_.end()) {
+			return it->second;
+		}
+
+		values_.push_back(std::move(val));
+		int id = static_cast<int>(values_.size() - 1);
+		interned_.insert({key, id});
+		return id;
+	}
+
+	int add_input(column_index_type input) {
+		return intern("I" + std::to_string(input), value{value_kind::INPUT, input, plan_literal{}, operator_type::BLZ_INVALID_OP, -1, -1, -1});
+	}
+
+	int add_literal(const plan_literal & literal) {
+		std::string key = is_null(literal.value)
+			? "N" + std::to_string(static_cast<int>(literal.type.id()))
+			: "L" + std::to_string(static_cast<int>(literal.type.id())) + ":" + literal.value;
+		return intern(key, value{value_kind::LITERAL, -1, literal, operator_type::BLZ_INVALID_OP, -1, -1, -1});
+	}
+
+	/**
+	 * @brief Returns the value an operand evaluates to, folded operations are
+	 * replaced by their literal so equivalent operations are detected
+	 */
+	int canonical(int id) const {
+		return (id >= 0 && values_[id].folded >= 0) ? values_[id].folded : id;
+	}
+
+	int add_operation(operator_type op, int left, int right) {
+		left = canonical(left);
+		right = canonical(right);
+
+		int folded = -1;
+		if (left >= 0 && values_[left].kind == value_kind::LITERAL && (right < 0 || values_[right].kind == value_kind::LITERAL)) {
+			plan_literal result;
+			if (fold_operation(op, &values_[left].literal, right >= 0 ? &values_[right].literal : nullptr, result)) {
+				folded = add_literal(result);
+			}
+		}
+
+		value val{value_kind::OPERATION, -1, plan_literal{}, op, left, right, folded};
+		if (is_nullary_operator(op)) {
+			// Non deterministic operations (e.g. RAND) produce a different value every time
+			values_.push_back(std::move(val));
+			return static_cast<int>(values_.size() - 1);
+		}
+
+		std::string key = "O" + std::to_string(static_cast<int>(op)) + ":" + std::to_string(left) + ":" + std::to_string(right);
+		return intern(key, std::move(val));
+	}
+
+	std::vector<value> values_;
+	std::map<std::string, int> interned_;
+	std::vector<int> finals_;
+};
+
+std::vector<column_index_type> all_inputs(cudf::size_type num_inputs) {
+	std::vector<column_index_type> inputs(num_inputs);
+	for (cudf::size_type i = 0; i < num_inputs; i++) {
+		inputs[i] = i;
+	}
+	return inputs;
+}
+
+} // namespace detail
+
+void add_expression_to_plan(const ral::parser::parse_tree & expr_tree,
+	const std::map<column_index_type, column_index_type> & expr_idx_to_col_idx_map,
+	interpreter_plan & plan) {
+
+	detail::plan_encoding_visitor visitor{expr_idx_to_col_idx_map, plan};
+	expr_tree.visit(visitor);
+
+	RAL_EXPECTS(visitor.last_position() >= 0, "Only expressions with operations can be added to an interpreter plan");
+	plan.final_output_positions.push_back(visitor.last_position());
+}
+
+void optimize_plan(interpreter_plan & plan) {
+	detail::value_graph graph(plan);
+	plan = graph.encode(graph.finals(), detail::all_inputs(plan.num_inputs));
+}
+
+std::vector<interpreter_sub_plan> split_plan(const interpreter_plan & plan, column_index_type max_positions) {
+	using detail::value_graph;
+
+	value_graph graph(plan);
+	const std::vector<int> & finals = graph.finals();
+
+	struct output_group {
+		std::vector<size_t> final_output_indices;
+		std::set<int> operations;
+		std::set<column_index_type> inputs;
+		interpreter_plan plan;
+	};
+
+	auto encode_group = [&](const output_group & group) {
+		std::vector<int> group_finals;
+		for (size_t idx : group.final_output_indices) {
+			group_finals.push_back(finals[idx]);
+		}
+		return graph.encode(group_finals, std::vector<column_index_type>(group.inputs.begin(), group.inputs.end()));
+	};
+
+	std::vector<output_group> groups;
+	for (size_t i = 0; i < finals.size(); i++) {
+		std::set<int> operations;
+		std::set<column_index_type> inputs;
+		graph.collect_dependencies(finals[i], operations, inputs);
+
+		// Try first the groups that already compute most of what this output needs
+		std::vector<std::pair<size_t, size_t>> candidates;
+		for (size_t g = 0; g < groups.size(); g++) {
+			size_t shared = 0;
+			for (int id : operations) {
+				shared += groups[g].operations.count(id);
+			}
+			for (column_index_type input : inputs) {
+				shared += groups[g].inputs.count(input);
+			}
+			candidates.push_back({shared, g});
+		}
+		std::stable_sort(candidates.begin(), candidates.end(), [](auto & a, auto & b) { return a.first > b.first; });
+
+		bool placed = false;
+		for (auto & candidate : candidates) {
+			output_group group = groups[candidate.second];
+			group.final_output_indices.push_back(i);
+			group.operations.insert(operations.begin(), operations.end());
+			group.inputs.insert(inputs.begin(), inputs.end());
+			group.plan = encode_group(group);
+			if (group.plan.max_position() < max_positions) {
+				groups[candidate.second] = std::move(group);
+				placed = true;
+				break;
+			}
+		}
+
+		if (!placed) {
+			output_group group;
+			group.final_output_indices.push_back(i);
+			group.operations = std::move(operations);
+			group.inputs = std::move(inputs);
+			group.plan = encode_group(group);
+			if (group.plan.max_position() >= max_positions) {
+				RAL_FAIL("Interops does not support expressions that need more than " + std::to_string(max_positions) + " positions");
+			}
+			groups.push_back(std::move(group));
+		}
+	}
+
+	std::vector<interpreter_sub_plan> sub_plans;
+	for (auto & group : groups) {
+		interpreter_sub_plan sub_plan;
+		sub_plan.plan = std::move(group.plan);
+		sub_plan.input_indices.assign(group.inputs.begin(), group.inputs.end());
+		sub_plan.final_output_indices = std::move(group.final_output_indices);
+		sub_plans.push_back(std::move(sub_plan));
+	}
+
+	return sub_plans;
+}
+
+void make_plan_scalars(const interpreter_plan & plan,
+	std::vector<std::unique_ptr<cudf::scalar>> & left_scalars,
+	std::vector<std::unique_ptr<cudf::scalar>> & right_scalars) {
+
+	left_scalars.clear();
+	right_scalars.clear();
+	for (size_t i = 0; i < plan.operators.size(); i++) {
+		left_scalars.push_back(plan.left_inputs[i] == SCALAR_INDEX ? get_scalar_from_string(plan.left_literals[i].value, plan.left_literals[i].type) : nullptr);
+		right_scalars.push_back(plan.right_inputs[i] == SCALAR_INDEX ? get_scalar_from_string(plan.right_literals[i].value, plan.right_literals[i].type) : nullptr);
+	}
+}
+
+} // namespace interops
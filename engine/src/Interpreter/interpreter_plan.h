@@ -0,0 +1,123 @@
+/*
+ * interpreter_plan.h
+ *
+ * Host side construction and optimization of the plans evaluated by the
+ * interpreter kernel.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+#include <cudf/types.hpp>
+#include <cudf/scalar/scalar.hpp>
+#include "parser/expression_tree.hpp"
+
+namespace interops {
+
+typedef int16_t column_index_type;
+
+enum column_index : column_index_type {
+	UNARY_INDEX = -1,
+	SCALAR_INDEX = -2,
+	SCALAR_NULL_INDEX = -3,
+	NULLARY_INDEX = -4
+};
+
+/**
+ * @brief The interpreter keeps the valids of all the positions of a plan in a
+ * single uint64_t, so inputs and outputs positions must be lower than this
+ */
+constexpr column_index_type MAX_PLAN_POSITIONS = 64;
+
+/**
+ * @brief A literal operand of an interpreter plan.
+ *
+ * Literals are kept as text until the plan is ready to be evaluated so that
+ * plans can be built, compared and rewritten on the host without allocating
+ * device scalars.
+ */
+struct plan_literal {
+	std::string value;
+	cudf::data_type type;
+};
+
+/**
+ * @brief An interpreter plan using the same encoding that
+ * perform_interpreter_operation expects, except for the scalars.
+ *
+ * Positions lower than num_inputs are the input columns, any other position is
+ * a temporary value. For every operation i, left_literals[i] (right_literals[i])
+ * holds the literal used when left_inputs[i] (right_inputs[i]) is SCALAR_INDEX.
+ */
+struct interpreter_plan {
+	cudf::size_type num_inputs = 0;
+	std::vector<column_index_type> left_inputs;
+	std::vector<column_index_type> right_inputs;
+	std::vector<column_index_type> outputs;
+	std::vector<column_index_type> final_output_positions;
+	std::vector<operator_type> operators;
+	std::vector<plan_literal> left_literals;
+	std::vector<plan_literal> right_literals;
+
+	/**
+	 * @brief Returns the highest position used by the plan, including its inputs
+	 */
+	column_index_type max_position() const;
+};
+
+/**
+ * @brief A part of an interpreter plan that can be evaluated on its own
+ */
+struct interpreter_sub_plan {
+	interpreter_plan plan;
+	std::vector<cudf::size_type> input_indices; /**< The inputs of the original plan used as the inputs of this plan, in order. */
+	std::vector<size_t> final_output_indices; /**< The final outputs of the original plan computed by this plan, in order. */
+};
+
+/**
+ * @brief Appends an expression tree consisting of simple operations to a plan
+ *
+ * Every operator gets its own output position, positions are reassigned later
+ * by optimize_plan or split_plan.
+ *
+ * @param expr_tree The expression tree to encode, its root must be an operator
+ * @param expr_idx_to_col_idx_map A map from input table column indices to plan input positions
+ * @param plan The plan where the expression is appended
+ */
+void add_expression_to_plan(const ral::parser::parse_tree & expr_tree,
+	const std::map<column_index_type, column_index_type> & expr_idx_to_col_idx_map,
+	interpreter_plan & plan);
+
+/**
+ * @brief Optimizes a plan as a whole
+ *
+ * - Common subexpressions, within an expression or across expressions, are evaluated once
+ * - Operations between literals are folded when their result is used by another operation
+ * - Operations that are not needed by any final output are removed
+ * - Output positions are reassigned so a position is reused as soon as the
+ *   value it holds is no longer needed
+ */
+void optimize_plan(interpreter_plan & plan);
+
+/**
+ * @brief Optimizes a plan and splits it into plans whose positions are lower
+ * than max_positions
+ *
+ * Final outputs are grouped by the operations they depend on, so outputs that
+ * share subexpressions are evaluated together. Each sub plan only reads the
+ * inputs its outputs need. If the whole plan fits a single sub plan is returned.
+ */
+std::vector<interpreter_sub_plan> split_plan(const interpreter_plan & plan, column_index_type max_positions = MAX_PLAN_POSITIONS);
+
+/**
+ * @brief Creates the scalars used by the plan as perform_interpreter_operation expects them
+ */
+void make_plan_scalars(const interpreter_plan & plan,
+	std::vector<std::unique_ptr<cudf::scalar>> & left_scalars,
+	std::vector<std::unique_ptr<cudf::scalar>> & right_scalars);
+
+} // namespace interops
@@ -35,5 +35,6 @@ RAISE_ERROR(RegisterFileSystemGCS)
 RAISE_ERROR(RegisterFileSystemS3)
 RAISE_ERROR(RegisterFileSystemLocal)
 RAISE_ERROR(InferFolderPartitionMetadata)
+RAISE_ERROR(PrunePartitions)
 RAISE_ERROR(ResetMaxMemoryUsed)
 RAISE_ERROR(GetMaxMemoryUsed)
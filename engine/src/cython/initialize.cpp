@@ -47,6 +47,8 @@
 #include "communication/CommunicationInterface/messageListener.hpp"
 #include "execution_graph/logic_controllers/taskflow/kernel.h"
 #include "execution_graph/logic_controllers/taskflow/executor.h"
+#include "io/data_provider/FileHandlePool.h"
+#include "io/MetadataCatalog.h"
 
 #include "error.hpp"
 
@@ -616,6 +618,31 @@ std::pair<std::pair<std::shared_ptr<CacheMachine>,std::shared_ptr<CacheMachine>
 	}
 
 	ral::execution::executor::init_executor(executor_threads, processing_memory_limit_threshold);
+
+	size_t max_open_file_handles = 512;
+	config_it = config_options.find("MAX_OPEN_FILE_HANDLES");
+	if (config_it != config_options.end()){
+		max_open_file_handles = std::stoul(config_options["MAX_OPEN_FILE_HANDLES"]);
+	}
+	size_t num_file_opener_threads = 4;
+	config_it = config_options.find("NUM_FILE_OPENER_THREADS");
+	if (config_it != config_options.end()){
+		num_file_opener_threads = std::stoul(config_options["NUM_FILE_OPENER_THREADS"]);
+	}
+	size_t num_prefetched_files = 8;
+	config_it = config_options.find("NUM_PREFETCHED_FILES");
+	if (config_it != config_options.end()){
+		num_prefetched_files = std::stoul(config_options["NUM_PREFETCHED_FILES"]);
+	}
+	ral::io::file_handle_pool::initialize(max_open_file_handles, num_file_opener_threads, num_prefetched_files);
+
+	std::string metadata_catalog_directory = "";
+	config_it = config_options.find("METADATA_CATALOG_DIRECTORY");
+	if (config_it != config_options.end()){
+		metadata_catalog_directory = config_options["METADATA_CATALOG_DIRECTORY"];
+	}
+	ral::io::metadata_catalog::initialize(metadata_catalog_directory);
+
 	initialized = true;
   blazing_context_ref_counter::getInstance().increase();
 	return std::make_pair(output_input_caches, ralCommunicationPort);	
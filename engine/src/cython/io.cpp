@@ -1,5 +1,6 @@
 #include "../../include/io/io.h"
 #include "../io/DataLoader.h"
+#include "../io/MetadataCatalog.h"
 #include "../io/data_parser/ArgsUtil.h"
 #include "../io/data_parser/CSVParser.h"
 #include "../io/data_parser/JSONParser.h"
@@ -9,6 +10,7 @@
 
 #include "utilities/CommonOperations.h"
 #include "parser/expression_tree.hpp"
+#include "skip_data/PartitionPruner.h"
 
 #include <blazingdb/io/Config/BlazingContext.h>
 
@@ -57,6 +59,8 @@ TableSchema parseSchema(std::vector<std::string> files,
 	auto loader = std::make_shared<ral::io::data_loader>(parser, provider);
 
 	ral::io::Schema schema;
+	auto catalog = ral::io::metadata_catalog::get_instance();
+	std::string parser_key = ral::io::metadata_catalog::get_parser_key(fileType, args_map);
 
 	try {
 
@@ -64,7 +68,7 @@ TableSchema parseSchema(std::vector<std::string> files,
 		while (!got_schema && provider->has_next()){
 			ral::io::data_handle handle = provider->get_next();
 			if (handle.file_handle != nullptr){
-				parser->parse_schema(handle.file_handle, schema);
+				catalog->parse_schema(*parser, parser_key, handle, schema);
 				if (schema.get_num_columns() > 0){
 					got_schema = true;
 					schema.add_file(handle.uri.toString(true));
@@ -240,30 +244,6 @@ std::pair<bool, std::string> registerFileSystemLocal(std::string root, std::stri
 	return registerFileSystem(fileSystemConnection, root, authority);
 }
 
-void visitPartitionFolder(Uri folder_uri, std::vector<FolderPartitionMetadata>& metadata, int depth) {
-	auto fs = BlazingContext::getInstance()->getFileSystemManager();
-
-	auto matches = fs->list(folder_uri, "*=*");
-	for (auto &&uri : matches) {
-		auto status = fs->getFileStatus(uri);
-		if (!status.isDirectory()) {
-			continue;
-		}
-
-		std::string name = uri.getPath().getResourceName();
-		auto parts = StringUtil::split(name, '=');
-
-		if (metadata.size() < static_cast<size_t>(depth) + 1) {
-			metadata.resize(depth + 1);
-		}
-
-		metadata[depth].name = parts[0];
-		metadata[depth].values.insert(parts[1]);
-
-		visitPartitionFolder(uri, metadata, depth + 1);
-	}
-}
-
 std::vector<FolderPartitionMetadata> inferFolderPartitionMetadata(std::string folder_path) {
 	Uri folder_uri{folder_path};
 
@@ -278,21 +258,32 @@ std::vector<FolderPartitionMetadata> inferFolderPartitionMetadata(std::string fo
 	}
 
 	std::vector<FolderPartitionMetadata> metadata;
-	visitPartitionFolder(folder_uri, metadata, 0);
+	for (auto && folder : ral::skip_data::list_partition_folders(folder_uri)) {
+		auto levels = StringUtil::split(folder, '/');
+		if (metadata.size() < levels.size()) {
+			metadata.resize(levels.size());
+		}
+		for (size_t depth = 0; depth < levels.size(); depth++) {
+			size_t separator = levels[depth].find('=');
+			metadata[depth].name = levels[depth].substr(0, separator);
+			metadata[depth].values.insert(levels[depth].substr(separator + 1));
+		}
+	}
 
-	static std::regex boolean_regex{std::string(ral::parser::detail::lexer::BOOLEAN_REGEX_STR)};
-  static std::regex number_regex{std::string(ral::parser::detail::lexer::NUMBER_REGEX_STR)};
-  static std::regex timestamp_regex{std::string(ral::parser::detail::lexer::TIMESTAMP_REGEX_STR)};
+	using ral::parser::detail::lexer;
+	auto matches = [](size_t (*match)(const char *, const char *), const std::string & value) {
+		return !value.empty() && match(value.data(), value.data() + value.size()) == value.size();
+	};
 
 	for (auto &&m : metadata) {
 		m.data_type = cudf::type_id::EMPTY;
 		for (auto &&value : m.values) {
 			ral::parser::detail::lexer::token token;
-		 	if (std::regex_match(value, boolean_regex)) {
+			if (matches(lexer::match_boolean, value)) {
 				token = {ral::parser::detail::lexer::token_type::Boolean, value};
-			} else if (std::regex_match(value, timestamp_regex)) {
+			} else if (matches(lexer::match_timestamp, value)) {
 				token = {ral::parser::detail::lexer::token_type::Timestamp, value};
-			} else if (std::regex_match(value, number_regex)) {
+			} else if (matches(lexer::match_number, value)) {
 				token = {ral::parser::detail::lexer::token_type::Number, value};
 			} else {
 				token = {ral::parser::detail::lexer::token_type::String, value};
@@ -310,6 +301,21 @@ std::vector<FolderPartitionMetadata> inferFolderPartitionMetadata(std::string fo
 	return metadata;
 }
 
+std::vector<int> prunePartitions(std::vector<std::map<std::string, std::string>> partitions,
+	std::vector<std::string> column_names,
+	std::vector<cudf::type_id> column_types,
+	std::string table_scan) {
+
+	ral::skip_data::partition_pruner pruner(table_scan, column_names, column_types);
+	std::vector<int> kept_partitions;
+	for (size_t i = 0; i < partitions.size(); i++) {
+		if (pruner.may_match(partitions[i])) {
+			kept_partitions.push_back(i);
+		}
+	}
+	return kept_partitions;
+}
+
 std::pair<TableSchema, error_code_t> parseSchema_C(std::vector<std::string> files,
 	std::string file_format_hint,
 	std::vector<std::string> arg_keys,
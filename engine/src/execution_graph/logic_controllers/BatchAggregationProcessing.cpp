@@ -8,9 +8,57 @@ namespace batch {
 
 // BEGIN ComputeAggregateKernel
 
+namespace {
+
+// the bypass is decided once this many batches were aggregated
+const std::size_t PARTIAL_AGGREGATION_SAMPLE_BATCHES = 4;
+
+}  // namespace
+
 ComputeAggregateKernel::ComputeAggregateKernel(std::size_t kernel_id, const std::string & queryString, std::shared_ptr<Context> context, std::shared_ptr<ral::cache::graph> query_graph)
     : kernel{kernel_id, queryString, context, kernel_type::ComputeAggregateKernel} {
     this->query_graph = query_graph;
+
+    this->min_partial_aggregation_reduction = 0.1;
+    std::map<std::string, std::string> config_options = context->getConfigOptions();
+    auto it = config_options.find("PARTIAL_AGGREGATION_MIN_REDUCTION");
+    if (it != config_options.end()){
+        this->min_partial_aggregation_reduction = std::stod(config_options["PARTIAL_AGGREGATION_MIN_REDUCTION"]);
+    }
+}
+
+void ComputeAggregateKernel::update_partial_aggregation_stats(const ral::frame::BlazingTable & aggregated, std::size_t input_num_rows) {
+    std::lock_guard<std::mutex> lock(partial_aggregation_stats_mutex);
+    if (this->partial_aggregation_batches >= PARTIAL_AGGREGATION_SAMPLE_BATCHES || input_num_rows == 0) {
+        return;
+    }
+
+    if (this->partial_aggregation_batches == 0) {
+        this->partial_aggregation_types = aggregated.get_schema();
+        this->partial_aggregation_names = aggregated.names();
+    }
+    this->partial_aggregation_batches++;
+    this->partial_aggregation_input_rows += input_num_rows;
+    this->partial_aggregation_output_rows += aggregated.num_rows();
+
+    if (this->partial_aggregation_batches == PARTIAL_AGGREGATION_SAMPLE_BATCHES) {
+        double reduction = 1.0 - (double)this->partial_aggregation_output_rows / this->partial_aggregation_input_rows;
+        bool bypass = reduction < this->min_partial_aggregation_reduction;
+        this->bypass_partial_aggregation = bypass;
+
+        if(logger) {
+            logger->debug("{query_id}|{step}|{substep}|{info}|{duration}|kernel_id|{kernel_id}||",
+                                    "query_id"_a=context->getContextToken(),
+                                    "step"_a=context->getQueryStep(),
+                                    "substep"_a=context->getQuerySubstep(),
+                                    "info"_a="ComputeAggregate partial aggregation reduced " + std::to_string(this->partial_aggregation_input_rows) +
+                                        " rows to " + std::to_string(this->partial_aggregation_output_rows) + " (reduction ratio " + std::to_string(reduction) +
+                                        ", threshold " + std::to_string(this->min_partial_aggregation_reduction) + "), " +
+                                        (bypass ? "bypassing it for the next batches" : "keeping it"),
+                                    "duration"_a="",
+                                    "kernel_id"_a=this->get_id());
+        }
+    }
 }
 
 ral::execution::task_result ComputeAggregateKernel::do_process(std::vector< std::unique_ptr<ral::frame::BlazingTable> > inputs,
@@ -26,9 +74,17 @@ ral::execution::task_result ComputeAggregateKernel::do_process(std::vector< std:
         } else if (this->group_column_indices.size() == 0) {
             columns = ral::operators::compute_aggregations_without_groupby(
                     input->toBlazingTableView(), aggregation_input_expressions, this->aggregation_types, aggregation_column_assigned_aliases);
+        } else if (this->bypass_partial_aggregation) {
+            // the group keys are nearly unique, MergeAggregateKernel will do all the aggregation
+            columns = ral::operators::compute_partial_aggregations_per_row(
+                input->toBlazingTableView(), aggregation_input_expressions, this->aggregation_types, group_column_indices,
+                this->partial_aggregation_types, this->partial_aggregation_names);
         } else {
             columns = ral::operators::compute_aggregations_with_groupby(
                 input->toBlazingTableView(), aggregation_input_expressions, this->aggregation_types, aggregation_column_assigned_aliases, group_column_indices);
+            if (this->bypass_supported) {
+                update_partial_aggregation_stats(*columns, input->num_rows());
+            }
         }
         output->addToCache(std::move(columns));
     }catch(const rmm::bad_alloc& e){
@@ -49,6 +105,9 @@ kstatus ComputeAggregateKernel::run() {
     std::tie(this->group_column_indices, aggregation_input_expressions, this->aggregation_types,
         aggregation_column_assigned_aliases) = ral::operators::parseGroupByExpression(this->expression, cache_data->num_columns());
 
+    this->bypass_supported = this->min_partial_aggregation_reduction > 0 && this->group_column_indices.size() > 0 &&
+        this->aggregation_types.size() > 0 && ral::operators::can_compute_partial_aggregations_per_row(this->aggregation_types);
+
     while(cache_data != nullptr ){
         std::vector<std::unique_ptr <ral::cache::CacheData> > inputs;
         inputs.push_back(std::move(cache_data));
@@ -119,6 +178,123 @@ DistributeAggregateKernel::DistributeAggregateKernel(std::size_t kernel_id, cons
     : distributing_kernel{kernel_id, queryString, context, kernel_type::DistributeAggregateKernel} {
     this->query_graph = query_graph;
     set_number_of_message_trackers(1); //default
+
+    ral::cache::cache_settings cache_machine_config;
+    cache_machine_config.type = ral::cache::CacheType::SIMPLE;
+    cache_machine_config.context = context->clone();
+    this->local_partials = ral::cache::create_cache_machine(cache_machine_config, std::to_string(this->get_id()) + "_local_partials");
+
+    this->tree_reduction = true;
+    std::map<std::string, std::string> config_options = context->getConfigOptions();
+    auto it = config_options.find("AGGREGATION_TREE_REDUCTION");
+    if (it != config_options.end()){
+        this->tree_reduction = (config_options["AGGREGATION_TREE_REDUCTION"] == "true" ||
+                                config_options["AGGREGATION_TREE_REDUCTION"] == "True" ||
+                                config_options["AGGREGATION_TREE_REDUCTION"] == "1" ||
+                                config_options["AGGREGATION_TREE_REDUCTION"] == "TRUE");
+    }
+}
+
+std::unique_ptr<ral::frame::BlazingTable> DistributeAggregateKernel::merge_partials(const std::vector<ral::frame::BlazingTableView> & partials) {
+    auto concatenated = ral::utilities::concatTables(partials);
+    return ral::operators::compute_aggregations_without_groupby(
+            concatenated->toBlazingTableView(), mod_aggregation_input_expressions, mod_aggregation_types,
+            mod_aggregation_column_assigned_aliases);
+}
+
+std::pair<std::vector<int>, int> get_aggregation_reduction_peers(int rank, int num_nodes, bool tree_reduction) {
+    std::vector<int> receive_ranks;
+    if (!tree_reduction) {
+        if (rank != 0) {
+            return {receive_ranks, 0};
+        }
+        for (int node_rank = 1; node_rank < num_nodes; node_rank++) {
+            receive_ranks.push_back(node_rank);
+        }
+        return {receive_ranks, -1};
+    }
+
+    // at step k each node with a rank that is an odd multiple of 2^k sends its partial to the node 2^k ranks below it,
+    // so the master gets ceil(log2(N)) messages
+    for (int stride = 1; stride < num_nodes; stride *= 2) {
+        if (rank % (2 * stride) == stride) {
+            return {receive_ranks, rank - stride};
+        } else if (rank % (2 * stride) == 0 && rank + stride < num_nodes) {
+            receive_ranks.push_back(rank + stride);
+        }
+    }
+    return {receive_ranks, -1};
+}
+
+void DistributeAggregateKernel::reduce_aggregations_without_groupby() {
+    CodeTimer timer;
+
+    std::vector<std::unique_ptr<ral::frame::BlazingTable>> partials;
+    std::vector<ral::frame::BlazingTableView> partial_views;
+    for (auto & cache_data : this->local_partials->pull_all_cache_data()) {
+        partials.push_back(cache_data->decache());
+        partial_views.push_back(partials.back()->toBlazingTableView());
+    }
+    RAL_EXPECTS(!partials.empty(), "In DistributeAggregateKernel: there are no partial aggregations to reduce");
+    std::unique_ptr<ral::frame::BlazingTable> reduced = merge_partials(partial_views);
+    partials.clear();
+    partial_views.clear();
+
+    const std::string message_prefix = "aggregate_reduction_";
+    auto message_id_from = [&](const std::string & node_id) {
+        return message_prefix + std::to_string(this->context->getContextToken()) + "_" + std::to_string(this->get_id()) + "_" + node_id;
+    };
+    auto send_to = [&](const std::string & node_id) {
+        send_message(std::move(reduced),
+            false, //specific_cache
+            "", //cache_id
+            {node_id}, //target_ids
+            message_prefix, //message_id_prefix
+            true, //always_add
+            false, //wait_for
+            0); //message_tracker_idx
+    };
+
+    // nodes are ranked starting at the master
+    auto& self_node = ral::communication::CommunicationData::getInstance().getSelfNode();
+    int num_nodes = this->context->getTotalNodes();
+    int master_idx = this->context->getNodeIndex(this->context->getMasterNode());
+    int rank = (this->context->getNodeIndex(self_node) - master_idx + num_nodes) % num_nodes;
+    auto node_id_of_rank = [&](int node_rank) {
+        return this->context->getNode((node_rank + master_idx) % num_nodes).id();
+    };
+
+    std::vector<int> receive_ranks;
+    int send_rank;
+    std::tie(receive_ranks, send_rank) = get_aggregation_reduction_peers(rank, num_nodes, this->tree_reduction);
+    for (int receive_rank : receive_ranks) {
+        std::unique_ptr<ral::frame::BlazingTable> received =
+            this->query_graph->get_input_message_cache()->pullCacheData(message_id_from(node_id_of_rank(receive_rank)))->decache();
+        reduced = merge_partials({reduced->toBlazingTableView(), received->toBlazingTableView()});
+    }
+    if (send_rank >= 0) {
+        send_to(node_id_of_rank(send_rank));
+    }
+
+    if (rank == 0) {
+        this->add_to_output_cache(std::move(reduced), "", true);
+    } else {
+        // we want to keep in the non-master nodes something with the right schema, so that the cache is not empty
+        std::unique_ptr<ral::frame::BlazingTable> empty = ral::frame::createEmptyBlazingTable(
+            this->local_partials_types, this->local_partials_names);
+        this->add_to_output_cache(std::move(empty), "", true);
+    }
+    increment_node_count(self_node.id());
+
+    if(logger){
+        logger->debug("{query_id}|{step}|{substep}|{info}|{duration}|kernel_id|{kernel_id}||",
+                    "query_id"_a=context->getContextToken(),
+                    "step"_a=context->getQueryStep(),
+                    "substep"_a=context->getQuerySubstep(),
+                    "info"_a="DistributeAggregate reduced partials without group by, received " + std::to_string(receive_ranks.size()) + " messages",
+                    "duration"_a=timer.elapsed_time(),
+                    "kernel_id"_a=this->get_id());
+    }
 }
 
 ral::execution::task_result DistributeAggregateKernel::do_process(std::vector< std::unique_ptr<ral::frame::BlazingTable> > inputs,
@@ -130,31 +306,10 @@ ral::execution::task_result DistributeAggregateKernel::do_process(std::vector< s
     // If we do partition into something other than the number of nodes, then we have to use part_ids and change up more of the logic
     int num_partitions = this->context->getTotalNodes();
 
-    // If its an aggregation without group by we want to send all the results to the master node
-    auto& self_node = ral::communication::CommunicationData::getInstance().getSelfNode();
+    // If its an aggregation without group by the partials are merged in this node and then reduced across the nodes in run()
     if (group_column_indices.size() == 0) {
         try{
-            if(this->context->isMasterNode(self_node)) {
-                bool added = this->output_.get_cache()->addToCache(std::move(input),"",false);
-                if (added) {
-                    increment_node_count(self_node.id());
-                }
-            } else {
-                if (!set_empty_part_for_non_master_node){ // we want to keep in the non-master nodes something, so that the cache is not empty
-                    std::unique_ptr<ral::frame::BlazingTable> empty =
-                        ral::utilities::create_empty_table(input->toBlazingTableView());
-                    bool added = this->add_to_output_cache(std::move(empty), "", true);
-                    set_empty_part_for_non_master_node = true;
-                    if (added) {
-                        increment_node_count(self_node.id());
-                    }
-                }
-
-                send_message(std::move(input),
-                    true, //specific_cache
-                    "", //cache_id
-                    {this->context->getMasterNode().id()}); //target_id
-            }
+            this->local_partials->addToCache(std::move(input), "", true);
         }catch(const rmm::bad_alloc& e){
             return {ral::execution::task_status::RETRY, std::string(e.what()), std::move(inputs)};
         }catch(const std::exception& e){
@@ -210,8 +365,10 @@ kstatus DistributeAggregateKernel::run() {
         aggregation_column_assigned_aliases) = ral::operators::parseGroupByExpression(this->expression, cache_data->num_columns());
 
     // we want to update the `columns_to_hash` because the input could have more columns after ComputeAggregateKernel
-    std::tie(columns_to_hash, std::ignore, std::ignore, std::ignore) = ral::operators::modGroupByParametersPostComputeAggregations(group_column_indices,
-                                                                                             aggregation_types, cache_data->names());
+    std::tie(columns_to_hash, mod_aggregation_input_expressions, mod_aggregation_types, mod_aggregation_column_assigned_aliases) =
+        ral::operators::modGroupByParametersPostComputeAggregations(group_column_indices, aggregation_types, cache_data->names());
+    this->local_partials_types = cache_data->get_schema();
+    this->local_partials_names = cache_data->names();
 
     while(cache_data != nullptr ){
         std::vector<std::unique_ptr <ral::cache::CacheData> > inputs;
@@ -244,6 +401,10 @@ kstatus DistributeAggregateKernel::run() {
         std::rethrow_exception(ep);
     }
 
+    if (group_column_indices.size() == 0) {
+        reduce_aggregations_without_groupby();
+    }
+
     send_total_partition_counts(
         "", //message_prefix
         "" //cache_id
@@ -272,72 +433,106 @@ kstatus DistributeAggregateKernel::run() {
 MergeAggregateKernel::MergeAggregateKernel(std::size_t kernel_id, const std::string & queryString, std::shared_ptr<Context> context, std::shared_ptr<ral::cache::graph> query_graph)
     : kernel{kernel_id, queryString, context, kernel_type::MergeAggregateKernel} {
     this->query_graph = query_graph;
+
+    ral::cache::cache_settings cache_machine_config;
+    cache_machine_config.type = ral::cache::CacheType::SIMPLE;
+    cache_machine_config.context = context->clone();
+    this->stateCache = ral::cache::create_cache_machine(cache_machine_config, std::to_string(this->get_id()) + "_merge_state");
+
+    this->max_state_byte_size = 400000000;
+    std::map<std::string, std::string> config_options = context->getConfigOptions();
+    auto it = config_options.find("MAX_AGGREGATE_MERGE_STATE_BYTE_SIZE");
+    if (it != config_options.end()){
+        this->max_state_byte_size = std::stoull(config_options["MAX_AGGREGATE_MERGE_STATE_BYTE_SIZE"]);
+    }
+}
+
+std::unique_ptr<ral::frame::BlazingTable> MergeAggregateKernel::merge_partials(std::vector< std::unique_ptr<ral::frame::BlazingTable> > & inputs) {
+    // a merged state has wider types than the partials (i.e. a COUNT is INT32 in a partial and INT64 once its counts are summed)
+    std::vector<cudf::data_type> common_types = inputs[0]->get_schema();
+    for (std::size_t i = 1; i < inputs.size(); i++){
+        common_types = ral::utilities::get_common_types(common_types, inputs[i]->get_schema(), false);
+    }
+    for (std::size_t i = 0; i < inputs.size(); i++){
+        ral::utilities::normalize_types(inputs[i], common_types);
+    }
+
+    std::vector< ral::frame::BlazingTableView > tableViewsToConcat;
+    for (std::size_t i = 0; i < inputs.size(); i++){
+        tableViewsToConcat.emplace_back(inputs[i]->toBlazingTableView());
+    }
+
+    if( ral::utilities::checkIfConcatenatingStringsWillOverflow(tableViewsToConcat)) {
+        if(logger) {
+            logger->warn("{query_id}|{step}|{substep}|{info}",
+                            "query_id"_a=(context ? std::to_string(context->getContextToken()) : ""),
+                            "step"_a=(context ? std::to_string(context->getQueryStep()) : ""),
+                            "substep"_a=(context ? std::to_string(context->getQuerySubstep()) : ""),
+                            "info"_a="In MergeAggregateKernel::run Concatenating Strings will overflow strings length");
+        }
+    }
+    auto concatenated = ral::utilities::concatTables(tableViewsToConcat);
+
+    std::unique_ptr<ral::frame::BlazingTable> columns = nullptr;
+    if(aggregation_types.size() == 0) {
+        columns = ral::operators::compute_groupby_without_aggregations(
+                concatenated->toBlazingTableView(), mod_group_column_indices);
+    } else if (group_column_indices.size() == 0) {
+        // aggregations without groupby are only merged on the master node
+        if( context->isMasterNode(ral::communication::CommunicationData::getInstance().getSelfNode()) ) {
+            columns = ral::operators::compute_aggregations_without_groupby(
+                    concatenated->toBlazingTableView(), mod_aggregation_input_expressions, mod_aggregation_types,
+                    mod_aggregation_column_assigned_aliases);
+        } else {
+            // with aggregations without groupby the distribution phase should deposit an empty dataframe with the right schema into the cache, which is then output here
+            columns = std::move(concatenated);
+        }
+    } else {
+        columns = ral::operators::compute_aggregations_with_groupby(
+                concatenated->toBlazingTableView(), mod_aggregation_input_expressions, mod_aggregation_types,
+                mod_aggregation_column_assigned_aliases, mod_group_column_indices);
+    }
+    return columns;
 }
 
 ral::execution::task_result MergeAggregateKernel::do_process(std::vector< std::unique_ptr<ral::frame::BlazingTable> > inputs,
     std::shared_ptr<ral::cache::CacheMachine> output,
-    cudaStream_t /*stream*/, const std::map<std::string, std::string>& /*args*/) {
+    cudaStream_t /*stream*/, const std::map<std::string, std::string>& args) {
     try{
-        
-        std::vector< ral::frame::BlazingTableView > tableViewsToConcat;
-        for (std::size_t i = 0; i < inputs.size(); i++){
-            tableViewsToConcat.emplace_back(inputs[i]->toBlazingTableView());
-        }
-
-        CodeTimer eventTimer;
-        if( ral::utilities::checkIfConcatenatingStringsWillOverflow(tableViewsToConcat)) {
-            if(logger) {
-                logger->warn("{query_id}|{step}|{substep}|{info}",
-                                "query_id"_a=(context ? std::to_string(context->getContextToken()) : ""),
-                                "step"_a=(context ? std::to_string(context->getQueryStep()) : ""),
-                                "substep"_a=(context ? std::to_string(context->getQuerySubstep()) : ""),
-                                "info"_a="In MergeAggregateKernel::run Concatenating Strings will overflow strings length");
-            }
-        }
-        auto concatenated = ral::utilities::concatTables(tableViewsToConcat);
-
-        auto log_input_num_rows = concatenated ? concatenated->num_rows() : 0;
-        auto log_input_num_bytes = concatenated ? concatenated->sizeInBytes() : 0;
-
-        std::vector<int> group_column_indices;
-        std::vector<std::string> aggregation_input_expressions, aggregation_column_assigned_aliases;
-        std::vector<AggregateKind> aggregation_types;
-        std::tie(group_column_indices, aggregation_input_expressions, aggregation_types,
-            aggregation_column_assigned_aliases) = ral::operators::parseGroupByExpression(this->expression,concatenated->num_columns());
-
-        std::vector<int> mod_group_column_indices;
-        std::vector<std::string> mod_aggregation_input_expressions, mod_aggregation_column_assigned_aliases, merging_column_names;
-        std::vector<AggregateKind> mod_aggregation_types;
-        std::tie(mod_group_column_indices, mod_aggregation_input_expressions, mod_aggregation_types,
-            mod_aggregation_column_assigned_aliases) = ral::operators::modGroupByParametersPostComputeAggregations(
-            group_column_indices, aggregation_types, concatenated->names());
-
-        std::unique_ptr<ral::frame::BlazingTable> columns = nullptr;
-        if(aggregation_types.size() == 0) {
-            columns = ral::operators::compute_groupby_without_aggregations(
-                    concatenated->toBlazingTableView(), mod_group_column_indices);
-        } else if (group_column_indices.size() == 0) {
-            // aggregations without groupby are only merged on the master node
-            if( context->isMasterNode(ral::communication::CommunicationData::getInstance().getSelfNode()) ) {
-                columns = ral::operators::compute_aggregations_without_groupby(
-                        concatenated->toBlazingTableView(), mod_aggregation_input_expressions, mod_aggregation_types,
-                        mod_aggregation_column_assigned_aliases);
+        auto& operation_type = args.at("operation_type");
+        if (operation_type == "merge") {
+            std::unique_ptr<ral::frame::BlazingTable> columns = merge_partials(inputs);
+            if (args.at("target") == "state") {
+                this->stateCache->addToCache(std::move(columns), "", true);
             } else {
-                // with aggregations without groupby the distribution phase should deposit an empty dataframe with the right schema into the cache, which is then output here
-                columns = std::move(concatenated);
+                output->addToCache(std::move(columns));
+            }
+        } else if (operation_type == "partition") {
+            auto & input = inputs[0];
+            if (input->num_rows() > 0) {
+                std::unique_ptr<CudfTable> hashed_data;
+                std::vector<cudf::size_type> hashed_data_offsets;
+                std::tie(hashed_data, hashed_data_offsets) = cudf::hash_partition(input->view(), mod_group_column_indices, spill_partitions.size());
+                // the offsets returned by hash_partition will always start at 0, which is a value we want to ignore for cudf::split
+                std::vector<cudf::size_type> split_indexes(hashed_data_offsets.begin() + 1, hashed_data_offsets.end());
+                std::vector<CudfTableView> partitioned = cudf::split(hashed_data->view(), split_indexes);
+                // every partition is copied before any is added, so a retry does not add the first partitions twice
+                std::vector<std::unique_ptr<ral::frame::BlazingTable>> partitions(partitioned.size());
+                for (std::size_t i = 0; i < partitioned.size(); i++) {
+                    if (partitioned[i].num_rows() > 0) {
+                        partitions[i] = ral::frame::BlazingTableView(partitioned[i], input->names()).clone();
+                    }
+                }
+                hashed_data = nullptr;
+                for (std::size_t i = 0; i < partitions.size(); i++) {
+                    if (partitions[i] != nullptr) {
+                        spill_partitions[i]->addToCache(std::move(partitions[i]), "", true);
+                    }
+                }
             }
         } else {
-            columns = ral::operators::compute_aggregations_with_groupby(
-                    concatenated->toBlazingTableView(), mod_aggregation_input_expressions, mod_aggregation_types,
-                    mod_aggregation_column_assigned_aliases, mod_group_column_indices);
+            RAL_FAIL("In MergeAggregateKernel: unknown operation_type " + operation_type);
         }
-        eventTimer.stop();
-
-        auto log_output_num_rows = columns->num_rows();
-        auto log_output_num_bytes = columns->sizeInBytes();
-
-        output->addToCache(std::move(columns));
-        columns = nullptr;
     }catch(const rmm::bad_alloc& e){
         return {ral::execution::task_status::RETRY, std::string(e.what()), std::move(inputs)};
     }catch(const std::exception& e){
@@ -346,29 +541,125 @@ ral::execution::task_result MergeAggregateKernel::do_process(std::vector< std::u
     return {ral::execution::task_status::SUCCESS, std::string(), std::vector< std::unique_ptr<ral::frame::BlazingTable> > ()};
 }
 
+void MergeAggregateKernel::add_merge_task(std::vector<std::unique_ptr<ral::cache::CacheData>> inputs, const std::string & target) {
+    ral::execution::executor::get_instance()->add_task(
+            std::move(inputs),
+            this->output_cache(),
+            this,
+            {{"operation_type", "merge"}, {"target", target}});
+}
+
+void MergeAggregateKernel::add_partition_task(std::unique_ptr<ral::cache::CacheData> input) {
+    std::vector<std::unique_ptr<ral::cache::CacheData>> inputs;
+    inputs.push_back(std::move(input));
+    ral::execution::executor::get_instance()->add_task(
+            std::move(inputs),
+            this->output_cache(),
+            this,
+            {{"operation_type", "partition"}});
+}
+
+void MergeAggregateKernel::merge_into_state(std::vector<std::unique_ptr<ral::cache::CacheData>> pending) {
+    if (this->stateCache->has_next_now()) {
+        pending.push_back(this->stateCache->pullCacheData());
+    }
+    add_merge_task(std::move(pending), "state");
+    wait_for_tasks();
+
+    std::unique_ptr<ral::cache::CacheData> state = this->stateCache->pullCacheData();
+    if (this->group_column_indices.empty() || state->sizeInBytes() <= this->max_state_byte_size / 2) {
+        this->stateCache->addCacheData(std::move(state), "", true);
+        return;
+    }
+
+    // the group keys are too many to keep the state in one table, from now on every partial goes to a spill partition
+    // and each partition is merged on its own at the end
+    std::size_t num_partitions = 2;
+    std::pair<bool, uint64_t> estimated_input_rows = this->query_graph->get_estimated_input_rows_to_kernel(this->kernel_id);
+    if (estimated_input_rows.first && state->num_rows() > 0) {
+        double estimated_bytes = (double)state->sizeInBytes() * estimated_input_rows.second / state->num_rows();
+        while (num_partitions < 256 && num_partitions * (double)this->max_state_byte_size < estimated_bytes) {
+            num_partitions *= 2;
+        }
+    }
+
+    ral::cache::cache_settings cache_machine_config;
+    cache_machine_config.type = ral::cache::CacheType::SIMPLE;
+    cache_machine_config.context = context->clone();
+    for (std::size_t i = 0; i < num_partitions; i++) {
+        this->spill_partitions.push_back(ral::cache::create_cache_machine(cache_machine_config,
+            std::to_string(this->get_id()) + "_merge_partition_" + std::to_string(i)));
+    }
+    add_partition_task(std::move(state));
+
+    if(logger){
+        logger->debug("{query_id}|{step}|{substep}|{info}|{duration}|kernel_id|{kernel_id}||",
+                    "query_id"_a=context->getContextToken(),
+                    "step"_a=context->getQueryStep(),
+                    "substep"_a=context->getQuerySubstep(),
+                    "info"_a="MergeAggregate state partitioned into " + std::to_string(num_partitions) + " partitions",
+                    "duration"_a="",
+                    "kernel_id"_a=this->get_id());
+    }
+}
+
 kstatus MergeAggregateKernel::run() {
     CodeTimer timer;
 
-    // This Kernel needs all of the input before it can do any output. So lets wait until all the input is available
-    this->input_cache()->wait_until_finished();
-
     int batch_count=0;
     try {
-        std::vector<std::unique_ptr <ral::cache::CacheData> > inputs;
+        std::vector<std::unique_ptr <ral::cache::CacheData> > pending;
+        std::size_t pending_bytes = 0;
 
+        // partials are merged into the running state as they arrive, once at least a budget worth of them is pending
         while(this->input_cache()->wait_for_next()){
             std::unique_ptr <ral::cache::CacheData> cache_data = this->input_cache()->pullCacheData();
+            if(cache_data == nullptr){
+                continue;
+            }
 
-            if(cache_data != nullptr){
-                inputs.push_back(std::move(cache_data));
-                batch_count++;
+            if (batch_count == 0) {
+                std::tie(group_column_indices, std::ignore, aggregation_types, std::ignore) =
+                    ral::operators::parseGroupByExpression(this->expression, cache_data->num_columns());
+                std::tie(mod_group_column_indices, mod_aggregation_input_expressions, mod_aggregation_types,
+                    mod_aggregation_column_assigned_aliases) = ral::operators::modGroupByParametersPostComputeAggregations(
+                    group_column_indices, aggregation_types, cache_data->names());
+            }
+            batch_count++;
+
+            if (!this->spill_partitions.empty()) {
+                add_partition_task(std::move(cache_data));
+                continue;
+            }
+
+            pending_bytes += cache_data->sizeInBytes();
+            pending.push_back(std::move(cache_data));
+            if (pending_bytes >= this->max_state_byte_size) {
+                merge_into_state(std::move(pending));
+                pending.clear();
+                pending_bytes = 0;
             }
         }
+        RAL_EXPECTS(batch_count > 0, "In MergeAggregateKernel: The input cache data cannot be empty");
 
-        ral::execution::executor::get_instance()->add_task(
-                std::move(inputs),
-                this->output_cache(),
-                this);
+        if (this->spill_partitions.empty()) {
+            if (this->stateCache->has_next_now()) {
+                pending.push_back(this->stateCache->pullCacheData());
+            }
+            add_merge_task(std::move(pending), "output");
+        } else {
+            for (auto & cache_data : pending) {
+                add_partition_task(std::move(cache_data));
+            }
+            wait_for_tasks();
+
+            for (auto & partition : this->spill_partitions) {
+                std::vector<std::unique_ptr <ral::cache::CacheData> > partials = partition->pull_all_cache_data();
+                if (!partials.empty()) {
+                    add_merge_task(std::move(partials), "output");
+                }
+            }
+        }
 
         if(logger){
             logger->debug("{query_id}|{step}|{substep}|{info}|{duration}|kernel_id|{kernel_id}||",
@@ -380,14 +671,7 @@ kstatus MergeAggregateKernel::run() {
                                         "kernel_id"_a=this->get_id());
         }
 
-        std::unique_lock<std::mutex> lock(kernel_mutex);
-        kernel_cv.wait(lock,[this]{
-            return this->tasks.empty() || ral::execution::executor::get_instance()->has_exception();
-        });
-
-        if(auto ep = ral::execution::executor::get_instance()->last_exception()){
-            std::rethrow_exception(ep);
-        }
+        wait_for_tasks();
     } catch(const std::exception& e) {
         if(logger){
             logger->error("{query_id}|{step}|{substep}|{info}|{duration}||||",
@@ -410,6 +694,10 @@ kstatus MergeAggregateKernel::run() {
                     "kernel_id"_a=this->get_id());
     }
 
+    // these are intra kernel caches. We want to make sure they are empty before we finish.
+    this->stateCache->clear();
+    this->spill_partitions.clear();
+
     return kstatus::proceed;
 }
 
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <atomic>
 #include "BatchProcessing.h"
 #include "taskflow/distributing_kernel.h"
 #include "operators/GroupBy.h"
@@ -27,12 +28,30 @@ public:
     std::pair<bool, uint64_t> get_estimated_output_num_rows();
 
 private:
+    // Updates the rows reduction seen by the partial aggregation and decides whether to bypass it, once enough batches were aggregated
+    void update_partial_aggregation_stats(const ral::frame::BlazingTable & aggregated, std::size_t input_num_rows);
+
     std::vector<AggregateKind> aggregation_types;
     std::vector<int> group_column_indices;
     std::vector<std::string> aggregation_input_expressions;
     std::vector<std::string> aggregation_column_assigned_aliases;
+
+    // adaptive partial aggregation bypass
+    double min_partial_aggregation_reduction; // see PARTIAL_AGGREGATION_MIN_REDUCTION, 0 disables the bypass
+    bool bypass_supported = false;
+    std::atomic<bool> bypass_partial_aggregation{false};
+    std::mutex partial_aggregation_stats_mutex;
+    std::size_t partial_aggregation_batches = 0;
+    std::size_t partial_aggregation_input_rows = 0;
+    std::size_t partial_aggregation_output_rows = 0;
+    std::vector<cudf::data_type> partial_aggregation_types; // schema of the partial aggregations, the bypassed batches are cast to it
+    std::vector<std::string> partial_aggregation_names;
 };
 
+// Ranks of the nodes whose partial aggregations a node merges into its own, in that order, and the rank it then sends
+// the result to, -1 for the master node that keeps it. The master node has rank 0.
+std::pair<std::vector<int>, int> get_aggregation_reduction_peers(int rank, int num_nodes, bool tree_reduction);
+
 class DistributeAggregateKernel : public distributing_kernel {
 public:
     DistributeAggregateKernel(std::size_t kernel_id, const std::string & queryString, std::shared_ptr<Context> context, std::shared_ptr<ral::cache::graph> query_graph);
@@ -46,11 +65,24 @@ public:
     virtual kstatus run();
 
 private:
+    // Merges the partial aggregations without group by of this node into one and reduces them across the nodes, the
+    // master node ends up with the only non empty output
+    void reduce_aggregations_without_groupby();
+
+    std::unique_ptr<ral::frame::BlazingTable> merge_partials(const std::vector<ral::frame::BlazingTableView> & partials);
+
     std::vector<int> group_column_indices;
     std::vector<std::string> aggregation_input_expressions, aggregation_column_assigned_aliases; // not used in this kernel
     std::vector<AggregateKind> aggregation_types; // not used in this kernel
     std::vector<cudf::size_type> columns_to_hash;
-    bool set_empty_part_for_non_master_node = false; // this is only for aggregation without group by
+
+    // aggregation without group by related parameters
+    std::vector<std::string> mod_aggregation_input_expressions, mod_aggregation_column_assigned_aliases;
+    std::vector<AggregateKind> mod_aggregation_types;
+    std::shared_ptr<ral::cache::CacheMachine> local_partials; // partials of this node, merged once all the input is processed
+    std::vector<cudf::data_type> local_partials_types;
+    std::vector<std::string> local_partials_names;
+    bool tree_reduction; // see AGGREGATION_TREE_REDUCTION
 };
 
 class MergeAggregateKernel : public kernel {
@@ -66,7 +98,26 @@ public:
     virtual kstatus run();
 
 private:
+    // Concatenates partial aggregates and merges them, the partials are cast to their common types first
+    std::unique_ptr<ral::frame::BlazingTable> merge_partials(std::vector< std::unique_ptr<ral::frame::BlazingTable> > & inputs);
+
+    // Merges the pending partials into the running state, the state is hash partitioned into the spill partitions if
+    // merging did not make it smaller than half the budget
+    void merge_into_state(std::vector<std::unique_ptr<ral::cache::CacheData>> pending);
+
+    void add_merge_task(std::vector<std::unique_ptr<ral::cache::CacheData>> inputs, const std::string & target);
+
+    void add_partition_task(std::unique_ptr<ral::cache::CacheData> input);
+
+    std::vector<int> group_column_indices;
+    std::vector<AggregateKind> aggregation_types;
+    std::vector<int> mod_group_column_indices;
+    std::vector<std::string> mod_aggregation_input_expressions, mod_aggregation_column_assigned_aliases;
+    std::vector<AggregateKind> mod_aggregation_types;
 
+    std::size_t max_state_byte_size; // memory budget of the running state, see MAX_AGGREGATE_MERGE_STATE_BYTE_SIZE
+    std::shared_ptr<ral::cache::CacheMachine> stateCache; // holds the running state between merges
+    std::vector<std::shared_ptr<ral::cache::CacheMachine>> spill_partitions; // empty until the state is partitioned
 };
 
 } // namespace batch
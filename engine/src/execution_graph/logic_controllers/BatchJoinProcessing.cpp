@@ -1,13 +1,16 @@
+#include <deque>
 #include <string>
 #include "BatchJoinProcessing.h"
 #include "ExceptionHandling/BlazingThread.h"
 #include "parser/expression_tree.hpp"
+#include "parser/expression_utils.hpp"
 #include "CodeTimer.h"
 #include <cudf/partitioning.hpp>
 #include <cudf/join.hpp>
 #include <cudf/stream_compaction.hpp>
 #include <src/execution_graph/logic_controllers/LogicalFilter.h>
 #include "execution_graph/logic_controllers/taskflow/executor.h"
+#include "operators/JoinSkew.h"
 
 namespace ral {
 namespace batch {
@@ -194,6 +197,57 @@ void split_inequality_join_into_join_and_filter(const std::string & join_stateme
 	}
 }
 
+void publish_runtime_join_filter(std::shared_ptr<ral::cache::graph> query_graph, std::int32_t join_kernel_id, const std::string & port_name,
+	std::shared_ptr<ral::operators::runtime_join_filter> filter, const std::vector<cudf::size_type> & key_indices) {
+	for (auto & edge : query_graph->get_reverse_neighbours(join_kernel_id)) {
+		if (edge.target_port_name != port_name) {
+			continue;
+		}
+
+		std::vector<cudf::size_type> source_key_indices = key_indices;
+		kernel * source = query_graph->get_node(edge.source);
+		while (source != nullptr) {
+			kernel_type type = source->get_type_id();
+			if (type == kernel_type::ProjectKernel) {
+				// a key that is an input column of the projection is that column in its input, any other expression ends the walk
+				auto * projection = static_cast<Projection *>(source);
+				bool all_keys_are_columns = true;
+				for (auto & key_index : source_key_indices) {
+					const std::string & key_expression = projection->expressions()[key_index];
+					if (key_expression.size() < 2 || !is_var_column(key_expression) || key_expression.find_first_not_of("0123456789", 1) != std::string::npos) {
+						all_keys_are_columns = false;
+						break;
+					}
+					key_index = std::stoi(key_expression.substr(1));
+				}
+				if (!all_keys_are_columns) {
+					break;
+				}
+			} else if (type != kernel_type::FilterKernel && type != kernel_type::TableScanKernel && type != kernel_type::BindableTableScanKernel) {
+				break;
+			} else {
+				source->add_runtime_join_filter(filter, source_key_indices);
+				if (type != kernel_type::FilterKernel) {
+					break;
+				}
+			}
+
+			auto source_edges = query_graph->get_reverse_neighbours(source->get_id());
+			source = source_edges.size() == 1 ? query_graph->get_node(source_edges.begin()->source) : nullptr;
+		}
+	}
+}
+
+std::size_t get_runtime_join_filter_max_build_bytes(Context * context) {
+	std::size_t max_build_bytes = 256000000;
+	std::map<std::string, std::string> config_options = context->getConfigOptions();
+	auto it = config_options.find("RUNTIME_JOIN_FILTER_MAX_BUILD_BYTES");
+	if (it != config_options.end()){
+		max_build_bytes = std::stoull(config_options["RUNTIME_JOIN_FILTER_MAX_BUILD_BYTES"]);
+	}
+	return max_build_bytes;
+}
+
 // BEGIN PartwiseJoin
 
 PartwiseJoin::PartwiseJoin(std::size_t kernel_id, const std::string & queryString, std::shared_ptr<Context> context, std::shared_ptr<ral::cache::graph> query_graph)
@@ -212,6 +266,8 @@ PartwiseJoin::PartwiseJoin(std::size_t kernel_id, const std::string & queryStrin
 	this->leftArrayCache = 	ral::cache::create_cache_machine(cache_machine_config, left_array_cache_name);
 	std::string right_array_cache_name = std::to_string(this->get_id()) + "_right_array";
 	this->rightArrayCache = ral::cache::create_cache_machine(cache_machine_config, right_array_cache_name);
+	std::string right_buffer_cache_name = std::to_string(this->get_id()) + "_right_buffer";
+	this->rightBufferCache = ral::cache::create_cache_machine(cache_machine_config, right_buffer_cache_name);
 
 	std::tie(this->expression, this->condition, this->filter_statement, this->join_type) = parseExpressionToGetTypeAndCondition(this->expression);
 
@@ -221,6 +277,13 @@ PartwiseJoin::PartwiseJoin(std::size_t kernel_id, const std::string & queryStrin
 	if (this->join_type == RIGHT_JOIN) {
 		throw std::runtime_error("Right Outer Joins are not currently supported");
 	}
+
+	this->bucket_byte_size = 400000000;
+	std::map<std::string, std::string> config_options = context->getConfigOptions();
+	auto it = config_options.find("NUM_BYTES_PER_JOIN_BUCKET");
+	if (it != config_options.end()){
+		this->bucket_byte_size = std::stoull(config_options["NUM_BYTES_PER_JOIN_BUCKET"]);
+	}
 }
 
 std::unique_ptr<ral::cache::CacheData> PartwiseJoin::load_left_set(){
@@ -233,12 +296,106 @@ std::unique_ptr<ral::cache::CacheData> PartwiseJoin::load_left_set(){
 
 std::unique_ptr<ral::cache::CacheData> PartwiseJoin::load_right_set(){
 	this->max_right_ind++;
-	auto cache_data = this->right_input->pullCacheData();
+	std::unique_ptr<ral::cache::CacheData> cache_data;
+	if (this->num_buffered_right_sets > 0) {
+		this->num_buffered_right_sets--;
+		cache_data = this->rightBufferCache->pullCacheData();
+	} else {
+		cache_data = this->right_input->pullCacheData();
+	}
 	RAL_EXPECTS(cache_data != nullptr, "In PartwiseJoin: The right input cache data cannot be null");
 
 	return cache_data;
 }
 
+bool PartwiseJoin::has_next_right_set(){
+	return this->num_buffered_right_sets > 0 || this->right_input->wait_for_next();
+}
+
+void PartwiseJoin::build_runtime_join_filter(std::unique_ptr<ral::cache::CacheData> first_right_set){
+	std::size_t max_build_bytes = get_runtime_join_filter_max_build_bytes(this->context.get());
+
+	std::vector<std::unique_ptr<ral::cache::CacheData>> right_sets;
+	std::size_t build_bytes = 0;
+	bool complete = true;
+	std::unique_ptr<ral::cache::CacheData> cache_data = std::move(first_right_set);
+	while (cache_data != nullptr) {
+		build_bytes += cache_data->sizeInBytes();
+		right_sets.push_back(std::move(cache_data));
+		if (build_bytes > max_build_bytes) {
+			// the right side is too big to wait for all of it, the join goes on without a filter
+			complete = false;
+			break;
+		}
+		cache_data = this->right_input->pullCacheData();
+	}
+
+	this->num_buffered_right_sets += right_sets.size();
+	if (!complete) {
+		for (auto & right_set : right_sets) {
+			this->rightBufferCache->addCacheData(std::move(right_set), "", true);
+		}
+
+		if(logger) {
+			logger->debug("{query_id}|{step}|{substep}|{info}||kernel_id|{kernel_id}||",
+										"query_id"_a=context->getContextToken(),
+										"step"_a=context->getQueryStep(),
+										"substep"_a=context->getQuerySubstep(),
+										"info"_a="PartwiseJoin right side over runtime join filter budget",
+										"kernel_id"_a=this->get_id());
+		}
+		return;
+	}
+
+	std::pair<bool, uint64_t> right_num_rows_estimate = this->query_graph->get_estimated_input_rows_to_cache(this->kernel_id, "input_b");
+	this->runtime_filter = std::make_shared<ral::operators::runtime_join_filter>(this->join_column_common_types,
+		right_num_rows_estimate.first ? right_num_rows_estimate.second : 0);
+
+	// every set adds its keys in a task and goes back to the buffer, the last one publishes the filter
+	this->num_pending_runtime_filter_sets = right_sets.size();
+	for (auto & right_set : right_sets) {
+		std::vector<std::unique_ptr<ral::cache::CacheData>> inputs;
+		inputs.push_back(std::move(right_set));
+		ral::execution::executor::get_instance()->add_task(
+								std::move(inputs),
+								this->rightBufferCache,
+								this,
+								{{"operation_type", "runtime_join_filter"}});
+	}
+}
+
+ral::execution::task_result PartwiseJoin::process_runtime_join_filter_set(std::vector<std::unique_ptr<ral::frame::BlazingTable>> inputs,
+	std::shared_ptr<ral::cache::CacheMachine> output) {
+	try{
+		auto & input = inputs[0];
+		if (input->num_columns() > 0) {
+			// adding the same keys again when the task is retried leaves the filter as it was
+			std::lock_guard<std::mutex> lock(runtime_filter_mutex);
+			this->runtime_filter->add(input->toBlazingTableView(), this->right_column_indices);
+		}
+		output->addToCache(std::move(input), "", true);
+	}catch(const rmm::bad_alloc& e){
+		return {ral::execution::task_status::RETRY, std::string(e.what()), std::move(inputs)};
+	}catch(const std::exception& e){
+		return {ral::execution::task_status::FAIL, std::string(e.what()), std::vector< std::unique_ptr<ral::frame::BlazingTable> > ()};
+	}
+
+	if (--this->num_pending_runtime_filter_sets == 0) {
+		publish_runtime_join_filter(this->query_graph, this->get_id(), "input_a", this->runtime_filter, this->left_column_indices);
+
+		if(logger) {
+			logger->debug("{query_id}|{step}|{substep}|{info}||kernel_id|{kernel_id}||",
+										"query_id"_a=context->getContextToken(),
+										"step"_a=context->getQueryStep(),
+										"substep"_a=context->getQuerySubstep(),
+										"info"_a="PartwiseJoin published runtime join filter",
+										"kernel_id"_a=this->get_id());
+		}
+	}
+
+	return {ral::execution::task_status::SUCCESS, std::string(), std::vector< std::unique_ptr<ral::frame::BlazingTable> > ()};
+}
+
 void PartwiseJoin::mark_set_completed(int left_ind, int right_ind){
 	assert(left_ind >=0 && right_ind >=0 );
 	if (completion_matrix.size() <= static_cast<size_t>(left_ind)){
@@ -315,6 +472,245 @@ void PartwiseJoin::computeNormalizationData(const	std::vector<cudf::data_type> &
 												right_join_types.cbegin(), right_join_types.cend());
 }
 
+bool PartwiseJoin::use_partitioned_join(const ral::cache::CacheData & left_cache_data, const ral::cache::CacheData & right_cache_data){
+	if (this->join_type == CROSS_JOIN || this->bucket_byte_size == 0 ||
+		left_cache_data.num_rows() == 0 || right_cache_data.num_rows() == 0) {
+		return false;
+	}
+
+	std::pair<bool, uint64_t> left_num_rows_estimate = this->query_graph->get_estimated_input_rows_to_cache(this->kernel_id, "input_a");
+	std::pair<bool, uint64_t> right_num_rows_estimate = this->query_graph->get_estimated_input_rows_to_cache(this->kernel_id, "input_b");
+	if (!left_num_rows_estimate.first || !right_num_rows_estimate.first) {
+		return false;
+	}
+
+	double left_bytes_estimate = (double)left_cache_data.sizeInBytes() * left_num_rows_estimate.second / left_cache_data.num_rows();
+	double right_bytes_estimate = (double)right_cache_data.sizeInBytes() * right_num_rows_estimate.second / right_cache_data.num_rows();
+
+	// when one side fits in a bucket every set of the other side is joined just once against it
+	return std::min(left_bytes_estimate, right_bytes_estimate) > this->bucket_byte_size;
+}
+
+int PartwiseJoin::make_bucket_set(int num_buckets, const std::string & name){
+	ral::cache::cache_settings cache_machine_config;
+	cache_machine_config.type = ral::cache::CacheType::SIMPLE;
+	cache_machine_config.context = context->clone();
+
+	std::vector<std::shared_ptr<ral::cache::CacheMachine>> buckets;
+	for (int i = 0; i < num_buckets; i++) {
+		buckets.push_back(ral::cache::create_cache_machine(cache_machine_config, name + "_" + std::to_string(i)));
+	}
+
+	std::lock_guard<std::mutex> lock(bucket_sets_mutex);
+	this->bucket_sets.push_back(std::move(buckets));
+	return this->bucket_sets.size() - 1;
+}
+
+void PartwiseJoin::add_partition_task(std::unique_ptr<ral::cache::CacheData> cache_data, const std::string & side, int bucket_set){
+	std::vector<std::unique_ptr<ral::cache::CacheData>> inputs;
+	inputs.push_back(std::move(cache_data));
+
+	ral::execution::executor::get_instance()->add_task(
+							std::move(inputs),
+							this->output_cache(),
+							this,
+							{{"operation_type", "partition"}, {"side", side}, {"bucket_set", std::to_string(bucket_set)}});
+}
+
+namespace {
+
+// Buckets are partitioned again with a number of partitions that is coprime with the ones used before: the rows of a
+// bucket share the same hash modulo every one of them, so any common factor would leave them all in the same sub bucket
+int next_coprime_num_buckets(int min_num_buckets, const std::vector<int> & used_num_buckets) {
+	for (int candidate = std::max(min_num_buckets, 3); ; candidate++) {
+		bool coprime = true;
+		for (int used : used_num_buckets) {
+			int a = candidate, b = used;
+			while (b != 0) {
+				std::tie(a, b) = std::make_tuple(b, a % b);
+			}
+			coprime = coprime && a == 1;
+		}
+		if (coprime) {
+			return candidate;
+		}
+	}
+}
+
+const int MAX_JOIN_BUCKETS = 256;
+const int MAX_JOIN_REPARTITION_LEVELS = 3;
+
+}  // namespace
+
+void PartwiseJoin::run_partitioned_join(std::unique_ptr<ral::cache::CacheData> left_cache_data, std::unique_ptr<ral::cache::CacheData> right_cache_data){
+	CodeTimer timer;
+
+	std::pair<bool, uint64_t> left_num_rows_estimate = this->query_graph->get_estimated_input_rows_to_cache(this->kernel_id, "input_a");
+	std::pair<bool, uint64_t> right_num_rows_estimate = this->query_graph->get_estimated_input_rows_to_cache(this->kernel_id, "input_b");
+	double total_bytes_estimate = (double)left_cache_data->sizeInBytes() * left_num_rows_estimate.second / left_cache_data->num_rows() +
+		(double)right_cache_data->sizeInBytes() * right_num_rows_estimate.second / right_cache_data->num_rows();
+	int num_buckets = 2;
+	while (num_buckets < MAX_JOIN_BUCKETS && num_buckets * (double)this->bucket_byte_size < total_bytes_estimate) {
+		num_buckets *= 2;
+	}
+
+	std::string bucket_name = std::to_string(this->get_id()) + "_bucket";
+	int left_set = make_bucket_set(num_buckets, bucket_name + "_left");
+	int right_set = make_bucket_set(num_buckets, bucket_name + "_right");
+
+	add_partition_task(std::move(left_cache_data), "left", left_set);
+	add_partition_task(std::move(right_cache_data), "right", right_set);
+	while (this->left_input->wait_for_next()) {
+		add_partition_task(this->left_input->pullCacheData(), "left", left_set);
+	}
+	while (has_next_right_set()) {
+		add_partition_task(load_right_set(), "right", right_set);
+	}
+	wait_for_tasks();
+
+	struct bucket_pair {
+		std::shared_ptr<ral::cache::CacheMachine> left;
+		std::shared_ptr<ral::cache::CacheMachine> right;
+		std::vector<int> used_num_buckets;
+	};
+	std::deque<bucket_pair> pending;
+	for (int i = 0; i < num_buckets; i++) {
+		pending.push_back({bucket_sets[left_set][i], bucket_sets[right_set][i], {num_buckets}});
+	}
+
+	int num_joined_buckets = 0, num_repartitioned_buckets = 0;
+	while (!pending.empty()) {
+		bucket_pair pair = std::move(pending.front());
+		pending.pop_front();
+
+		std::size_t bucket_bytes = pair.left->get_num_bytes_added() + pair.right->get_num_bytes_added();
+		if (bucket_bytes > this->bucket_byte_size && static_cast<int>(pair.used_num_buckets.size()) <= MAX_JOIN_REPARTITION_LEVELS) {
+			int num_sub_buckets = next_coprime_num_buckets((bucket_bytes + this->bucket_byte_size - 1) / this->bucket_byte_size, pair.used_num_buckets);
+			int left_sub_set = make_bucket_set(num_sub_buckets, bucket_name + "_left");
+			int right_sub_set = make_bucket_set(num_sub_buckets, bucket_name + "_right");
+			for (auto & cache_data : pair.left->pull_all_cache_data()) {
+				add_partition_task(std::move(cache_data), "left", left_sub_set);
+			}
+			for (auto & cache_data : pair.right->pull_all_cache_data()) {
+				add_partition_task(std::move(cache_data), "right", right_sub_set);
+			}
+			wait_for_tasks();
+
+			std::vector<int> used_num_buckets = pair.used_num_buckets;
+			used_num_buckets.push_back(num_sub_buckets);
+			for (int i = 0; i < num_sub_buckets; i++) {
+				pending.push_back({bucket_sets[left_sub_set][i], bucket_sets[right_sub_set][i], used_num_buckets});
+			}
+			num_repartitioned_buckets++;
+			continue;
+		}
+
+		// a bucket with one side empty only produces rows for the outer joins
+		std::vector<std::unique_ptr<ral::cache::CacheData>> left_sets = pair.left->pull_all_cache_data();
+		std::vector<std::unique_ptr<ral::cache::CacheData>> right_sets = pair.right->pull_all_cache_data();
+		bool produces_rows = (this->join_type == INNER_JOIN && !left_sets.empty() && !right_sets.empty()) ||
+			(this->join_type == LEFT_JOIN && !left_sets.empty()) ||
+			(this->join_type == OUTER_JOIN && (!left_sets.empty() || !right_sets.empty()));
+		if (!produces_rows) {
+			continue;
+		}
+
+		std::size_t num_left_sets = left_sets.size();
+		std::vector<std::unique_ptr<ral::cache::CacheData>> inputs = std::move(left_sets);
+		for (auto & cache_data : right_sets) {
+			inputs.push_back(std::move(cache_data));
+		}
+		ral::execution::executor::get_instance()->add_task(
+								std::move(inputs),
+								this->output_cache(),
+								this,
+								{{"operation_type", "join_bucket"}, {"num_left_sets", std::to_string(num_left_sets)}});
+		num_joined_buckets++;
+	}
+
+	if(logger) {
+		logger->debug("{query_id}|{step}|{substep}|{info}|{duration}|kernel_id|{kernel_id}||",
+									"query_id"_a=context->getContextToken(),
+									"step"_a=context->getQueryStep(),
+									"substep"_a=context->getQuerySubstep(),
+									"info"_a="PartwiseJoin partitioned join into " + std::to_string(num_buckets) + " buckets, " +
+										std::to_string(num_repartitioned_buckets) + " partitioned again, " + std::to_string(num_joined_buckets) + " joined",
+									"duration"_a=timer.elapsed_time(),
+									"kernel_id"_a=this->get_id());
+	}
+}
+
+ral::execution::task_result PartwiseJoin::process_partitioned_join(std::vector<std::unique_ptr<ral::frame::BlazingTable>> inputs,
+	const std::string & operation_type, const std::map<std::string, std::string>& args) {
+	try{
+		if (operation_type == "partition") {
+			auto & input = inputs[0];
+			bool left_side = args.at("side") == "left";
+			const std::vector<cudf::size_type> & column_indices = left_side ? this->left_column_indices : this->right_column_indices;
+			if (left_side ? this->normalize_left : this->normalize_right) {
+				ral::utilities::normalize_types(input, this->join_column_common_types, column_indices);
+			}
+			if (input->num_rows() == 0) {
+				return {ral::execution::task_status::SUCCESS, std::string(), std::vector< std::unique_ptr<ral::frame::BlazingTable> > ()};
+			}
+
+			std::vector<std::shared_ptr<ral::cache::CacheMachine>> buckets;
+			{
+				std::lock_guard<std::mutex> lock(bucket_sets_mutex);
+				buckets = this->bucket_sets[std::stoi(args.at("bucket_set"))];
+			}
+
+			std::unique_ptr<cudf::table> hashed_data;
+			std::vector<cudf::size_type> hashed_data_offsets;
+			std::tie(hashed_data, hashed_data_offsets) = cudf::hash_partition(input->view(), column_indices, buckets.size());
+
+			// the offsets returned by hash_partition will always start at 0, which is a value we want to ignore for cudf::split
+			std::vector<cudf::size_type> split_indexes(hashed_data_offsets.begin() + 1, hashed_data_offsets.end());
+			std::vector<cudf::table_view> partitioned = cudf::split(hashed_data->view(), split_indexes);
+
+			// all the partitions are copied before any is added to its bucket, so a retry after running out of memory
+			// does not add the rows of the first partitions twice
+			std::vector<std::unique_ptr<ral::frame::BlazingTable>> partitions(partitioned.size());
+			for (std::size_t i = 0; i < partitioned.size(); i++) {
+				if (partitioned[i].num_rows() > 0) {
+					partitions[i] = ral::frame::BlazingTableView(partitioned[i], input->names()).clone();
+				}
+			}
+			hashed_data = nullptr;
+			for (std::size_t i = 0; i < partitions.size(); i++) {
+				if (partitions[i] != nullptr) {
+					buckets[i]->addToCache(std::move(partitions[i]), "", true);
+				}
+			}
+		} else if (operation_type == "join_bucket") {
+			std::size_t num_left_sets = std::stoull(args.at("num_left_sets"));
+			std::vector<ral::frame::BlazingTableView> left_views, right_views;
+			for (std::size_t i = 0; i < inputs.size(); i++) {
+				(i < num_left_sets ? left_views : right_views).push_back(inputs[i]->toBlazingTableView());
+			}
+
+			std::unique_ptr<ral::frame::BlazingTable> left_bucket = left_views.empty() ?
+				ral::frame::createEmptyBlazingTable(this->left_types, this->left_names) : ral::utilities::concatTables(left_views);
+			std::unique_ptr<ral::frame::BlazingTable> right_bucket = right_views.empty() ?
+				ral::frame::createEmptyBlazingTable(this->right_types, this->right_names) : ral::utilities::concatTables(right_views);
+
+			std::unique_ptr<ral::frame::BlazingTable> joined = join_set(left_bucket->toBlazingTableView(), right_bucket->toBlazingTableView());
+			if (filter_statement != "") {
+				joined = ral::processor::process_filter(joined->toBlazingTableView(), filter_statement, this->context.get());
+			}
+			this->add_to_output_cache(std::move(joined));
+		} else {
+			RAL_FAIL("In PartwiseJoin: unknown operation_type " + operation_type);
+		}
+	}catch(const rmm::bad_alloc& e){
+		return {ral::execution::task_status::RETRY, std::string(e.what()), std::move(inputs)};
+	}catch(const std::exception& e){
+		return {ral::execution::task_status::FAIL, std::string(e.what()), std::vector< std::unique_ptr<ral::frame::BlazingTable> > ()};
+	}
+
+	return {ral::execution::task_status::SUCCESS, std::string(), std::vector< std::unique_ptr<ral::frame::BlazingTable> > ()};
+}
+
 std::unique_ptr<ral::frame::BlazingTable> PartwiseJoin::join_set(
 	const ral::frame::BlazingTableView & table_left,
 	const ral::frame::BlazingTableView & table_right)
@@ -377,10 +773,17 @@ std::unique_ptr<ral::frame::BlazingTable> PartwiseJoin::join_set(
 }
 
 ral::execution::task_result PartwiseJoin::do_process(std::vector<std::unique_ptr<ral::frame::BlazingTable>> inputs,
-	std::shared_ptr<ral::cache::CacheMachine> /*output*/,
+	std::shared_ptr<ral::cache::CacheMachine> output,
 	cudaStream_t /*stream*/, const std::map<std::string, std::string>& args) {
 	CodeTimer eventTimer;
 
+	auto operation_type = args.find("operation_type");
+	if (operation_type != args.end() && operation_type->second == "runtime_join_filter") {
+		return process_runtime_join_filter_set(std::move(inputs), output);
+	} else if (operation_type != args.end()) {
+		return process_partitioned_join(std::move(inputs), operation_type->second, args);
+	}
+
 	auto & left_batch = inputs[0];
 	auto & right_batch = inputs[1];
 
@@ -473,6 +876,30 @@ kstatus PartwiseJoin::run() {
 			this->result_names.insert(this->result_names.end(), right_names.begin(), right_names.end());
 
 			computeNormalizationData(left_cache_data->get_schema(), right_cache_data->get_schema());
+
+			// in distributed mode JoinPartitionKernel builds the filter, before the shuffle
+			if (this->join_type == INNER_JOIN && this->context->getTotalNodes() == 1 &&
+				get_runtime_join_filter_max_build_bytes(this->context.get()) > 0) {
+				build_runtime_join_filter(std::move(right_cache_data));
+
+				// the first right set is now the first buffered one, it is back once its keys are in the filter
+				this->num_buffered_right_sets--;
+				right_cache_data = this->rightBufferCache->pullCacheData();
+			}
+
+			if (use_partitioned_join(*left_cache_data, *right_cache_data)) {
+				this->left_types = left_cache_data->get_schema();
+				this->right_types = right_cache_data->get_schema();
+				for (std::size_t i = 0; i < this->left_column_indices.size(); i++) {
+					this->left_types[this->left_column_indices[i]] = this->join_column_common_types[i];
+					this->right_types[this->right_column_indices[i]] = this->join_column_common_types[i];
+				}
+				this->left_names = left_names;
+				this->right_names = right_names;
+
+				run_partitioned_join(std::move(left_cache_data), std::move(right_cache_data));
+				done = true;
+			}
 		} else {
 			// Not first load, so we have joined a set pair. Now lets see if there is another set pair we can do, but keeping one of the two sides we already have
 			std::tie(left_ind, right_ind) = check_for_another_set_to_do_with_data_we_already_have();
@@ -484,7 +911,7 @@ kstatus PartwiseJoin::run() {
 					left_cache_data = load_left_set();
 					left_ind = this->max_left_ind;
 				}
-				if (this->right_input->wait_for_next()){
+				if (has_next_right_set()){
 					right_cache_data = load_right_set();
 					right_ind = this->max_right_ind;
 				}
@@ -555,6 +982,8 @@ kstatus PartwiseJoin::run() {
 	// these are intra kernel caches. We want to make sure they are empty before we finish.
 	this->leftArrayCache->clear();
 	this->rightArrayCache->clear();
+	this->rightBufferCache->clear();
+	this->bucket_sets.clear();
 
 	return kstatus::proceed;
 }
@@ -800,38 +1229,71 @@ void JoinPartitionKernel::perform_standard_hash_partitioning(
 
 	computeNormalizationData(left_cache_data->get_schema(), right_cache_data->get_schema());
 
-	BlazingThread left_thread([this, &left_input, &left_cache_data](){
-		while(left_cache_data != nullptr) {
+	// Rows with a heavy hitter key are split on one side and copied on the other one, which would
+	// repeat the unmatched rows of the copied side of a full outer join
+	if (this->join_type == INNER_JOIN || this->join_type == LEFT_JOIN) {
+		detect_heavy_hitters(left_cache_data, right_cache_data);
+	}
+
+	// With a runtime join filter the right side is partitioned first, so the filter is ready before the left side is shuffled
+	this->runtime_filter_max_build_bytes = get_runtime_join_filter_max_build_bytes(this->context.get());
+	bool build_runtime_filter = this->join_type == INNER_JOIN && this->runtime_filter_max_build_bytes > 0;
+	if (build_runtime_filter) {
+		std::pair<bool, uint64_t> right_num_rows_estimate = this->query_graph->get_estimated_input_rows_to_cache(this->kernel_id, "input_b");
+		this->runtime_filter = std::make_shared<ral::operators::runtime_join_filter>(this->join_column_common_types,
+			right_num_rows_estimate.first ? right_num_rows_estimate.second * this->context->getTotalNodes() : 0);
+	}
+
+	// The left side is shuffled while the filter is built, the left batches partitioned after the filter
+	// of all the nodes is merged are filtered before they are shuffled
+	BlazingThread right_thread([this, &right_input, &right_cache_data, build_runtime_filter](){
+		std::size_t num_right_tasks = 0;
+		while(right_cache_data != nullptr) {
 			std::vector<std::unique_ptr<ral::cache::CacheData>> inputs;
-			inputs.push_back(std::move(left_cache_data));
+			inputs.push_back(std::move(right_cache_data));
 
 			ral::execution::executor::get_instance()->add_task(
 										std::move(inputs),
-										this->output_cache("output_a"),
+										this->output_cache("output_b"),
 										this,
-										{{"operation_type", "hash_partition"}, {"side", "left"}});
+										{{"operation_type", "hash_partition"}, {"side", "right"}});
+			num_right_tasks++;
 
-			left_cache_data = left_input->pullCacheData();
+			right_cache_data = right_input->pullCacheData();
+		}
+
+		if (build_runtime_filter) {
+			std::unique_lock<std::mutex> lock(kernel_mutex);
+			kernel_cv.wait(lock,[this, num_right_tasks]{
+				return this->num_right_partition_tasks_done == num_right_tasks || ral::execution::executor::get_instance()->has_exception();
+			});
+			lock.unlock();
+
+			if (!ral::execution::executor::get_instance()->has_exception()) {
+				exchange_runtime_join_filter();
+			}
 		}
 	});
 
-	BlazingThread right_thread([this, &right_input, &right_cache_data](){
-		while(right_cache_data != nullptr) {
+	BlazingThread left_thread([this, &left_input, &left_cache_data](){
+		while(left_cache_data != nullptr) {
 			std::vector<std::unique_ptr<ral::cache::CacheData>> inputs;
-			inputs.push_back(std::move(right_cache_data));
+			inputs.push_back(std::move(left_cache_data));
 
 			ral::execution::executor::get_instance()->add_task(
 										std::move(inputs),
-										this->output_cache("output_b"),
+										this->output_cache("output_a"),
 										this,
-										{{"operation_type", "hash_partition"}, {"side", "right"}});
+										{{"operation_type", "hash_partition"}, {"side", "left"}});
 
-			right_cache_data = right_input->pullCacheData();
+			left_cache_data = left_input->pullCacheData();
 		}
 	});
 
 	left_thread.join();
-	right_thread.join();
+	if (right_thread.joinable()) {
+		right_thread.join();
+	}
 
 	if(logger) {
         logger->debug("{query_id}|{step}|{substep}|{info}||kernel_id|{kernel_id}||",
@@ -842,14 +1304,7 @@ void JoinPartitionKernel::perform_standard_hash_partitioning(
                                 "kernel_id"_a=this->get_id());
     }
 
-	std::unique_lock<std::mutex> lock(kernel_mutex);
-	kernel_cv.wait(lock,[this]{
-		return this->tasks.empty() || ral::execution::executor::get_instance()->has_exception();
-	});
-
-	if(auto ep = ral::execution::executor::get_instance()->last_exception()){
-		std::rethrow_exception(ep);
-	}
+	wait_for_tasks();
 
 	if(logger) {
         logger->debug("{query_id}|{step}|{substep}|{info}||kernel_id|{kernel_id}||",
@@ -887,6 +1342,174 @@ void JoinPartitionKernel::perform_standard_hash_partitioning(
 	this->output_.get_cache("output_b")->wait_for_count(total_count_right);
 }
 
+std::pair<std::unique_ptr<ral::frame::BlazingTable>, uint64_t> JoinPartitionKernel::exchange_join_key_samples(
+	std::unique_ptr<ral::cache::CacheData> & cache_data, bool left_side){
+	const std::vector<cudf::size_type> & key_indices = left_side ? this->left_column_indices : this->right_column_indices;
+
+	auto batch = cache_data->decache();
+	if (left_side ? this->normalize_left : this->normalize_right) {
+		ral::utilities::normalize_types(batch, this->join_column_common_types, key_indices);
+	}
+	auto samples = ral::operators::sample_join_keys(batch->toBlazingTableView(), key_indices);
+
+	std::pair<bool, uint64_t> estimated_rows = this->query_graph->get_estimated_input_rows_to_cache(this->kernel_id, left_side ? "input_a" : "input_b");
+	uint64_t total_rows = estimated_rows.first ? estimated_rows.second : batch->num_rows();
+	cache_data = std::make_unique<ral::cache::GPUCacheData>(std::move(batch));
+
+	std::string message_id_prefix = left_side ? "join_skew_left_samples_" : "join_skew_right_samples_";
+	auto& self_node = ral::communication::CommunicationData::getInstance().getSelfNode();
+	int self_node_idx = context->getNodeIndex(self_node);
+	auto nodes_to_send = context->getAllOtherNodes(self_node_idx);
+
+	std::vector<std::string> messages_to_wait_for;
+	std::vector<std::string> target_ids;
+	for (auto & node_to_send : nodes_to_send) {
+		target_ids.push_back(node_to_send.id());
+		messages_to_wait_for.push_back(
+			message_id_prefix + std::to_string(this->context->getContextToken()) + "_" + std::to_string(this->get_id()) + "_" + node_to_send.id());
+	}
+
+	ral::cache::MetadataDictionary extra_metadata;
+	extra_metadata.add_value(ral::cache::JOIN_SKEW_ESTIMATED_ROWS_METADATA_LABEL, std::to_string(total_rows));
+	send_message(samples->toBlazingTableView().clone(),
+			false, //specific_cache
+			"", //cache_id
+			target_ids, //target_ids
+			message_id_prefix, //message_id_prefix
+			true, //always_add
+			false, //wait_for
+			0, //message_tracker_idx
+			extra_metadata);
+
+	// every node gets the samples and the estimated rows of all the nodes, so all of them take the same decision
+	std::vector<std::unique_ptr<ral::frame::BlazingTable>> node_samples;
+	std::vector<ral::frame::BlazingTableView> sample_views{samples->toBlazingTableView()};
+	for (auto & message_id : messages_to_wait_for) {
+		auto message = this->query_graph->get_input_message_cache()->pullCacheData(message_id);
+		auto *message_with_metadata = dynamic_cast<ral::cache::CPUCacheData*>(message.get());
+		total_rows += std::stoull(message_with_metadata->getMetadata().get_values()[ral::cache::JOIN_SKEW_ESTIMATED_ROWS_METADATA_LABEL]);
+		node_samples.push_back(message->decache());
+		sample_views.push_back(node_samples.back()->toBlazingTableView());
+	}
+
+	return {ral::utilities::concatTables(sample_views), total_rows};
+}
+
+void JoinPartitionKernel::detect_heavy_hitters(std::unique_ptr<ral::cache::CacheData> & left_cache_data,
+	std::unique_ptr<ral::cache::CacheData> & right_cache_data){
+	double heavy_hitter_threshold = 0.05;
+	std::map<std::string, std::string> config_options = context->getConfigOptions();
+	auto it = config_options.find("JOIN_SKEW_HEAVY_HITTER_THRESHOLD");
+	if (it != config_options.end()){
+		heavy_hitter_threshold = std::stod(config_options["JOIN_SKEW_HEAVY_HITTER_THRESHOLD"]);
+	}
+	if (heavy_hitter_threshold <= 0) {
+		return;
+	}
+
+	CodeTimer timer;
+	this->context->incrementQuerySubstep();
+
+	// The side with more rows with a heavy hitter key is split and the other one is copied. The right side of a left join
+	// is never split, the left rows copied to every node would be unmatched (and kept) in the nodes without the key
+	auto left_samples = exchange_join_key_samples(left_cache_data, true);
+	auto left_heavy_hitters = ral::operators::get_heavy_hitters(left_samples.first->toBlazingTableView(), heavy_hitter_threshold);
+	double left_heavy_rows = ral::operators::get_heavy_hitter_fraction(left_samples.first->toBlazingTableView(),
+		left_heavy_hitters->toBlazingTableView()) * left_samples.second;
+
+	this->heavy_hitters = std::move(left_heavy_hitters);
+	this->split_left_heavy_hitters = true;
+	double heavy_rows = left_heavy_rows;
+	if (this->join_type == INNER_JOIN) {
+		auto right_samples = exchange_join_key_samples(right_cache_data, false);
+		auto right_heavy_hitters = ral::operators::get_heavy_hitters(right_samples.first->toBlazingTableView(), heavy_hitter_threshold);
+		double right_heavy_rows = ral::operators::get_heavy_hitter_fraction(right_samples.first->toBlazingTableView(),
+			right_heavy_hitters->toBlazingTableView()) * right_samples.second;
+
+		if (right_heavy_rows > left_heavy_rows) {
+			this->heavy_hitters = std::move(right_heavy_hitters);
+			this->split_left_heavy_hitters = false;
+			heavy_rows = right_heavy_rows;
+		}
+	}
+
+	cudf::size_type num_heavy_hitters = this->heavy_hitters->num_rows();
+	if (num_heavy_hitters == 0) {
+		this->heavy_hitters = nullptr;
+	}
+
+	if(logger) {
+		logger->debug("{query_id}|{step}|{substep}|{info}|{duration}|kernel_id|{kernel_id}||",
+									"query_id"_a=context->getContextToken(),
+									"step"_a=context->getQueryStep(),
+									"substep"_a=context->getQuerySubstep(),
+									"info"_a="JoinPartitionKernel found " + std::to_string(num_heavy_hitters) + " heavy hitter keys in about " +
+										std::to_string(static_cast<uint64_t>(heavy_rows)) + " rows of the " + (this->split_left_heavy_hitters ? "left" : "right") + " side",
+									"duration"_a=timer.elapsed_time(),
+									"kernel_id"_a=this->get_id());
+	}
+}
+
+void JoinPartitionKernel::exchange_runtime_join_filter(){
+	CodeTimer timer;
+	this->context->incrementQuerySubstep();
+
+	bool valid = this->runtime_filter_build_bytes <= this->runtime_filter_max_build_bytes;
+
+	auto& self_node = ral::communication::CommunicationData::getInstance().getSelfNode();
+	int self_node_idx = context->getNodeIndex(self_node);
+	auto nodes_to_send = context->getAllOtherNodes(self_node_idx);
+
+	ral::cache::MetadataDictionary extra_metadata;
+	extra_metadata.add_value(ral::cache::RUNTIME_JOIN_FILTER_VALID_METADATA_LABEL, valid ? "true" : "false");
+
+	std::vector<std::string> messages_to_wait_for;
+	std::vector<std::string> target_ids;
+	for (auto & node_to_send : nodes_to_send) {
+		target_ids.push_back(node_to_send.id());
+		messages_to_wait_for.push_back(
+			"runtime_join_filter_" + std::to_string(this->context->getContextToken()) + "_" + std::to_string(this->get_id()) + "_" + node_to_send.id());
+	}
+	// nodes with an empty right side send a table without columns
+	send_message(valid && !this->runtime_filter->empty() ? this->runtime_filter->to_table() : nullptr,
+			false, //specific_cache
+			"", //cache_id
+			target_ids, //target_ids
+			"runtime_join_filter_", //message_id_prefix
+			true, //always_add
+			false, //wait_for
+			0, //message_tracker_idx
+			extra_metadata);
+
+	for (auto & message_id : messages_to_wait_for) {
+		auto message = this->query_graph->get_input_message_cache()->pullCacheData(message_id);
+		auto *message_with_metadata = dynamic_cast<ral::cache::CPUCacheData*>(message.get());
+		valid = valid && message_with_metadata->getMetadata().get_values()[ral::cache::RUNTIME_JOIN_FILTER_VALID_METADATA_LABEL] == "true";
+		if (valid) {
+			auto filter_table = message->decache();
+			this->runtime_filter->merge(filter_table->toBlazingTableView());
+		}
+	}
+
+	std::lock_guard<std::mutex> lock(runtime_filter_mutex);
+	if (valid) {
+		publish_runtime_join_filter(this->query_graph, this->get_id(), "input_a", this->runtime_filter, this->left_column_indices);
+		this->runtime_filter_ready = true;
+	} else {
+		this->runtime_filter = nullptr;
+	}
+
+	if(logger) {
+		logger->debug("{query_id}|{step}|{substep}|{info}|{duration}|kernel_id|{kernel_id}||",
+									"query_id"_a=context->getContextToken(),
+									"step"_a=context->getQueryStep(),
+									"substep"_a=context->getQuerySubstep(),
+									"info"_a=valid ? "JoinPartitionKernel published runtime join filter" : "JoinPartitionKernel right side over runtime join filter budget",
+									"duration"_a=timer.elapsed_time(),
+									"kernel_id"_a=this->get_id());
+	}
+}
+
 void JoinPartitionKernel::small_table_scatter_distribution(std::unique_ptr<ral::cache::CacheData> small_cache_data,
 	std::unique_ptr<ral::cache::CacheData> big_cache_data,
 	std::shared_ptr<ral::cache::CacheMachine> small_input,
@@ -1011,41 +1634,93 @@ ral::execution::task_result JoinPartitionKernel::do_process(std::vector<std::uni
 				ral::utilities::normalize_types(input, join_column_common_types, column_indices);
 			}
 
-			auto batch_view = input->view();
-			std::unique_ptr<cudf::table> hashed_data;
-			std::vector<cudf::table_view> partitioned;
-			if (input->num_rows() > 0) {
-				// When is cross_join. `column_indices` is equal to 0, so we need all `batch` columns to apply cudf::hash_partition correctly
-				if (column_indices.size() == 0) {
-					column_indices.resize(input->num_columns());
-					std::iota(std::begin(column_indices), std::end(column_indices), 0);
+			std::shared_ptr<ral::operators::runtime_join_filter> filter;
+			bool filter_ready;
+			{
+				std::lock_guard<std::mutex> lock(runtime_filter_mutex);
+				filter = this->runtime_filter;
+				filter_ready = this->runtime_filter_ready;
+			}
+			// the bytes of a right side batch are only counted once it is partitioned, so a retried task counts them once.
+			// Adding the same keys to the filter twice does not change it
+			bool counts_filter_build_bytes = filter != nullptr && table_idx == RIGHT_TABLE_IDX && !filter_ready;
+			std::size_t input_bytes = input->sizeInBytes();
+			if (filter != nullptr) {
+				if (counts_filter_build_bytes) {
+					std::lock_guard<std::mutex> lock(runtime_filter_mutex);
+					// past the budget the filter is dropped by exchange_runtime_join_filter, the keys are not hashed anymore
+					if (this->runtime_filter_build_bytes + input_bytes <= this->runtime_filter_max_build_bytes) {
+						filter->add(input->toBlazingTableView(), column_indices);
+					}
+				} else if (table_idx == LEFT_TABLE_IDX && filter_ready) {
+					// rows dropped here are never shuffled
+					input = filter->apply(input->toBlazingTableView(), column_indices);
 				}
+			}
+
+			if (this->heavy_hitters != nullptr && input->num_rows() > 0) {
+				// the left side rows with a heavy hitter key are split across the nodes and the matching right side rows are copied to all of them
+				auto& self_node = ral::communication::CommunicationData::getInstance().getSelfNode();
+				int split_offset = context->getNodeIndex(self_node) + this->heavy_hitters_split_offset++;
+				auto partitioned = ral::operators::skew_aware_hash_partition(input->toBlazingTableView(), column_indices,
+					this->heavy_hitters->toBlazingTableView(), context->getTotalNodes(), (table_idx == LEFT_TABLE_IDX) == this->split_left_heavy_hitters, split_offset);
 
-				int num_partitions = context->getTotalNodes();
-				std::vector<cudf::size_type> hased_data_offsets;
-				std::tie(hashed_data, hased_data_offsets) = cudf::hash_partition(batch_view, column_indices, num_partitions);
-				assert(hased_data_offsets.begin() != hased_data_offsets.end());
+				std::vector<ral::frame::BlazingTableView> partitions;
+				for(auto & partition : partitioned) {
+					partitions.push_back(partition->toBlazingTableView());
+				}
 
-				// the offsets returned by hash_partition will always start at 0, which is a value we want to ignore for cudf::split
-				std::vector<cudf::size_type> split_indexes(hased_data_offsets.begin() + 1, hased_data_offsets.end());
-				partitioned = cudf::split(hashed_data->view(), split_indexes);
+				scatter(partitions,
+					this->output_.get_cache(cache_id).get(),
+					"", //message_id_prefix
+					cache_id, //cache_id
+					table_idx  //message_tracker_idx
+				);
 			} else {
-				for(int i = 0; i < context->getTotalNodes(); i++){
-					partitioned.push_back(batch_view);
+				auto batch_view = input->view();
+				std::unique_ptr<cudf::table> hashed_data;
+				std::vector<cudf::table_view> partitioned;
+				if (input->num_rows() > 0) {
+					// When is cross_join. `column_indices` is equal to 0, so we need all `batch` columns to apply cudf::hash_partition correctly
+					if (column_indices.size() == 0) {
+						column_indices.resize(input->num_columns());
+						std::iota(std::begin(column_indices), std::end(column_indices), 0);
+					}
+
+					int num_partitions = context->getTotalNodes();
+					std::vector<cudf::size_type> hased_data_offsets;
+					std::tie(hashed_data, hased_data_offsets) = cudf::hash_partition(batch_view, column_indices, num_partitions);
+					assert(hased_data_offsets.begin() != hased_data_offsets.end());
+
+					// the offsets returned by hash_partition will always start at 0, which is a value we want to ignore for cudf::split
+					std::vector<cudf::size_type> split_indexes(hased_data_offsets.begin() + 1, hased_data_offsets.end());
+					partitioned = cudf::split(hashed_data->view(), split_indexes);
+				} else {
+					for(int i = 0; i < context->getTotalNodes(); i++){
+						partitioned.push_back(batch_view);
+					}
+				}
+
+				std::vector<ral::frame::BlazingTableView> partitions;
+				for(auto partition : partitioned) {
+					partitions.push_back(ral::frame::BlazingTableView(partition, input->names()));
 				}
-			}
 
-			std::vector<ral::frame::BlazingTableView> partitions;
-			for(auto partition : partitioned) {
-				partitions.push_back(ral::frame::BlazingTableView(partition, input->names()));
+				scatter(partitions,
+					this->output_.get_cache(cache_id).get(),
+					"", //message_id_prefix
+					cache_id, //cache_id
+					table_idx  //message_tracker_idx
+				);
 			}
 
-			scatter(partitions,
-				this->output_.get_cache(cache_id).get(),
-				"", //message_id_prefix
-				cache_id, //cache_id
-				table_idx  //message_tracker_idx
-			);
+			if (counts_filter_build_bytes) {
+				std::lock_guard<std::mutex> lock(runtime_filter_mutex);
+				this->runtime_filter_build_bytes += input_bytes;
+			}
+			if (table_idx == RIGHT_TABLE_IDX) {
+				this->num_right_partition_tasks_done++;
+			}
 		} else { // not an option! error
 			if (logger) {
 				logger->error("{query_id}|{step}|{substep}|{info}|{duration}||||",
@@ -3,6 +3,7 @@
 #include <tuple>
 #include "BatchProcessing.h"
 #include "taskflow/distributing_kernel.h"
+#include "operators/RuntimeJoinFilter.h"
 
 namespace ral {
 namespace batch {
@@ -34,6 +35,16 @@ void parseJoinConditionToColumnIndices(const std::string & condition, std::vecto
 
 void split_inequality_join_into_join_and_filter(const std::string & join_statement, std::string & new_join_statement, std::string & filter_statement);
 
+/* Registers a runtime join filter on the kernels that produce the given input port of a join.
+The filter goes down through Filter kernels, which keep the columns of their input, and through
+Projection kernels whose key columns are plain input columns, until it reaches a TableScan or
+BindableTableScan */
+void publish_runtime_join_filter(std::shared_ptr<ral::cache::graph> query_graph, std::int32_t join_kernel_id, const std::string & port_name,
+	std::shared_ptr<ral::operators::runtime_join_filter> filter, const std::vector<cudf::size_type> & key_indices);
+
+/* Returns the max size of the build side of an inner join for which a runtime join filter is built, 0 when they are disabled */
+std::size_t get_runtime_join_filter_max_build_bytes(Context * context);
+
 class PartwiseJoin : public kernel {
 public:
 	PartwiseJoin(std::size_t kernel_id, const std::string & queryString, std::shared_ptr<Context> context, std::shared_ptr<ral::cache::graph> query_graph);
@@ -56,6 +67,34 @@ private:
 	std::unique_ptr<ral::cache::CacheData> load_left_set();
 	std::unique_ptr<ral::cache::CacheData> load_right_set();
 
+	// Returns true if there is a right set left to load, from the buffered build side or the right input
+	bool has_next_right_set();
+
+	// Consumes the right side up to the runtime join filter budget and schedules a task per consumed set that adds its keys
+	// to a filter, the last one publishes it to the left side. The consumed sets are buffered and served first by load_right_set
+	void build_runtime_join_filter(std::unique_ptr<ral::cache::CacheData> first_right_set);
+
+	// do_process for the "runtime_join_filter" tasks, adds the keys of a right set to the filter and buffers the set
+	ral::execution::task_result process_runtime_join_filter_set(std::vector<std::unique_ptr<ral::frame::BlazingTable>> inputs,
+		std::shared_ptr<ral::cache::CacheMachine> output);
+
+	// Returns true when both sides are estimated to be bigger than a bucket, then joining every left set against every
+	// right set is quadratic and the partitioned join is used instead
+	bool use_partitioned_join(const ral::cache::CacheData & left_cache_data, const ral::cache::CacheData & right_cache_data);
+
+	// Partitioned (grace) join: hash partitions both inputs into spillable buckets and joins every left bucket only with the
+	// right bucket of the same hash. Buckets that are still bigger than NUM_BYTES_PER_JOIN_BUCKET are partitioned again
+	void run_partitioned_join(std::unique_ptr<ral::cache::CacheData> left_cache_data, std::unique_ptr<ral::cache::CacheData> right_cache_data);
+
+	// Creates a set of bucket caches and returns its index, used as the "bucket_set" argument of the partition tasks
+	int make_bucket_set(int num_buckets, const std::string & name);
+
+	void add_partition_task(std::unique_ptr<ral::cache::CacheData> cache_data, const std::string & side, int bucket_set);
+
+	// do_process for the "partition" and "join_bucket" tasks of the partitioned join
+	ral::execution::task_result process_partitioned_join(std::vector<std::unique_ptr<ral::frame::BlazingTable>> inputs,
+		const std::string & operation_type, const std::map<std::string, std::string>& args);
+
 	void mark_set_completed(int left_ind, int right_ind);
 
 	// This function checks to see if there is a set from our current completion_matix (data we have already loaded once)
@@ -78,6 +117,18 @@ private:
 	std::vector<std::vector<bool>> completion_matrix;
 	std::shared_ptr<ral::cache::CacheMachine> leftArrayCache;
 	std::shared_ptr<ral::cache::CacheMachine> rightArrayCache;
+	std::shared_ptr<ral::cache::CacheMachine> rightBufferCache; // right sets consumed while building the runtime join filter
+	int num_buffered_right_sets = 0;
+	std::shared_ptr<ral::operators::runtime_join_filter> runtime_filter; // null when no runtime join filter is built
+	std::mutex runtime_filter_mutex;
+	std::atomic<int> num_pending_runtime_filter_sets{0};
+
+	// partitioned join related parameters
+	std::size_t bucket_byte_size;
+	std::vector<std::vector<std::shared_ptr<ral::cache::CacheMachine>>> bucket_sets;
+	std::mutex bucket_sets_mutex;
+	std::vector<cudf::data_type> left_types, right_types; // schemas after the join columns are normalized
+	std::vector<std::string> left_names, right_names;
 
 	// parsed expression related parameters
 	std::string join_type;
@@ -122,9 +173,34 @@ private:
 		std::shared_ptr<ral::cache::CacheMachine> small_input,
 		std::shared_ptr<ral::cache::CacheMachine> big_input);
 
+	// Samples the join keys of the first batch of one side, sends the samples and the estimated rows of the side to all
+	// the other nodes and returns the samples and the estimated rows of all the nodes. The batch is decached and replaced
+	std::pair<std::unique_ptr<ral::frame::BlazingTable>, uint64_t> exchange_join_key_samples(
+		std::unique_ptr<ral::cache::CacheData> & cache_data, bool left_side);
+
+	// Samples the join keys of the first batches of every node and finds the keys that are frequent enough to overload
+	// the node they hash to. The side where they cover more rows is split across the nodes, the other side is copied
+	void detect_heavy_hitters(std::unique_ptr<ral::cache::CacheData> & left_cache_data,
+		std::unique_ptr<ral::cache::CacheData> & right_cache_data);
+
+	// Merges the runtime join filter built with the local right side with the ones of all the other nodes and
+	// publishes the result to the left side. The filter is dropped if any node went over the build budget
+	void exchange_runtime_join_filter();
+
 private:
 	std::pair<bool, bool> scatter_left_right = {false, false};
 
+	std::shared_ptr<ral::operators::runtime_join_filter> runtime_filter; // null when no runtime join filter is built
+	bool runtime_filter_ready = false; // true once the filter of all the nodes is merged, then it is applied to the left side
+	std::size_t runtime_filter_build_bytes = 0;
+	std::size_t runtime_filter_max_build_bytes = 0;
+	std::mutex runtime_filter_mutex;
+	std::atomic<std::size_t> num_right_partition_tasks_done{0}; // the filter is exchanged once all the right batches are partitioned
+
+	std::unique_ptr<ral::frame::BlazingTable> heavy_hitters; // keys split across the nodes instead of hash partitioned, null when there are none
+	bool split_left_heavy_hitters = true; // the rows with a heavy hitter key are split on the left side and copied on the right one, or the opposite
+	std::atomic<int> heavy_hitters_split_offset{0};
+
 	// parsed expression related parameters
 	std::string join_type;
 	std::string condition;
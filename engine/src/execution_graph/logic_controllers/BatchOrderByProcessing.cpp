@@ -1,6 +1,7 @@
 #include "BatchOrderByProcessing.h"
 #include "CodeTimer.h"
 #include <src/utilities/CommonOperations.h>
+#include <cudf/copying.hpp>
 #include "taskflow/executor.h"
 #include "parser/expression_utils.hpp"
 
@@ -469,20 +470,27 @@ MergeStreamKernel::MergeStreamKernel(std::size_t kernel_id, const std::string &
 
 ral::execution::task_result MergeStreamKernel::do_process(std::vector< std::unique_ptr<ral::frame::BlazingTable> > inputs,
     std::shared_ptr<ral::cache::CacheMachine> output,
-    cudaStream_t /*stream*/, const std::map<std::string, std::string>& /*args*/) {
+    cudaStream_t /*stream*/, const std::map<std::string, std::string>& args) {
 
     try{
+        // merges of the windows of a streamed partition are put back in order by merge_partition_streaming
+        std::string message_id;
+        auto it = args.find("operation_type");
+        if (it != args.end() && it->second == "merge_window") {
+            message_id = "window_" + args.at("window_id");
+        }
+
         if (inputs.empty()) {
             // no op
         } else if(inputs.size() == 1) {
-            output->addToCache(std::move(inputs[0]));
+            output->addToCache(std::move(inputs[0]), message_id);
         } else {
             std::vector< ral::frame::BlazingTableView > tableViewsToConcat;
             for (std::size_t i = 0; i < inputs.size(); i++){
                 tableViewsToConcat.emplace_back(inputs[i]->toBlazingTableView());
             }
             auto output_merge = ral::operators::merge(tableViewsToConcat, this->expression);
-            output->addToCache(std::move(output_merge));
+            output->addToCache(std::move(output_merge), message_id);
         }
     }catch(const rmm::bad_alloc& e){
         return {ral::execution::task_status::RETRY, std::string(e.what()), std::move(inputs)};
@@ -492,9 +500,164 @@ ral::execution::task_result MergeStreamKernel::do_process(std::vector< std::uniq
     return {ral::execution::task_status::SUCCESS, std::string(), std::vector< std::unique_ptr<ral::frame::BlazingTable> > ()};
 }
 
+void MergeStreamKernel::merge_partition_streaming(std::vector<std::unique_ptr<ral::cache::CacheData>> runs, std::size_t window_bytes) {
+    const cudf::size_type MIN_WINDOW_ROWS = 1024;
+
+    std::size_t total_rows = 0;
+    std::size_t total_bytes = 0;
+    for (auto & run : runs) {
+        total_rows += run->num_rows();
+        total_bytes += run->sizeInBytes();
+    }
+    if (total_rows == 0) {
+        return;
+    }
+
+    std::size_t bytes_per_row = std::max<std::size_t>(1, total_bytes / total_rows);
+    cudf::size_type window_rows = std::max<cudf::size_type>(MIN_WINDOW_ROWS, window_bytes / (runs.size() * bytes_per_row));
+
+    // Every run is cut in chunks of window_rows, the cache decides whether each chunk stays in GPU or is moved to host or disk
+    auto runs_cache = std::make_shared<ral::cache::CacheMachine>(context, "merge_stream_runs_" + std::to_string(this->get_id()), false);
+    auto chunk_id = [](std::size_t run_idx, int chunk_idx) {
+        return "run_" + std::to_string(run_idx) + "_" + std::to_string(chunk_idx);
+    };
+
+    struct run_window {
+        std::size_t run_idx;
+        int num_chunks;
+        int next_chunk;
+        std::unique_ptr<ral::frame::BlazingTable> table;
+        cudf::size_type offset;
+    };
+    std::vector<run_window> windows;
+    std::vector<std::string> names;
+
+    for (std::size_t run_idx = 0; run_idx < runs.size(); run_idx++) {
+        int num_chunks = 0;
+        if (runs[run_idx]->num_rows() > static_cast<std::size_t>(window_rows)) {
+            std::unique_ptr<ral::frame::BlazingTable> table = runs[run_idx]->decache();
+            runs[run_idx] = nullptr;
+            for (cudf::size_type start = 0; start < table->num_rows(); start += window_rows) {
+                cudf::size_type end = std::min(start + window_rows, table->num_rows());
+                cudf::table_view chunk = cudf::slice(table->view(), {start, end})[0];
+                runs_cache->addToCache(std::make_unique<ral::frame::BlazingTable>(chunk, table->names()), chunk_id(run_idx, num_chunks), true);
+                num_chunks++;
+            }
+        } else if (runs[run_idx]->num_rows() > 0) {
+            runs_cache->addCacheData(std::move(runs[run_idx]), chunk_id(run_idx, num_chunks), true);
+            num_chunks++;
+        }
+
+        if (num_chunks > 0) {
+            windows.push_back({run_idx, num_chunks, 0, nullptr, 0});
+        }
+    }
+
+    auto load_next_chunk = [&](run_window & window) {
+        window.table = runs_cache->pullCacheData(chunk_id(window.run_idx, window.next_chunk))->decache();
+        window.next_chunk++;
+        window.offset = 0;
+        if (names.empty()) {
+            names = window.table->names();
+        }
+    };
+    for (auto & window : windows) {
+        load_next_chunk(window);
+    }
+
+    // Every merge of a window is a task, the tasks can finish in any order so they are collected by window id
+    auto merged_cache = std::make_shared<ral::cache::CacheMachine>(context, "merge_stream_windows_" + std::to_string(this->get_id()), false);
+    int num_windows = 0;
+    auto submit = [&](std::vector<std::unique_ptr<ral::cache::CacheData>> inputs) {
+        if (inputs.empty()) {
+            return;
+        }
+        ral::execution::executor::get_instance()->add_task(
+                std::move(inputs),
+                merged_cache,
+                this,
+                {{"operation_type", "merge_window"}, {"window_id", std::to_string(num_windows)}});
+        num_windows++;
+    };
+
+    // A merged window is final once its task is done, it goes to the output as soon as all the windows before it are there
+    int next_window_to_output = 0;
+    auto output_merged_windows = [&](bool all_merged) {
+        for (; next_window_to_output < num_windows; next_window_to_output++) {
+            std::string message_id = "window_" + std::to_string(next_window_to_output);
+            if (!all_merged && !merged_cache->has_messages_now({message_id})) {
+                break;
+            }
+            std::unique_ptr<ral::cache::CacheData> merged = merged_cache->pullCacheData(message_id);
+            if (merged != nullptr && merged->num_rows() > 0) {
+                this->add_to_output_cache(std::move(merged));
+            }
+        }
+    };
+
+    while (!windows.empty()) {
+        std::vector<ral::frame::BlazingTableView> heads;
+        for (auto & window : windows) {
+            cudf::table_view head = cudf::slice(window.table->view(), {window.offset, window.table->num_rows()})[0];
+            heads.emplace_back(head, names);
+        }
+
+        if (windows.size() == 1) {
+            // Nothing left to merge with, the rest of the run goes to the output as it is
+            run_window & window = windows[0];
+            std::vector<std::unique_ptr<ral::cache::CacheData>> inputs;
+            inputs.push_back(std::make_unique<ral::cache::GPUCacheData>(heads[0].clone()));
+            submit(std::move(inputs));
+            for (; window.next_chunk < window.num_chunks; window.next_chunk++) {
+                std::vector<std::unique_ptr<ral::cache::CacheData>> chunk_inputs;
+                chunk_inputs.push_back(runs_cache->pullCacheData(chunk_id(window.run_idx, window.next_chunk)));
+                submit(std::move(chunk_inputs));
+            }
+            break;
+        }
+
+        // Everything up to the smallest tail of the windows can be merged without reading more chunks
+        std::vector<cudf::size_type> splits = ral::operators::get_merge_frontier_splits(heads, this->expression);
+        std::vector<std::unique_ptr<ral::cache::CacheData>> prefixes;
+        for (std::size_t i = 0; i < heads.size(); i++) {
+            if (splits[i] > 0) {
+                cudf::table_view prefix = cudf::slice(heads[i].view(), {0, splits[i]})[0];
+                prefixes.push_back(std::make_unique<ral::cache::GPUCacheData>(std::make_unique<ral::frame::BlazingTable>(prefix, names)));
+            }
+            windows[i].offset += splits[i];
+        }
+        submit(std::move(prefixes));
+        output_merged_windows(false);
+
+        std::vector<run_window> live_windows;
+        for (auto & window : windows) {
+            if (window.offset == window.table->num_rows()) {
+                if (window.next_chunk == window.num_chunks) {
+                    continue;
+                }
+                load_next_chunk(window);
+            }
+            live_windows.push_back(std::move(window));
+        }
+        windows = std::move(live_windows);
+    }
+
+    this->wait_for_tasks();
+
+    merged_cache->finish();
+    output_merged_windows(true);
+}
+
 kstatus MergeStreamKernel::run() {
     CodeTimer timer;
 
+    std::size_t max_merge_stream_byte_size = 400000000;
+    std::map<std::string, std::string> config_options = context->getConfigOptions();
+    auto it = config_options.find("MAX_MERGE_STREAM_BYTE_SIZE");
+    if (it != config_options.end()){
+        max_merge_stream_byte_size = std::stoull(config_options["MAX_MERGE_STREAM_BYTE_SIZE"]);
+    }
+
     int batch_count = 0;
     for (std::size_t idx = 0; idx < this->input_.count(); idx++)
     {
@@ -511,10 +674,22 @@ kstatus MergeStreamKernel::run() {
                 }
             }
 
-            ral::execution::executor::get_instance()->add_task(
-                    std::move(inputs),
-                    this->output_cache(),
-                    this);
+            std::size_t partition_bytes = 0;
+            for (auto & input : inputs) {
+                partition_bytes += input->sizeInBytes();
+            }
+
+            if (inputs.size() > 1 && partition_bytes > max_merge_stream_byte_size) {
+                // The partitions before this one must be in the output first
+                this->wait_for_tasks();
+
+                merge_partition_streaming(std::move(inputs), max_merge_stream_byte_size);
+            } else {
+                ral::execution::executor::get_instance()->add_task(
+                        std::move(inputs),
+                        this->output_cache(),
+                        this);
+            }
 
             batch_count++;
         } catch(const std::exception& e) {
@@ -725,5 +900,180 @@ kstatus LimitKernel::run() {
 
 // END LimitKernel
 
+// BEGIN TopNKernel
+
+TopNKernel::TopNKernel(std::size_t kernel_id, const std::string & queryString,
+    std::shared_ptr<Context> context,
+    std::shared_ptr<ral::cache::graph> query_graph)
+    : distributing_kernel{kernel_id,queryString, context, kernel_type::TopNKernel}  {
+    this->query_graph = query_graph;
+    set_number_of_message_trackers(1); //default
+    std::tie(std::ignore, std::ignore, limit_rows) = ral::operators::get_sort_vars(this->expression);
+}
+
+ral::execution::task_result TopNKernel::do_process(std::vector< std::unique_ptr<ral::frame::BlazingTable> > inputs,
+    std::shared_ptr<ral::cache::CacheMachine> output,
+    cudaStream_t /*stream*/, const std::map<std::string, std::string>& args) {
+
+    try{
+        auto& operation_type = args.at("operation_type");
+
+        if (operation_type == "top_n") {
+            auto & input = inputs[0];
+
+            std::unique_ptr<ral::frame::BlazingTable> threshold;
+            {
+                std::lock_guard<std::mutex> top_n_lock(top_n_mutex);
+                if (top_n_table != nullptr && top_n_table->num_rows() == limit_rows && limit_rows > 0) {
+                    cudf::table_view last_row = cudf::slice(top_n_table->view(), {limit_rows - 1, limit_rows})[0];
+                    threshold = std::make_unique<ral::frame::BlazingTable>(last_row, top_n_table->names());
+                }
+            }
+
+            auto batch_top_n = ral::operators::get_top_n(input->toBlazingTableView(),
+                threshold != nullptr ? threshold->toBlazingTableView() : ral::frame::BlazingTableView(),
+                this->expression, limit_rows);
+
+            std::lock_guard<std::mutex> top_n_lock(top_n_mutex);
+            if (top_n_table == nullptr) {
+                top_n_table = std::move(batch_top_n);
+            } else if (batch_top_n->num_rows() > 0) {
+                top_n_table = ral::operators::merge_top_n({top_n_table->toBlazingTableView(), batch_top_n->toBlazingTableView()},
+                    this->expression, limit_rows);
+            }
+        } else if (operation_type == "merge_top_n") {
+            std::vector<ral::frame::BlazingTableView> tables_to_merge;
+            for (auto & input : inputs) {
+                tables_to_merge.push_back(input->toBlazingTableView());
+            }
+            output->addToCache(ral::operators::merge_top_n(tables_to_merge, this->expression, limit_rows));
+        }
+    }catch(const rmm::bad_alloc& e){
+        return {ral::execution::task_status::RETRY, std::string(e.what()), std::move(inputs)};
+    }catch(const std::exception& e){
+        return {ral::execution::task_status::FAIL, std::string(e.what()), std::vector< std::unique_ptr<ral::frame::BlazingTable> > ()};
+    }
+    return {ral::execution::task_status::SUCCESS, std::string(), std::vector< std::unique_ptr<ral::frame::BlazingTable> > ()};
+}
+
+std::unique_ptr<ral::frame::BlazingTable> TopNKernel::make_empty_output() const {
+    return ral::utilities::create_empty_table(input_names, input_types);
+}
+
+kstatus TopNKernel::run() {
+    CodeTimer timer;
+
+    while(this->input_cache()->wait_for_next()){
+        std::unique_ptr <ral::cache::CacheData> cache_data = this->input_cache()->pullCacheData();
+        if(cache_data != nullptr){
+            if (input_names.empty()) {
+                input_names = cache_data->names();
+                input_types = cache_data->get_schema();
+            }
+
+            std::vector<std::unique_ptr <ral::cache::CacheData> > inputs;
+            inputs.push_back(std::move(cache_data));
+
+            ral::execution::executor::get_instance()->add_task(
+                    std::move(inputs),
+                    this->output_cache(),
+                    this,
+                    {{"operation_type", "top_n"}});
+        }
+    }
+
+    if(logger) {
+        logger->debug("{query_id}|{step}|{substep}|{info}|{duration}|kernel_id|{kernel_id}||",
+                                "query_id"_a=context->getContextToken(),
+                                "step"_a=context->getQueryStep(),
+                                "substep"_a=context->getQuerySubstep(),
+                                "info"_a="TopN Kernel tasks created",
+                                "duration"_a=timer.elapsed_time(),
+                                "kernel_id"_a=this->get_id());
+    }
+
+    std::unique_lock<std::mutex> lock(kernel_mutex);
+    kernel_cv.wait(lock,[this]{
+        return this->tasks.empty() || ral::execution::executor::get_instance()->has_exception();
+    });
+    lock.unlock();
+
+    if(auto ep = ral::execution::executor::get_instance()->last_exception()){
+        std::rethrow_exception(ep);
+    }
+
+    if(this->context->getTotalNodes() > 1) {
+        this->context->incrementQuerySubstep();
+
+        if(context->isMasterNode(ral::communication::CommunicationData::getInstance().getSelfNode())) {
+            std::vector<std::unique_ptr <ral::cache::CacheData> > inputs;
+            if (top_n_table != nullptr) {
+                inputs.push_back(std::make_unique<ral::cache::GPUCacheData>(std::move(top_n_table)));
+            }
+
+            auto nodes = context->getAllNodes();
+            for(std::size_t i = 0; i < nodes.size(); ++i) {
+                if(!(nodes[i] == ral::communication::CommunicationData::getInstance().getSelfNode())) {
+                    std::string message_id = std::to_string(this->context->getContextToken()) + "_" + std::to_string(this->get_id()) + "_" + nodes[i].id();
+                    auto top_n_cache_data = this->query_graph->get_input_message_cache()->pullCacheData(message_id);
+                    // nodes without input send an empty table without columns
+                    if (top_n_cache_data->num_columns() > 0) {
+                        inputs.push_back(std::move(top_n_cache_data));
+                    }
+                }
+            }
+
+            if (!inputs.empty()) {
+                ral::execution::executor::get_instance()->add_task(
+                        std::move(inputs),
+                        this->output_cache(),
+                        this,
+                        {{"operation_type", "merge_top_n"}});
+            } else {
+                this->add_to_output_cache(make_empty_output());
+            }
+        } else {
+            send_message(std::move(top_n_table),
+                false, //specific_cache
+                "", //cache_id
+                {this->context->getMasterNode().id()}, //target_id
+                "", //message_id_prefix
+                true, //always_add
+                false, //wait_for
+                0); //message_tracker_idx
+
+            // the master outputs the top n rows of all the nodes
+            this->add_to_output_cache(make_empty_output());
+        }
+    } else if (top_n_table != nullptr) {
+        this->add_to_output_cache(std::move(top_n_table));
+    } else {
+        this->add_to_output_cache(make_empty_output());
+    }
+
+    lock.lock();
+    kernel_cv.wait(lock,[this]{
+        return this->tasks.empty() || ral::execution::executor::get_instance()->has_exception();
+    });
+
+    if(auto ep = ral::execution::executor::get_instance()->last_exception()){
+        std::rethrow_exception(ep);
+    }
+
+    if(logger) {
+        logger->debug("{query_id}|{step}|{substep}|{info}|{duration}|kernel_id|{kernel_id}||",
+                                    "query_id"_a=context->getContextToken(),
+                                    "step"_a=context->getQueryStep(),
+                                    "substep"_a=context->getQuerySubstep(),
+                                    "info"_a="TopN Kernel Completed",
+                                    "duration"_a=timer.elapsed_time(),
+                                    "kernel_id"_a=this->get_id());
+    }
+
+    return kstatus::proceed;
+}
+
+// END TopNKernel
+
 } // namespace batch
 } // namespace ral
@@ -92,6 +92,8 @@ private:
 /**
  * This kernel has a loop over all its different input caches.
  * It then pulls all the inputs from one cache and merges them.
+ * Partitions larger than MAX_MERGE_STREAM_BYTE_SIZE are merged as a stream,
+ * only a window of every sorted batch is held in GPU memory at a time.
  */
 class MergeStreamKernel : public kernel {
 public:
@@ -106,6 +108,15 @@ public:
 		cudaStream_t stream, const std::map<std::string, std::string>& args) override;
 
 	kstatus run() override;
+
+private:
+	/**
+	 * Merges the sorted batches of one partition keeping at most window_bytes of them in GPU memory.
+	 * Batches are cut in chunks that wait in a cache, where they can be spilled, until their window is consumed.
+	 * The merge of every window runs as a task, a merged window is added to the output cache as soon as
+	 * it and all the windows before it are done.
+	 */
+	void merge_partition_streaming(std::vector<std::unique_ptr<ral::cache::CacheData>> runs, std::size_t window_bytes);
 };
 
 
@@ -131,5 +142,38 @@ private:
 	std::atomic<int64_t> rows_limit;
 };
 
+/**
+ * @brief This kernel computes an ORDER BY with a small LIMIT without sorting the whole input.
+ * Every batch is reduced to its first N rows and merged into a running top N of the node. Once the running top N
+ * is full its last row is a threshold, rows of the next batches that do not sort before it are dropped before sorting.
+ * In distributed mode every node sends its top N to the master node, which merges them into the result.
+ */
+class TopNKernel : public distributing_kernel {
+public:
+	TopNKernel(std::size_t kernel_id, const std::string & queryString,
+		std::shared_ptr<Context> context,
+		std::shared_ptr<ral::cache::graph> query_graph);
+
+	std::string kernel_name() { return "TopN";}
+
+	ral::execution::task_result do_process(std::vector< std::unique_ptr<ral::frame::BlazingTable> > inputs,
+		std::shared_ptr<ral::cache::CacheMachine> output,
+		cudaStream_t stream, const std::map<std::string, std::string>& args) override;
+
+	kstatus run() override;
+
+private:
+	/**
+	 * Returns an empty table with the schema of the inputs, for the nodes that have no top n rows to output.
+	 */
+	std::unique_ptr<ral::frame::BlazingTable> make_empty_output() const;
+
+	cudf::size_type limit_rows;
+	std::mutex top_n_mutex;
+	std::unique_ptr<ral::frame::BlazingTable> top_n_table;
+	std::vector<std::string> input_names;
+	std::vector<cudf::data_type> input_types;
+};
+
 } // namespace batch
 } // namespace ral
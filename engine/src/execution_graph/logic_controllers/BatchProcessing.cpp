@@ -2,13 +2,15 @@
 #include "CodeTimer.h"
 #include "communication/CommunicationData.h"
 #include "ExceptionHandling/BlazingThread.h"
-#include "io/data_parser/CSVParser.h"
+#include "io/MetadataCatalog.h"
+#include "io/ScanPlanner.h"
 #include "parser/expression_utils.hpp"
 #include "taskflow/executor.h"
 #include <cudf/types.hpp>
 #include <src/utilities/DebuggingUtils.h>
 #include <src/execution_graph/logic_controllers/LogicalFilter.h>
 #include "execution_graph/logic_controllers/LogicalProject.h"
+#include "utilities/CommonOperations.h"
 
 namespace ral {
 namespace batch {
@@ -69,6 +71,225 @@ bool BatchSequenceBypass::has_next_now() {
 
 // END BatchSequenceBypass
 
+// BEGIN scan tasks
+
+namespace {
+
+const int64_t DEFAULT_NUM_BYTES_PER_SCAN_TASK = 400000000;
+
+int64_t get_num_bytes_per_scan_task(std::shared_ptr<Context> context, std::shared_ptr<ral::io::data_parser> parser) {
+    if (parser->type() != ral::io::DataType::PARQUET && parser->type() != ral::io::DataType::ORC && parser->type() != ral::io::DataType::ARROW) {
+        return 0;
+    }
+    std::map<std::string, std::string> config_options = context->getConfigOptions();
+    auto it = config_options.find("NUM_BYTES_PER_SCAN_TASK");
+    if (it != config_options.end()){
+        return std::stoll(config_options["NUM_BYTES_PER_SCAN_TASK"]);
+    }
+    return DEFAULT_NUM_BYTES_PER_SCAN_TASK;
+}
+
+const std::size_t DEFAULT_MAX_LIMIT_SCAN_TASKS_IN_FLIGHT = 4;
+
+// Scans with a pushed down limit keep up to this many tasks loading at a time, so no more is loaded than needed
+std::size_t get_max_limit_scan_tasks_in_flight(std::shared_ptr<Context> context) {
+    std::map<std::string, std::string> config_options = context->getConfigOptions();
+    auto it = config_options.find("MAX_LIMIT_SCAN_TASKS_IN_FLIGHT");
+    if (it != config_options.end()){
+        return std::max<std::size_t>(std::stoul(config_options["MAX_LIMIT_SCAN_TASKS_IN_FLIGHT"]), 1);
+    }
+    return DEFAULT_MAX_LIMIT_SCAN_TASKS_IN_FLIGHT;
+}
+
+const cudf::size_type DEFAULT_INTERPRETER_CPU_MAX_ROWS = 2048;
+
+// Batches of up to this many rows evaluate their expressions with the CPU interpreter
+cudf::size_type get_interpreter_cpu_max_rows(std::shared_ptr<Context> context) {
+    std::map<std::string, std::string> config_options = context->getConfigOptions();
+    auto it = config_options.find("INTERPRETER_CPU_MAX_ROWS");
+    if (it != config_options.end()){
+        return std::stoi(config_options["INTERPRETER_CPU_MAX_ROWS"]);
+    }
+    return DEFAULT_INTERPRETER_CPU_MAX_ROWS;
+}
+
+/**
+ * @brief Plans the tasks of a scan from the row groups (or stripes) of all the files,
+ * so every task loads about num_bytes_per_task bytes no matter how the files were written.
+ *
+ * @param max_rows When not negative, row groups past the first max_rows rows are not planned.
+ * @param split_row_groups Makes every row group a separate input of its task.
+ * @return The inputs of every task.
+ */
+std::vector<std::vector<std::unique_ptr<ral::cache::CacheData> > > plan_scan_inputs_by_row_groups(
+    std::shared_ptr<ral::io::data_provider> provider,
+    std::shared_ptr<ral::io::data_parser> parser,
+    const ral::io::Schema & schema,
+    const std::vector<int> & projections,
+    int64_t num_bytes_per_task,
+    int64_t max_rows,
+    bool split_row_groups,
+    size_t & file_index) {
+
+    std::vector<int> projections_in_file;
+    for (auto projection_idx : projections){
+        if(schema.get_in_file()[projection_idx]) {
+            projections_in_file.push_back(projection_idx);
+        }
+    }
+
+    std::vector<ral::io::data_handle> handles;
+    std::vector<std::vector<ral::io::row_group_info>> files_row_groups;
+    std::vector<std::vector<int>> selected_row_groups;
+    while(provider->has_next()) {
+        auto handle = provider->get_next(true);
+        std::vector<ral::io::row_group_info> row_groups;
+        if (handle.file_handle != nullptr) {
+            auto row_group_stats = ral::io::metadata_catalog::get_instance()->get_row_group_stats(*parser, handle);
+            row_groups = ral::io::get_row_group_info(row_group_stats, schema, projections_in_file);
+        }
+        handles.push_back(handle);
+        files_row_groups.push_back(std::move(row_groups));
+        selected_row_groups.push_back(schema.get_rowgroup_ids(file_index));
+        file_index++;
+    }
+
+    std::vector<std::vector<std::unique_ptr<ral::cache::CacheData> > > tasks_inputs;
+    for (auto & scan_task : ral::io::plan_scan_tasks(files_row_groups, selected_row_groups, num_bytes_per_task, max_rows)) {
+        std::vector<std::unique_ptr<ral::cache::CacheData> > inputs;
+        for (auto & piece : scan_task.pieces) {
+            size_t estimated_bytes = piece.num_rows > 0 ? piece.num_bytes : 0;
+            if (split_row_groups && piece.row_group_ids.size() > 1) {
+                for (int row_group_id : piece.row_group_ids) {
+                    inputs.push_back(std::make_unique<ral::cache::CacheDataIO>(handles[piece.file_index], parser, schema,
+                        schema.fileSchema(piece.file_index), std::vector<int>{row_group_id}, projections, estimated_bytes / piece.row_group_ids.size()));
+                }
+            } else {
+                inputs.push_back(std::make_unique<ral::cache::CacheDataIO>(handles[piece.file_index], parser, schema,
+                    schema.fileSchema(piece.file_index), piece.row_group_ids, projections, estimated_bytes));
+            }
+        }
+        tasks_inputs.push_back(std::move(inputs));
+    }
+    return tasks_inputs;
+}
+
+/**
+ * @brief Plans a task for every chunk of the text (CSV, JSON lines) files, the chunks are
+ * split on record boundaries so every task reads its own byte range and nothing else.
+ *
+ * @return The inputs of every task, empty if the files can not be split into chunks.
+ */
+std::vector<std::vector<std::unique_ptr<ral::cache::CacheData> > > plan_scan_inputs_by_chunks(
+    std::shared_ptr<ral::io::data_provider> provider,
+    std::shared_ptr<ral::io::data_parser> parser,
+    const ral::io::Schema & schema,
+    const std::vector<int> & projections,
+    size_t & file_index) {
+
+    std::vector<std::vector<std::unique_ptr<ral::cache::CacheData> > > tasks_inputs;
+    if (!parser->can_plan_chunks()) {
+        return tasks_inputs;
+    }
+
+    std::vector<ral::io::data_handle> handles;
+    while(provider->has_next()) {
+        handles.push_back(provider->get_next(true));
+    }
+    std::vector<size_t> num_chunks = parser->plan_chunks(handles);
+
+    for (size_t i = 0; i < handles.size(); i++, file_index++) {
+        std::vector<int> chunks = schema.get_rowgroup_ids(file_index);
+        if (chunks.empty()) {
+            chunks.resize(num_chunks[i]);
+            std::iota(chunks.begin(), chunks.end(), 0);
+        } else {
+            chunks.erase(std::remove_if(chunks.begin(), chunks.end(), [&](int chunk) { return chunk >= (int)num_chunks[i]; }), chunks.end());
+        }
+
+        // a file that could not be opened still gets a task, that returns an empty table
+        if (num_chunks[i] == 0) {
+            chunks.clear();
+            chunks.push_back(-1);
+        }
+        for (int chunk : chunks) {
+            std::vector<std::unique_ptr<ral::cache::CacheData> > inputs;
+            inputs.push_back(std::make_unique<ral::cache::CacheDataIO>(handles[i], parser, schema,
+                schema.fileSchema(file_index), chunk >= 0 ? std::vector<int>{chunk} : std::vector<int>{}, projections));
+            tasks_inputs.push_back(std::move(inputs));
+        }
+    }
+    return tasks_inputs;
+}
+
+/**
+ * @brief Plans a task for every host table the parser wraps its data in (in-memory Arrow tables),
+ * the tables are only copied to the device when the tasks load them.
+ *
+ * @return The inputs of every task, empty if the parser has no host tables.
+ */
+std::vector<std::vector<std::unique_ptr<ral::cache::CacheData> > > plan_scan_inputs_from_host_tables(
+    std::shared_ptr<ral::io::data_parser> parser,
+    const std::vector<int> & projections,
+    int64_t num_bytes_per_task,
+    size_t & file_index) {
+
+    std::vector<std::vector<std::unique_ptr<ral::cache::CacheData> > > tasks_inputs;
+    if (!parser->has_host_tables()) {
+        return tasks_inputs;
+    }
+
+    for (auto & host_table : parser->get_host_tables(projections, num_bytes_per_task)) {
+        std::vector<std::unique_ptr<ral::cache::CacheData> > inputs;
+        inputs.push_back(std::make_unique<ral::cache::CPUCacheData>(std::move(host_table)));
+        tasks_inputs.push_back(std::move(inputs));
+        file_index++;
+    }
+    return tasks_inputs;
+}
+
+bool is_late_materialization_enabled(std::shared_ptr<Context> context) {
+    std::map<std::string, std::string> config_options = context->getConfigOptions();
+    auto it = config_options.find("ENABLE_LATE_MATERIALIZATION");
+    if (it != config_options.end()){
+        return (config_options["ENABLE_LATE_MATERIALIZATION"] == "true" ||
+                config_options["ENABLE_LATE_MATERIALIZATION"] == "True" ||
+                config_options["ENABLE_LATE_MATERIALIZATION"] == "1" ||
+                config_options["ENABLE_LATE_MATERIALIZATION"] == "TRUE");
+    }
+    return true;
+}
+
+// Sum of the sizes estimated when the scan was planned, 0 if any of the inputs has no estimate
+std::size_t estimate_scan_output_bytes(const std::vector<std::unique_ptr<ral::cache::CacheData > > & inputs) {
+    std::size_t estimated_bytes = 0;
+    for (auto & input : inputs) {
+        auto io_input = dynamic_cast<ral::cache::CacheDataIO *>(input.get());
+        if (io_input == nullptr || io_input->estimatedSizeInBytes() == 0) {
+            return 0;
+        }
+        estimated_bytes += io_input->estimatedSizeInBytes();
+    }
+    return estimated_bytes;
+}
+
+// Loads of a scan task that holds several pieces are concatenated into a single batch
+void concat_scan_inputs(std::vector< std::unique_ptr<ral::frame::BlazingTable> > & inputs) {
+    if (inputs.size() > 1) {
+        std::vector<ral::frame::BlazingTableView> tables_to_concat;
+        for (auto & input : inputs) {
+            tables_to_concat.push_back(input->toBlazingTableView());
+        }
+        std::unique_ptr<ral::frame::BlazingTable> concatenated = ral::utilities::concatTables(tables_to_concat);
+        inputs.clear();
+        inputs.push_back(std::move(concatenated));
+    }
+}
+
+} // namespace
+
+// END scan tasks
+
 // BEGIN TableScan
 
 TableScan::TableScan(std::size_t kernel_id, const std::string & queryString, std::shared_ptr<ral::io::data_provider> provider, std::shared_ptr<ral::io::data_parser> parser, ral::io::Schema & schema, std::shared_ptr<Context> context, std::shared_ptr<ral::cache::graph> query_graph)
@@ -76,26 +297,6 @@ TableScan::TableScan(std::size_t kernel_id, const std::string & queryString, std
 {
     if(parser->type() == ral::io::DataType::CUDF || parser->type() == ral::io::DataType::DASK_CUDF){
         num_batches = std::max(provider->get_num_handles(), (size_t)1);
-    } else if (parser->type() == ral::io::DataType::CSV)	{
-        auto csv_parser = static_cast<ral::io::csv_parser*>(parser.get());
-        num_batches = 0;
-        size_t max_bytes_chunk_size = csv_parser->max_bytes_chunk_size();
-        if (max_bytes_chunk_size > 0) {
-            int file_idx = 0;
-            while (provider->has_next()) {
-                auto data_handle = provider->get_next();
-                int64_t file_size = data_handle.file_handle->GetSize().ValueOrDie();
-                size_t num_chunks = (file_size + max_bytes_chunk_size - 1) / max_bytes_chunk_size;
-                std::vector<int> file_row_groups(num_chunks);
-                std::iota(file_row_groups.begin(), file_row_groups.end(), 0);
-                schema.get_rowgroups()[file_idx] = std::move(file_row_groups);
-                num_batches += num_chunks;
-                file_idx++;
-            }
-            provider->reset();
-        } else {
-            num_batches = provider->get_num_handles();
-        }
     } else {
         num_batches = provider->get_num_handles();
     }
@@ -107,6 +308,8 @@ ral::execution::task_result TableScan::do_process(std::vector< std::unique_ptr<r
     std::shared_ptr<ral::cache::CacheMachine> output,
     cudaStream_t /*stream*/, const std::map<std::string, std::string>& /*args*/) {
     try{
+        concat_scan_inputs(inputs);
+        this->apply_runtime_join_filters(inputs[0]);
         output->addToCache(std::move(inputs[0]));
     }catch(const rmm::bad_alloc& e){
         //can still recover if the input was not a GPUCacheData 
@@ -124,11 +327,39 @@ kstatus TableScan::run() {
     std::iota(projections.begin(), projections.end(), 0);
 
     //if its empty we can just add it to the cache without scheduling
-    if (!provider->has_next()) {
+    if (!provider->has_next() && !parser->has_host_tables()) {
         this->add_to_output_cache(std::move(schema.makeEmptyBlazingTable(projections)));
     } else {
+        int64_t num_bytes_per_scan_task = get_num_bytes_per_scan_task(context, parser);
+        std::size_t max_tasks_in_flight = get_max_limit_scan_tasks_in_flight(context);
+        if (num_bytes_per_scan_task > 0 || parser->can_plan_chunks() || parser->has_host_tables()) {
+            auto tasks_inputs = parser->has_host_tables() ?
+                plan_scan_inputs_from_host_tables(parser, projections, num_bytes_per_scan_task, file_index) :
+                num_bytes_per_scan_task > 0 ?
+                plan_scan_inputs_by_row_groups(provider, parser, schema, projections, num_bytes_per_scan_task,
+                    this->has_limit_ ? this->limit_rows_ : -1, false, file_index) :
+                plan_scan_inputs_by_chunks(provider, parser, schema, projections, file_index);
+            if (!tasks_inputs.empty()) {
+                num_batches = tasks_inputs.size();
+            }
+            for (auto & inputs : tasks_inputs) {
+                if (this->has_reached_limit()) {
+                    break;
+                }
+                ral::execution::executor::get_instance()->add_task(
+                        std::move(inputs),
+                        this->output_cache(),
+                        this);
+                if (this->has_limit_) {
+                    this->wait_for_tasks(max_tasks_in_flight - 1);
+                }
+            }
+        }
 
         while(provider->has_next()) {
+            if (this->has_reached_limit()) {
+                break;
+            }
             //retrieve the file handle but do not open the file
             //this will allow us to prevent from having too many open file handles by being
             //able to limit the number of file tasks
@@ -147,9 +378,10 @@ kstatus TableScan::run() {
                     output_cache,
                     this);
 
-            /*if (this->has_limit_ && output_cache->get_num_rows_added() >= this->limit_rows_) {
-            //	break;
-            }*/
+            // with a limit only a few files are loaded at a time, so no more of them are loaded than needed
+            if (this->has_limit_) {
+                this->wait_for_tasks(max_tasks_in_flight - 1);
+            }
             file_index++;
         }
 
@@ -163,14 +395,7 @@ kstatus TableScan::run() {
                                         "kernel_id"_a=this->get_id());
         }
 
-        std::unique_lock<std::mutex> lock(kernel_mutex);
-        kernel_cv.wait(lock,[this]{
-            return this->tasks.empty() || ral::execution::executor::get_instance()->has_exception();
-        });
-
-        if(auto ep = ral::execution::executor::get_instance()->last_exception()){
-            std::rethrow_exception(ep);
-        }
+        this->wait_for_tasks();
     }
 
     if(logger) {
@@ -186,6 +411,11 @@ kstatus TableScan::run() {
     return kstatus::proceed;
 }
 
+std::size_t TableScan::estimate_output_bytes(const std::vector<std::unique_ptr<ral::cache::CacheData > > & inputs){
+    std::size_t estimated_bytes = estimate_scan_output_bytes(inputs);
+    return estimated_bytes > 0 ? estimated_bytes : kernel::estimate_output_bytes(inputs);
+}
+
 std::pair<bool, uint64_t> TableScan::get_estimated_output_num_rows(){
     double rows_so_far = (double)this->output_.total_rows_added();
     double batches_so_far = (double)this->output_.total_batches_added();
@@ -204,21 +434,29 @@ BindableTableScan::BindableTableScan(std::size_t kernel_id, const std::string &
 : kernel(kernel_id, queryString, context, kernel_type::BindableTableScanKernel), provider(provider), parser(parser), schema(schema) {
     this->query_graph = query_graph;
     this->filtered = is_filtered_bindable_scan(expression);
+    if(this->filtered) {
+        this->filter_programs = std::make_unique<ral::processor::expression_program_cache>(
+            std::vector<std::string>{ral::processor::get_filter_expression(expression)}, get_interpreter_cpu_max_rows(context));
+    }
 }
 
 ral::execution::task_result BindableTableScan::do_process(std::vector< std::unique_ptr<ral::frame::BlazingTable> > inputs,
     std::shared_ptr<ral::cache::CacheMachine> output,
     cudaStream_t /*stream*/, const std::map<std::string, std::string>& /*args*/) {
-    auto & input = inputs[0];
     std::unique_ptr<ral::frame::BlazingTable> filtered_input;
 
     try{
-        if(this->filtered) {
-            filtered_input = ral::processor::process_filter(input->toBlazingTableView(), expression, this->context.get());
+        concat_scan_inputs(inputs);
+        auto & input = inputs[0];
+        // with late materialization the rows were already filtered when loaded
+        if(this->filtered && !this->late_filter_programs) {
+            filtered_input = ral::processor::process_filter(input->toBlazingTableView(), *filter_programs);
             filtered_input->setNames(fix_column_aliases(filtered_input->names(), expression));
+            this->apply_runtime_join_filters(filtered_input);
             output->addToCache(std::move(filtered_input));
         } else {
             input->setNames(fix_column_aliases(input->names(), expression));
+            this->apply_runtime_join_filters(input);
             output->addToCache(std::move(input));
         }
     }catch(const rmm::bad_alloc& e){
@@ -240,14 +478,56 @@ kstatus BindableTableScan::run() {
         std::iota(projections.begin(), projections.end(), 0);
     }
 
+    if (this->filtered && parser->type() == ral::io::DataType::PARQUET && schema.all_in_file() && is_late_materialization_enabled(context)) {
+        std::string condition = ral::processor::get_filter_expression(expression);
+        std::vector<int> filter_positions = ral::processor::get_filter_column_indices(condition);
+        if (!filter_positions.empty() && filter_positions.size() < projections.size()) {
+            this->late_filter_positions = filter_positions;
+            this->late_filter_programs = std::make_shared<ral::processor::expression_program_cache>(
+                std::vector<std::string>{ral::processor::remap_filter_columns(condition, filter_positions)}, get_interpreter_cpu_max_rows(context));
+        }
+    }
+
     //if its empty we can just add it to the cache without scheduling
-    if (!provider->has_next()) {
+    if (!provider->has_next() && !parser->has_host_tables()) {
         auto empty = schema.makeEmptyBlazingTable(projections);
         empty->setNames(fix_column_aliases(empty->names(), expression));
         this->add_to_output_cache(std::move(empty));
     } else {
+        int64_t num_bytes_per_scan_task = get_num_bytes_per_scan_task(context, parser);
+        std::size_t max_tasks_in_flight = get_max_limit_scan_tasks_in_flight(context);
+        if (num_bytes_per_scan_task > 0 || parser->can_plan_chunks() || parser->has_host_tables()) {
+            // a filter drops rows, so the limit can not be used to plan fewer row groups
+            // with late materialization every row group is loaded on its own, so it can be skipped when no row passes the filter
+            auto tasks_inputs = parser->has_host_tables() ?
+                plan_scan_inputs_from_host_tables(parser, projections, num_bytes_per_scan_task, file_index) :
+                num_bytes_per_scan_task > 0 ?
+                plan_scan_inputs_by_row_groups(provider, parser, schema, projections, num_bytes_per_scan_task,
+                    this->has_limit_ && !this->filtered ? this->limit_rows_ : -1, this->late_filter_programs != nullptr, file_index) :
+                plan_scan_inputs_by_chunks(provider, parser, schema, projections, file_index);
+            for (auto & inputs : tasks_inputs) {
+                if (this->has_reached_limit()) {
+                    break;
+                }
+                if (this->late_filter_programs) {
+                    for (auto & input : inputs) {
+                        static_cast<ral::cache::CacheDataIO *>(input.get())->set_late_materialization_filter(this->late_filter_programs, this->late_filter_positions);
+                    }
+                }
+                ral::execution::executor::get_instance()->add_task(
+                        std::move(inputs),
+                        this->output_cache(),
+                        this);
+                if (this->has_limit_) {
+                    this->wait_for_tasks(max_tasks_in_flight - 1);
+                }
+            }
+        }
 
         while(provider->has_next()) {
+            if (this->has_reached_limit()) {
+                break;
+            }
             //retrieve the file handle but do not open the file
             //this will allow us to prevent from having too many open file handles by being
             //able to limit the number of file tasks
@@ -255,8 +535,10 @@ kstatus BindableTableScan::run() {
             auto file_schema = schema.fileSchema(file_index);
             auto row_group_ids = schema.get_rowgroup_ids(file_index);
             //this is the part where we make the task now
-            std::unique_ptr<ral::cache::CacheData> input =
-                std::make_unique<ral::cache::CacheDataIO>(handle,parser,schema,file_schema,row_group_ids,projections);
+            auto input = std::make_unique<ral::cache::CacheDataIO>(handle,parser,schema,file_schema,row_group_ids,projections);
+            if (this->late_filter_programs) {
+                input->set_late_materialization_filter(this->late_filter_programs, this->late_filter_positions);
+            }
             std::vector<std::unique_ptr<ral::cache::CacheData> > inputs;
             inputs.push_back(std::move(input));
 
@@ -267,10 +549,11 @@ kstatus BindableTableScan::run() {
                     output_cache,
                     this);
 
+            // with a limit only a few files are loaded at a time, so no more of them are loaded than needed
+            if (this->has_limit_) {
+                this->wait_for_tasks(max_tasks_in_flight - 1);
+            }
             file_index++;
-            /*if (this->has_limit_ && output_cache->get_num_rows_added() >= this->limit_rows_) {
-            //	break;
-            }*/
         }
 
         if(logger){
@@ -283,14 +566,7 @@ kstatus BindableTableScan::run() {
                                         "kernel_id"_a=this->get_id());
         }
 
-        std::unique_lock<std::mutex> lock(kernel_mutex);
-        kernel_cv.wait(lock,[this]{
-            return this->tasks.empty() || ral::execution::executor::get_instance()->has_exception();
-        });
-
-        if(auto ep = ral::execution::executor::get_instance()->last_exception()){
-            std::rethrow_exception(ep);
-        }
+        this->wait_for_tasks();
     }
 
     if(logger){
@@ -305,6 +581,11 @@ kstatus BindableTableScan::run() {
     return kstatus::proceed;
 }
 
+std::size_t BindableTableScan::estimate_output_bytes(const std::vector<std::unique_ptr<ral::cache::CacheData > > & inputs){
+    std::size_t estimated_bytes = estimate_scan_output_bytes(inputs);
+    return estimated_bytes > 0 ? estimated_bytes : kernel::estimate_output_bytes(inputs);
+}
+
 std::pair<bool, uint64_t> BindableTableScan::get_estimated_output_num_rows(){
     double rows_so_far = (double)this->output_.total_rows_added();
     double current_batch = (double)file_index;
@@ -323,6 +604,10 @@ Projection::Projection(std::size_t kernel_id, const std::string & queryString, s
 : kernel(kernel_id, queryString, context, kernel_type::ProjectKernel)
 {
     this->query_graph = query_graph;
+
+    std::vector<std::string> expressions;
+    std::tie(expressions, this->out_column_names) = ral::processor::get_project_expressions_and_names(this->expression);
+    this->programs = std::make_unique<ral::processor::expression_program_cache>(expressions, get_interpreter_cpu_max_rows(context));
 }
 
 ral::execution::task_result Projection::do_process(std::vector< std::unique_ptr<ral::frame::BlazingTable> > inputs,
@@ -331,7 +616,7 @@ ral::execution::task_result Projection::do_process(std::vector< std::unique_ptr<
 
     try{
         auto & input = inputs[0];
-        auto columns = ral::processor::process_project(std::move(input), expression, this->context.get());
+        auto columns = ral::processor::process_project(std::move(input), out_column_names, *programs);
         output->addToCache(std::move(columns));
     }catch(const rmm::bad_alloc& e){
         //can still recover if the input was not a GPUCacheData 
@@ -412,6 +697,8 @@ Filter::Filter(std::size_t kernel_id, const std::string & queryString, std::shar
 : kernel(kernel_id, queryString, context, kernel_type::FilterKernel)
 {
     this->query_graph = query_graph;
+    this->programs = std::make_unique<ral::processor::expression_program_cache>(
+        std::vector<std::string>{ral::processor::get_filter_expression(this->expression)}, get_interpreter_cpu_max_rows(context));
 }
 
 ral::execution::task_result Filter::do_process(std::vector< std::unique_ptr<ral::frame::BlazingTable> > inputs,
@@ -421,7 +708,8 @@ ral::execution::task_result Filter::do_process(std::vector< std::unique_ptr<ral:
     std::unique_ptr<ral::frame::BlazingTable> columns;
     try{
         auto & input = inputs[0];
-        columns = ral::processor::process_filter(input->toBlazingTableView(), expression, this->context.get());
+        columns = ral::processor::process_filter(input->toBlazingTableView(), *programs);
+        this->apply_runtime_join_filters(columns);
         output->addToCache(std::move(columns));
     }catch(const rmm::bad_alloc& e){
         return {ral::execution::task_status::RETRY, std::string(e.what()), std::move(inputs)};
@@ -7,6 +7,7 @@
 #include "io/DataLoader.h"
 #include "execution_graph/logic_controllers/taskflow/kernel.h"
 #include <execution_graph/logic_controllers/LogicPrimitives.h>
+#include "execution_graph/logic_controllers/LogicalProject.h"
 
 namespace ral {
 namespace batch {
@@ -142,6 +143,11 @@ public:
 	 */
 	kstatus run() override;
 
+	/**
+	 * Estimates the bytes of a batch from the row group sizes found when the scan was planned.
+	 */
+	std::size_t estimate_output_bytes(const std::vector<std::unique_ptr<ral::cache::CacheData > > & inputs) override;
+
 	/**
 	 * Returns the estimated num_rows for the output at one point.
 	 * @return A pair representing that there is no data to be processed, or the estimated number of output rows.
@@ -190,6 +196,11 @@ public:
 	 */
 	kstatus run() override;
 
+	/**
+	 * Estimates the bytes of a batch from the row group sizes found when the scan was planned.
+	 */
+	std::size_t estimate_output_bytes(const std::vector<std::unique_ptr<ral::cache::CacheData > > & inputs) override;
+
 	/**
 	 * Returns the estimated num_rows for the output at one point.
 	 * @return A pair representing that there is no data to be processed, or the estimated number of output rows.
@@ -203,6 +214,9 @@ private:
 	size_t file_index = 0;
 	double num_batches;
 	bool filtered;
+	std::unique_ptr<ral::processor::expression_program_cache> filter_programs; /**< Programs compiled for the filter condition, reused across batches. */
+	std::shared_ptr<ral::processor::expression_program_cache> late_filter_programs; /**< The filter over only the columns it reads, set when the other columns are loaded just for the rows that pass it. */
+	std::vector<int> late_filter_positions; /**< Positions in the projections of the columns the filter reads. */
 };
 
 /**
@@ -232,6 +246,15 @@ public:
 	 * @return kstatus 'stop' to halt processing, or 'proceed' to continue processing.
 	 */
 	kstatus run() override;
+
+	/**
+	 * Returns the projected expressions, one per output column.
+	 */
+	const std::vector<std::string> & expressions() const { return programs->expressions(); }
+
+private:
+	std::vector<std::string> out_column_names; /**< Names of the projected columns. */
+	std::unique_ptr<ral::processor::expression_program_cache> programs; /**< Programs compiled for the projected expressions, reused across batches. */
 };
 
 /**
@@ -267,6 +290,9 @@ public:
 	 * @return A pair representing that there is no data to be processed, or the estimated number of output rows.
 	 */
 	std::pair<bool, uint64_t> get_estimated_output_num_rows() override;
+
+private:
+	std::unique_ptr<ral::processor::expression_program_cache> programs; /**< Programs compiled for the filter condition, reused across batches. */
 };
 
 /**
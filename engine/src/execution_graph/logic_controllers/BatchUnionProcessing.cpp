@@ -1,5 +1,10 @@
 #include "BatchUnionProcessing.h"
+#include <numeric>
 #include <cudf/types.hpp>
+#include <cudf/copying.hpp>
+#include <cudf/join.hpp>
+#include <cudf/partitioning.hpp>
+#include <cudf/stream_compaction.hpp>
 #include "CodeTimer.h"
 #include "parser/expression_utils.hpp"
 #include <src/utilities/CommonOperations.h>
@@ -8,6 +13,22 @@
 namespace ral {
 namespace batch {
 
+namespace {
+
+const int MIN_NUM_DISTINCT_BUCKETS = 16;
+
+std::vector<cudf::size_type> all_column_indices(cudf::size_type num_columns) {
+    std::vector<cudf::size_type> indices(num_columns);
+    std::iota(indices.begin(), indices.end(), 0);
+    return indices;
+}
+
+std::unique_ptr<cudf::table> drop_duplicated_rows(cudf::table_view table) {
+    return cudf::drop_duplicates(table, all_column_indices(table.num_columns()), cudf::duplicate_keep_option::KEEP_FIRST);
+}
+
+} // namespace
+
 UnionKernel::UnionKernel(std::size_t kernel_id, const std::string & queryString, std::shared_ptr<Context> context, std::shared_ptr<ral::cache::graph> query_graph)
     : kernel{kernel_id, queryString, context, kernel_type::UnionKernel} {
     this->query_graph = query_graph;
@@ -131,5 +152,276 @@ kstatus UnionKernel::run() {
     return kstatus::proceed;
 }
 
+// BEGIN DistinctPartitionKernel
+
+DistinctPartitionKernel::DistinctPartitionKernel(std::size_t kernel_id, const std::string & queryString, std::shared_ptr<Context> context, std::shared_ptr<ral::cache::graph> query_graph)
+    : distributing_kernel{kernel_id, queryString, context, kernel_type::DistinctPartitionKernel} {
+    this->query_graph = query_graph;
+    set_number_of_message_trackers(1); //default
+}
+
+ral::execution::task_result DistinctPartitionKernel::do_process(std::vector< std::unique_ptr<ral::frame::BlazingTable> > inputs,
+    std::shared_ptr<ral::cache::CacheMachine> output,
+    cudaStream_t /*stream*/, const std::map<std::string, std::string>& /*args*/) {
+
+    auto & input = inputs[0];
+    try{
+        int num_partitions = this->context->getTotalNodes();
+        std::vector<cudf::table_view> partitioned;
+        std::unique_ptr<cudf::table> hashed_data; // Keep table alive in this scope
+        if (input->num_rows() > 0) {
+            std::unique_ptr<cudf::table> distinct_rows = drop_duplicated_rows(input->view());
+            std::vector<cudf::size_type> hashed_data_offsets;
+            std::tie(hashed_data, hashed_data_offsets) = cudf::hash_partition(distinct_rows->view(), all_column_indices(distinct_rows->num_columns()), num_partitions);
+            // the offsets returned by hash_partition will always start at 0, which is a value we want to ignore for cudf::split
+            std::vector<cudf::size_type> split_indexes(hashed_data_offsets.begin() + 1, hashed_data_offsets.end());
+            partitioned = cudf::split(hashed_data->view(), split_indexes);
+        } else {
+            //  copy empty view
+            for (auto i = 0; i < num_partitions; i++) {
+                partitioned.push_back(input->view());
+            }
+        }
+
+        std::vector<ral::frame::BlazingTableView> partitions;
+        for(auto partition : partitioned) {
+            partitions.push_back(ral::frame::BlazingTableView(partition, input->names()));
+        }
+
+        scatter(partitions,
+            output.get(),
+            "", //message_id_prefix
+            "" //cache_id
+        );
+    }catch(const rmm::bad_alloc& e){
+        return {ral::execution::task_status::RETRY, std::string(e.what()), std::move(inputs)};
+    }catch(const std::exception& e){
+        return {ral::execution::task_status::FAIL, std::string(e.what()), std::vector< std::unique_ptr<ral::frame::BlazingTable> > ()};
+    }
+    return {ral::execution::task_status::SUCCESS, std::string(), std::vector< std::unique_ptr<ral::frame::BlazingTable> > ()};
+}
+
+kstatus DistinctPartitionKernel::run() {
+    CodeTimer timer;
+
+    std::unique_ptr<ral::cache::CacheData> cache_data = this->input_cache()->pullCacheData();
+    while(cache_data != nullptr) {
+        std::vector<std::unique_ptr<ral::cache::CacheData>> inputs;
+        inputs.push_back(std::move(cache_data));
+
+        ral::execution::executor::get_instance()->add_task(
+                std::move(inputs),
+                this->output_cache(),
+                this);
+
+        cache_data = this->input_cache()->pullCacheData();
+    }
+
+    this->wait_for_tasks();
+
+    send_total_partition_counts(
+        "", //message_prefix
+        "" //cache_id
+    );
+
+    int total_count = get_total_partition_counts();
+    this->output_cache()->wait_for_count(total_count);
+
+    if(logger) {
+        logger->debug("{query_id}|{step}|{substep}|{info}|{duration}|kernel_id|{kernel_id}||",
+                    "query_id"_a=context->getContextToken(),
+                    "step"_a=context->getQueryStep(),
+                    "substep"_a=context->getQuerySubstep(),
+                    "info"_a="DistinctPartition Kernel Completed",
+                    "duration"_a=timer.elapsed_time(),
+                    "kernel_id"_a=this->get_id());
+    }
+
+    return kstatus::proceed;
+}
+
+// END DistinctPartitionKernel
+
+// BEGIN DistinctKernel
+
+DistinctKernel::DistinctKernel(std::size_t kernel_id, const std::string & queryString, std::shared_ptr<Context> context, std::shared_ptr<ral::cache::graph> query_graph)
+    : kernel{kernel_id, queryString, context, kernel_type::DistinctKernel} {
+    this->query_graph = query_graph;
+
+    this->max_piece_byte_size = 400000000;
+    std::map<std::string, std::string> config_options = context->getConfigOptions();
+    auto it = config_options.find("MAX_DISTINCT_STATE_PIECE_BYTE_SIZE");
+    if (it != config_options.end()){
+        this->max_piece_byte_size = std::stoull(config_options["MAX_DISTINCT_STATE_PIECE_BYTE_SIZE"]);
+    }
+
+    // the rows of a node already share the hash of all their columns modulo the number of nodes,
+    // a number of buckets with a common factor would leave some of them empty
+    int num_buckets = MIN_NUM_DISTINCT_BUCKETS;
+    int num_nodes = std::max(context->getTotalNodes(), 1);
+    auto gcd = [](int a, int b) {
+        while (b != 0) {
+            std::tie(a, b) = std::make_tuple(b, a % b);
+        }
+        return a;
+    };
+    while (gcd(num_buckets, num_nodes) != 1) {
+        num_buckets++;
+    }
+
+    ral::cache::cache_settings cache_machine_config;
+    cache_machine_config.type = ral::cache::CacheType::SIMPLE;
+    cache_machine_config.context = context->clone();
+    for (int i = 0; i < num_buckets; i++) {
+        this->buckets.push_back(ral::cache::create_cache_machine(cache_machine_config, std::to_string(this->get_id()) + "_distinct_bucket_" + std::to_string(i)));
+        this->bucket_mutexes.emplace_back();
+    }
+}
+
+// Adds the rows that were not in the bucket yet to the output and then to the bucket, returns true if there were any.
+// Both happen under the bucket lock and a row is only added to the bucket once it is in the output, so when a later
+// bucket of the same task runs out of memory the retried task skips the rows it already output and loses none.
+// The lock is held while the rows are anti joined with every piece: two tasks that checked the same bucket at the same
+// time could both output a row that is new to it. Tasks still run in parallel on the other buckets, and there are at
+// least MIN_NUM_DISTINCT_BUCKETS of them
+bool DistinctKernel::add_to_bucket(std::size_t bucket_index, cudf::table_view rows, const std::vector<std::string> & names,
+    std::shared_ptr<ral::cache::CacheMachine> output) {
+    std::lock_guard<std::mutex> lock(this->bucket_mutexes[bucket_index]);
+
+    std::vector<cudf::size_type> columns = all_column_indices(rows.num_columns());
+    std::vector<std::unique_ptr<ral::cache::CacheData>> pieces = this->buckets[bucket_index]->pull_all_cache_data();
+    bool added = false;
+    try {
+        std::unique_ptr<cudf::table> unseen_rows = std::make_unique<cudf::table>(rows);
+        // only one piece of the bucket is brought to the GPU at a time
+        for (auto & piece : pieces) {
+            if (unseen_rows->num_rows() == 0) {
+                break;
+            }
+            if (piece->get_type() != ral::cache::CacheDataType::GPU) {
+                piece = std::make_unique<ral::cache::GPUCacheData>(piece->decache());
+            }
+            ral::frame::BlazingTableView seen_rows = static_cast<ral::cache::GPUCacheData *>(piece.get())->getTableView();
+            unseen_rows = cudf::left_anti_join(unseen_rows->view(), seen_rows.view(), columns, columns, columns);
+            if (piece->sizeInBytes() > this->max_piece_byte_size / 2) {
+                // keep only the last piece in GPU memory while it can still grow
+                this->buckets[bucket_index]->addToCache(piece->decache(), "", true);
+                piece = nullptr;
+            }
+        }
+
+        if (unseen_rows->num_rows() > 0) {
+            // every piece left was brought to the GPU by the loop above, the last one is only replaced once the rows are output
+            std::unique_ptr<ral::frame::BlazingTable> new_piece = std::make_unique<ral::frame::BlazingTable>(std::make_unique<cudf::table>(unseen_rows->view()), names);
+            bool grows_last_piece = !pieces.empty() && pieces.back() != nullptr && pieces.back()->sizeInBytes() + new_piece->sizeInBytes() <= this->max_piece_byte_size;
+            if (grows_last_piece) {
+                ral::frame::BlazingTableView last_piece = static_cast<ral::cache::GPUCacheData *>(pieces.back().get())->getTableView();
+                new_piece = ral::utilities::concatTables({last_piece, new_piece->toBlazingTableView()});
+            }
+
+            output->addToCache(std::make_unique<ral::frame::BlazingTable>(std::move(unseen_rows), names));
+            added = true;
+
+            if (grows_last_piece) {
+                pieces.back() = std::make_unique<ral::cache::GPUCacheData>(std::move(new_piece));
+            } else {
+                pieces.push_back(std::make_unique<ral::cache::GPUCacheData>(std::move(new_piece)));
+            }
+        }
+
+        for (auto & piece : pieces) {
+            if (piece == nullptr) {
+                continue;
+            }
+            if (piece->get_type() == ral::cache::CacheDataType::GPU) {
+                // added as a table, so the cache can spill it
+                this->buckets[bucket_index]->addToCache(piece->decache(), "", true);
+            } else {
+                this->buckets[bucket_index]->addCacheData(std::move(piece), "", true);
+            }
+            piece = nullptr;
+        }
+    } catch(...) {
+        for (auto & piece : pieces) {
+            if (piece != nullptr) {
+                this->buckets[bucket_index]->addCacheData(std::move(piece), "", true);
+            }
+        }
+        throw;
+    }
+    return added;
+}
+
+ral::execution::task_result DistinctKernel::do_process(std::vector< std::unique_ptr<ral::frame::BlazingTable> > inputs,
+    std::shared_ptr<ral::cache::CacheMachine> output,
+    cudaStream_t /*stream*/, const std::map<std::string, std::string>& /*args*/) {
+
+    auto & input = inputs[0];
+    try{
+        bool added = false;
+        if (input->num_rows() > 0) {
+            std::unique_ptr<cudf::table> distinct_rows = drop_duplicated_rows(input->view());
+            std::unique_ptr<cudf::table> hashed_data;
+            std::vector<cudf::size_type> hashed_data_offsets;
+            std::tie(hashed_data, hashed_data_offsets) = cudf::hash_partition(distinct_rows->view(), all_column_indices(distinct_rows->num_columns()), this->buckets.size());
+            // the offsets returned by hash_partition will always start at 0, which is a value we want to ignore for cudf::split
+            std::vector<cudf::size_type> split_indexes(hashed_data_offsets.begin() + 1, hashed_data_offsets.end());
+            std::vector<cudf::table_view> partitioned = cudf::split(hashed_data->view(), split_indexes);
+            for (std::size_t i = 0; i < partitioned.size(); i++) {
+                if (partitioned[i].num_rows() > 0) {
+                    added = add_to_bucket(i, partitioned[i], input->names(), output) || added;
+                }
+            }
+        }
+
+        if (!added) {
+            // an empty table is only kept by the cache when nothing else was added, so the schema is not lost
+            output->addToCache(ral::utilities::create_empty_table(input->toBlazingTableView()));
+        }
+    }catch(const rmm::bad_alloc& e){
+        return {ral::execution::task_status::RETRY, std::string(e.what()), std::move(inputs)};
+    }catch(const std::exception& e){
+        return {ral::execution::task_status::FAIL, std::string(e.what()), std::vector< std::unique_ptr<ral::frame::BlazingTable> > ()};
+    }
+    return {ral::execution::task_status::SUCCESS, std::string(), std::vector< std::unique_ptr<ral::frame::BlazingTable> > ()};
+}
+
+kstatus DistinctKernel::run() {
+    CodeTimer timer;
+
+    std::unique_ptr<ral::cache::CacheData> cache_data = this->input_cache()->pullCacheData();
+    while(cache_data != nullptr) {
+        std::vector<std::unique_ptr<ral::cache::CacheData>> inputs;
+        inputs.push_back(std::move(cache_data));
+
+        ral::execution::executor::get_instance()->add_task(
+                std::move(inputs),
+                this->output_cache(),
+                this);
+
+        cache_data = this->input_cache()->pullCacheData();
+    }
+
+    this->wait_for_tasks();
+
+    for (auto & bucket : this->buckets) {
+        bucket->clear();
+    }
+
+    if(logger) {
+        logger->debug("{query_id}|{step}|{substep}|{info}|{duration}|kernel_id|{kernel_id}||",
+                    "query_id"_a=context->getContextToken(),
+                    "step"_a=context->getQueryStep(),
+                    "substep"_a=context->getQuerySubstep(),
+                    "info"_a="Distinct Kernel Completed",
+                    "duration"_a=timer.elapsed_time(),
+                    "kernel_id"_a=this->get_id());
+    }
+
+    return kstatus::proceed;
+}
+
+// END DistinctKernel
+
 } // namespace batch
 } // namespace ral
@@ -1,7 +1,10 @@
 #pragma once
 
+#include <deque>
+#include <mutex>
 #include "BatchProcessing.h"
 #include "LogicPrimitives.h"
+#include "taskflow/distributing_kernel.h"
 
 
 
@@ -9,6 +12,7 @@ namespace ral {
 namespace batch {
 using ral::cache::kstatus;
 using ral::cache::kernel;
+using ral::cache::distributing_kernel;
 using ral::cache::kernel_type;
 using namespace fmt::literals;
 
@@ -29,5 +33,53 @@ private:
     std::vector<cudf::data_type> common_types;
 };
 
+/**
+ * @brief Sends every row to the node given by the hash of all its columns, so
+ * that duplicated rows end up in the same node. Every batch is deduplicated
+ * before it is sent. Only used in distributed mode.
+ */
+class DistinctPartitionKernel : public distributing_kernel {
+public:
+    DistinctPartitionKernel(std::size_t kernel_id, const std::string & queryString, std::shared_ptr<Context> context, std::shared_ptr<ral::cache::graph> query_graph);
+
+    std::string kernel_name() { return "DistinctPartition";}
+
+    ral::execution::task_result do_process(std::vector< std::unique_ptr<ral::frame::BlazingTable> > inputs,
+        std::shared_ptr<ral::cache::CacheMachine> output,
+        cudaStream_t stream, const std::map<std::string, std::string>& args) override;
+
+    virtual kstatus run();
+};
+
+/**
+ * @brief Removes the duplicated rows of its input as the batches arrive (UNION
+ * without ALL).
+ *
+ * The rows are hash partitioned on all their columns into buckets that hold
+ * the distinct rows seen so far, split in pieces of up to
+ * MAX_DISTINCT_STATE_PIECE_BYTE_SIZE bytes that can spill. The rows of a batch
+ * that are not in their bucket yet are output right away and added to it.
+ */
+class DistinctKernel : public kernel {
+public:
+    DistinctKernel(std::size_t kernel_id, const std::string & queryString, std::shared_ptr<Context> context, std::shared_ptr<ral::cache::graph> query_graph);
+
+    std::string kernel_name() { return "Distinct";}
+
+    ral::execution::task_result do_process(std::vector< std::unique_ptr<ral::frame::BlazingTable> > inputs,
+        std::shared_ptr<ral::cache::CacheMachine> output,
+        cudaStream_t stream, const std::map<std::string, std::string>& args) override;
+
+    virtual kstatus run();
+
+private:
+    bool add_to_bucket(std::size_t bucket_index, cudf::table_view rows, const std::vector<std::string> & names,
+        std::shared_ptr<ral::cache::CacheMachine> output);
+
+    std::size_t max_piece_byte_size;
+    std::vector<std::shared_ptr<ral::cache::CacheMachine>> buckets;
+    std::deque<std::mutex> bucket_mutexes; // a bucket is checked and updated by one task at a time
+};
+
 } // namespace batch
 } // namespace ral
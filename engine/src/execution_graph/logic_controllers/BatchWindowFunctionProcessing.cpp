@@ -23,6 +23,272 @@
 namespace ral {
 namespace batch {
 
+// BEGIN WindowPartitionKernel
+
+WindowPartitionKernel::WindowPartitionKernel(std::size_t kernel_id, const std::string & queryString,
+    std::shared_ptr<Context> context,
+    std::shared_ptr<ral::cache::graph> query_graph)
+    : distributing_kernel{kernel_id, queryString, context, kernel_type::WindowPartitionKernel} {
+    this->query_graph = query_graph;
+    set_number_of_message_trackers(1); //default
+
+    std::vector<int> partition_column_indices;
+    std::tie(partition_column_indices, std::ignore) = ral::operators::get_vars_to_partition(this->expression);
+    this->column_indices_partitioned.assign(partition_column_indices.begin(), partition_column_indices.end());
+}
+
+ral::execution::task_result WindowPartitionKernel::do_process(std::vector< std::unique_ptr<ral::frame::BlazingTable> > inputs,
+    std::shared_ptr<ral::cache::CacheMachine> output,
+    cudaStream_t /*stream*/, const std::map<std::string, std::string>& /*args*/) {
+
+    auto & input = inputs[0];
+
+    try{
+        int num_partitions = this->context->getTotalNodes();
+        CudfTableView batch_view = input->view();
+        std::vector<CudfTableView> partitioned;
+        std::unique_ptr<CudfTable> hashed_data; // Keep table alive in this scope
+        if (batch_view.num_rows() > 0) {
+            std::vector<cudf::size_type> hashed_data_offsets;
+            std::tie(hashed_data, hashed_data_offsets) = cudf::hash_partition(batch_view, this->column_indices_partitioned, num_partitions);
+            // the offsets returned by hash_partition will always start at 0, which is a value we want to ignore for cudf::split
+            std::vector<cudf::size_type> split_indexes(hashed_data_offsets.begin() + 1, hashed_data_offsets.end());
+            partitioned = cudf::split(hashed_data->view(), split_indexes);
+        } else {
+            //  copy empty view
+            for (auto i = 0; i < num_partitions; i++) {
+                partitioned.push_back(batch_view);
+            }
+        }
+
+        std::vector<ral::frame::BlazingTableView> partitions;
+        for(auto partition : partitioned) {
+            partitions.push_back(ral::frame::BlazingTableView(partition, input->names()));
+        }
+
+        scatter(partitions,
+            output.get(),
+            "", //message_id_prefix
+            "" //cache_id
+        );
+    }catch(const rmm::bad_alloc& e){
+        return {ral::execution::task_status::RETRY, std::string(e.what()), std::move(inputs)};
+    }catch(const std::exception& e){
+        return {ral::execution::task_status::FAIL, std::string(e.what()), std::vector< std::unique_ptr<ral::frame::BlazingTable> > ()};
+    }
+
+    return {ral::execution::task_status::SUCCESS, std::string(), std::vector< std::unique_ptr<ral::frame::BlazingTable> > ()};
+}
+
+kstatus WindowPartitionKernel::run() {
+    CodeTimer timer;
+
+    std::unique_ptr<ral::cache::CacheData> cache_data = this->input_cache()->pullCacheData();
+
+    while (cache_data != nullptr ){
+        std::vector<std::unique_ptr <ral::cache::CacheData> > inputs;
+        inputs.push_back(std::move(cache_data));
+
+        ral::execution::executor::get_instance()->add_task(
+                std::move(inputs),
+                this->output_cache(),
+                this);
+
+        cache_data = this->input_cache()->pullCacheData();
+    }
+
+    this->wait_for_tasks();
+
+    send_total_partition_counts(
+        "", //message_prefix
+        "" //cache_id
+    );
+
+    int total_count = get_total_partition_counts();
+    this->output_cache()->wait_for_count(total_count);
+
+    if (logger != nullptr) {
+        logger->debug("{query_id}|{step}|{substep}|{info}|{duration}|kernel_id|{kernel_id}||",
+                    "query_id"_a=context->getContextToken(),
+                    "step"_a=context->getQueryStep(),
+                    "substep"_a=context->getQuerySubstep(),
+                    "info"_a="WindowPartition Kernel Completed",
+                    "duration"_a=timer.elapsed_time(),
+                    "kernel_id"_a=this->get_id());
+    }
+    return kstatus::proceed;
+}
+
+// END WindowPartitionKernel
+
+// BEGIN WindowSortKernel
+
+WindowSortKernel::WindowSortKernel(std::size_t kernel_id, const std::string & queryString,
+    std::shared_ptr<Context> context,
+    std::shared_ptr<ral::cache::graph> query_graph)
+    : kernel{kernel_id, queryString, context, kernel_type::WindowSortKernel} {
+    this->query_graph = query_graph;
+
+    // the batches are sorted by the first OVER clause, ComputeWindowKernel computes it without sorting again
+    std::string first_clause_expression = get_window_expressions_by_over_clause(this->expression)[0].first;
+
+    std::vector<int> partition_column_indices;
+    std::vector<int> order_column_indices;
+    std::vector<cudf::order> order_types;
+    std::tie(partition_column_indices, std::ignore) = ral::operators::get_vars_to_partition(first_clause_expression);
+    this->column_indices_partitioned.assign(partition_column_indices.begin(), partition_column_indices.end());
+
+    // partition by is always in ASCENDING order
+    this->sort_column_indices = partition_column_indices;
+    this->sort_order_types.assign(partition_column_indices.size(), cudf::order::ASCENDING);
+    if (window_expression_contains_order_by(first_clause_expression)) {
+        std::tie(order_column_indices, order_types) = ral::operators::get_vars_to_orders(first_clause_expression);
+        this->sort_column_indices.insert(this->sort_column_indices.end(), order_column_indices.begin(), order_column_indices.end());
+        this->sort_order_types.insert(this->sort_order_types.end(), order_types.begin(), order_types.end());
+    }
+}
+
+ral::execution::task_result WindowSortKernel::do_process(std::vector< std::unique_ptr<ral::frame::BlazingTable> > inputs,
+    std::shared_ptr<ral::cache::CacheMachine> output,
+    cudaStream_t /*stream*/, const std::map<std::string, std::string>& args) {
+
+    try{
+        auto & operation_type = args.at("operation_type");
+        if (operation_type == "partition") {
+            auto & input = inputs[0];
+            if (input->num_rows() > 0) {
+                std::unique_ptr<CudfTable> hashed_data;
+                std::vector<cudf::size_type> hashed_data_offsets;
+                std::tie(hashed_data, hashed_data_offsets) = cudf::hash_partition(input->view(), this->column_indices_partitioned, this->buckets.size());
+                // the offsets returned by hash_partition will always start at 0, which is a value we want to ignore for cudf::split
+                std::vector<cudf::size_type> split_indexes(hashed_data_offsets.begin() + 1, hashed_data_offsets.end());
+                std::vector<CudfTableView> partitioned = cudf::split(hashed_data->view(), split_indexes);
+                // every partition is copied before any is added, so a retry does not add the first partitions twice
+                std::vector<std::unique_ptr<ral::frame::BlazingTable>> partitions(partitioned.size());
+                for (std::size_t i = 0; i < partitioned.size(); i++) {
+                    if (partitioned[i].num_rows() > 0) {
+                        partitions[i] = ral::frame::BlazingTableView(partitioned[i], input->names()).clone();
+                    }
+                }
+                hashed_data = nullptr;
+                for (std::size_t i = 0; i < partitions.size(); i++) {
+                    if (partitions[i] != nullptr) {
+                        this->buckets[i]->addToCache(std::move(partitions[i]), "", true);
+                    }
+                }
+            }
+        } else if (operation_type == "sort") {
+            std::vector<ral::frame::BlazingTableView> tables_to_concat;
+            for (auto & input : inputs) {
+                tables_to_concat.push_back(input->toBlazingTableView());
+            }
+            std::unique_ptr<ral::frame::BlazingTable> concatenated = ral::utilities::concatTables(tables_to_concat);
+
+            std::vector<cudf::null_order> null_orders(this->sort_column_indices.size(), cudf::null_order::AFTER);
+            std::unique_ptr<cudf::table> sorted_table = cudf::sort_by_key(concatenated->view(),
+                concatenated->view().select(this->sort_column_indices), this->sort_order_types, null_orders);
+
+            output->addToCache(std::make_unique<ral::frame::BlazingTable>(std::move(sorted_table), concatenated->names()));
+        } else {
+            RAL_FAIL("In WindowSortKernel: unknown operation_type " + operation_type);
+        }
+    }catch(const rmm::bad_alloc& e){
+        return {ral::execution::task_status::RETRY, std::string(e.what()), std::move(inputs)};
+    }catch(const std::exception& e){
+        return {ral::execution::task_status::FAIL, std::string(e.what()), std::vector< std::unique_ptr<ral::frame::BlazingTable> > ()};
+    }
+
+    return {ral::execution::task_status::SUCCESS, std::string(), std::vector< std::unique_ptr<ral::frame::BlazingTable> > ()};
+}
+
+kstatus WindowSortKernel::run() {
+    CodeTimer timer;
+
+    // a window partition can be anywhere in the input, so all of it is needed before the first bucket can be sorted.
+    // It stays in the input cache, which can spill it, and is pulled once the number of buckets is known
+    this->input_cache()->wait_until_finished();
+    std::size_t total_bytes = this->input_cache()->get_num_bytes_added();
+
+    std::size_t num_bytes_per_bucket = 400000000;
+    std::map<std::string, std::string> config_options = context->getConfigOptions();
+    auto it = config_options.find("NUM_BYTES_PER_ORDER_BY_PARTITION");
+    if (it != config_options.end()){
+        num_bytes_per_bucket = std::stoull(config_options["NUM_BYTES_PER_ORDER_BY_PARTITION"]);
+    }
+
+    int num_buckets = std::max(static_cast<int>((total_bytes + num_bytes_per_bucket - 1) / num_bytes_per_bucket), 1);
+    if (num_buckets > 1) {
+        // the rows of this node already share the hash of their PARTITION BY columns modulo the number of nodes,
+        // a number of buckets with a common factor would leave some of them empty
+        int num_nodes = this->context->getTotalNodes();
+        auto gcd = [](int a, int b) {
+            while (b != 0) {
+                std::tie(a, b) = std::make_tuple(b, a % b);
+            }
+            return a;
+        };
+        while (gcd(num_buckets, num_nodes) != 1) {
+            num_buckets++;
+        }
+    }
+
+    if (num_buckets == 1) {
+        std::vector<std::unique_ptr<ral::cache::CacheData>> all_inputs = this->input_cache()->pull_all_cache_data();
+        if (!all_inputs.empty()) {
+            ral::execution::executor::get_instance()->add_task(
+                    std::move(all_inputs),
+                    this->output_cache(),
+                    this,
+                    {{"operation_type", "sort"}});
+        }
+    } else {
+        ral::cache::cache_settings cache_machine_config;
+        cache_machine_config.type = ral::cache::CacheType::SIMPLE;
+        cache_machine_config.context = context->clone();
+        for (int i = 0; i < num_buckets; i++) {
+            this->buckets.push_back(ral::cache::create_cache_machine(cache_machine_config, std::to_string(this->get_id()) + "_window_bucket_" + std::to_string(i)));
+        }
+
+        std::unique_ptr<ral::cache::CacheData> cache_data = this->input_cache()->pullCacheData();
+        while (cache_data != nullptr) {
+            std::vector<std::unique_ptr<ral::cache::CacheData>> inputs;
+            inputs.push_back(std::move(cache_data));
+            ral::execution::executor::get_instance()->add_task(
+                    std::move(inputs),
+                    this->output_cache(),
+                    this,
+                    {{"operation_type", "partition"}});
+            cache_data = this->input_cache()->pullCacheData();
+        }
+        wait_for_tasks();
+
+        for (auto & bucket : this->buckets) {
+            std::vector<std::unique_ptr<ral::cache::CacheData>> inputs = bucket->pull_all_cache_data();
+            if (!inputs.empty()) {
+                ral::execution::executor::get_instance()->add_task(
+                        std::move(inputs),
+                        this->output_cache(),
+                        this,
+                        {{"operation_type", "sort"}});
+            }
+        }
+    }
+    wait_for_tasks();
+
+    if (logger != nullptr) {
+        logger->debug("{query_id}|{step}|{substep}|{info}|{duration}|kernel_id|{kernel_id}||",
+                    "query_id"_a=context->getContextToken(),
+                    "step"_a=context->getQueryStep(),
+                    "substep"_a=context->getQuerySubstep(),
+                    "info"_a="WindowSort Kernel Completed with " + std::to_string(num_buckets) + " buckets",
+                    "duration"_a=timer.elapsed_time(),
+                    "kernel_id"_a=this->get_id());
+    }
+    return kstatus::proceed;
+}
+
+// END WindowSortKernel
+
 // BEGIN ComputeWindowKernel
 
 ComputeWindowKernel::ComputeWindowKernel(std::size_t kernel_id, const std::string & queryString,
@@ -30,12 +296,33 @@ ComputeWindowKernel::ComputeWindowKernel(std::size_t kernel_id, const std::strin
     std::shared_ptr<ral::cache::graph> query_graph)
     : kernel{kernel_id, queryString, context, kernel_type::ComputeWindowKernel} {
     this->query_graph = query_graph;
-    std::tie(this->preceding_value, this->following_value) = get_bounds_from_window_expression(this->expression);
-    this->frame_type = get_frame_type_from_over_clause(this->expression);
+
+    for (auto & window_expression : get_window_expressions_by_over_clause(this->expression)) {
+        window_clause clause;
+        clause.expression = window_expression.first;
+        clause.output_positions = window_expression.second;
+        std::tie(clause.preceding_value, clause.following_value) = get_bounds_from_window_expression(clause.expression);
+        clause.frame_type = get_frame_type_from_over_clause(clause.expression);
+        std::tie(clause.column_indices_to_agg, clause.type_aggs_as_str, clause.agg_param_values) =
+                                        get_cols_to_apply_window_and_cols_to_apply_agg(clause.expression);
+        std::tie(clause.column_indices_partitioned, std::ignore) = ral::operators::get_vars_to_partition(clause.expression);
+        if (window_expression_contains_order_by(clause.expression)) {
+            std::tie(clause.column_indices_ordered, clause.order_types) = ral::operators::get_vars_to_orders(clause.expression);
+        }
+
+        // fill all the Kind aggregations
+        for (std::size_t col_i = 0; col_i < clause.type_aggs_as_str.size(); ++col_i) {
+            clause.aggs_wind_func.push_back(ral::operators::get_aggregation_operation(clause.type_aggs_as_str[col_i]));
+        }
+
+        this->num_window_columns += clause.output_positions.size();
+        this->clauses.push_back(std::move(clause));
+    }
 }
 
 // TODO: Support for RANK() and DENSE_RANK()
 std::unique_ptr<CudfColumn> ComputeWindowKernel::compute_column_from_window_function(
+    const window_clause & clause,
     cudf::table_view input_table_cudf_view,
     cudf::column_view col_view_to_agg,
     std::size_t pos, int & agg_param_count ) {
@@ -43,30 +330,30 @@ std::unique_ptr<CudfColumn> ComputeWindowKernel::compute_column_from_window_func
     std::unique_ptr<cudf::aggregation> window_aggregation;
 
     // we want firs get the type of aggregation
-    if (this->agg_param_values.size() > agg_param_count && is_lag_or_lead_aggregation(this->type_aggs_as_str[pos])) {
-        window_aggregation = ral::operators::makeCudfAggregation(this->aggs_wind_func[pos], this->agg_param_values[agg_param_count]);
+    if (clause.agg_param_values.size() > agg_param_count && is_lag_or_lead_aggregation(clause.type_aggs_as_str[pos])) {
+        window_aggregation = ral::operators::makeCudfAggregation(clause.aggs_wind_func[pos], clause.agg_param_values[agg_param_count]);
         agg_param_count++;
-    } else if (is_last_value_window(this->type_aggs_as_str[pos])) {
-        window_aggregation = ral::operators::makeCudfAggregation(this->aggs_wind_func[pos], -1);
+    } else if (is_last_value_window(clause.type_aggs_as_str[pos])) {
+        window_aggregation = ral::operators::makeCudfAggregation(clause.aggs_wind_func[pos], -1);
     } else {
-        window_aggregation = ral::operators::makeCudfAggregation(this->aggs_wind_func[pos]);
+        window_aggregation = ral::operators::makeCudfAggregation(clause.aggs_wind_func[pos]);
     }
 
     // want all columns to be partitioned
     std::vector<cudf::column_view> columns_to_partition;
-    for (std::size_t col_i = 0; col_i < this->column_indices_partitioned.size(); ++col_i) {
-        columns_to_partition.push_back(input_table_cudf_view.column(this->column_indices_partitioned[col_i]));
+    for (std::size_t col_i = 0; col_i < clause.column_indices_partitioned.size(); ++col_i) {
+        columns_to_partition.push_back(input_table_cudf_view.column(clause.column_indices_partitioned[col_i]));
     }
 
     cudf::table_view partitioned_table_view(columns_to_partition);
 
     std::unique_ptr<CudfColumn> windowed_col;
-    if (is_first_value_window(this->type_aggs_as_str[pos]) || is_last_value_window(this->type_aggs_as_str[pos])) {
+    if (is_first_value_window(clause.type_aggs_as_str[pos]) || is_last_value_window(clause.type_aggs_as_str[pos])) {
 
-        if (is_last_value_window(this->type_aggs_as_str[pos])) {
+        if (is_last_value_window(clause.type_aggs_as_str[pos])) {
             // We want also all the ordered columns
-            for (std::size_t col_i = 0; col_i < this->column_indices_ordered.size(); ++col_i) {
-                columns_to_partition.push_back(input_table_cudf_view.column(this->column_indices_ordered[col_i]));
+            for (std::size_t col_i = 0; col_i < clause.column_indices_ordered.size(); ++col_i) {
+                columns_to_partition.push_back(input_table_cudf_view.column(clause.column_indices_ordered[col_i]));
             }
 
             partitioned_table_view = {{cudf::table_view(columns_to_partition)}};
@@ -119,12 +406,12 @@ std::unique_ptr<CudfColumn> ComputeWindowKernel::compute_column_from_window_func
             windowed_col = std::move(sorted_table->release()[position_of_values_column]);
         }
     }
-    else if (window_expression_contains_order_by(this->expression)) {
-        if (window_expression_contains_bounds(this->expression)) {
+    else if (window_expression_contains_order_by(clause.expression)) {
+        if (window_expression_contains_bounds(clause.expression)) {
             // TODO: for now just ROWS bounds works (not RANGE)
-            windowed_col = cudf::grouped_rolling_window(partitioned_table_view, col_view_to_agg, this->preceding_value + 1, this->following_value, 1, window_aggregation);
+            windowed_col = cudf::grouped_rolling_window(partitioned_table_view, col_view_to_agg, clause.preceding_value + 1, clause.following_value, 1, window_aggregation);
         } else {
-            if (this->type_aggs_as_str[pos] == "LEAD") {
+            if (clause.type_aggs_as_str[pos] == "LEAD") {
                 windowed_col = cudf::grouped_rolling_window(partitioned_table_view, col_view_to_agg, 0, col_view_to_agg.size(), 1, window_aggregation);
             } else {
                 windowed_col = cudf::grouped_rolling_window(partitioned_table_view, col_view_to_agg, col_view_to_agg.size(), 0, 1, window_aggregation);
@@ -153,25 +440,44 @@ ral::execution::task_result ComputeWindowKernel::do_process(std::vector< std::un
         cudf::table_view input_table_cudf_view = input->view();
 
         std::vector<std::string> input_names = input->names();
-        std::tie(this->column_indices_to_agg, this->type_aggs_as_str, this->agg_param_values) = 
-                                        get_cols_to_apply_window_and_cols_to_apply_agg(this->expression);
-        std::tie(this->column_indices_partitioned, std::ignore) = ral::operators::get_vars_to_partition(this->expression);
-        std::tie(this->column_indices_ordered, std::ignore) = ral::operators::get_vars_to_orders(this->expression);
-
-        // fill all the Kind aggregations
-        for (std::size_t col_i = 0; col_i < this->type_aggs_as_str.size(); ++col_i) {
-            AggregateKind aggr_kind_i = ral::operators::get_aggregation_operation(this->type_aggs_as_str[col_i]);
-            this->aggs_wind_func.push_back(aggr_kind_i);
-        }
 
-        std::vector< std::unique_ptr<CudfColumn> > new_wf_cols;
-        int agg_param_count = 0;
-        for (std::size_t col_i = 0; col_i < this->type_aggs_as_str.size(); ++col_i) {
-            cudf::column_view col_view_to_agg = input_table_cudf_view.column(column_indices_to_agg[col_i]);
+        std::vector< std::unique_ptr<CudfColumn> > new_wf_cols(this->num_window_columns);
+        for (std::size_t clause_i = 0; clause_i < this->clauses.size(); ++clause_i) {
+            const window_clause & clause = this->clauses[clause_i];
+            const window_clause & first_clause = this->clauses[0];
+
+            // the batch is sorted by the first clause, the rows are sorted by any other clause before computing it
+            std::unique_ptr<CudfColumn> sorted_order;
+            std::unique_ptr<cudf::table> sorted_table;
+            cudf::table_view clause_view = input_table_cudf_view;
+            if (clause.column_indices_partitioned != first_clause.column_indices_partitioned ||
+                clause.column_indices_ordered != first_clause.column_indices_ordered ||
+                clause.order_types != first_clause.order_types) {
+                std::vector<int> sort_column_indices = clause.column_indices_partitioned;
+                sort_column_indices.insert(sort_column_indices.end(), clause.column_indices_ordered.begin(), clause.column_indices_ordered.end());
+                // partition by is always in ASCENDING order
+                std::vector<cudf::order> sort_order_types(clause.column_indices_partitioned.size(), cudf::order::ASCENDING);
+                sort_order_types.insert(sort_order_types.end(), clause.order_types.begin(), clause.order_types.end());
+                std::vector<cudf::null_order> null_orders(sort_column_indices.size(), cudf::null_order::AFTER);
+
+                sorted_order = cudf::sorted_order(input_table_cudf_view.select(sort_column_indices), sort_order_types, null_orders);
+                sorted_table = cudf::gather(input_table_cudf_view, sorted_order->view());
+                clause_view = sorted_table->view();
+            }
 
-            // calling main window function
-            std::unique_ptr<CudfColumn> windowed_col = compute_column_from_window_function(input_table_cudf_view, col_view_to_agg, col_i, agg_param_count);
-            new_wf_cols.push_back(std::move(windowed_col));
+            int agg_param_count = 0;
+            for (std::size_t col_i = 0; col_i < clause.type_aggs_as_str.size(); ++col_i) {
+                cudf::column_view col_view_to_agg = clause_view.column(clause.column_indices_to_agg[col_i]);
+
+                // calling main window function
+                std::unique_ptr<CudfColumn> windowed_col = compute_column_from_window_function(clause, clause_view, col_view_to_agg, col_i, agg_param_count);
+                if (sorted_order) {
+                    // back to the order of the batch
+                    cudf::table_view windowed_view({windowed_col->view()});
+                    windowed_col = std::move(cudf::scatter(windowed_view, sorted_order->view(), windowed_view)->release()[0]);
+                }
+                new_wf_cols[clause.output_positions[col_i]] = std::move(windowed_col);
+            }
         }
 
         std::unique_ptr<cudf::table> cudf_table_input = input->releaseCudfTable();
@@ -230,9 +536,13 @@ kstatus ComputeWindowKernel::run() {
 
     std::unique_lock<std::mutex> lock(kernel_mutex);
     kernel_cv.wait(lock,[this]{
-        return this->tasks.empty();
+        return this->tasks.empty() || ral::execution::executor::get_instance()->has_exception();
     });
 
+    if(auto ep = ral::execution::executor::get_instance()->last_exception()){
+        std::rethrow_exception(ep);
+    }
+
     if (logger != nullptr) {
         logger->debug("{query_id}|{step}|{substep}|{info}|{duration}|kernel_id|{kernel_id}||",
                     "query_id"_a=context->getContextToken(),
@@ -1,17 +1,69 @@
 #pragma once
 
 #include "BatchProcessing.h"
+#include "taskflow/distributing_kernel.h"
 #include "operators/OrderBy.h"
 #include "operators/GroupBy.h"
 
 namespace ral {
 namespace batch {
 
-//using ral::cache::distributing_kernel;
+using ral::cache::distributing_kernel;
 using ral::cache::kstatus;
 using ral::cache::kernel;
 using ral::cache::kernel_type;
 
+/**
+ * @brief This kernel sends every row to the node given by the hash of its
+ * PARTITION BY columns, so that all the rows of a window partition end up in
+ * the same node. Only used in distributed mode.
+ */
+class WindowPartitionKernel : public distributing_kernel {
+public:
+	WindowPartitionKernel(std::size_t kernel_id, const std::string & queryString,
+		std::shared_ptr<Context> context,
+		std::shared_ptr<ral::cache::graph> query_graph);
+
+	std::string kernel_name() { return "WindowPartition";}
+
+	ral::execution::task_result do_process(std::vector< std::unique_ptr<ral::frame::BlazingTable> > inputs,
+		std::shared_ptr<ral::cache::CacheMachine> output,
+		cudaStream_t stream, const std::map<std::string, std::string>& args) override;
+
+	kstatus run() override;
+
+private:
+	std::vector<cudf::size_type> column_indices_partitioned;
+};
+
+/**
+ * @brief This kernel hash partitions the rows of this node on the PARTITION BY
+ * columns into buckets of about NUM_BYTES_PER_ORDER_BY_PARTITION bytes, which
+ * can spill. Then every bucket is sorted by the PARTITION BY and ORDER BY
+ * columns of the first OVER clause and output as one batch, so every batch has
+ * complete window partitions.
+ */
+class WindowSortKernel : public kernel {
+public:
+	WindowSortKernel(std::size_t kernel_id, const std::string & queryString,
+		std::shared_ptr<Context> context,
+		std::shared_ptr<ral::cache::graph> query_graph);
+
+	std::string kernel_name() { return "WindowSort";}
+
+	ral::execution::task_result do_process(std::vector< std::unique_ptr<ral::frame::BlazingTable> > inputs,
+		std::shared_ptr<ral::cache::CacheMachine> output,
+		cudaStream_t stream, const std::map<std::string, std::string>& args) override;
+
+	kstatus run() override;
+
+private:
+	std::vector<cudf::size_type> column_indices_partitioned;
+	std::vector<int> sort_column_indices; // PARTITION BY and ORDER BY columns of the first OVER clause
+	std::vector<cudf::order> sort_order_types;
+	std::vector<std::shared_ptr<ral::cache::CacheMachine>> buckets;
+};
+
 /**
  * @brief This kernel computes the main Window Function (ROW_NUMBER, LAG, LEAD, MIN, ...)
  * to each batch already pattitioned and sorted
@@ -24,7 +76,25 @@ public:
 		std::shared_ptr<Context> context,
 		std::shared_ptr<ral::cache::graph> query_graph);
 
+	// Window functions that share the same OVER clause
+	struct window_clause {
+		// LogicalComputeWindow(min_keys=[MIN($0) OVER (PARTITION BY $1 ORDER BY $3 DESC)], lag_col=[LAG($0, 5) OVER (PARTITION BY $1 ORDER BY $3 DESC)])
+		std::string expression;                        // only the window functions of this clause
+		std::vector<std::size_t> output_positions;     // positions of its columns among all the window columns
+		std::vector<int> column_indices_partitioned;   // column indices to be partitioned: [1]
+		std::vector<int> column_indices_ordered;   	   // column indices to be ordered: [3]
+		std::vector<cudf::order> order_types;          // [cudf::order::DESCENDING]
+		std::vector<int> column_indices_to_agg;        // column indices to be agg: [0, 0]
+		std::vector<int> agg_param_values;     		   // due to LAG or LEAD: [5]
+		int preceding_value;     	                   // X PRECEDING
+		int following_value;     		               // Y FOLLOWING
+		std::string frame_type;                        // ROWS or RANGE
+		std::vector<std::string> type_aggs_as_str;     // ["MIN", "LAG"]
+		std::vector<AggregateKind> aggs_wind_func;     // [AggregateKind::MIN, AggregateKind::LAG]
+	};
+
 	std::unique_ptr<CudfColumn> compute_column_from_window_function(
+		const window_clause & clause,
 		cudf::table_view input_cudf_view,
 		cudf::column_view input_col_view,
 		std::size_t pos, int & agg_param_count);
@@ -38,16 +108,9 @@ public:
 	kstatus run() override;
 
 private:
-	// LogicalComputeWindow(min_keys=[MIN($0) OVER (PARTITION BY $1 ORDER BY $3 DESC)], lag_col=[LAG($0, 5) OVER (PARTITION BY $1)], n_name=[$2])
-	std::vector<int> column_indices_partitioned;   // column indices to be partitioned: [1]
-	std::vector<int> column_indices_ordered;   	   // column indices to be ordered: [3]
-	std::vector<int> column_indices_to_agg;        // column indices to be agg: [0, 0]
-	std::vector<int> agg_param_values;     		   // due to LAG or LEAD: [5]
-	int preceding_value;     	                   // X PRECEDING
-	int following_value;     		               // Y FOLLOWING
-	std::string frame_type;                        // ROWS or RANGE
-	std::vector<std::string> type_aggs_as_str;     // ["MIN", "LAG"]
-	std::vector<AggregateKind> aggs_wind_func;     // [AggregateKind::MIN, AggregateKind::LAG]
+	// Batches come sorted by the first clause, the rows are sorted by every other clause before computing it
+	std::vector<window_clause> clauses;
+	std::size_t num_window_columns = 0;
 };
 
 } // namespace batch
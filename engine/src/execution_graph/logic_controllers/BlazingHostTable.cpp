@@ -10,18 +10,27 @@ namespace frame {
 
 BlazingHostTable::BlazingHostTable(const std::vector<ColumnTransport> &columns_offsets,
             std::vector<ral::memory::blazing_chunked_column_info> && chunked_column_infos,
-            std::vector<std::unique_ptr<ral::memory::blazing_allocation_chunk>> && allocations)
-        : columns_offsets{columns_offsets}, chunked_column_infos{std::move(chunked_column_infos)}, allocations{std::move(allocations)} {
+            std::vector<std::unique_ptr<ral::memory::blazing_allocation_chunk>> && allocations,
+            std::shared_ptr<void> external_data)
+        : columns_offsets{columns_offsets}, chunked_column_infos{std::move(chunked_column_infos)}, allocations{std::move(allocations)}, external_data{external_data} {
 
-    auto size = sizeInBytes();
-    blazing_host_memory_resource::getInstance().allocate(size); // this only increments the memory usage counter for the host memory. This does not actually allocate
+    if (!this->external_data) {
+        auto size = sizeInBytes();
+        blazing_host_memory_resource::getInstance().allocate(size); // this only increments the memory usage counter for the host memory. This does not actually allocate
+    }
 
 }
 
 BlazingHostTable::~BlazingHostTable() {
-    auto size = sizeInBytes();
-    blazing_host_memory_resource::getInstance().deallocate(size); // this only decrements the memory usage counter for the host memory. This does not actually allocate
+    if (!external_data) {
+        auto size = sizeInBytes();
+        blazing_host_memory_resource::getInstance().deallocate(size); // this only decrements the memory usage counter for the host memory. This does not actually allocate
+    }
     for(auto i = 0; i < allocations.size(); i++){
+        // the chunks without an allocation belong to external_data
+        if (allocations[i]->allocation == nullptr) {
+            continue;
+        }
         auto pool = allocations[i]->allocation->pool;
         pool->free_chunk(std::move(allocations[i]));
     }
@@ -23,9 +23,15 @@ class BlazingTable;  // forward declaration
 class BlazingHostTable {
 public:
 
+    /**
+        @param external_data Keeps alive the memory of the chunks that were not taken from the
+        buffer pools (the ones without an allocation), like the buffers of an Arrow table that
+        are wrapped without copying them. That memory is not counted as used by the host memory resource.
+    */
     BlazingHostTable(const std::vector<ColumnTransport> &columns_offsets,
         std::vector<ral::memory::blazing_chunked_column_info> && chunked_column_infos,
-        std::vector<std::unique_ptr<ral::memory::blazing_allocation_chunk>> && allocations);
+        std::vector<std::unique_ptr<ral::memory::blazing_allocation_chunk>> && allocations,
+        std::shared_ptr<void> external_data = nullptr);
 
     ~BlazingHostTable();
 
@@ -57,6 +63,7 @@ private:
     std::vector<ColumnTransport> columns_offsets;
     std::vector<ral::memory::blazing_chunked_column_info> chunked_column_infos;
     std::vector<std::unique_ptr<ral::memory::blazing_allocation_chunk>> allocations;
+    std::shared_ptr<void> external_data;
 
     
     size_t part_id;
@@ -4,6 +4,7 @@
 #include <utilities/CommonOperations.h>
 #include <cudf/io/orc.hpp>
 #include "CalciteExpressionParsing.h"
+#include "LogicalFilter.h"
 #include "communication/CommunicationData.h"
 #include <Util/StringUtil.h>
 #include <stdio.h>
@@ -222,11 +223,12 @@ CacheDataIO::CacheDataIO(ral::io::data_handle handle,
 	ral::io::Schema schema,
 	ral::io::Schema file_schema,
 	std::vector<int> row_group_ids,
-	std::vector<int> projections)
+	std::vector<int> projections,
+	size_t estimated_bytes)
 	: CacheData(CacheDataType::IO_FILE, schema.get_names(), schema.get_data_types(), 1),
 	handle(handle), parser(parser), schema(schema),
 	file_schema(file_schema), row_group_ids(row_group_ids),
-	projections(projections)
+	projections(projections), estimated_bytes(estimated_bytes)
 	{
 
 	}
@@ -235,8 +237,64 @@ size_t CacheDataIO::sizeInBytes() const{
 	return 0;
 }
 
+std::unique_ptr<ral::frame::BlazingTable> CacheDataIO::decache_late_materialized(){
+	std::vector<bool> is_filter_column(projections.size(), false);
+	std::vector<int> filter_column_indices;
+	for (int position : filter_positions){
+		is_filter_column[position] = true;
+		filter_column_indices.push_back(projections[position]);
+	}
+	std::vector<int> other_column_indices;
+	for(std::size_t i = 0; i < projections.size(); i++) {
+		if (!is_filter_column[i]) {
+			other_column_indices.push_back(projections[i]);
+		}
+	}
+
+	std::unique_ptr<ral::frame::BlazingTable> filter_table = parser->parse_batch(handle, file_schema, filter_column_indices, row_group_ids);
+	if (filter_table->num_rows() == 0) {
+		return file_schema.makeEmptyBlazingTable(projections);
+	}
+	std::unique_ptr<ral::frame::BlazingColumn> bool_values = ral::processor::evaluate_filter(filter_table->toBlazingTableView(), *filter_programs);
+	std::unique_ptr<ral::frame::BlazingTable> selected_filter_table = ral::processor::applyBooleanFilter(filter_table->toBlazingTableView(), bool_values->view());
+	filter_table.reset();
+	if (selected_filter_table->num_rows() == 0) {
+		return file_schema.makeEmptyBlazingTable(projections);
+	}
+
+	std::unique_ptr<ral::frame::BlazingTable> other_table = parser->parse_batch(handle, file_schema, other_column_indices, row_group_ids);
+	RAL_EXPECTS(other_table->num_rows() == bool_values->view().size(), "Columns of the same row groups have a different number of rows");
+	std::unique_ptr<ral::frame::BlazingTable> selected_other_table = ral::processor::applyBooleanFilter(other_table->toBlazingTableView(), bool_values->view());
+	other_table.reset();
+
+	std::vector<std::string> filter_names = selected_filter_table->names();
+	std::vector<std::string> other_names = selected_other_table->names();
+	std::vector<std::unique_ptr<cudf::column>> filter_columns = selected_filter_table->releaseCudfTable()->release();
+	std::vector<std::unique_ptr<cudf::column>> other_columns = selected_other_table->releaseCudfTable()->release();
+
+	std::vector<std::unique_ptr<cudf::column>> all_columns(projections.size());
+	std::vector<std::string> names(projections.size());
+	std::size_t filter_column_counter = 0;
+	std::size_t other_column_counter = 0;
+	for(std::size_t i = 0; i < projections.size(); i++) {
+		if (is_filter_column[i]) {
+			names[i] = filter_names[filter_column_counter];
+			all_columns[i] = std::move(filter_columns[filter_column_counter]);
+			filter_column_counter++;
+		} else {
+			names[i] = other_names[other_column_counter];
+			all_columns[i] = std::move(other_columns[other_column_counter]);
+			other_column_counter++;
+		}
+	}
+	auto unique_table = std::make_unique<cudf::table>(std::move(all_columns));
+	return std::make_unique<ral::frame::BlazingTable>(std::move(unique_table), names);
+}
+
 std::unique_ptr<ral::frame::BlazingTable> CacheDataIO::decache(){
-	if (schema.all_in_file()){
+	if (filter_programs && schema.all_in_file()){
+		return decache_late_materialized();
+	} else if (schema.all_in_file()){
 		std::unique_ptr<ral::frame::BlazingTable> loaded_table = parser->parse_batch(handle, file_schema, projections, row_group_ids);
 		return loaded_table;
 	} else {
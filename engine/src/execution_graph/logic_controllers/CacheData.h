@@ -26,6 +26,10 @@
 using namespace std::chrono_literals;
 
 namespace ral {
+namespace processor {
+class expression_program_cache;
+}  // namespace processor
+
 namespace cache {
 
 using Context = blazingdb::manager::Context;
@@ -51,6 +55,8 @@ const std::string WORKER_IDS_METADATA_LABEL = "worker_ids"; /**< A message metad
 const std::string TOTAL_TABLE_ROWS_METADATA_LABEL = "total_table_rows"; /**< A message metadata field that indicates how many rows are in this message. */
 const std::string JOIN_LEFT_BYTES_METADATA_LABEL = "join_left_bytes_metadata_label"; /**< A message metadata field that indicates how many bytes were found in a left table for join scheduling.  */
 const std::string JOIN_RIGHT_BYTES_METADATA_LABEL = "join_right_bytes_metadata_label"; /**< A message metadata field that indicates how many bytes were found in a right table for join scheduling.  */
+const std::string RUNTIME_JOIN_FILTER_VALID_METADATA_LABEL = "runtime_join_filter_valid"; /**< A message metadata field that indicates if the node could build a runtime join filter with all its build side. */
+const std::string JOIN_SKEW_ESTIMATED_ROWS_METADATA_LABEL = "join_skew_estimated_rows"; /**< A message metadata field that indicates how many rows a node estimates for the join side it sampled. */
 const std::string AVG_BYTES_PER_ROW_METADATA_LABEL = "avg_bytes_per_row"; /** < A message metadata field that indicates the average of bytes per row. */
 const std::string MESSAGE_ID = "message_id"; /**< A message metadata field that indicates the id of a message. Not all messages have an id. Any message that has add_to_specific_cache == false MUST have a message id. */
 const std::string PARTITION_COUNT = "partition_count"; /**< A message metadata field that indicates the number of partitions a kernel processed.  */
@@ -487,7 +493,8 @@ public:
 	 	ral::io::Schema schema,
 		ral::io::Schema file_schema,
 		std::vector<int> row_group_ids,
-		std::vector<int> projections
+		std::vector<int> projections,
+		size_t estimated_bytes = 0
 		 );
 
 	/**
@@ -507,6 +514,27 @@ public:
  	*/
 	size_t sizeInBytes() const override;
 
+	/**
+	* Get the size the decached BlazingTable is expected to have, estimated from
+	* the file metadata when the scan was planned.
+	* @return The estimated number of bytes, 0 if unknown.
+	*/
+	size_t estimatedSizeInBytes() const { return estimated_bytes; }
+
+	/**
+	* Makes decache() load the columns read by a filter first, and the other
+	* columns only for the rows that pass it. The decached table only has
+	* those rows. Nothing else is loaded when no row passes.
+	* Only used when all the projected columns are in the file.
+	* @param filter_programs The filter, over a table with only the columns it reads.
+	* @param filter_positions The positions in the projections of the columns the filter reads.
+	*/
+	void set_late_materialization_filter(std::shared_ptr<ral::processor::expression_program_cache> filter_programs,
+		const std::vector<int> & filter_positions) {
+		this->filter_programs = filter_programs;
+		this->filter_positions = filter_positions;
+	}
+
 	/**
 	* Set the names of the columns from the schema.
 	* @param names a vector of the column names.
@@ -527,7 +555,12 @@ private:
 	ral::io::Schema schema;
 	ral::io::Schema file_schema;
 	std::vector<int> row_group_ids;
+	std::unique_ptr<ral::frame::BlazingTable> decache_late_materialized();
+
 	std::vector<int> projections;
+	size_t estimated_bytes;
+	std::shared_ptr<ral::processor::expression_program_cache> filter_programs;
+	std::vector<int> filter_positions;
 };
 
 class ConcatCacheData : public CacheData {
@@ -1,9 +1,12 @@
 #include <spdlog/spdlog.h>
 #include <cudf/stream_compaction.hpp>
 #include <cudf/copying.hpp>
+#include <map>
+#include <set>
 #include "LogicalFilter.h"
 #include "LogicalProject.h"
 #include "parser/expression_utils.hpp"
+#include "parser/expression_tree.hpp"
 #include "error.hpp"
 
 namespace ral {
@@ -17,6 +20,32 @@ const std::string LEFT_JOIN = "left";
 const std::string RIGHT_JOIN = "right";
 const std::string OUTER_JOIN = "full";
 
+struct variable_index_visitor : public ral::parser::node_visitor {
+  void visit(const ral::parser::operad_node& node) override {
+    if (node.type == ral::parser::node_type::VARIABLE) {
+      indices.insert(static_cast<const ral::parser::variable_node&>(node).index());
+    }
+  }
+  void visit(const ral::parser::operator_node& /*node*/) override {}
+
+  std::set<int> indices;
+};
+
+struct variable_index_transformer : public ral::parser::node_transformer {
+  explicit variable_index_transformer(const std::map<int, int> & new_indices) : new_indices{new_indices} {}
+
+  ral::parser::node * transform(ral::parser::operad_node& node) override {
+    if (node.type == ral::parser::node_type::VARIABLE) {
+      int index = static_cast<ral::parser::variable_node&>(node).index();
+      return new ral::parser::variable_node("$" + std::to_string(new_indices.at(index)));
+    }
+    return &node;
+  }
+  ral::parser::node * transform(ral::parser::operator_node& node) override { return &node; }
+
+  const std::map<int, int> & new_indices;
+};
+
 } // namespace
 
 bool is_logical_filter(const std::string & query_part) {
@@ -32,25 +61,66 @@ std::unique_ptr<ral::frame::BlazingTable> applyBooleanFilter(
     filteredTable),table.names());
 }
 
+std::string get_filter_expression(const std::string & query_part) {
+  std::string conditional_expression = get_named_expression(query_part, "condition");
+	if(conditional_expression.empty()) {
+		conditional_expression = get_named_expression(query_part, "filters");
+	}
+  return conditional_expression;
+}
+
 std::unique_ptr<ral::frame::BlazingTable> process_filter(
   const ral::frame::BlazingTableView & table_view,
   const std::string & query_part,
   blazingdb::manager::Context * /*context*/) {
 
-	if(table_view.num_rows() == 0) {
-		return std::make_unique<ral::frame::BlazingTable>(cudf::empty_like(table_view.view()), table_view.names());
-	}
+  expression_program_cache programs({get_filter_expression(query_part)});
+  return process_filter(table_view, programs);
+}
 
-  std::string conditional_expression = get_named_expression(query_part, "condition");
-	if(conditional_expression.empty()) {
-		conditional_expression = get_named_expression(query_part, "filters");
-	}
+std::unique_ptr<ral::frame::BlazingColumn> evaluate_filter(
+  const ral::frame::BlazingTableView & table_view,
+  expression_program_cache & programs) {
 
-  std::vector<std::unique_ptr<ral::frame::BlazingColumn>> evaluated_table = evaluate_expressions(table_view.view(), {conditional_expression});
+  std::shared_ptr<expression_program> program = programs.get(table_view.view());
+  std::vector<std::unique_ptr<ral::frame::BlazingColumn>> evaluated_table = program->evaluate(table_view.view());
 
   RAL_EXPECTS(evaluated_table.size() == 1 && evaluated_table[0]->view().type().id() == cudf::type_id::BOOL8, "Expression does not evaluate to a boolean mask");
 
-  return applyBooleanFilter(table_view, evaluated_table[0]->view());
+  return std::move(evaluated_table[0]);
+}
+
+std::vector<int> get_filter_column_indices(const std::string & condition) {
+  ral::parser::parse_tree tree;
+  tree.build(condition);
+  variable_index_visitor visitor;
+  tree.visit(visitor);
+  return std::vector<int>(visitor.indices.begin(), visitor.indices.end());
+}
+
+std::string remap_filter_columns(const std::string & condition, const std::vector<int> & column_indices) {
+  std::map<int, int> new_indices;
+  for (size_t i = 0; i < column_indices.size(); i++) {
+    new_indices[column_indices[i]] = i;
+  }
+
+  ral::parser::parse_tree tree;
+  tree.build(condition);
+  variable_index_transformer transformer(new_indices);
+  tree.transform(transformer);
+  return tree.rebuildExpression();
+}
+
+std::unique_ptr<ral::frame::BlazingTable> process_filter(
+  const ral::frame::BlazingTableView & table_view,
+  expression_program_cache & programs) {
+
+	if(table_view.num_rows() == 0) {
+		return std::make_unique<ral::frame::BlazingTable>(cudf::empty_like(table_view.view()), table_view.names());
+	}
+
+  std::unique_ptr<ral::frame::BlazingColumn> bool_values = evaluate_filter(table_view, programs);
+  return applyBooleanFilter(table_view, bool_values->view());
 }
 
 
@@ -2,6 +2,7 @@
 
 #include <execution_graph/Context.h>
 #include "LogicPrimitives.h"
+#include "LogicalProject.h"
 
 namespace ral{
 namespace processor{
@@ -15,11 +16,41 @@ std::unique_ptr<ral::frame::BlazingTable> applyBooleanFilter(
   const ral::frame::BlazingTableView & table,
   const CudfColumnView & boolValues);
 
+/**
+ * @brief Returns the condition of a LogicalFilter or the filters of a BindableTableScan
+ */
+std::string get_filter_expression(const std::string & query_part);
+
 std::unique_ptr<ral::frame::BlazingTable> process_filter(
   const ral::frame::BlazingTableView & table,
   const std::string & query_part,
   blazingdb::manager::Context * context);
 
+/**
+ * @brief Evaluates a filter condition into a BOOL8 column, reusing the program compiled for it
+ */
+std::unique_ptr<ral::frame::BlazingColumn> evaluate_filter(
+  const ral::frame::BlazingTableView & table,
+  expression_program_cache & programs);
+
+/**
+ * @brief Returns the sorted indices of the columns a condition reads
+ */
+std::vector<int> get_filter_column_indices(const std::string & condition);
+
+/**
+ * @brief Rewrites a condition so it reads its columns from a table that only has the columns
+ * column_indices, in that order. Every column the condition reads must be in column_indices.
+ */
+std::string remap_filter_columns(const std::string & condition, const std::vector<int> & column_indices);
+
+/**
+ * @brief Applies a filter reusing the program compiled for its condition
+ */
+std::unique_ptr<ral::frame::BlazingTable> process_filter(
+  const ral::frame::BlazingTableView & table,
+  expression_program_cache & programs);
+
 bool check_if_has_nulls(CudfTableView const& input, std::vector<cudf::size_type> const& keys);
 
 /**
@@ -1,5 +1,8 @@
 #include <spdlog/spdlog.h>
+#include <regex>
 #include <cudf/copying.hpp>
+#include <cudf/null_mask.hpp>
+#include <cudf/utilities/traits.hpp>
 #include <cudf/replace.hpp>
 #include <cudf/strings/capitalize.hpp>
 #include <cudf/strings/combine.hpp>
@@ -18,6 +21,7 @@
 #include "LogicalProject.h"
 #include "utilities/transform.hpp"
 #include "Interpreter/interpreter_cpp.h"
+#include "Interpreter/interpreter_cpu.h"
 #include "parser/expression_utils.hpp"
 
 namespace ral {
@@ -708,6 +712,7 @@ public:
             // Replace the operator node with its corresponding result
             std::string computed_var_token = "$" + std::to_string(table.num_columns() + computed_columns.size());
             computed_columns.push_back(std::move(computed_col));
+            evaluated_any_ = true;
 
             return new parser::variable_node(computed_var_token);
         }
@@ -725,9 +730,13 @@ public:
 
     std::vector<std::unique_ptr<cudf::column>> release_computed_columns() { return std::move(computed_columns); }
 
+    // Returns true if any node was evaluated outside of the interpreter
+    bool evaluated_any() const { return evaluated_any_; }
+
 private:
     cudf::table_view table;
     std::vector<std::unique_ptr<cudf::column>> computed_columns;
+    bool evaluated_any_ = false;
 };
 
 /**
@@ -782,16 +791,204 @@ private:
 	cudf::table_view table_;
 };
 
-std::vector<std::unique_ptr<ral::frame::BlazingColumn>> evaluate_expressions(
-    const cudf::table_view & table,
-    const std::vector<std::string> & expressions) {
-    using interops::column_index_type;
+// BEGIN expression_program
+
+namespace {
+
+bool can_run_on_cpu(const interops::interpreter_plan & plan, const cudf::table_view & input_table, const cudf::mutable_table_view & out_table) {
+    std::vector<cudf::data_type> input_types;
+    for (auto && column : input_table) {
+        if (!cudf::is_fixed_width(column.type())) {
+            return false;
+        }
+        input_types.push_back(column.type());
+    }
+
+    std::vector<cudf::data_type> output_types;
+    for (auto && column : out_table) {
+        if (!cudf::is_fixed_width(column.type())) {
+            return false;
+        }
+        output_types.push_back(column.type());
+    }
+
+    return interops::can_perform_interpreter_operation_cpu(plan, input_types, output_types);
+}
+
+/**
+ * @brief Copies the inputs of the plan to the host, evaluates it with the CPU
+ * interpreter and copies the results back to the output columns
+ */
+void run_on_cpu(const interops::interpreter_plan & plan, const cudf::table_view & input_table, const cudf::mutable_table_view & out_table, cudf::size_type num_rows) {
+    size_t num_mask_words = cudf::bitmask_allocation_size_bytes(num_rows) / sizeof(cudf::bitmask_type);
+
+    std::vector<std::vector<char>> input_data(input_table.num_columns());
+    std::vector<std::vector<cudf::bitmask_type>> input_masks(input_table.num_columns());
+    std::vector<interops::host_column_view> host_inputs;
+    for (cudf::size_type i = 0; i < input_table.num_columns(); i++) {
+        const cudf::column_view & column = input_table.column(i);
+        input_data[i].resize(num_rows * cudf::size_of(column.type()));
+        CUDA_TRY(cudaMemcpy(input_data[i].data(), column.data<char>(), input_data[i].size(), cudaMemcpyDeviceToHost));
+
+        const cudf::bitmask_type * null_mask = nullptr;
+        if (column.nullable()) {
+            // copy_bitmask rebases the mask of a sliced column to start at bit 0
+            rmm::device_buffer mask = cudf::copy_bitmask(column);
+            input_masks[i].resize(num_mask_words);
+            CUDA_TRY(cudaMemcpy(input_masks[i].data(), mask.data(), num_mask_words * sizeof(cudf::bitmask_type), cudaMemcpyDeviceToHost));
+            null_mask = input_masks[i].data();
+        }
+        host_inputs.push_back({column.type(), input_data[i].data(), null_mask});
+    }
+
+    std::vector<std::vector<char>> out_data(out_table.num_columns());
+    std::vector<std::vector<cudf::bitmask_type>> out_masks(out_table.num_columns());
+    std::vector<interops::host_mutable_column_view> host_outputs;
+    for (cudf::size_type i = 0; i < out_table.num_columns(); i++) {
+        const cudf::mutable_column_view & column = out_table.column(i);
+        out_data[i].resize(num_rows * cudf::size_of(column.type()));
+        cudf::bitmask_type * null_mask = nullptr;
+        if (column.nullable()) {
+            out_masks[i].resize(num_mask_words);
+            null_mask = out_masks[i].data();
+        }
+        host_outputs.push_back({column.type(), out_data[i].data(), null_mask});
+    }
+
+    interops::perform_interpreter_operation_cpu(host_outputs, host_inputs, plan, num_rows);
+
+    for (cudf::size_type i = 0; i < out_table.num_columns(); i++) {
+        const cudf::mutable_column_view & column = out_table.column(i);
+        CUDA_TRY(cudaMemcpy(column.data<char>(), out_data[i].data(), out_data[i].size(), cudaMemcpyHostToDevice));
+        if (column.nullable()) {
+            CUDA_TRY(cudaMemcpy(column.null_mask(), out_masks[i].data(), num_mask_words * sizeof(cudf::bitmask_type), cudaMemcpyHostToDevice));
+        }
+    }
+}
+
+} // namespace
+
+expression_program::expression_program(const std::vector<std::string> & expressions, const cudf::table_view & table, cudf::size_type cpu_max_rows)
+    : cpu_max_rows_{cpu_max_rows} {
+    input_types_.reserve(table.num_columns());
+    for(cudf::size_type i = 0; i < table.num_columns(); i++) {
+        input_types_.push_back(table.column(i).type());
+    }
 
     // Let's clean all the expressions that contains Window functions (if exists)
     // as they should be updated with new indices
-    std::vector<std::string> new_expressions = clean_window_function_expressions(expressions, table.num_columns());
+    expressions_ = clean_window_function_expressions(expressions, table.num_columns());
+
+    expr_trees_.reserve(expressions_.size());
+    for(size_t i = 0; i < expressions_.size(); i++){
+        std::string expression = replace_calcite_regex(expressions_[i]);
+        expression = expand_if_logical_op(expression);
+
+        parser::parse_tree tree;
+        tree.build(expression);
+
+        // Transform the expression tree to use the custom operators, this doesn't
+        // depend on the input data so it is done only once
+        tree.transform_to_custom_op();
+
+        expr_trees_.emplace_back(std::move(tree));
+    }
+}
+
+bool expression_program::matches(const cudf::table_view & table) const {
+    if (static_cast<size_t>(table.num_columns()) != input_types_.size()) {
+        return false;
+    }
+
+    for(cudf::size_type i = 0; i < table.num_columns(); i++) {
+        if (!(table.column(i).type() == input_types_[i])) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+bool expression_program::is_compiled() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return plan_ != nullptr;
+}
+
+std::vector<std::unique_ptr<ral::frame::BlazingColumn>> expression_program::evaluate(const cudf::table_view & table) {
+    std::shared_ptr<const compiled_plan> plan;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        plan = plan_;
+    }
+
+    if (plan) {
+        return evaluate_compiled(*plan, table);
+    }
+
+    return evaluate_and_compile(table);
+}
+
+std::vector<std::unique_ptr<ral::frame::BlazingColumn>> expression_program::evaluate_compiled(const compiled_plan & plan, const cudf::table_view & table) const {
+    std::vector<std::unique_ptr<ral::frame::BlazingColumn>> out_columns(plan.slots.size());
+    std::vector<cudf::mutable_column_view> interpreter_out_column_views;
+
+    for(size_t i = 0; i < plan.slots.size(); i++){
+        const output_slot & slot = plan.slots[i];
+        if (slot.kind == output_kind::LITERAL) {
+            out_columns[i] = std::make_unique<ral::frame::BlazingColumnOwner>(cudf::make_column_from_scalar(*slot.literal, table.num_rows()));
+        } else if (slot.kind == output_kind::INPUT_COLUMN) {
+            out_columns[i] = std::make_unique<ral::frame::BlazingColumnOwner>(std::make_unique<cudf::column>(table.column(slot.column_index)));
+        } else {
+            auto new_column = cudf::make_fixed_width_column(slot.type, table.num_rows(), cudf::mask_state::UNINITIALIZED);
+            interpreter_out_column_views.push_back(new_column->mutable_view());
+            out_columns[i] = std::make_unique<ral::frame::BlazingColumnOwner>(std::move(new_column));
+        }
+    }
+
+    run_sub_plans(plan.sub_plans, table.select(plan.input_col_indices), interpreter_out_column_views, table.num_rows(), cpu_max_rows_);
+
+    return std::move(out_columns);
+}
+
+void expression_program::run_sub_plans(const std::vector<compiled_sub_plan> & sub_plans,
+    const cudf::table_view & interops_input_table,
+    const std::vector<cudf::mutable_column_view> & interpreter_out_column_views,
+    cudf::size_type num_rows,
+    cudf::size_type cpu_max_rows) {
+    for (auto && compiled : sub_plans) {
+        const interops::interpreter_sub_plan & sub_plan = compiled.sub_plan;
+
+        std::vector<cudf::mutable_column_view> out_column_views;
+        for (auto idx : sub_plan.final_output_indices) {
+            out_column_views.push_back(interpreter_out_column_views[idx]);
+        }
+        cudf::mutable_table_view out_table_view(out_column_views);
+
+        if (num_rows <= cpu_max_rows && can_run_on_cpu(sub_plan.plan, interops_input_table.select(sub_plan.input_indices), out_table_view)) {
+            run_on_cpu(sub_plan.plan, interops_input_table.select(sub_plan.input_indices), out_table_view, num_rows);
+            continue;
+        }
+
+        interops::perform_interpreter_operation(out_table_view,
+                                                interops_input_table.select(sub_plan.input_indices),
+                                                sub_plan.plan.left_inputs,
+                                                sub_plan.plan.right_inputs,
+                                                sub_plan.plan.outputs,
+                                                sub_plan.plan.final_output_positions,
+                                                sub_plan.plan.operators,
+                                                compiled.left_scalars,
+                                                compiled.right_scalars,
+                                                num_rows);
+    }
+}
 
-    std::vector<std::unique_ptr<ral::frame::BlazingColumn>> out_columns(new_expressions.size());
+std::vector<std::unique_ptr<ral::frame::BlazingColumn>> expression_program::evaluate_and_compile(const cudf::table_view & table) {
+    using interops::column_index_type;
+
+    auto plan = std::make_shared<compiled_plan>();
+    plan->slots.resize(expr_trees_.size());
+
+    std::vector<std::unique_ptr<ral::frame::BlazingColumn>> out_columns(expr_trees_.size());
 
     std::vector<bool> column_used(table.num_columns(), false);
     std::vector<std::pair<int, int>> out_idx_computed_idx_pair;
@@ -800,25 +997,26 @@ std::vector<std::unique_ptr<ral::frame::BlazingColumn>> evaluate_expressions(
     std::vector<cudf::mutable_column_view> interpreter_out_column_views;
 
     function_evaluator_transformer evaluator{table};
-    for(size_t i = 0; i < new_expressions.size(); i++){
-        std::string expression = replace_calcite_regex(new_expressions[i]);
-        expression = expand_if_logical_op(expression);
-
-        parser::parse_tree tree;
-        tree.build(expression);
+    for(size_t i = 0; i < expr_trees_.size(); i++){
+        parser::parse_tree tree = expr_trees_[i].clone();
 
         // Transform the expression tree so that only nodes that can be evaluated
         // by the interpreter remain
-        tree.transform_to_custom_op();
         tree.transform(evaluator);
 
+        output_slot & slot = plan->slots[i];
         if (tree.root().type == parser::node_type::LITERAL) {
             cudf::data_type literal_type = static_cast<const ral::parser::literal_node&>(tree.root()).type();
-            std::unique_ptr<cudf::scalar> literal_scalar = get_scalar_from_string(tree.root().value, literal_type);
-            out_columns[i] = std::make_unique<ral::frame::BlazingColumnOwner>(cudf::make_column_from_scalar(*literal_scalar, table.num_rows()));
+            slot.kind = output_kind::LITERAL;
+            slot.type = literal_type;
+            slot.literal = get_scalar_from_string(tree.root().value, literal_type);
+            out_columns[i] = std::make_unique<ral::frame::BlazingColumnOwner>(cudf::make_column_from_scalar(*slot.literal, table.num_rows()));
         } else if (tree.root().type == parser::node_type::VARIABLE) {
             cudf::size_type idx = static_cast<const ral::parser::variable_node&>(tree.root()).index();
             if (idx < table.num_columns()) {
+                slot.kind = output_kind::INPUT_COLUMN;
+                slot.column_index = idx;
+                slot.type = table.column(idx).type();
                 out_columns[i] = std::make_unique<ral::frame::BlazingColumnOwner>(std::make_unique<cudf::column>(table.column(idx)));
             } else {
                 out_idx_computed_idx_pair.push_back({i, idx - table.num_columns()});
@@ -828,6 +1026,8 @@ std::vector<std::unique_ptr<ral::frame::BlazingColumn>> evaluate_expressions(
 	        tree.visit(visitor);
 
             cudf::data_type expr_out_type = visitor.get_expr_output_type();
+            slot.kind = output_kind::INTERPRETER;
+            slot.type = expr_out_type;
 
             auto new_column = cudf::make_fixed_width_column(expr_out_type, table.num_rows(), cudf::mask_state::UNINITIALIZED);
             interpreter_out_column_views.push_back(new_column->mutable_view());
@@ -851,7 +1051,7 @@ std::vector<std::unique_ptr<ral::frame::BlazingColumn>> evaluate_expressions(
 
     // Get the needed columns indices in order and keep track of the mapped indices
     std::map<column_index_type, column_index_type> col_idx_map;
-    std::vector<cudf::size_type> input_col_indices;
+    std::vector<cudf::size_type> & input_col_indices = plan->input_col_indices;
     for(size_t i = 0; i < column_used.size(); i++) {
         if(column_used[i]) {
             col_idx_map.insert({i, col_idx_map.size()});
@@ -873,71 +1073,65 @@ std::vector<std::unique_ptr<ral::frame::BlazingColumn>> evaluate_expressions(
 
     cudf::table_view interops_input_table{{table.select(input_col_indices), cudf::table_view{filtered_computed_views}}};
 
-    std::vector<column_index_type> left_inputs;
-    std::vector<column_index_type> right_inputs;
-    std::vector<column_index_type> outputs;
-    std::vector<column_index_type> final_output_positions;
-    std::vector<operator_type> operators;
-    std::vector<std::unique_ptr<cudf::scalar>> left_scalars;
-    std::vector<std::unique_ptr<cudf::scalar>> right_scalars;
-
+    // Encode the simple operations of all the expressions in a single plan, so
+    // common subexpressions are evaluated once, and split it if it needs more
+    // positions than the interpreter supports
+    interops::interpreter_plan interpreter_plan;
+    interpreter_plan.num_inputs = interops_input_table.num_columns();
     for (size_t i = 0; i < expr_tree_vector.size(); i++) {
-        final_output_positions.push_back(interops_input_table.num_columns() + i);
-
-        interops::add_expression_to_interpreter_plan(expr_tree_vector[i],
-                                                    col_idx_map,
-                                                    interops_input_table.num_columns() + interpreter_out_column_views.size(),
-                                                    interops_input_table.num_columns() + i,
-                                                    left_inputs,
-                                                    right_inputs,
-                                                    outputs,
-                                                    operators,
-                                                    left_scalars,
-                                                    right_scalars);
-    }
-
-    // TODO: Find a proper solution for plan with input or output index greater than 63
-	auto max_left_it = std::max_element(left_inputs.begin(), left_inputs.end());
-	auto max_right_it = std::max_element(right_inputs.begin(), right_inputs.end());
-	auto max_out_it = std::max_element(outputs.begin(), outputs.end());
-    if (!expr_tree_vector.empty() && std::max(std::max(*max_left_it, *max_right_it), *max_out_it) >= 64) {
-        out_columns.clear();
-        computed_columns.clear();
-
-        size_t const half_size = new_expressions.size() / 2;
-        std::vector<std::string> split_lo(new_expressions.begin(), new_expressions.begin() + half_size);
-        std::vector<std::string> split_hi(new_expressions.begin() + half_size, new_expressions.end());
-        auto out_cols_lo = evaluate_expressions(table, split_lo);
-        auto out_cols_hi = evaluate_expressions(table, split_hi);
-
-        std::move(out_cols_hi.begin(), out_cols_hi.end(), std::back_inserter(out_cols_lo));
-        return std::move(out_cols_lo);
-    }
-    // END
-
-    if(!expr_tree_vector.empty()){
-        cudf::mutable_table_view out_table_view(interpreter_out_column_views);
+        interops::add_expression_to_plan(expr_tree_vector[i], col_idx_map, interpreter_plan);
+    }
 
-        interops::perform_interpreter_operation(out_table_view,
-                                                interops_input_table,
-                                                left_inputs,
-                                                right_inputs,
-                                                outputs,
-                                                final_output_positions,
-                                                operators,
-                                                left_scalars,
-                                                right_scalars,
-                                                table.num_rows());
+    for (auto && sub_plan : interops::split_plan(interpreter_plan)) {
+        compiled_sub_plan compiled;
+        interops::make_plan_scalars(sub_plan.plan, compiled.left_scalars, compiled.right_scalars);
+        compiled.sub_plan = std::move(sub_plan);
+        plan->sub_plans.push_back(std::move(compiled));
+    }
+
+    run_sub_plans(plan->sub_plans, interops_input_table, interpreter_out_column_views, table.num_rows(), cpu_max_rows_);
+
+    // Columns computed outside of the interpreter belong to this batch, so the
+    // plan can only be reused when every node was handled by the interpreter
+    if (!evaluator.evaluated_any()) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!plan_) {
+            plan_ = std::move(plan);
+        }
     }
 
     return std::move(out_columns);
 }
 
-std::unique_ptr<ral::frame::BlazingTable> process_project(
-  std::unique_ptr<ral::frame::BlazingTable> blazing_table_in,
-  const std::string & query_part,
-  blazingdb::manager::Context * /*context*/) {
+// END expression_program
+
+// BEGIN expression_program_cache
+
+expression_program_cache::expression_program_cache(const std::vector<std::string> & expressions, cudf::size_type cpu_max_rows)
+    : expressions_{expressions}, cpu_max_rows_{cpu_max_rows} {}
+
+std::shared_ptr<expression_program> expression_program_cache::get(const cudf::table_view & table) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (auto && program : programs_) {
+        if (program->matches(table)) {
+            return program;
+        }
+    }
+
+    programs_.push_back(std::make_shared<expression_program>(expressions_, table, cpu_max_rows_));
+    return programs_.back();
+}
+
+// END expression_program_cache
+
+std::vector<std::unique_ptr<ral::frame::BlazingColumn>> evaluate_expressions(
+    const cudf::table_view & table,
+    const std::vector<std::string> & expressions) {
+    expression_program program(expressions, table);
+    return program.evaluate(table);
+}
 
+std::pair<std::vector<std::string>, std::vector<std::string>> get_project_expressions_and_names(const std::string & query_part) {
     std::string combined_expression = get_query_part(query_part);
 
     std::vector<std::string> named_expressions = get_expressions_from_expression_list(combined_expression);
@@ -954,8 +1148,30 @@ std::unique_ptr<ral::frame::BlazingTable> process_project(
         out_column_names[i] = name;
     }
 
+    return std::make_pair(std::move(expressions), std::move(out_column_names));
+}
+
+std::unique_ptr<ral::frame::BlazingTable> process_project(
+  std::unique_ptr<ral::frame::BlazingTable> blazing_table_in,
+  const std::string & query_part,
+  blazingdb::manager::Context * /*context*/) {
+
+    std::vector<std::string> expressions;
+    std::vector<std::string> out_column_names;
+    std::tie(expressions, out_column_names) = get_project_expressions_and_names(query_part);
+
     return std::make_unique<ral::frame::BlazingTable>(evaluate_expressions(blazing_table_in->view(), expressions), out_column_names);
 }
 
+std::unique_ptr<ral::frame::BlazingTable> process_project(
+  std::unique_ptr<ral::frame::BlazingTable> blazing_table_in,
+  const std::vector<std::string> & out_column_names,
+  expression_program_cache & programs) {
+
+    std::shared_ptr<expression_program> program = programs.get(blazing_table_in->view());
+
+    return std::make_unique<ral::frame::BlazingTable>(program->evaluate(blazing_table_in->view()), out_column_names);
+}
+
 } // namespace processor
 } // namespace ral
@@ -1,12 +1,119 @@
 #pragma once
 
+#include <mutex>
 #include <execution_graph/Context.h>
 #include "LogicPrimitives.h"
 #include "execution_graph/logic_controllers/BlazingColumn.h"
+#include "Interpreter/interpreter_cpp.h"
+#include "parser/expression_tree.hpp"
 
 namespace ral{
 namespace processor{
 
+/**
+ * @brief A list of expressions compiled against an input schema.
+ *
+ * Parsing the calcite expressions, rewriting them with the custom operators,
+ * inferring their output types and encoding the interpreter plan only depend on
+ * the expressions and on the input column types, so a kernel that evaluates the
+ * same expressions over many batches compiles them once and reuses the program
+ * for every batch with the same schema.
+ *
+ * The expressions are parsed when the program is constructed. The interpreter
+ * plan is encoded while evaluating the first batch and kept if no complex
+ * operation (e.g. string functions) had to be evaluated outside of the
+ * interpreter, as those produce temporary columns that belong to each batch.
+ * The simple operations of all the expressions are encoded in a single plan that
+ * is optimized as a whole and split by interops::split_plan when it needs more
+ * positions than the interpreter supports.
+ *
+ * Batches of at most cpu_max_rows rows are evaluated by the CPU interpreter when
+ * it supports the plan, as copying a few rows to the host costs less than
+ * launching the interpreter kernel for them.
+ */
+class expression_program {
+public:
+	expression_program(const std::vector<std::string> & expressions, const cudf::table_view & table, cudf::size_type cpu_max_rows = 0);
+
+	/**
+	 * @brief Returns true if the program was compiled for the schema of the table
+	 */
+	bool matches(const cudf::table_view & table) const;
+
+	/**
+	 * @brief Evaluates all the expressions of the program over the table
+	 */
+	std::vector<std::unique_ptr<ral::frame::BlazingColumn>> evaluate(const cudf::table_view & table);
+
+	/**
+	 * @brief Returns true if the interpreter plan has been encoded and is being reused
+	 */
+	bool is_compiled();
+
+private:
+	enum class output_kind { LITERAL, INPUT_COLUMN, INTERPRETER };
+
+	struct output_slot {
+		output_kind kind;
+		cudf::size_type column_index;
+		cudf::data_type type;
+		std::unique_ptr<cudf::scalar> literal;
+	};
+
+	struct compiled_sub_plan {
+		interops::interpreter_sub_plan sub_plan;
+		std::vector<std::unique_ptr<cudf::scalar>> left_scalars;
+		std::vector<std::unique_ptr<cudf::scalar>> right_scalars;
+	};
+
+	struct compiled_plan {
+		std::vector<output_slot> slots;
+		std::vector<cudf::size_type> input_col_indices;
+		std::vector<compiled_sub_plan> sub_plans;
+	};
+
+	static void run_sub_plans(const std::vector<compiled_sub_plan> & sub_plans,
+		const cudf::table_view & interops_input_table,
+		const std::vector<cudf::mutable_column_view> & interpreter_out_column_views,
+		cudf::size_type num_rows,
+		cudf::size_type cpu_max_rows);
+
+	std::vector<std::unique_ptr<ral::frame::BlazingColumn>> evaluate_compiled(const compiled_plan & plan, const cudf::table_view & table) const;
+	std::vector<std::unique_ptr<ral::frame::BlazingColumn>> evaluate_and_compile(const cudf::table_view & table);
+
+	std::vector<cudf::data_type> input_types_;
+	std::vector<std::string> expressions_;
+	std::vector<parser::parse_tree> expr_trees_;
+	cudf::size_type cpu_max_rows_;
+
+	std::mutex mutex_;
+	std::shared_ptr<const compiled_plan> plan_;
+};
+
+/**
+ * @brief Keeps the programs compiled by a kernel for its expressions, one per
+ * input schema seen by the kernel.
+ */
+class expression_program_cache {
+public:
+	explicit expression_program_cache(const std::vector<std::string> & expressions, cudf::size_type cpu_max_rows = 0);
+
+	const std::vector<std::string> & expressions() const { return expressions_; }
+
+	/**
+	 * @brief Returns the program compiled for the schema of the table, compiling
+	 * a new one if needed
+	 */
+	std::shared_ptr<expression_program> get(const cudf::table_view & table);
+
+private:
+	std::vector<std::string> expressions_;
+	cudf::size_type cpu_max_rows_;
+
+	std::mutex mutex_;
+	std::vector<std::shared_ptr<expression_program>> programs_;
+};
+
 /**
  * @brief Evaluates multiple expressions consisting of arithmetic operations and
  * SQL functions.
@@ -24,10 +131,24 @@ namespace processor{
 std::vector<std::unique_ptr<ral::frame::BlazingColumn>> evaluate_expressions(
   const cudf::table_view & table, const std::vector<std::string> & expressions);
 
+/**
+ * @brief Splits the project expressions of a LogicalProject into the expressions
+ * and the output column names
+ */
+std::pair<std::vector<std::string>, std::vector<std::string>> get_project_expressions_and_names(const std::string & query_part);
+
 std::unique_ptr<ral::frame::BlazingTable> process_project(
   std::unique_ptr<ral::frame::BlazingTable> blazing_table_in,
   const std::string & query_part,
   blazingdb::manager::Context * context);
 
+/**
+ * @brief Evaluates a LogicalProject reusing the programs compiled for its expressions
+ */
+std::unique_ptr<ral::frame::BlazingTable> process_project(
+  std::unique_ptr<ral::frame::BlazingTable> blazing_table_in,
+  const std::vector<std::string> & out_column_names,
+  expression_program_cache & programs);
+
 } // namespace processor
 } // namespace ral
@@ -88,12 +88,21 @@ struct tree_processor {
 		} else if (is_sort_and_sample(expr)) {
 			k = std::make_shared<SortAndSampleKernel>(kernel_id,expr, kernel_context, query_graph);
 
+		} else if (is_window_partition(expr)) {
+			k = std::make_shared<WindowPartitionKernel>(kernel_id,expr, kernel_context, query_graph);
+
+		} else if (is_window_sort(expr)) {
+			k = std::make_shared<WindowSortKernel>(kernel_id,expr, kernel_context, query_graph);
+
 		} else if (is_window_compute(expr)) {
 			k = std::make_shared<ComputeWindowKernel>(kernel_id,expr, kernel_context, query_graph);
 
 		} else if (is_merge(expr)) {
 			k = std::make_shared<MergeStreamKernel>(kernel_id,expr, kernel_context, query_graph);
 
+		} else if (is_top_n(expr)) {
+			k = std::make_shared<TopNKernel>(kernel_id,expr, kernel_context, query_graph);
+
 		} else if (is_limit(expr)) {
 			k = std::make_shared<LimitKernel>(kernel_id,expr, kernel_context, query_graph);
 
@@ -115,6 +124,12 @@ struct tree_processor {
 		} else if (is_union(expr)) {
 			k = std::make_shared<UnionKernel>(kernel_id,expr, kernel_context, query_graph);
 
+		} else if (is_distinct_partition(expr)) {
+			k = std::make_shared<DistinctPartitionKernel>(kernel_id,expr, kernel_context, query_graph);
+
+		} else if (is_distinct(expr)) {
+			k = std::make_shared<DistinctKernel>(kernel_id,expr, kernel_context, query_graph);
+
 		} else {
 			RAL_FAIL("Invalid or unsupported expression: '" + expr + "' in the logical plan");
 		}
@@ -141,6 +156,23 @@ struct tree_processor {
 		return children;
 	}
 
+	// An ORDER BY with a LIMIT up to MAX_ORDER_BY_TOP_N_ROWS is computed keeping only the top rows of every batch
+	bool is_top_n_sort(const std::string & expr) {
+		if (is_window_function(expr)) {
+			return false;
+		}
+
+		std::map<std::string, std::string> config_options = context->getConfigOptions();
+		int64_t max_top_n_rows = 100000;
+		auto it = config_options.find("MAX_ORDER_BY_TOP_N_ROWS");
+		if (it != config_options.end()){
+			max_top_n_rows = std::stoll(config_options["MAX_ORDER_BY_TOP_N_ROWS"]);
+		}
+
+		int64_t limit_rows = ral::operators::get_limit_rows_when_relational_alg_is_simple(expr);
+		return limit_rows >= 0 && limit_rows <= max_top_n_rows;
+	}
+
 	void transform_json_tree(boost::property_tree::ptree &p_tree, bool first_windowed_call = true) {
 		std::string expr = p_tree.get<std::string>("expr", "");
 		if (is_sort(expr)){
@@ -148,11 +180,16 @@ struct tree_processor {
 			std::string merge_expr = expr;
 			std::string partition_expr = expr;
 			std::string sort_and_sample_expr = expr;
+			std::string top_n_expr = expr;
 
 			if( ral::operators::has_limit_only(expr) && !is_window_function(expr) ){
 				StringUtil::findAndReplaceAll(limit_expr, LOGICAL_SORT_TEXT, LOGICAL_LIMIT_TEXT);
 
 				p_tree.put("expr", limit_expr);
+			} else if (is_top_n_sort(expr)) {
+				StringUtil::findAndReplaceAll(top_n_expr, LOGICAL_SORT_TEXT, LOGICAL_TOP_N_TEXT);
+
+				p_tree.put("expr", top_n_expr);
 			} else {
 				if (this->context->getTotalNodes() == 1) {
 					StringUtil::findAndReplaceAll(limit_expr, LOGICAL_SORT_TEXT, LOGICAL_LIMIT_TEXT);
@@ -246,52 +283,35 @@ struct tree_processor {
 		else if (is_union(expr) && get_named_expression(expr, "all") == "false") {
 			expr = "LogicalUnion(all=[true])";
 
-			// when UNION, we want to do a group by on all columns without aggregations.
-			std::string merge_aggregate_expr = LOGICAL_MERGE_AGGREGATE_TEXT + "(group=[{*}])";
-			std::string compute_aggregate_expr = LOGICAL_COMPUTE_AGGREGATE_TEXT + "(group=[{*}])";
-			std::string distribute_aggregate_expr = LOGICAL_DISTRIBUTE_AGGREGATE_TEXT + "(group=[{*}])";
-
-			if (this->context->getTotalNodes() == 1) {
+			// when UNION, we want to remove the duplicated rows by hashing all the columns
+			std::string distinct_expr = LOGICAL_DISTINCT_TEXT + "(group=[{*}])";
 
-				boost::property_tree::ptree root_union_tree;
-				root_union_tree.put("expr", expr);
-				root_union_tree.add_child("children", p_tree.get_child("children"));
+			boost::property_tree::ptree root_union_tree;
+			root_union_tree.put("expr", expr);
+			root_union_tree.add_child("children", p_tree.get_child("children"));
 
-				boost::property_tree::ptree agg_union_tree;
-				agg_union_tree.put("expr", compute_aggregate_expr);
-				agg_union_tree.add_child("children", create_array_tree(root_union_tree));
-
-				p_tree.clear();
-
-				p_tree.put("expr", merge_aggregate_expr);
-				p_tree.put_child("children", create_array_tree(agg_union_tree));
+			p_tree.clear();
+			p_tree.put("expr", distinct_expr);
 
+			if (this->context->getTotalNodes() == 1) {
+				p_tree.put_child("children", create_array_tree(root_union_tree));
 			} else {
+				std::string distinct_partition_expr = LOGICAL_DISTINCT_PARTITION_TEXT + "(group=[{*}])";
 
-				boost::property_tree::ptree root_union_tree;
-				root_union_tree.put("expr", expr);
-				root_union_tree.add_child("children", p_tree.get_child("children"));
-
-				boost::property_tree::ptree compute_aggregate_tree;
-				compute_aggregate_tree.put("expr", compute_aggregate_expr);
-				compute_aggregate_tree.add_child("children", create_array_tree(root_union_tree));
-
-				boost::property_tree::ptree distribute_aggregate_tree;
-				distribute_aggregate_tree.put("expr", distribute_aggregate_expr);
-				distribute_aggregate_tree.add_child("children", create_array_tree(compute_aggregate_tree));
-
-				p_tree.clear();
+				boost::property_tree::ptree distinct_partition_tree;
+				distinct_partition_tree.put("expr", distinct_partition_expr);
+				distinct_partition_tree.put_child("children", create_array_tree(root_union_tree));
 
-				p_tree.put("expr", merge_aggregate_expr);
-				p_tree.put_child("children", create_array_tree(distribute_aggregate_tree));
+				p_tree.put_child("children", create_array_tree(distinct_partition_tree));
 			}
 		}
 		else if (is_project(expr) && is_window_function(expr) && first_windowed_call) {
 			if (!window_expression_contains_partition_by(expr)) {
 				throw std::runtime_error("In Window Function: PARTITION BY clause is mandatory");
 			}
-			if (window_expression_contains_multiple_diff_over_clauses(expr)) {
-				throw std::runtime_error("In Window Function: multiple WINDOW FUNCTIONs with different OVER clauses are not supported currently");
+			// OVER clauses with the same PARTITION BY share the partitioning, each one is computed with its own ORDER BY
+			if (window_expression_contains_multiple_diff_partition_by(expr)) {
+				throw std::runtime_error("In Window Function: multiple WINDOW FUNCTIONs with different PARTITION BY clauses are not supported currently");
 			}
 
 			if (window_expression_contains_bounds_by_range(expr)) {
@@ -302,11 +322,22 @@ struct tree_processor {
 			std::string window_expr = expr;
 
 			StringUtil::findAndReplaceAll(window_expr, LOGICAL_PROJECT_TEXT, LOGICAL_COMPUTE_WINDOW_TEXT);
-			StringUtil::findAndReplaceAll(sort_expr, LOGICAL_PROJECT_TEXT, LOGICAL_SORT_TEXT);
+			StringUtil::findAndReplaceAll(sort_expr, LOGICAL_PROJECT_TEXT, LOGICAL_WINDOW_SORT_TEXT);
 
+			// rows are hash partitioned by the PARTITION BY columns, so no global sort is needed
 			boost::property_tree::ptree sort_tree;
 			sort_tree.put("expr", sort_expr);
-			sort_tree.add_child("children", p_tree.get_child("children"));
+			if (this->context->getTotalNodes() == 1) {
+				sort_tree.add_child("children", p_tree.get_child("children"));
+			} else {
+				std::string partition_expr = expr;
+				StringUtil::findAndReplaceAll(partition_expr, LOGICAL_PROJECT_TEXT, LOGICAL_WINDOW_PARTITION_TEXT);
+
+				boost::property_tree::ptree partition_tree;
+				partition_tree.put("expr", partition_expr);
+				partition_tree.add_child("children", p_tree.get_child("children"));
+				sort_tree.put_child("children", create_array_tree(partition_tree));
+			}
 
 			boost::property_tree::ptree window_tree;
 			window_tree.put("expr", window_expr);
@@ -72,6 +72,12 @@ std::size_t task::task_memory_needed() {
 
 
 void task::run(cudaStream_t stream, executor * executor){
+    // the kernel already has all the rows it needs, so the inputs are not even loaded
+    if (kernel->has_reached_limit()) {
+        complete();
+        return;
+    }
+
     std::vector< std::unique_ptr<ral::frame::BlazingTable> > input_gpu;
     CodeTimer decachingEventTimer;
 
@@ -300,25 +300,42 @@ namespace cache {
 		}
 	}
 
-	// This function will work when the Relational Algebra only contains: TableScan (or BindableTableScan) and Limit
-	void graph::check_for_simple_scan_with_limit_query() {
-		auto first_iterator = container_.begin();
-		first_iterator++;
-		int32_t min_index_valid = first_iterator->first;
-		size_t total_kernels = container_.size();
-
-		if (total_kernels == 4) { // LimitKernel, TableScanKernel (or BindableTableScan), OutputKernel and null
-			if ( get_node(min_index_valid)->get_type_id() == kernel_type::LimitKernel &&
-				(get_node(min_index_valid + 1)->get_type_id() == kernel_type::TableScanKernel ||
-				 get_node(min_index_valid + 1)->get_type_id() == kernel_type::BindableTableScanKernel) &&
-				 get_node(min_index_valid + 2)->expression == "OutputKernel"
-				)
-			{
-				get_node(min_index_valid + 1)->has_limit_ = true;
-				// get the limit value from LogicalLimit
-				std::string LimitExpression = get_node(min_index_valid)->expression;
-				int64_t scan_only_rows = ral::operators::get_limit_rows_when_relational_alg_is_simple(LimitExpression);
-				get_node(min_index_valid + 1)->limit_rows_ = scan_only_rows;
+	// Gives the fetch of every LogicalLimit without a sort to the scan that feeds it, as long as there are
+	// only projects in between. Projects keep the number of rows, so the scan can stop loading once its
+	// output has that many rows.
+	void graph::push_down_limits() {
+		for (auto & id_kernel : container_) {
+			kernel * limit_kernel = id_kernel.second.get();
+			if (limit_kernel == nullptr || limit_kernel->get_type_id() != kernel_type::LimitKernel ||
+				!ral::operators::has_limit_only(limit_kernel->expression)) {
+				continue;
+			}
+			int64_t limit_rows = ral::operators::get_limit_rows_when_relational_alg_is_simple(limit_kernel->expression);
+			if (limit_rows <= 0) {
+				continue;
+			}
+
+			kernel * current = limit_kernel;
+			while (current != nullptr) {
+				auto input_edges = get_reverse_neighbours(current);
+				if (input_edges.size() != 1) {
+					break;
+				}
+				kernel * input_kernel = get_node(input_edges.begin()->source);
+				if (input_kernel == nullptr || get_neighbours(input_kernel).size() != 1) {
+					break;
+				}
+
+				if (input_kernel->get_type_id() == kernel_type::TableScanKernel ||
+					input_kernel->get_type_id() == kernel_type::BindableTableScanKernel) {
+					input_kernel->has_limit_ = true;
+					input_kernel->limit_rows_ = limit_rows;
+					break;
+				} else if (input_kernel->get_type_id() == kernel_type::ProjectKernel) {
+					current = input_kernel;
+				} else {
+					break;
+				}
 			}
 		}
 	}
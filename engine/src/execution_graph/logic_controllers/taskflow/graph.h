@@ -121,7 +121,10 @@ public:
 
 	void set_kernels_order();
 
-	void check_for_simple_scan_with_limit_query();
+	/**
+	 * @brief Pushes the fetch of the limits down to the scans they read from, through projects.
+	 */
+	void push_down_limits();
 	void set_memory_monitor(std::shared_ptr<ral::MemoryMonitor> mem_monitor);
 	void clear_kernels(); 
 	
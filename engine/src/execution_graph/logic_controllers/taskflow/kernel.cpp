@@ -1,12 +1,15 @@
 #include "kernel.h"
 #include "CodeTimer.h"
 #include "communication/CommunicationData.h"
+#include "operators/RuntimeJoinFilter.h"
+#include "executor.h"
 
 namespace ral {
 namespace cache {
 
 kernel::kernel(std::size_t kernel_id, std::string expr, std::shared_ptr<Context> context, kernel_type kernel_type_id)
         : total_input_bytes_processed{0},
+          runtime_join_filters{std::make_shared<ral::operators::runtime_join_filter_set>()},
           expression{expr},
           kernel_id(kernel_id),
           parent_id_(-1),
@@ -76,11 +79,6 @@ ral::execution::task_result kernel::process(std::vector<std::unique_ptr<ral::fra
 		cudaStream_t stream,
     const std::map<std::string, std::string>& args){
 
-    // TODO: figure out if this can be re enabled;
-    // if (this->has_limit_ && output->get_num_rows_added() >= this->limit_rows_) {
-    //     return;
-    // }
-
     if(inputs.size()==0){
         return {ral::execution::task_status::SUCCESS, std::string(), std::vector< std::unique_ptr<ral::frame::BlazingTable> > ()};
     }
@@ -107,12 +105,35 @@ void kernel::add_task(size_t task_id){
     this->tasks.insert(task_id);
 }
 
+void kernel::add_runtime_join_filter(std::shared_ptr<ral::operators::runtime_join_filter> filter, const std::vector<cudf::size_type> & key_indices) {
+    runtime_join_filters->add(std::move(filter), key_indices);
+}
+
+void kernel::apply_runtime_join_filters(std::unique_ptr<ral::frame::BlazingTable> & table) {
+    runtime_join_filters->apply(table);
+}
+
 void kernel::notify_complete(size_t task_id){
     std::lock_guard<std::mutex> lock(kernel_mutex);
     this->tasks.erase(task_id);
     kernel_cv.notify_one();
 }
 
+bool kernel::has_reached_limit(){
+    return this->has_limit_ && this->output_.total_rows_added() >= (uint64_t)this->limit_rows_;
+}
+
+void kernel::wait_for_tasks(std::size_t max_tasks){
+    std::unique_lock<std::mutex> lock(kernel_mutex);
+    kernel_cv.wait(lock,[this, max_tasks]{
+        return this->tasks.size() <= max_tasks || ral::execution::executor::get_instance()->has_exception();
+    });
+
+    if(auto ep = ral::execution::executor::get_instance()->last_exception()){
+        std::rethrow_exception(ep);
+    }
+}
+
 void kernel::notify_fail(size_t task_id){
     std::lock_guard<std::mutex> lock(kernel_mutex);
     this->tasks.erase(task_id);
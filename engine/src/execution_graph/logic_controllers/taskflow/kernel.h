@@ -22,6 +22,13 @@ struct task_result{
 } 
 }
 
+namespace ral {
+namespace operators {
+class runtime_join_filter;
+class runtime_join_filter_set;
+}
+}
+
 namespace ral {
 namespace cache {
 class kernel;
@@ -192,11 +199,31 @@ public:
 			return {ral::execution::task_status::SUCCESS, std::string(), std::vector< std::unique_ptr<ral::frame::BlazingTable> > ()};
 	}
 
-	std::size_t estimate_output_bytes(const std::vector<std::unique_ptr<ral::cache::CacheData > > & inputs);
-	std::size_t estimate_operating_bytes(const std::vector<std::unique_ptr<ral::cache::CacheData > > & inputs);
+	virtual std::size_t estimate_output_bytes(const std::vector<std::unique_ptr<ral::cache::CacheData > > & inputs);
+	virtual std::size_t estimate_operating_bytes(const std::vector<std::unique_ptr<ral::cache::CacheData > > & inputs);
 
 	virtual std::string kernel_name() { return "base_kernel"; }
 
+	/**
+	 * @brief Registers a filter built from the build side of a join that consumes the output of this kernel.
+	 *
+	 * @param filter The runtime join filter.
+	 * @param key_indices Indices of the join key columns in the output of this kernel.
+	 */
+	void add_runtime_join_filter(std::shared_ptr<ral::operators::runtime_join_filter> filter, const std::vector<cudf::size_type> & key_indices);
+
+	/**
+	 * @brief Removes the rows of a batch that cannot match the build side of the joins that registered a filter.
+	 * The batch is left untouched if the filters throw, so it can still be retried.
+	 */
+	void apply_runtime_join_filters(std::unique_ptr<ral::frame::BlazingTable> & table);
+
+	/**
+	 * @brief Returns true when a limit was pushed down to this kernel and its output already has that many rows.
+	 * Tasks of the kernel that have not started yet are then dropped without loading their inputs.
+	 */
+	bool has_reached_limit();
+
 	void notify_complete(size_t task_id);
 	void notify_fail(size_t task_id);
 	void add_task(size_t task_id);
@@ -204,10 +231,17 @@ public:
 		return tasks.empty();
 	}
 protected:
+	/**
+	 * @brief Blocks until no more than max_tasks tasks of this kernel are left, and rethrows
+	 * the exception of a failed task.
+	 */
+	void wait_for_tasks(std::size_t max_tasks = 0);
+
 	std::set<size_t> tasks;
 	std::mutex kernel_mutex;
 	std::condition_variable kernel_cv;
 	std::atomic<std::size_t> total_input_bytes_processed;
+	std::shared_ptr<ral::operators::runtime_join_filter_set> runtime_join_filters;
 	
 public:
 	std::string expression; /**< Stores the logical expression being processed. */
@@ -220,7 +254,7 @@ public:
 	std::shared_ptr<graph> query_graph; /**< Stores a pointer to the current execution graph. */
 	std::shared_ptr<Context> context; /**< Shared context of the running query. */
 
-	bool has_limit_; /**< Indicates if the Logical plan only contains a LogicalTableScan (or BindableTableScan) and LogicalLimit. */
+	bool has_limit_; /**< Indicates if a LogicalLimit was pushed down to this kernel, see graph::push_down_limits. */
 	int64_t limit_rows_; /**< Specifies the maximum number of rows to return. */
 
 	std::shared_ptr<spdlog::logger> logger;
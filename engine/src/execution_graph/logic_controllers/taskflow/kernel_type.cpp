@@ -8,12 +8,17 @@ std::string get_kernel_type_name(kernel_type type){
         case kernel_type::ProjectKernel: return "ProjectKernel";
         case kernel_type::FilterKernel: return "FilterKernel";
         case kernel_type::UnionKernel: return "UnionKernel";
+        case kernel_type::DistinctPartitionKernel: return "DistinctPartitionKernel";
+        case kernel_type::DistinctKernel: return "DistinctKernel";
         case kernel_type::MergeStreamKernel: return "MergeStreamKernel";
         case kernel_type::PartitionKernel: return "PartitionKernel";
         case kernel_type::SortAndSampleKernel: return "SortAndSampleKernel";
         case kernel_type::ComputeWindowKernel: return "ComputeWindowKernel";
+        case kernel_type::WindowPartitionKernel: return "WindowPartitionKernel";
+        case kernel_type::WindowSortKernel: return "WindowSortKernel";
         case kernel_type::PartitionSingleNodeKernel: return "PartitionSingleNodeKernel";
         case kernel_type::LimitKernel: return "LimitKernel";
+        case kernel_type::TopNKernel: return "TopNKernel";
         case kernel_type::ComputeAggregateKernel: return "ComputeAggregateKernel";
         case kernel_type::DistributeAggregateKernel: return "DistributeAggregateKernel";
         case kernel_type::MergeAggregateKernel: return "MergeAggregateKernel";
@@ -9,12 +9,17 @@ enum class kernel_type {
 	ProjectKernel,
 	FilterKernel,
 	UnionKernel,
+	DistinctPartitionKernel,
+	DistinctKernel,
 	MergeStreamKernel,
 	PartitionKernel,
 	SortAndSampleKernel,
 	ComputeWindowKernel,
+	WindowPartitionKernel,
+	WindowSortKernel,
 	PartitionSingleNodeKernel,
 	LimitKernel,
+	TopNKernel,
 	ComputeAggregateKernel,
 	DistributeAggregateKernel,
 	MergeAggregateKernel,
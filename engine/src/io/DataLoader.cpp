@@ -1,5 +1,6 @@
 
 #include "DataLoader.h"
+#include "MetadataCatalog.h"
 
 #include <numeric>
 
@@ -69,13 +70,19 @@ std::unique_ptr<ral::frame::BlazingTable> data_loader::get_metadata(int offset)
 	std::size_t NUM_FILES_AT_A_TIME = 64;
 	std::vector<std::unique_ptr<ral::frame::BlazingTable>> metadata_batches;
 	std::vector<ral::frame::BlazingTableView> metadata_batches_views;
+	auto catalog = metadata_catalog::get_instance();
 	while(this->provider->has_next()){
 		std::vector<std::shared_ptr<arrow::io::RandomAccessFile>> files;
-		std::vector<data_handle> handles = this->provider->get_some(NUM_FILES_AT_A_TIME);
+		// the catalog only opens the files it does not have the metadata of
+		std::vector<data_handle> handles = this->provider->get_some(NUM_FILES_AT_A_TIME, !catalog->is_enabled());
 		for(auto handle : handles) {
 			files.push_back(handle.file_handle);
 		}
-		metadata_batches.emplace_back(this->parser->get_metadata(files, offset));
+		if (catalog->is_enabled()) {
+			metadata_batches.emplace_back(catalog->get_metadata(*this->parser, handles, offset));
+		} else {
+			metadata_batches.emplace_back(this->parser->get_metadata(files, offset));
+		}
 		metadata_batches_views.emplace_back(metadata_batches.back()->toBlazingTableView());
 		offset += files.size();
 		this->provider->close_file_handles();
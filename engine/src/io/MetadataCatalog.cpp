@@ -0,0 +1,419 @@
+#include "MetadataCatalog.h"
+
+#include <cstdio>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <mutex>
+#include <sstream>
+#include <thread>
+
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "Config/BlazingContext.h"
+#include <cudf/column/column_factories.hpp>
+#include <cudf/io/orc.hpp>
+#include <cudf/scalar/scalar.hpp>
+#include <cudf/unary.hpp>
+
+#include "data_parser/ArgsUtil.h"
+#include "data_provider/FileHandlePool.h"
+#include "utilities/CommonOperations.h"
+
+namespace ral {
+namespace io {
+
+namespace {
+
+const std::string ENTRY_MAGIC = "BSQLCATALOG1";
+
+std::mutex instance_mutex;
+std::shared_ptr<metadata_catalog> instance;
+
+// Appends the values of an entry, the integers in the byte order of the host as the catalog is local
+struct entry_writer {
+	std::string data;
+
+	void put(uint64_t value) {
+		data.append(reinterpret_cast<const char *>(&value), sizeof(value));
+	}
+
+	void put(const std::string & value) {
+		put(static_cast<uint64_t>(value.size()));
+		data.append(value);
+	}
+};
+
+// Reads the values of an entry, ok turns false when an entry is shorter than expected
+struct entry_reader {
+	entry_reader(const std::string & data) : data(data) {}
+
+	uint64_t get_uint() {
+		uint64_t value = 0;
+		if (!ok || data.size() - position < sizeof(value)) {
+			ok = false;
+			return 0;
+		}
+		std::copy(data.data() + position, data.data() + position + sizeof(value), reinterpret_cast<char *>(&value));
+		position += sizeof(value);
+		return value;
+	}
+
+	int64_t get_int() {
+		return static_cast<int64_t>(get_uint());
+	}
+
+	std::string get_string() {
+		uint64_t size = get_uint();
+		if (!ok || data.size() - position < size) {
+			ok = false;
+			return "";
+		}
+		std::string value = data.substr(position, size);
+		position += size;
+		return value;
+	}
+
+	const std::string & data;
+	size_t position = 0;
+	bool ok = true;
+};
+
+std::string encode_row_group_stats(const std::vector<row_group_stats> & row_groups) {
+	entry_writer writer;
+	writer.put(row_groups.size());
+	for (auto & row_group : row_groups) {
+		writer.put(static_cast<uint64_t>(row_group.num_rows));
+		writer.put(static_cast<uint64_t>(row_group.num_bytes));
+		writer.put(row_group.column_bytes.size());
+		for (auto & column : row_group.column_bytes) {
+			writer.put(column.first);
+			writer.put(static_cast<uint64_t>(column.second));
+		}
+	}
+	return writer.data;
+}
+
+bool decode_row_group_stats(const std::string & payload, std::vector<row_group_stats> & row_groups) {
+	entry_reader reader(payload);
+	uint64_t num_row_groups = reader.get_uint();
+	for (uint64_t i = 0; i < num_row_groups && reader.ok; i++) {
+		row_group_stats row_group;
+		row_group.num_rows = reader.get_int();
+		row_group.num_bytes = reader.get_int();
+		uint64_t num_columns = reader.get_uint();
+		for (uint64_t j = 0; j < num_columns && reader.ok; j++) {
+			std::string name = reader.get_string();
+			row_group.column_bytes[name] = reader.get_int();
+		}
+		row_groups.push_back(std::move(row_group));
+	}
+	return reader.ok;
+}
+
+// The metadata table is kept as an ORC file, with its column types as the ORC reader
+// does not give back the timestamp resolutions it was written with
+std::string encode_metadata(const ral::frame::BlazingTable & table, bool has_row_groups) {
+	cudf::io::table_metadata metadata;
+	metadata.column_names = table.names();
+	std::vector<char> orc_buffer;
+	cudf::io::orc_writer_options out_opts = cudf::io::orc_writer_options::builder(cudf::io::sink_info(&orc_buffer), table.view())
+		.metadata(&metadata);
+	cudf::io::write_orc(out_opts);
+
+	entry_writer writer;
+	writer.put(has_row_groups ? 1 : 0);
+	writer.put(table.names().size());
+	for (size_t i = 0; i < table.names().size(); i++) {
+		writer.put(table.names()[i]);
+		writer.put(static_cast<uint64_t>(table.view().column(i).type().id()));
+	}
+	writer.put(std::string(orc_buffer.begin(), orc_buffer.end()));
+	return writer.data;
+}
+
+bool decode_metadata(const std::string & payload, std::unique_ptr<ral::frame::BlazingTable> & table, bool & has_row_groups) {
+	entry_reader reader(payload);
+	has_row_groups = reader.get_uint() != 0;
+	uint64_t num_columns = reader.get_uint();
+	std::vector<std::string> names;
+	std::vector<cudf::type_id> types;
+	for (uint64_t i = 0; i < num_columns && reader.ok; i++) {
+		names.push_back(reader.get_string());
+		types.push_back(static_cast<cudf::type_id>(reader.get_uint()));
+	}
+	std::string orc_data = reader.get_string();
+	if (!reader.ok) {
+		return false;
+	}
+
+	// a damaged entry can still have the right length, then it is read from the file again as any other bad entry
+	try {
+		cudf::io::orc_reader_options read_opts = cudf::io::orc_reader_options::builder(cudf::io::source_info(orc_data.data(), orc_data.size()));
+		auto result = cudf::io::read_orc(read_opts);
+		auto columns = result.tbl->release();
+		if (columns.size() != names.size()) {
+			return false;
+		}
+		for (size_t i = 0; i < columns.size(); i++) {
+			if (columns[i]->type().id() != types[i]) {
+				columns[i] = cudf::cast(columns[i]->view(), cudf::data_type{types[i]});
+			}
+		}
+		table = std::make_unique<ral::frame::BlazingTable>(std::make_unique<cudf::table>(std::move(columns)), names);
+	} catch (...) {
+		return false;
+	}
+	return true;
+}
+
+// Points the file_handle_index of the metadata of a file, read with offset 0, to the file
+std::unique_ptr<ral::frame::BlazingTable> set_file_handle_index(std::unique_ptr<ral::frame::BlazingTable> table, int file_handle_index) {
+	std::vector<std::string> names = table->names();
+	auto columns = table->releaseCudfTable()->release();
+	for (size_t i = 0; i < names.size(); i++) {
+		if (names[i] == "file_handle_index") {
+			cudf::numeric_scalar<int32_t> index(file_handle_index);
+			columns[i] = cudf::make_column_from_scalar(index, columns[i]->size());
+		}
+	}
+	return std::make_unique<ral::frame::BlazingTable>(std::make_unique<cudf::table>(std::move(columns)), names);
+}
+
+// Creates the directory only accessible by the user, and returns an empty one (disabling the catalog)
+// when it is not a directory of the user that only the user can write to, as its entries could be forged
+std::string get_private_directory(const std::string & directory) {
+	if (directory.empty()) {
+		return directory;
+	}
+	mkdir(directory.c_str(), 0700);
+	struct stat status;
+	if (stat(directory.c_str(), &status) != 0 || !S_ISDIR(status.st_mode) || status.st_uid != getuid() ||
+		(status.st_mode & (S_IWGRP | S_IWOTH)) != 0) {
+		return "";
+	}
+	return directory;
+}
+
+}  // namespace
+
+metadata_catalog::metadata_catalog(const std::string & directory) : directory(get_private_directory(directory)) {}
+
+void metadata_catalog::initialize(const std::string & directory) {
+	std::lock_guard<std::mutex> lock(instance_mutex);
+	instance = std::make_shared<metadata_catalog>(directory);
+}
+
+std::shared_ptr<metadata_catalog> metadata_catalog::get_instance() {
+	std::lock_guard<std::mutex> lock(instance_mutex);
+	if (!instance) {
+		instance = std::make_shared<metadata_catalog>("");
+	}
+	return instance;
+}
+
+std::string metadata_catalog::get_parser_key(DataType data_type, const std::map<std::string, std::string> & args_map) {
+	std::string key = getDataTypeName(data_type);
+	for (auto & arg : args_map) {
+		key += "\n" + arg.first + "=" + arg.second;
+	}
+	return key;
+}
+
+void metadata_catalog::parse_schema(data_parser & parser, const std::string & parser_key, const data_handle & handle, Schema & schema) {
+	file_version version;
+	bool cacheable = is_enabled() && get_file_version(handle.uri, version);
+
+	std::string payload;
+	if (cacheable && read_entry("schema", parser_key, version, payload)) {
+		entry_reader reader(payload);
+		bool has_header_csv = reader.get_uint() != 0;
+		uint64_t num_columns = reader.get_uint();
+		std::vector<std::pair<std::string, cudf::type_id>> columns;
+		for (uint64_t i = 0; i < num_columns && reader.ok; i++) {
+			std::string name = reader.get_string();
+			columns.emplace_back(name, static_cast<cudf::type_id>(reader.get_uint()));
+		}
+		if (reader.ok) {
+			if (has_header_csv) {
+				schema.set_has_header_csv(true);
+			}
+			for (size_t i = 0; i < columns.size(); i++) {
+				schema.add_column(columns[i].first, columns[i].second, i, true);
+			}
+			return;
+		}
+	}
+
+	parser.parse_schema(handle.file_handle, schema);
+
+	if (cacheable) {
+		entry_writer writer;
+		writer.put(schema.get_has_header_csv() ? 1 : 0);
+		writer.put(schema.get_num_columns());
+		for (size_t i = 0; i < schema.get_num_columns(); i++) {
+			writer.put(schema.get_name(i));
+			writer.put(static_cast<uint64_t>(schema.get_dtype(i)));
+		}
+		write_entry("schema", parser_key, version, writer.data);
+	}
+}
+
+std::vector<row_group_stats> metadata_catalog::get_row_group_stats(data_parser & parser, const data_handle & handle) {
+	file_version version;
+	if (!is_enabled() || !get_file_version(handle.uri, version)) {
+		return parser.get_row_group_stats(handle.file_handle);
+	}
+
+	std::string key = getDataTypeName(parser.type());
+	std::string payload;
+	std::vector<row_group_stats> row_groups;
+	if (read_entry("row_groups", key, version, payload) && decode_row_group_stats(payload, row_groups)) {
+		return row_groups;
+	}
+
+	row_groups = parser.get_row_group_stats(handle.file_handle);
+	write_entry("row_groups", key, version, encode_row_group_stats(row_groups));
+	return row_groups;
+}
+
+std::unique_ptr<ral::frame::BlazingTable> metadata_catalog::get_metadata(data_parser & parser, const std::vector<data_handle> & handles, int offset) {
+	std::string key = getDataTypeName(parser.type());
+	std::vector<std::unique_ptr<ral::frame::BlazingTable>> tables(handles.size());
+	std::vector<char> has_row_groups(handles.size(), 0);
+	std::vector<std::shared_ptr<arrow::io::RandomAccessFile>> files(handles.size());
+
+	auto open = [&](size_t file_index) {
+		if (!files[file_index]) {
+			files[file_index] = handles[file_index].file_handle != nullptr ?
+				handles[file_index].file_handle : file_handle_pool::get_instance()->open(handles[file_index].uri);
+		}
+		return files[file_index];
+	};
+
+	std::vector<size_t> missing_files;
+	std::vector<char> cacheable(handles.size(), 0);
+	std::vector<file_version> versions(handles.size());
+	for (size_t file_index = 0; file_index < handles.size(); file_index++) {
+		cacheable[file_index] = is_enabled() && get_file_version(handles[file_index].uri, versions[file_index]);
+
+		std::string payload;
+		bool file_has_row_groups = false;
+		if (cacheable[file_index] && read_entry("metadata", key, versions[file_index], payload) &&
+			decode_metadata(payload, tables[file_index], file_has_row_groups)) {
+			has_row_groups[file_index] = file_has_row_groups;
+		} else {
+			missing_files.push_back(file_index);
+		}
+	}
+
+	ral::utilities::run_in_parallel(missing_files.size(), [&](size_t missing_index) {
+		size_t file_index = missing_files[missing_index];
+		data_handle handle = handles[file_index];
+		handle.file_handle = open(file_index);
+		has_row_groups[file_index] = !get_row_group_stats(parser, handle).empty();
+		tables[file_index] = parser.get_metadata({handle.file_handle}, 0);
+		if (cacheable[file_index] && tables[file_index]) {
+			write_entry("metadata", key, versions[file_index], encode_metadata(*tables[file_index], has_row_groups[file_index]));
+		}
+	});
+
+	std::vector<std::unique_ptr<ral::frame::BlazingTable>> file_tables;
+	for (size_t file_index = 0; file_index < handles.size(); file_index++) {
+		if (has_row_groups[file_index] && tables[file_index]) {
+			file_tables.push_back(set_file_handle_index(std::move(tables[file_index]), offset + file_index));
+		}
+	}
+
+	// as the parsers do, the metadata of files without row groups is only used when no file has any
+	if (file_tables.empty()) {
+		return tables.empty() ? nullptr : std::move(tables[0]);
+	}
+
+	// files with different statistics columns are read together, as the parser would read them
+	for (auto & table : file_tables) {
+		if (table->names() != file_tables[0]->names()) {
+			for (size_t file_index = 0; file_index < handles.size(); file_index++) {
+				open(file_index);
+			}
+			return parser.get_metadata(files, offset);
+		}
+	}
+
+	if (file_tables.size() == 1) {
+		return std::move(file_tables[0]);
+	}
+	std::vector<ral::frame::BlazingTableView> views;
+	for (auto & table : file_tables) {
+		views.push_back(table->toBlazingTableView());
+	}
+	return ral::utilities::concatTables(views);
+}
+
+bool metadata_catalog::get_file_version(const Uri & uri, file_version & version) const {
+	FileStatus status;
+	try {
+		status = BlazingContext::getInstance()->getFileSystemManager()->getFileStatus(uri);
+	} catch (const std::exception &) {
+		return false;
+	}
+	if (!status.isFile() || status.getModificationTime() == 0) {
+		return false;
+	}
+	version = {uri.toString(), status.getFileSize(), status.getModificationTime()};
+	return true;
+}
+
+std::string metadata_catalog::get_entry_path(const std::string & kind, const std::string & key, const std::string & uri) const {
+	std::ostringstream path;
+	path << directory << "/" << std::hex << std::setw(16) << std::setfill('0') << std::hash<std::string>()(key + "\n" + uri) << "." << kind;
+	return path.str();
+}
+
+bool metadata_catalog::read_entry(const std::string & kind, const std::string & key, const file_version & version, std::string & payload) const {
+	std::ifstream entry_file(get_entry_path(kind, key, version.uri), std::ios::binary);
+	if (!entry_file) {
+		return false;
+	}
+	std::string data((std::istreambuf_iterator<char>(entry_file)), std::istreambuf_iterator<char>());
+
+	// the uri and the key are kept too, as different files may get the same entry path
+	entry_reader reader(data);
+	bool same_version = reader.get_string() == ENTRY_MAGIC && reader.get_string() == version.uri &&
+		reader.get_string() == key && reader.get_uint() == version.size && reader.get_uint() == version.modification_time;
+	if (!reader.ok || !same_version) {
+		return false;
+	}
+	payload = data.substr(reader.position);
+	return true;
+}
+
+void metadata_catalog::write_entry(const std::string & kind, const std::string & key, const file_version & version, const std::string & payload) const {
+	entry_writer writer;
+	writer.put(ENTRY_MAGIC);
+	writer.put(version.uri);
+	writer.put(key);
+	writer.put(version.size);
+	writer.put(version.modification_time);
+
+	std::string path = get_entry_path(kind, key, version.uri);
+	std::ostringstream temp_path;
+	temp_path << path << ".tmp." << getpid() << "." << std::hash<std::thread::id>()(std::this_thread::get_id());
+	{
+		std::ofstream entry_file(temp_path.str(), std::ios::binary | std::ios::trunc);
+		entry_file << writer.data << payload;
+		if (!entry_file) {
+			// the catalog is only a cache, the entry is read from the file again next time
+			entry_file.close();
+			std::remove(temp_path.str().c_str());
+			return;
+		}
+	}
+	if (std::rename(temp_path.str().c_str(), path.c_str()) != 0) {
+		std::remove(temp_path.str().c_str());
+	}
+}
+
+}  // namespace io
+}  // namespace ral
@@ -0,0 +1,99 @@
+#pragma once
+
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <blazingdb/io/FileSystem/Uri.h>
+
+#include "DataType.h"
+#include "Schema.h"
+#include "data_parser/DataParser.h"
+#include "data_provider/DataProvider.h"
+
+namespace ral {
+namespace io {
+
+/**
+ * @brief Keeps what is read from the footers of the files (schema, row group
+ * stats and min/max metadata) in a local directory, so the next tables and
+ * queries over the same files do not read the footers again.
+ *
+ * Every entry is a file of the directory that starts with the uri, size and
+ * modification time of the data file it was read from, and it is only used
+ * while the file system reports the same size and modification time. Files
+ * whose modification time is not known are never cached. Entries are written
+ * to a temporary file and renamed, so the processes sharing the directory
+ * never read a partial entry. The directory is created only accessible by the
+ * user, and one that other users can write to is not used.
+ */
+class metadata_catalog {
+public:
+	/**
+	 * @param directory Where the entries are kept, empty (or not private to the user) disables the catalog.
+	 */
+	metadata_catalog(const std::string & directory);
+
+	static void initialize(const std::string & directory);
+
+	/**
+	 * @brief Returns the catalog of the process, disabled if initialize was never called.
+	 */
+	static std::shared_ptr<metadata_catalog> get_instance();
+
+	bool is_enabled() const { return !directory.empty(); }
+
+	/**
+	 * @brief Identifies a format and the options that change the schema read from a file.
+	 */
+	static std::string get_parser_key(DataType data_type, const std::map<std::string, std::string> & args_map);
+
+	/**
+	 * @brief Adds the columns of the file to the schema, like data_parser::parse_schema,
+	 * unless the catalog has them already.
+	 */
+	void parse_schema(data_parser & parser, const std::string & parser_key, const data_handle & handle, Schema & schema);
+
+	/**
+	 * @brief Returns the stats of the row groups of the file, like data_parser::get_row_group_stats,
+	 * unless the catalog has them already.
+	 */
+	std::vector<row_group_stats> get_row_group_stats(data_parser & parser, const data_handle & handle);
+
+	/**
+	 * @brief Returns the min/max metadata of the files, like data_parser::get_metadata.
+	 * Only the files the catalog does not have are opened and read, in parallel.
+	 */
+	std::unique_ptr<ral::frame::BlazingTable> get_metadata(data_parser & parser, const std::vector<data_handle> & handles, int offset);
+
+private:
+	/**
+	 * @brief The version of a file an entry was read from.
+	 */
+	struct file_version {
+		std::string uri;
+		uint64_t size;
+		uint64_t modification_time;
+	};
+
+	/**
+	 * @brief Gets the current version of a file, false when it can not be cached.
+	 */
+	bool get_file_version(const Uri & uri, file_version & version) const;
+
+	std::string get_entry_path(const std::string & kind, const std::string & key, const std::string & uri) const;
+
+	/**
+	 * @brief Reads the payload of the entry of this version of a file, false if there is none.
+	 */
+	bool read_entry(const std::string & kind, const std::string & key, const file_version & version, std::string & payload) const;
+
+	void write_entry(const std::string & kind, const std::string & key, const file_version & version, const std::string & payload) const;
+
+	const std::string directory;
+};
+
+}  // namespace io
+}  // namespace ral
@@ -0,0 +1,115 @@
+#include "ScanPlanner.h"
+
+#include <algorithm>
+
+#include <cudf/utilities/traits.hpp>
+
+namespace ral {
+namespace io {
+
+std::vector<row_group_info> get_row_group_info(
+	const std::vector<row_group_stats> & row_groups,
+	const Schema & schema,
+	const std::vector<int> & column_indices) {
+
+	std::vector<row_group_info> row_groups_info;
+	for(size_t row_group_index = 0; row_group_index < row_groups.size(); row_group_index++) {
+		const row_group_stats & row_group = row_groups[row_group_index];
+		int64_t num_rows = row_group.num_rows;
+		if (num_rows == 0) {
+			row_groups_info.push_back({(int)row_group_index, 0, row_group.num_bytes});
+			continue;
+		}
+
+		int64_t num_bytes = 0;
+		for(int column_index : column_indices) {
+			cudf::data_type dtype{schema.get_dtype(column_index)};
+			auto column_bytes = row_group.column_bytes.find(schema.get_name(column_index));
+			if (cudf::is_fixed_width(dtype)) {
+				num_bytes += num_rows * cudf::size_of(dtype);
+			} else if (column_bytes != row_group.column_bytes.end()) {
+				// strings: the plain encoded chars plus the offsets
+				num_bytes += column_bytes->second + (num_rows + 1) * sizeof(cudf::size_type);
+			} else {
+				num_bytes += row_group.num_bytes / std::max<int64_t>(row_group.column_bytes.size(), 1);
+			}
+		}
+		row_groups_info.push_back({(int)row_group_index, num_rows, num_bytes});
+	}
+	return row_groups_info;
+}
+
+std::vector<scan_task> plan_scan_tasks(
+	const std::vector<std::vector<row_group_info>> & files_row_groups,
+	const std::vector<std::vector<int>> & selected_row_groups,
+	int64_t target_bytes,
+	int64_t max_rows) {
+
+	std::vector<scan_task> tasks;
+	scan_task current{{}, 0};
+	int64_t planned_rows = 0;
+
+	auto flush = [&]() {
+		if (!current.pieces.empty()) {
+			tasks.push_back(std::move(current));
+			current = scan_task{{}, 0};
+		}
+	};
+
+	for(size_t file_index = 0; file_index < files_row_groups.size(); file_index++) {
+		if (max_rows >= 0 && planned_rows >= max_rows) {
+			break;
+		}
+		const std::vector<row_group_info> & row_groups = files_row_groups[file_index];
+		std::vector<int> selected;
+		if (file_index < selected_row_groups.size()) {
+			selected = selected_row_groups[file_index];
+		}
+
+		if (row_groups.empty()) {
+			flush();
+			tasks.push_back(scan_task{{scan_piece{(int)file_index, selected, 0, 0}}, 0});
+			continue;
+		}
+
+		if (selected.empty()) {
+			for (auto & row_group : row_groups) {
+				selected.push_back(row_group.index);
+			}
+		}
+
+		for (int row_group_id : selected) {
+			if (max_rows >= 0 && planned_rows >= max_rows) {
+				break;
+			}
+			auto it = std::find_if(row_groups.begin(), row_groups.end(),
+				[row_group_id](const row_group_info & row_group) { return row_group.index == row_group_id; });
+			int64_t num_rows = it != row_groups.end() ? it->num_rows : 0;
+			int64_t num_bytes = it != row_groups.end() ? it->num_bytes : 0;
+
+			if (current.num_bytes > 0 && current.num_bytes + num_bytes > target_bytes) {
+				flush();
+			}
+
+			if (current.pieces.empty() || current.pieces.back().file_index != (int)file_index) {
+				current.pieces.push_back(scan_piece{(int)file_index, {}, 0, 0});
+			}
+			scan_piece & piece = current.pieces.back();
+			piece.row_group_ids.push_back(row_group_id);
+			piece.num_rows += num_rows;
+			piece.num_bytes += num_bytes;
+			current.num_bytes += num_bytes;
+			planned_rows += num_rows;
+
+			if (current.num_bytes >= target_bytes) {
+				flush();
+			}
+		}
+	}
+	flush();
+
+	return tasks;
+}
+
+}  // namespace io
+}  // namespace ral
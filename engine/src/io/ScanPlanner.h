@@ -0,0 +1,60 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "data_parser/DataParser.h"
+
+namespace ral {
+namespace io {
+
+/**
+ * @brief Row groups of a single file that are read together.
+ */
+struct scan_piece {
+	int file_index;
+	std::vector<int> row_group_ids;
+	int64_t num_rows;
+	int64_t num_bytes;
+};
+
+/**
+ * @brief Unit of work of a scan, one or more pieces that are loaded and concatenated by a single task.
+ */
+struct scan_task {
+	std::vector<scan_piece> pieces;
+	int64_t num_bytes;
+};
+
+/**
+ * @brief Returns the row groups of a file with the size they take once the given columns are loaded.
+ *
+ * Fixed width columns take their width for every row and strings their uncompressed size plus
+ * the offsets. A row group without a row count takes its whole size.
+ */
+std::vector<row_group_info> get_row_group_info(
+	const std::vector<row_group_stats> & row_groups,
+	const Schema & schema,
+	const std::vector<int> & column_indices);
+
+/**
+ * @brief Groups the row groups of the files into tasks of about target_bytes each.
+ *
+ * Row groups are packed in file order, so a task holds consecutive row groups
+ * of one or more files. A row group bigger than target_bytes gets a task of
+ * its own, as does a file without row group info, which is then read whole.
+ *
+ * @param files_row_groups The row groups of every file, as returned by get_row_group_info.
+ * @param selected_row_groups The row groups to read from every file, empty means all of them.
+ * @param target_bytes The size aimed for every task.
+ * @param max_rows When not negative, no more row groups are planned once the ones already planned hold this many rows.
+ * Only row groups with a known number of rows count.
+ */
+std::vector<scan_task> plan_scan_tasks(
+	const std::vector<std::vector<row_group_info>> & files_row_groups,
+	const std::vector<std::vector<int>> & selected_row_groups,
+	int64_t target_bytes,
+	int64_t max_rows = -1);
+
+}  // namespace io
+}  // namespace ral
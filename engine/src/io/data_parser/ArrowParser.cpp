@@ -7,24 +7,272 @@
 
 #include "ArrowParser.h"
 
+#include <algorithm>
+#include <cstring>
+
 #include "arrow/api.h"
+#include "arrow/util/bit_util.h"
+#include "arrow/util/bitmap_ops.h"
+
+#include <cudf/null_mask.hpp>
+#include <cudf/utilities/traits.hpp>
 
 namespace ral {
 namespace io {
 
-arrow_parser::arrow_parser(std::shared_ptr< arrow::Table > table):  table(table) {
-	// TODO Auto-generated constructor stub
+namespace {
+
+using ColumnTransport = blazingdb::transport::ColumnTransport;
+
+cudf::type_id get_cudf_type(const arrow::DataType & type) {
+	switch (type.id()) {
+		case arrow::Type::INT8: return cudf::type_id::INT8;
+		case arrow::Type::INT16: return cudf::type_id::INT16;
+		case arrow::Type::INT32: return cudf::type_id::INT32;
+		case arrow::Type::INT64: return cudf::type_id::INT64;
+		case arrow::Type::UINT8: return cudf::type_id::UINT8;
+		case arrow::Type::UINT16: return cudf::type_id::UINT16;
+		case arrow::Type::UINT32: return cudf::type_id::UINT32;
+		case arrow::Type::UINT64: return cudf::type_id::UINT64;
+		case arrow::Type::FLOAT: return cudf::type_id::FLOAT32;
+		case arrow::Type::DOUBLE: return cudf::type_id::FLOAT64;
+		case arrow::Type::BOOL: return cudf::type_id::BOOL8;
+		case arrow::Type::DATE32: return cudf::type_id::TIMESTAMP_DAYS;
+		case arrow::Type::DATE64: return cudf::type_id::TIMESTAMP_MILLISECONDS;
+		case arrow::Type::STRING: return cudf::type_id::STRING;
+		case arrow::Type::TIMESTAMP:
+			switch (static_cast<const arrow::TimestampType &>(type).unit()) {
+				case arrow::TimeUnit::SECOND: return cudf::type_id::TIMESTAMP_SECONDS;
+				case arrow::TimeUnit::MILLI: return cudf::type_id::TIMESTAMP_MILLISECONDS;
+				case arrow::TimeUnit::MICRO: return cudf::type_id::TIMESTAMP_MICROSECONDS;
+				case arrow::TimeUnit::NANO: return cudf::type_id::TIMESTAMP_NANOSECONDS;
+			}
+			break;
+		case arrow::Type::DURATION:
+			switch (static_cast<const arrow::DurationType &>(type).unit()) {
+				case arrow::TimeUnit::SECOND: return cudf::type_id::DURATION_SECONDS;
+				case arrow::TimeUnit::MILLI: return cudf::type_id::DURATION_MILLISECONDS;
+				case arrow::TimeUnit::MICRO: return cudf::type_id::DURATION_MICROSECONDS;
+				case arrow::TimeUnit::NANO: return cudf::type_id::DURATION_NANOSECONDS;
+			}
+			break;
+		default:
+			break;
+	}
+	return cudf::type_id::EMPTY;
+}
+
+/**
+ * @brief Holds what the chunks of a host table point to: the record batch it wraps and
+ * the buffers that had to be copied.
+ */
+struct arrow_host_data {
+	std::shared_ptr<arrow::RecordBatch> batch;
+	std::vector<std::shared_ptr<arrow::Buffer>> copied_buffers;
+};
+
+/**
+ * @brief Builds a host table whose chunks point to the buffers of a record batch.
+ * Every buffer is a chunk of its own, that is copied to a device buffer of use_size bytes.
+ */
+class host_table_builder {
+public:
+	host_table_builder(std::shared_ptr<arrow::RecordBatch> batch) : data(std::make_shared<arrow_host_data>()) {
+		data->batch = batch;
+	}
+
+	std::unique_ptr<ral::frame::BlazingHostTable> build() {
+		const arrow::RecordBatch & batch = *data->batch;
+		for (int i = 0; i < batch.num_columns(); i++) {
+			add_column(*batch.column(i), batch.schema()->field(i)->name());
+		}
+		return std::make_unique<ral::frame::BlazingHostTable>(columns_offsets,
+			std::move(chunked_column_infos), std::move(allocations), data);
+	}
+
+private:
+	void add_column(const arrow::Array & array, const std::string & name) {
+		cudf::type_id type = get_cudf_type(*array.type());
+		if (type == cudf::type_id::EMPTY) {
+			throw std::runtime_error("Column " + name + " of the Arrow table has the unsupported type " + array.type()->ToString());
+		}
+
+		ColumnTransport col_transport = ColumnTransport{ColumnTransport::MetaData{
+															.dtype = (int32_t)type,
+															.size = (int32_t)array.length(),
+															.null_count = (int32_t)array.null_count(),
+															.col_name = {},
+														},
+			.data = -1,
+			.valid = -1,
+			.strings_data = -1,
+			.strings_offsets = -1,
+			.strings_nullmask = -1,
+			.strings_data_size = 0,
+			.strings_offsets_size = 0,
+			.size_in_bytes = 0};
+		std::strncpy(col_transport.metadata.col_name, name.c_str(), sizeof(col_transport.metadata.col_name) - 1);
+
+		int64_t length = array.length();
+		if (length == 0) {
+			// do nothing
+		} else if (type == cudf::type_id::STRING) {
+			auto & strings = static_cast<const arrow::StringArray &>(array);
+			const int32_t * offsets = strings.raw_value_offsets();
+			const uint8_t * chars = strings.value_data() != nullptr ? strings.value_data()->data() : nullptr;
+
+			col_transport.strings_data = add_buffer(chars + offsets[0], offsets[length] - offsets[0], col_transport.size_in_bytes);
+			col_transport.strings_data_size = offsets[length] - offsets[0];
+
+			col_transport.strings_offsets_size = (length + 1) * sizeof(int32_t);
+			if (offsets[0] == 0) {
+				col_transport.strings_offsets = add_buffer(reinterpret_cast<const uint8_t *>(offsets), col_transport.strings_offsets_size, col_transport.size_in_bytes);
+			} else {
+				// a slice of a string array has offsets into the chars of the whole array
+				auto rebased = arrow::AllocateBuffer(col_transport.strings_offsets_size).ValueOrDie();
+				int32_t * rebased_offsets = reinterpret_cast<int32_t *>(rebased->mutable_data());
+				for (int64_t i = 0; i <= length; i++) {
+					rebased_offsets[i] = offsets[i] - offsets[0];
+				}
+				col_transport.strings_offsets = add_buffer(std::move(rebased), col_transport.strings_offsets_size, col_transport.size_in_bytes);
+			}
+
+			if (array.null_count() > 0) {
+				col_transport.strings_nullmask = add_null_mask(array, col_transport.size_in_bytes);
+			}
+		} else if (type == cudf::type_id::BOOL8) {
+			// cudf keeps a byte for every boolean, Arrow a bit
+			auto & booleans = static_cast<const arrow::BooleanArray &>(array);
+			auto values = arrow::AllocateBuffer(length).ValueOrDie();
+			for (int64_t i = 0; i < length; i++) {
+				values->mutable_data()[i] = booleans.Value(i) ? 1 : 0;
+			}
+			col_transport.data = add_buffer(std::move(values), length, col_transport.size_in_bytes);
 
-	std::cout<<"the total num rows is "<<table->num_rows()<<std::endl;
-	// WSM TODO table_schema news to be newed up and copy in the properties
+			if (array.null_count() > 0) {
+				col_transport.valid = add_null_mask(array, col_transport.size_in_bytes);
+			}
+		} else {
+			size_t width = cudf::size_of(cudf::data_type{type});
+			const uint8_t * values = array.data()->buffers[1]->data() + array.offset() * width;
+			col_transport.data = add_buffer(values, length * width, col_transport.size_in_bytes);
+
+			if (array.null_count() > 0) {
+				col_transport.valid = add_null_mask(array, col_transport.size_in_bytes);
+			}
+		}
+		columns_offsets.push_back(col_transport);
+	}
+
+	int add_null_mask(const arrow::Array & array, std::size_t & size_in_bytes) {
+		size_t use_size = cudf::bitmask_allocation_size_bytes(array.length());
+		if (array.offset() % 8 == 0) {
+			return add_buffer(array.null_bitmap_data() + array.offset() / 8,
+				arrow::BitUtil::BytesForBits(array.length()), size_in_bytes, use_size);
+		}
+		// the bits of a slice that does not start on a byte are shifted into a bitmap of its own
+		auto null_mask = arrow::internal::CopyBitmap(arrow::default_memory_pool(),
+			array.null_bitmap_data(), array.offset(), array.length()).ValueOrDie();
+		return add_buffer(std::move(null_mask), arrow::BitUtil::BytesForBits(array.length()), size_in_bytes, use_size);
+	}
+
+	int add_buffer(std::shared_ptr<arrow::Buffer> buffer, size_t size, std::size_t & size_in_bytes, size_t use_size = 0) {
+		const uint8_t * buffer_data = buffer->data();
+		data->copied_buffers.push_back(std::move(buffer));
+		return add_buffer(buffer_data, size, size_in_bytes, use_size);
+	}
+
+	int add_buffer(const uint8_t * buffer_data, size_t size, std::size_t & size_in_bytes, size_t use_size = 0) {
+		auto chunk = std::make_unique<ral::memory::blazing_allocation_chunk>();
+		chunk->size = size;
+		chunk->data = const_cast<char *>(reinterpret_cast<const char *>(buffer_data));
+		chunk->allocation = nullptr;
+
+		ral::memory::blazing_chunked_column_info chunked_column_info;
+		chunked_column_info.chunk_index.push_back(allocations.size());
+		chunked_column_info.offset.push_back(0);
+		chunked_column_info.size.push_back(size);
+		chunked_column_info.use_size = std::max(size, use_size);
+
+		size_in_bytes += chunked_column_info.use_size;
+		allocations.push_back(std::move(chunk));
+		chunked_column_infos.push_back(std::move(chunked_column_info));
+		return chunked_column_infos.size() - 1;
+	}
+
+	std::shared_ptr<arrow_host_data> data;
+	std::vector<ColumnTransport> columns_offsets;
+	std::vector<ral::memory::blazing_chunked_column_info> chunked_column_infos;
+	std::vector<std::unique_ptr<ral::memory::blazing_allocation_chunk>> allocations;
+};
+
+int64_t get_buffers_size(const arrow::ChunkedArray & column) {
+	int64_t num_bytes = 0;
+	for (auto & chunk : column.chunks()) {
+		for (auto & buffer : chunk->data()->buffers) {
+			if (buffer != nullptr) {
+				num_bytes += buffer->size();
+			}
+		}
+	}
+	return num_bytes;
 }
 
+}  // namespace
+
+arrow_parser::arrow_parser(std::shared_ptr< arrow::Table > table):  table(table) {}
+
 arrow_parser::~arrow_parser() {}
 
 void arrow_parser::parse_schema(std::shared_ptr<arrow::io::RandomAccessFile> /*file*/,
-		ral::io::Schema &  /*schema*/){
-	std::vector<std::string> names;
-	std::vector<cudf::type_id> types;
+		ral::io::Schema & schema){
+	for (int i = 0; i < table->num_columns(); i++) {
+		schema.add_column(table->field(i)->name(), get_cudf_type(*table->field(i)->type()), i, true);
+	}
+}
+
+std::vector<std::unique_ptr<ral::frame::BlazingHostTable>> arrow_parser::get_host_tables(
+	const std::vector<int> & column_indices, int64_t max_bytes_per_table) {
+
+	std::vector<std::shared_ptr<arrow::Field>> fields;
+	std::vector<std::shared_ptr<arrow::ChunkedArray>> columns;
+	int64_t num_bytes = 0;
+	for (int column_index : column_indices) {
+		fields.push_back(table->field(column_index));
+		columns.push_back(table->column(column_index));
+		num_bytes += get_buffers_size(*columns.back());
+	}
+	auto selected = arrow::Table::Make(arrow::schema(fields), columns, table->num_rows());
+
+	// the slices are whole multiples of 64 rows, so their null masks start on a byte
+	// whenever the chunks of the table do
+	arrow::TableBatchReader reader(*selected);
+	if (max_bytes_per_table > 0 && num_bytes > max_bytes_per_table) {
+		int64_t rows_per_table = std::max<int64_t>(table->num_rows() * max_bytes_per_table / num_bytes, 1);
+		reader.set_chunksize((rows_per_table + 63) / 64 * 64);
+	}
+
+	std::vector<std::unique_ptr<ral::frame::BlazingHostTable>> host_tables;
+	std::shared_ptr<arrow::RecordBatch> batch;
+	while (true) {
+		arrow::Status status = reader.ReadNext(&batch);
+		if (!status.ok()) {
+			throw std::runtime_error("Unable to read the Arrow table: " + status.ToString());
+		}
+		if (batch == nullptr) {
+			break;
+		}
+		host_tables.push_back(host_table_builder(batch).build());
+	}
+
+	if (host_tables.empty()) {
+		std::vector<std::shared_ptr<arrow::Array>> empty_columns;
+		for (auto & field : fields) {
+			empty_columns.push_back(arrow::MakeArrayOfNull(field->type(), 0).ValueOrDie());
+		}
+		host_tables.push_back(host_table_builder(arrow::RecordBatch::Make(arrow::schema(fields), 0, empty_columns)).build());
+	}
+	return host_tables;
 }
 
 }
@@ -1,5 +1,3 @@
-
-
 #ifndef ARROWPARSER_H_
 #define ARROWPARSER_H_
 
@@ -15,6 +13,12 @@
 namespace ral {
 namespace io {
 
+/**
+ * @brief Scans an Arrow table that is in host memory. Its buffers are wrapped as host tables
+ * without copying them (only null masks of slices that do not start on a byte, rebased string
+ * offsets and booleans, that are bytes in cudf, are copied), so they are copied straight to the
+ * device when the scan tasks load them.
+ */
 class arrow_parser : public data_parser {
 public:
 	arrow_parser( std::shared_ptr< arrow::Table > table);
@@ -24,6 +28,11 @@ public:
 	void parse_schema(std::shared_ptr<arrow::io::RandomAccessFile> file,
 			ral::io::Schema & schema);
 
+	bool has_host_tables() const override { return true; }
+
+	std::vector<std::unique_ptr<ral::frame::BlazingHostTable>> get_host_tables(
+		const std::vector<int> & column_indices, int64_t max_bytes_per_table) override;
+
 	DataType type() const override { return DataType::ARROW; }
 
 private:
@@ -0,0 +1,199 @@
+#include "CSVChunkPlanner.h"
+
+#include <algorithm>
+
+#include <arrow/buffer.h>
+#include <arrow/io/memory.h>
+
+#include "utilities/CommonOperations.h"
+
+namespace ral {
+namespace io {
+
+namespace {
+
+const int64_t SCAN_BLOCK_SIZE = 1 << 16;
+
+// State of the scan of a split point when it is assumed to be outside (or inside) a quoted field
+struct scan_hypothesis {
+	bool in_quotes;
+	bool valid;
+	bool closed_quote;  // the last character closed a quoted field
+	int64_t record_start;
+};
+
+} // namespace
+
+csv_chunk_planner::csv_chunk_planner(char lineterminator, char quotechar, char delimiter, bool has_header, int64_t chunk_size, int64_t max_lookahead)
+	: lineterminator{lineterminator}, quotechar{quotechar}, delimiter{delimiter}, has_header{has_header},
+	chunk_size{std::max<int64_t>(chunk_size, 1)}, max_lookahead{max_lookahead} {}
+
+csv_file_chunks csv_chunk_planner::plan_file(std::shared_ptr<arrow::io::RandomAccessFile> file) const {
+	return plan_files({file})[0];
+}
+
+std::vector<csv_file_chunks> csv_chunk_planner::plan_files(const std::vector<std::shared_ptr<arrow::io::RandomAccessFile>> & files) const {
+	std::vector<csv_file_chunks> plans(files.size());
+	std::vector<int64_t> file_sizes(files.size(), 0);
+	std::vector<int64_t> data_begins(files.size(), 0);
+
+	// the headers are read first, as the split points are counted from the end of the header
+	ral::utilities::run_in_parallel(files.size(), [&](size_t file_index) {
+		auto & file = files[file_index];
+		file_sizes[file_index] = file->GetSize().ValueOrDie();
+		if (has_header) {
+			int64_t header_end = find_header_end(file, file_sizes[file_index]);
+			std::string & header = plans[file_index].header;
+			header.resize(header_end);
+			if (header_end > 0) {
+				file->ReadAt(0, header_end, &header[0]).ValueOrDie();
+			}
+			data_begins[file_index] = header_end;
+		}
+	});
+
+	std::vector<std::pair<size_t, int64_t>> split_points;
+	for (size_t file_index = 0; file_index < files.size(); file_index++) {
+		for (int64_t offset = data_begins[file_index] + chunk_size; offset < file_sizes[file_index]; offset += chunk_size) {
+			split_points.emplace_back(file_index, offset);
+		}
+	}
+
+	std::vector<int64_t> record_starts(split_points.size());
+	ral::utilities::run_in_parallel(split_points.size(), [&](size_t split_index) {
+		size_t file_index = split_points[split_index].first;
+		record_starts[split_index] = find_record_start(files[file_index], split_points[split_index].second, file_sizes[file_index]);
+	});
+
+	// a record longer than chunk_size moves several split points to the same record, those give a single chunk
+	size_t split_index = 0;
+	for (size_t file_index = 0; file_index < files.size(); file_index++) {
+		int64_t begin = data_begins[file_index];
+		for (; split_index < split_points.size() && split_points[split_index].first == file_index; split_index++) {
+			int64_t end = std::max(record_starts[split_index], begin);
+			if (end > begin) {
+				plans[file_index].ranges.emplace_back(begin, end);
+				begin = end;
+			}
+		}
+		if (file_sizes[file_index] > begin || plans[file_index].ranges.empty()) {
+			plans[file_index].ranges.emplace_back(begin, file_sizes[file_index]);
+		}
+	}
+
+	return plans;
+}
+
+int64_t csv_chunk_planner::find_record_start(std::shared_ptr<arrow::io::RandomAccessFile> file, int64_t offset, int64_t file_size) const {
+	if (offset <= 0) {
+		return 0;
+	}
+	// the scan starts one byte before offset, so a record that starts right at offset is found
+	return scan_record_start(file, offset - 1, file_size, quotechar != '\0');
+}
+
+int64_t csv_chunk_planner::find_header_end(std::shared_ptr<arrow::io::RandomAccessFile> file, int64_t file_size) const {
+	// the start of the file is known to be outside a quoted field
+	return scan_record_start(file, 0, file_size, false);
+}
+
+int64_t csv_chunk_planner::scan_record_start(std::shared_ptr<arrow::io::RandomAccessFile> file, int64_t position, int64_t file_size, bool speculate) const {
+	// without speculation only the first hypothesis is followed
+	scan_hypothesis hypotheses[2] = {{false, true, false, -1}, {true, speculate, false, -1}};
+	scan_hypothesis & outside = hypotheses[0];
+	scan_hypothesis & inside = hypotheses[1];
+
+	auto is_field_start = [this](char c) {
+		return c == delimiter || c == lineterminator || c == '\r' || c == '\0';
+	};
+
+	const int64_t scan_begin = position;
+	char prev = '\0';
+	std::vector<char> block(SCAN_BLOCK_SIZE);
+	while (position < file_size) {
+		int64_t num_bytes = file->ReadAt(position, std::min(SCAN_BLOCK_SIZE, file_size - position), block.data()).ValueOrDie();
+		if (num_bytes <= 0) {
+			break;
+		}
+
+		for (int64_t i = 0; i < num_bytes; i++) {
+			char c = block[i];
+			for (auto & hypothesis : hypotheses) {
+				if (!hypothesis.valid) {
+					continue;
+				}
+				if (quotechar != '\0' && c == quotechar) {
+					if (hypothesis.in_quotes) {
+						hypothesis.in_quotes = false;
+						hypothesis.closed_quote = true;
+					} else {
+						// a quote only opens a field at its start, or right after a closing quote when it is escaped
+						if (!hypothesis.closed_quote && !is_field_start(prev)) {
+							hypothesis.valid = false;
+						}
+						hypothesis.in_quotes = true;
+						hypothesis.closed_quote = false;
+					}
+				} else {
+					if (hypothesis.closed_quote && c != delimiter && c != lineterminator && c != '\r') {
+						hypothesis.valid = false;
+					}
+					hypothesis.closed_quote = false;
+					if (!hypothesis.in_quotes && c == lineterminator && hypothesis.record_start < 0) {
+						hypothesis.record_start = position + i + 1;
+					}
+				}
+			}
+			prev = c;
+
+			if (!inside.valid) {
+				if (outside.record_start >= 0) {
+					return outside.record_start;
+				}
+			} else if (!outside.valid) {
+				if (inside.record_start >= 0) {
+					return inside.record_start;
+				}
+			} else if (outside.record_start >= 0 && position + i - scan_begin >= max_lookahead) {
+				return outside.record_start;
+			}
+		}
+		position += num_bytes;
+	}
+
+	// a field still quoted at the end of the file means that hypothesis was wrong
+	bool outside_holds = outside.valid && !outside.in_quotes;
+	bool inside_holds = inside.valid && !inside.in_quotes;
+	const scan_hypothesis & chosen = inside_holds && !outside_holds ? inside : outside;
+	return chosen.record_start >= 0 ? chosen.record_start : file_size;
+}
+
+std::shared_ptr<arrow::io::RandomAccessFile> read_csv_chunks(
+	const csv_file_chunks & chunks,
+	std::shared_ptr<arrow::io::RandomAccessFile> file,
+	const std::vector<int> & chunk_indices) {
+
+	int64_t num_bytes = chunks.header.size();
+	int64_t num_data_bytes = 0;
+	for (auto chunk : chunk_indices) {
+		auto & range = chunks.ranges.at(chunk);
+		num_data_bytes += range.second - range.first;
+	}
+	if (num_data_bytes == 0) {
+		return nullptr;
+	}
+	num_bytes += num_data_bytes;
+
+	std::shared_ptr<arrow::Buffer> buffer = arrow::AllocateBuffer(num_bytes).ValueOrDie();
+	uint8_t * data = buffer->mutable_data();
+	std::copy(chunks.header.begin(), chunks.header.end(), data);
+	data += chunks.header.size();
+	for (auto chunk : chunk_indices) {
+		auto & range = chunks.ranges[chunk];
+		data += file->ReadAt(range.first, range.second - range.first, data).ValueOrDie();
+	}
+	return std::make_shared<arrow::io::BufferReader>(buffer);
+}
+
+}  // namespace io
+}  // namespace ral
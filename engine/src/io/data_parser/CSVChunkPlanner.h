@@ -0,0 +1,72 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <arrow/io/interfaces.h>
+
+namespace ral {
+namespace io {
+
+/**
+ * @brief Chunks of a CSV file that start and end on record boundaries.
+ */
+struct csv_file_chunks {
+	std::string header; /**< Bytes of the header record, including its line terminator. Empty if the file has no header. */
+	std::vector<std::pair<int64_t, int64_t>> ranges; /**< [begin, end) byte range of every chunk, contiguous and after the header. */
+};
+
+/**
+ * @brief Splits CSV files into chunks of about chunk_size bytes that never cut a record.
+ *
+ * The split points of all the files are moved to the start of the next record
+ * in parallel, on the CPU. As the state at a split point is not known, every
+ * split point is scanned assuming it is outside and inside a quoted field, and
+ * a hypothesis is dropped when it finds a quote that can not open or close a
+ * field. When both hypotheses are still valid after max_lookahead bytes the
+ * split point is taken as outside a quoted field.
+ */
+class csv_chunk_planner {
+public:
+	/**
+	 * @param quotechar Character that quotes fields, '\0' if fields are never quoted.
+	 * @param has_header Whether the first record of every file is a header.
+	 */
+	csv_chunk_planner(char lineterminator, char quotechar, char delimiter, bool has_header, int64_t chunk_size, int64_t max_lookahead = 1 << 16);
+
+	csv_file_chunks plan_file(std::shared_ptr<arrow::io::RandomAccessFile> file) const;
+
+	std::vector<csv_file_chunks> plan_files(const std::vector<std::shared_ptr<arrow::io::RandomAccessFile>> & files) const;
+
+	/**
+	 * @brief Returns the offset of the first record that starts at or after offset, file_size if there is none.
+	 */
+	int64_t find_record_start(std::shared_ptr<arrow::io::RandomAccessFile> file, int64_t offset, int64_t file_size) const;
+
+private:
+	int64_t find_header_end(std::shared_ptr<arrow::io::RandomAccessFile> file, int64_t file_size) const;
+
+	int64_t scan_record_start(std::shared_ptr<arrow::io::RandomAccessFile> file, int64_t offset, int64_t file_size, bool speculate) const;
+
+	char lineterminator;
+	char quotechar;
+	char delimiter;
+	bool has_header;
+	int64_t chunk_size;
+	int64_t max_lookahead;
+};
+
+/**
+ * @brief Reads the header and the byte ranges of the given chunks of a file into memory.
+ * Returns nullptr when the chunks hold no records.
+ */
+std::shared_ptr<arrow::io::RandomAccessFile> read_csv_chunks(
+	const csv_file_chunks & chunks,
+	std::shared_ptr<arrow::io::RandomAccessFile> file,
+	const std::vector<int> & chunk_indices);
+
+}  // namespace io
+}  // namespace ral
@@ -6,8 +6,7 @@
  */
 
 #include "CSVParser.h"
-#include <arrow/buffer.h>
-#include <arrow/io/memory.h>
+#include <algorithm>
 #include <numeric>
 
 #include <blazingdb/io/Library/Logging/Logger.h>
@@ -40,6 +39,22 @@ std::unique_ptr<ral::frame::BlazingTable> csv_parser::parse_batch(
 
 	if(column_indices.size() > 0) {
 
+		// planned chunks are read exactly, the others rely on the reader to find the records of their byte range
+		std::shared_ptr<csv_file_chunks> chunks;
+		if(!row_groups.empty()) {
+			std::lock_guard<std::mutex> lock(chunks_mutex);
+			auto it = file_chunks.find(handle.uri.toString());
+			if(it != file_chunks.end()) {
+				chunks = it->second;
+			}
+		}
+		if(chunks) {
+			file = read_csv_chunks(*chunks, file, row_groups);
+			if(file == nullptr) {
+				return schema.makeEmptyBlazingTable(column_indices);
+			}
+		}
+
 		// copy column_indices into use_col_indexes (at the moment is ordered only)
 		auto arrow_source = cudf::io::arrow_io_source{file};
 		cudf::io::csv_reader_options args = getCsvReaderOptions(args_map, arrow_source);
@@ -55,7 +70,7 @@ std::unique_ptr<ral::frame::BlazingTable> csv_parser::parse_batch(
 
 		// Overrride `byte_range_offset` and `byte_range_size`
 		auto iter = args_map.find("max_bytes_chunk_read");
-		if(iter != args_map.end() && !row_groups.empty()) {
+		if(iter != args_map.end() && !row_groups.empty() && !chunks) {
 			auto chunk_size = std::stoll(iter->second);
 			args.set_byte_range_offset(chunk_size * row_groups[0]);
 			args.set_byte_range_size(chunk_size);
@@ -134,5 +149,60 @@ size_t csv_parser::max_bytes_chunk_size() const {
 	return std::stoll(iter->second);
 }
 
+bool csv_parser::can_plan_chunks() const {
+	if(max_bytes_chunk_size() == 0) {
+		return false;
+	}
+	// skipped rows are counted from the start of the file and comments may hold unbalanced quotes
+	for(auto key : {"skiprows", "skipfooter", "nrows", "comment"}) {
+		if(args_map.find(key) != args_map.end()) {
+			return false;
+		}
+	}
+	auto header = args_map.find("header");
+	if(header != args_map.end() && to_int(header->second) > 0) {
+		return false;
+	}
+	auto compression = args_map.find("compression");
+	return compression == args_map.end() ||
+		(cudf::io::compression_type) to_int(compression->second) == cudf::io::compression_type::NONE;
+}
+
+std::vector<size_t> csv_parser::plan_chunks(const std::vector<ral::io::data_handle> & handles) {
+	auto arg = [this](const std::string & key, char default_value) {
+		auto iter = args_map.find(key);
+		return iter != args_map.end() ? ord(iter->second) : default_value;
+	};
+	auto has_header = args_map.find("has_header_csv");
+	csv_chunk_planner planner(arg("lineterminator", '\n'), arg("quotechar", '"'), arg("delimiter", ','),
+		has_header != args_map.end() && has_header->second == "True", max_bytes_chunk_size());
+
+	std::vector<std::string> uris;
+	std::vector<std::shared_ptr<arrow::io::RandomAccessFile>> files;
+	{
+		std::lock_guard<std::mutex> lock(chunks_mutex);
+		for(auto & handle : handles) {
+			std::string uri = handle.uri.toString();
+			if(handle.file_handle != nullptr && file_chunks.find(uri) == file_chunks.end()) {
+				uris.push_back(uri);
+				files.push_back(handle.file_handle);
+			}
+		}
+	}
+
+	std::vector<csv_file_chunks> plans = planner.plan_files(files);
+
+	std::vector<size_t> num_chunks;
+	std::lock_guard<std::mutex> lock(chunks_mutex);
+	for(size_t i = 0; i < plans.size(); i++) {
+		file_chunks[uris[i]] = std::make_shared<csv_file_chunks>(std::move(plans[i]));
+	}
+	for(auto & handle : handles) {
+		auto it = file_chunks.find(handle.uri.toString());
+		num_chunks.push_back(handle.file_handle != nullptr && it != file_chunks.end() ? it->second->ranges.size() : 0);
+	}
+	return num_chunks;
+}
+
 } /* namespace io */
 } /* namespace ral */
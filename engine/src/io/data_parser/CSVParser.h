@@ -9,9 +9,12 @@
 #define CSVPARSER_H_
 
 #include "DataParser.h"
+#include "CSVChunkPlanner.h"
 #include "../data_provider/DataProvider.h"
 #include "arrow/io/interfaces.h"
+#include <map>
 #include <memory>
+#include <mutex>
 #include <vector>
 
 #include <cudf/io/datasource.hpp>
@@ -36,10 +39,29 @@ public:
 
 	size_t max_bytes_chunk_size() const;
 
+	/**
+	 * @brief Whether the files can be split into chunks by record boundaries,
+	 * which needs max_bytes_chunk_read and is not done for compressed files or
+	 * when rows are skipped.
+	 */
+	bool can_plan_chunks() const override;
+
+	/**
+	 * @brief Splits the files into chunks of about max_bytes_chunk_size bytes that
+	 * start and end on record boundaries, and keeps their byte ranges and header.
+	 * Once planned, the row groups passed to parse_batch are chunk indices.
+	 *
+	 * @return The number of chunks of every file, 0 for a file that could not be opened.
+	 */
+	std::vector<size_t> plan_chunks(const std::vector<ral::io::data_handle> & handles) override;
+
 	DataType type() const override { return DataType::CSV; }
 
 private:
 	std::map<std::string, std::string> args_map;
+
+	std::mutex chunks_mutex;
+	std::map<std::string, std::shared_ptr<csv_file_chunks>> file_chunks; /**< Planned chunks of every file, by uri. */
 };
 
 } /* namespace io */
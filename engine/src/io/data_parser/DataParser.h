@@ -13,13 +13,37 @@
 #include "../data_provider/DataProvider.h"
 
 #include "execution_graph/logic_controllers/LogicPrimitives.h"
+#include "execution_graph/logic_controllers/BlazingHostTable.h"
 #include "arrow/io/interfaces.h"
+#include <map>
 #include <memory>
+#include <string>
 #include <vector>
 
 namespace ral {
 namespace io {
 
+/**
+ * @brief Row count of a row group (Parquet) or stripe (ORC) and the size it
+ * takes once the scanned columns are loaded. num_rows is 0 when it is not known.
+ */
+struct row_group_info {
+	int index;
+	int64_t num_rows;
+	int64_t num_bytes;
+};
+
+/**
+ * @brief Row count, size and size of every column of a row group (Parquet) or
+ * stripe (ORC), as stored in the footer of a file. num_rows is 0 and
+ * column_bytes is empty when they are not known.
+ */
+struct row_group_stats {
+	int64_t num_rows;
+	int64_t num_bytes;
+	std::map<std::string, int64_t> column_bytes; /**< Uncompressed bytes of every column, by name. */
+};
+
 class data_parser {
 public:
 
@@ -44,6 +68,52 @@ public:
 		return nullptr;
 	}
 
+	/**
+	 * @brief Returns the stats of the row groups of a file, read from its footer.
+	 * Empty if the format has no row groups.
+	 */
+	virtual std::vector<row_group_stats> get_row_group_stats(
+		std::shared_ptr<arrow::io::RandomAccessFile> /*file*/) {
+		return {};
+	}
+
+	/**
+	 * @brief Whether the text files can be split into chunks of whole records,
+	 * each of them parsed by its own task.
+	 */
+	virtual bool can_plan_chunks() const {
+		return false;
+	}
+
+	/**
+	 * @brief Splits the files into chunks of whole records. Once planned, the row
+	 * groups passed to parse_batch are chunk indices.
+	 *
+	 * @return The number of chunks of every file, 0 for a file that could not be opened.
+	 */
+	virtual std::vector<size_t> plan_chunks(const std::vector<ral::io::data_handle> & /*handles*/) {
+		return {};
+	}
+
+	/**
+	 * @brief Whether the data is already in host memory, in a layout that the scan tasks
+	 * take as host tables without copying it.
+	 */
+	virtual bool has_host_tables() const {
+		return false;
+	}
+
+	/**
+	 * @brief Wraps the data in host tables of about max_bytes_per_table bytes, one per scan task.
+	 * The data is only copied to the device when the tasks load the tables.
+	 *
+	 * @return At least one table, an empty one when there is no data.
+	 */
+	virtual std::vector<std::unique_ptr<ral::frame::BlazingHostTable>> get_host_tables(
+		const std::vector<int> & /*column_indices*/, int64_t /*max_bytes_per_table*/) {
+		return {};
+	}
+
 	virtual DataType type() const { return 	DataType::UNDEFINED; }
 };
 
@@ -1,5 +1,8 @@
 #include <arrow/io/file.h>
 #include <blazingdb/io/Library/Logging/Logger.h>
+#include <cudf/column/column_factories.hpp>
+#include <cudf/scalar/scalar_factories.hpp>
+#include <algorithm>
 #include <numeric>
 
 #include "ArgsUtil.h"
@@ -8,6 +11,34 @@
 namespace ral {
 namespace io {
 
+namespace {
+
+// Name of a type as the dtype option of the JSON reader expects it, empty if it has none
+std::string get_json_dtype(cudf::type_id type) {
+	switch(type) {
+	case cudf::type_id::BOOL8: return "bool";
+	case cudf::type_id::INT8: return "int8";
+	case cudf::type_id::INT16: return "int16";
+	case cudf::type_id::INT32: return "int32";
+	case cudf::type_id::INT64: return "int64";
+	case cudf::type_id::UINT8: return "uint8";
+	case cudf::type_id::UINT16: return "uint16";
+	case cudf::type_id::UINT32: return "uint32";
+	case cudf::type_id::UINT64: return "uint64";
+	case cudf::type_id::FLOAT32: return "float32";
+	case cudf::type_id::FLOAT64: return "float64";
+	case cudf::type_id::STRING: return "str";
+	case cudf::type_id::TIMESTAMP_DAYS: return "date32";
+	case cudf::type_id::TIMESTAMP_SECONDS: return "timestamp[s]";
+	case cudf::type_id::TIMESTAMP_MILLISECONDS: return "timestamp[ms]";
+	case cudf::type_id::TIMESTAMP_MICROSECONDS: return "timestamp[us]";
+	case cudf::type_id::TIMESTAMP_NANOSECONDS: return "timestamp[ns]";
+	default: return "";
+	}
+}
+
+}  // namespace
+
 json_parser::json_parser(std::map<std::string, std::string> args_map_) : args_map{args_map_} {}
 
 json_parser::~json_parser() {
@@ -17,18 +48,55 @@ json_parser::~json_parser() {
 std::unique_ptr<ral::frame::BlazingTable> json_parser::parse_batch(ral::io::data_handle handle,
 	const Schema & schema,
 	std::vector<int> column_indices,
-	std::vector<cudf::size_type> /*row_groups*/) {
+	std::vector<cudf::size_type> row_groups) {
 	std::shared_ptr<arrow::io::RandomAccessFile> file = handle.file_handle;
 	if(file == nullptr) {
 		return schema.makeEmptyBlazingTable(column_indices);
 	}
 
 	if(column_indices.size() > 0) {
+
+		// planned chunks are read exactly, the other files are read whole
+		std::shared_ptr<csv_file_chunks> chunks;
+		if(!row_groups.empty()) {
+			std::lock_guard<std::mutex> lock(chunks_mutex);
+			auto it = file_chunks.find(handle.uri.toString());
+			if(it != file_chunks.end()) {
+				chunks = it->second;
+			}
+		}
+		if(chunks) {
+			file = read_csv_chunks(*chunks, file, row_groups);
+			if(file == nullptr) {
+				return schema.makeEmptyBlazingTable(column_indices);
+			}
+		}
+
 		auto arrow_source = cudf::io::arrow_io_source{file};
 		cudf::io::json_reader_options json_opts = getJsonReaderOptions(args_map, arrow_source);
 
+		// a chunk may not hold every key, or hold values that would be inferred as another type,
+		// so its columns are found by name and parsed with the types inferred for the whole file
+		std::map<size_t, std::pair<std::string, cudf::type_id>> file_columns;
+		if(chunks) {
+			auto file_indices = schema.get_calcite_to_file_indices();
+			std::vector<std::string> dtypes;
+			for(size_t i = 0; i < schema.get_num_columns(); i++) {
+				size_t file_index = file_indices.empty() ? i : file_indices[i];
+				file_columns[file_index] = {schema.get_name(i), schema.get_dtype(i)};
+				std::string dtype = get_json_dtype(schema.get_dtype(i));
+				if(!dtype.empty()) {
+					dtypes.push_back(schema.get_name(i) + ":" + dtype);
+				}
+			}
+			if(args_map.find("dtype") == args_map.end()) {
+				json_opts.dtypes(dtypes);
+			}
+		}
+
 		cudf::io::table_with_metadata json_table = cudf::io::read_json(json_opts);
 
+		cudf::size_type num_rows = json_table.tbl->num_rows();
 		auto columns = json_table.tbl->release();
 		auto column_names = std::move(json_table.metadata.column_names);
 
@@ -38,8 +106,21 @@ std::unique_ptr<ral::frame::BlazingTable> json_parser::parse_batch(ral::io::data
 		std::vector<std::string> selected_column_names;
 		selected_column_names.reserve(column_indices.size());
 		for(auto && i : column_indices) {
-			selected_columns.push_back(std::move(columns[i]));
-			selected_column_names.push_back(std::move(column_names[i]));
+			if(!chunks) {
+				selected_columns.push_back(std::move(columns[i]));
+				selected_column_names.push_back(std::move(column_names[i]));
+				continue;
+			}
+
+			auto & file_column = file_columns.at(i);
+			auto it = std::find(column_names.begin(), column_names.end(), file_column.first);
+			if(it != column_names.end()) {
+				selected_columns.push_back(std::move(columns[it - column_names.begin()]));
+			} else {
+				auto null_scalar = cudf::make_default_constructed_scalar(cudf::data_type{file_column.second});
+				selected_columns.push_back(cudf::make_column_from_scalar(*null_scalar, num_rows));
+			}
+			selected_column_names.push_back(file_column.first);
 		}
 
 		return std::make_unique<ral::frame::BlazingTable>(
@@ -74,5 +155,64 @@ void json_parser::parse_schema(std::shared_ptr<arrow::io::RandomAccessFile> file
 	}
 }
 
+size_t json_parser::max_bytes_chunk_size() const {
+	auto iter = args_map.find("max_bytes_chunk_read");
+	if(iter == args_map.end()) {
+		return 0;
+	}
+
+	return std::stoll(iter->second);
+}
+
+bool json_parser::can_plan_chunks() const {
+	if(max_bytes_chunk_size() == 0) {
+		return false;
+	}
+	// only JSON lines has a record per line, and a given byte range already reads part of the file
+	auto lines = args_map.find("lines");
+	if(lines != args_map.end() && !to_bool(lines->second)) {
+		return false;
+	}
+	for(auto key : {"byte_range_offset", "byte_range_size"}) {
+		if(args_map.find(key) != args_map.end()) {
+			return false;
+		}
+	}
+	auto compression = args_map.find("compression");
+	return compression == args_map.end() ||
+		(cudf::io::compression_type) to_int(compression->second) == cudf::io::compression_type::NONE;
+}
+
+std::vector<size_t> json_parser::plan_chunks(const std::vector<ral::io::data_handle> & handles) {
+	// strings of JSON can not hold a line terminator, so every line terminator ends a record
+	csv_chunk_planner planner('\n', '\0', ',', false, max_bytes_chunk_size());
+
+	std::vector<std::string> uris;
+	std::vector<std::shared_ptr<arrow::io::RandomAccessFile>> files;
+	{
+		std::lock_guard<std::mutex> lock(chunks_mutex);
+		for(auto & handle : handles) {
+			std::string uri = handle.uri.toString();
+			if(handle.file_handle != nullptr && file_chunks.find(uri) == file_chunks.end()) {
+				uris.push_back(uri);
+				files.push_back(handle.file_handle);
+			}
+		}
+	}
+
+	std::vector<csv_file_chunks> plans = planner.plan_files(files);
+
+	std::vector<size_t> num_chunks;
+	std::lock_guard<std::mutex> lock(chunks_mutex);
+	for(size_t i = 0; i < plans.size(); i++) {
+		file_chunks[uris[i]] = std::make_shared<csv_file_chunks>(std::move(plans[i]));
+	}
+	for(auto & handle : handles) {
+		auto it = file_chunks.find(handle.uri.toString());
+		num_chunks.push_back(handle.file_handle != nullptr && it != file_chunks.end() ? it->second->ranges.size() : 0);
+	}
+	return num_chunks;
+}
+
 } /* namespace io */
 } /* namespace ral */
@@ -3,10 +3,13 @@
 #include <arrow/io/interfaces.h>
 #include <cudf/io/datasource.hpp>
 #include <cudf/io/json.hpp>
+#include <map>
 #include <memory>
+#include <mutex>
 #include <vector>
 
 #include "DataParser.h"
+#include "CSVChunkPlanner.h"
 
 namespace ral {
 namespace io {
@@ -24,10 +27,31 @@ public:
 
 	void parse_schema(std::shared_ptr<arrow::io::RandomAccessFile> file, Schema & schema);
 
+	size_t max_bytes_chunk_size() const;
+
+	/**
+	 * @brief Whether the files can be split into chunks of whole lines, which
+	 * needs max_bytes_chunk_read and is only done for uncompressed JSON lines.
+	 */
+	bool can_plan_chunks() const override;
+
+	/**
+	 * @brief Splits the files into chunks of about max_bytes_chunk_size bytes that
+	 * start and end on line boundaries. Once planned, the row groups passed to
+	 * parse_batch are chunk indices, and the chunks are parsed with the column
+	 * types of the schema instead of inferring them again.
+	 *
+	 * @return The number of chunks of every file, 0 for a file that could not be opened.
+	 */
+	std::vector<size_t> plan_chunks(const std::vector<ral::io::data_handle> & handles) override;
+
 	DataType type() const override { return DataType::JSON; }
 
 private:
 	std::map<std::string, std::string> args_map;
+
+	std::mutex chunks_mutex;
+	std::map<std::string, std::shared_ptr<csv_file_chunks>> file_chunks; /**< Planned chunks of every file, by uri. */
 };
 
 } /* namespace io */
@@ -85,5 +85,21 @@ std::unique_ptr<ral::frame::BlazingTable> orc_parser::get_metadata(
 	return minmax_metadata_table;
 }
 
+std::vector<row_group_stats> orc_parser::get_row_group_stats(
+	std::shared_ptr<arrow::io::RandomAccessFile> file) {
+
+	auto arrow_source = cudf::io::arrow_io_source{file};
+	cudf::io::parsed_orc_statistics statistics = cudf::io::read_parsed_orc_statistics(cudf::io::source_info{&arrow_source});
+
+	// the row count and size of every stripe are not exposed, so the file size is split evenly among them
+	std::vector<row_group_stats> stripes;
+	int num_stripes = statistics.stripes_stats.size();
+	int64_t file_size = file->GetSize().ValueOrDie();
+	for(int stripe_index = 0; stripe_index < num_stripes; stripe_index++) {
+		stripes.push_back({0, file_size / num_stripes, {}});
+	}
+	return stripes;
+}
+
 } /* namespace io */
 } /* namespace ral */
@@ -31,6 +31,9 @@ public:
 		std::vector<std::shared_ptr<arrow::io::RandomAccessFile>> files,
 		int offset);
 
+	std::vector<row_group_stats> get_row_group_stats(
+		std::shared_ptr<arrow::io::RandomAccessFile> file) override;
+
 	DataType type() const override { return DataType::ORC; }
 
 private:
@@ -7,6 +7,7 @@
 #include <numeric>
 
 #include <arrow/io/file.h>
+#include <blazingdb/io/FileSystem/ReadAheadFile.h>
 #include "ExceptionHandling/BlazingThread.h"
 
 #include <parquet/column_writer.h>
@@ -19,6 +20,46 @@ namespace io {
 
 namespace cudf_io = cudf::io;
 
+namespace {
+
+// tells a remote file which column chunks are about to be read, so they are loaded together and in parallel
+void prefetch_column_chunks(std::shared_ptr<ReadAheadFile> file,
+	const std::vector<std::string> & col_names,
+	const std::vector<cudf::size_type> & row_groups) {
+	try {
+		auto parquet_reader = parquet::ParquetFileReader::Open(file);
+		std::shared_ptr<parquet::FileMetaData> file_metadata = parquet_reader->metadata();
+
+		std::vector<int> columns;
+		for(auto & name : col_names) {
+			int column_index = file_metadata->schema()->ColumnIndex(name);
+			if(column_index >= 0) {
+				columns.push_back(column_index);
+			}
+		}
+		std::vector<cudf::size_type> planned_row_groups = row_groups;
+		if(planned_row_groups.empty()) {
+			planned_row_groups.resize(file_metadata->num_row_groups());
+			std::iota(planned_row_groups.begin(), planned_row_groups.end(), 0);
+		}
+
+		std::vector<std::pair<int64_t, int64_t>> ranges;
+		for(cudf::size_type row_group_index : planned_row_groups) {
+			auto row_group = file_metadata->RowGroup(row_group_index);
+			for(int column_index : columns) {
+				auto column_chunk = row_group->ColumnChunk(column_index);
+				int64_t offset = column_chunk->has_dictionary_page() ? column_chunk->dictionary_page_offset() : column_chunk->data_page_offset();
+				ranges.emplace_back(offset, column_chunk->total_compressed_size());
+			}
+		}
+		file->willNeed(ranges);
+	} catch(const std::exception &) {
+		// the chunks are only loaded ahead, read_parquet reports anything wrong with the file
+	}
+}
+
+} // namespace
+
 parquet_parser::parquet_parser() {
 	// TODO Auto-generated constructor stub
 }
@@ -61,6 +102,11 @@ std::unique_ptr<ral::frame::BlazingTable> parquet_parser::parse_batch(
 
 		pq_args.set_row_groups(full_row_groups);
 
+		auto read_ahead_file = std::dynamic_pointer_cast<ReadAheadFile>(file);
+		if(read_ahead_file != nullptr) {
+			prefetch_column_chunks(read_ahead_file, col_names, row_groups);
+		}
+
 		auto result = cudf::io::read_parquet(pq_args);
 
 		auto result_table = std::move(result.tbl);
@@ -131,5 +177,24 @@ std::unique_ptr<ral::frame::BlazingTable> parquet_parser::get_metadata(
 	return minmax_metadata_table;
 }
 
+std::vector<row_group_stats> parquet_parser::get_row_group_stats(
+	std::shared_ptr<arrow::io::RandomAccessFile> file) {
+
+	std::vector<row_group_stats> row_groups;
+	auto parquet_reader = parquet::ParquetFileReader::Open(file);
+	std::shared_ptr<parquet::FileMetaData> file_metadata = parquet_reader->metadata();
+
+	for(int row_group_index = 0; row_group_index < file_metadata->num_row_groups(); row_group_index++) {
+		auto row_group = file_metadata->RowGroup(row_group_index);
+		row_group_stats stats{row_group->num_rows(), row_group->total_byte_size(), {}};
+		for(int column_index = 0; column_index < file_metadata->num_columns(); column_index++) {
+			std::string name = file_metadata->schema()->Column(column_index)->path()->ToDotString();
+			stats.column_bytes[name] = row_group->ColumnChunk(column_index)->total_uncompressed_size();
+		}
+		row_groups.push_back(std::move(stats));
+	}
+	return row_groups;
+}
+
 } /* namespace io */
 } /* namespace ral */
@@ -0,0 +1,407 @@
+#include "FileHandlePool.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+#include <arrow/result.h>
+#include "Config/BlazingContext.h"
+
+namespace ral {
+namespace io {
+
+namespace {
+
+const size_t DEFAULT_MAX_OPEN_FILES = 512;
+const size_t DEFAULT_NUM_OPENER_THREADS = 4;
+const size_t DEFAULT_NUM_PREFETCHED_FILES = 8;
+
+std::mutex instance_mutex;
+std::shared_ptr<file_handle_pool> instance;
+
+std::shared_ptr<arrow::io::RandomAccessFile> open_readable(const Uri & uri) {
+	auto file = BlazingContext::getInstance()->getFileSystemManager()->openReadable(uri);
+	if (file == nullptr) {
+		throw std::runtime_error("Unable to open " + uri.toString() + " for reading");
+	}
+	return file;
+}
+
+} // namespace
+
+struct file_handle_pool::entry {
+	enum class state { CLOSED, OPENING, OPEN };
+
+	explicit entry(const Uri & uri) : uri(uri) {}
+
+	Uri uri;
+	state status = state::CLOSED;
+	std::shared_ptr<arrow::io::RandomAccessFile> file;
+	size_t num_readers = 0;
+	bool is_idle = false;
+	std::list<std::shared_ptr<entry>>::iterator idle_position;
+	bool prefetched = false; /**< Still waiting in prefetched_files to be claimed by open. */
+	bool closed = false; /**< Closed by its owner, it is never opened again. */
+};
+
+/**
+ * @brief A file of the pool, it reads through whatever handle the pool has open for it,
+ * so the handle can be closed and opened again between reads.
+ */
+class pooled_file : public arrow::io::RandomAccessFile {
+public:
+	pooled_file(std::shared_ptr<file_handle_pool> pool, std::shared_ptr<file_handle_pool::entry> file_entry)
+		: pool{pool}, file_entry{file_entry} {}
+
+	~pooled_file() { pool->close(file_entry); }
+
+	arrow::Status Close() override {
+		is_closed = true;
+		pool->close(file_entry);
+		return arrow::Status::OK();
+	}
+
+	bool closed() const override { return is_closed; }
+
+	arrow::Result<int64_t> GetSize() override {
+		if (size < 0) {
+			ARROW_ASSIGN_OR_RAISE(size, with_file<int64_t>([](arrow::io::RandomAccessFile & file) { return file.GetSize(); }));
+		}
+		return size;
+	}
+
+	arrow::Result<int64_t> Read(int64_t nbytes, void * out) override {
+		ARROW_ASSIGN_OR_RAISE(int64_t bytes_read, ReadAt(position, nbytes, out));
+		position += bytes_read;
+		return bytes_read;
+	}
+
+	arrow::Result<std::shared_ptr<arrow::Buffer>> Read(int64_t nbytes) override {
+		ARROW_ASSIGN_OR_RAISE(auto buffer, ReadAt(position, nbytes));
+		position += buffer->size();
+		return buffer;
+	}
+
+	arrow::Result<int64_t> ReadAt(int64_t read_position, int64_t nbytes, void * out) override {
+		return with_file<int64_t>([read_position, nbytes, out](arrow::io::RandomAccessFile & file) {
+			return file.ReadAt(read_position, nbytes, out);
+		});
+	}
+
+	arrow::Result<std::shared_ptr<arrow::Buffer>> ReadAt(int64_t read_position, int64_t nbytes) override {
+		return with_file<std::shared_ptr<arrow::Buffer>>([read_position, nbytes](arrow::io::RandomAccessFile & file) {
+			return file.ReadAt(read_position, nbytes);
+		});
+	}
+
+	// the buffers must outlive the handle they were read from, which may be closed by the pool
+	bool supports_zero_copy() const override { return false; }
+
+	arrow::Status Seek(int64_t new_position) override {
+		if (is_closed) {
+			return arrow::Status::Invalid("Operation on closed file");
+		}
+		position = new_position;
+		return arrow::Status::OK();
+	}
+
+	arrow::Result<int64_t> Tell() const override { return position; }
+
+private:
+	// keeps the handle open while the function reads from it
+	template <typename T, typename Function>
+	arrow::Result<T> with_file(Function function) {
+		if (is_closed) {
+			return arrow::Status::Invalid("Operation on closed file");
+		}
+
+		std::shared_ptr<arrow::io::RandomAccessFile> file;
+		try {
+			file = pool->acquire(file_entry);
+		} catch (const std::exception & e) {
+			return arrow::Status::IOError(e.what());
+		}
+
+		struct lease {
+			file_handle_pool & pool;
+			const std::shared_ptr<file_handle_pool::entry> & file_entry;
+			~lease() { pool.release(file_entry); }
+		} file_lease{*pool, file_entry};
+		return function(*file);
+	}
+
+	std::shared_ptr<file_handle_pool> pool;
+	std::shared_ptr<file_handle_pool::entry> file_entry;
+	int64_t position = 0;
+	int64_t size = -1;
+	bool is_closed = false;
+};
+
+file_handle_pool::file_handle_pool(size_t max_open_files, size_t num_opener_threads, size_t num_prefetched_files)
+	: max_open_files{std::max<size_t>(max_open_files, 1)}, num_prefetched_files{num_opener_threads > 0 ? num_prefetched_files : 0} {
+	for (size_t i = 0; i < num_opener_threads; i++) {
+		opener_threads.emplace_back(&file_handle_pool::run_opener, this);
+	}
+}
+
+file_handle_pool::~file_handle_pool() {
+	{
+		std::lock_guard<std::mutex> lock(pool_mutex);
+		shutting_down = true;
+	}
+	pool_cv.notify_all();
+	for (auto & thread : opener_threads) {
+		thread.join();
+	}
+}
+
+void file_handle_pool::initialize(size_t max_open_files, size_t num_opener_threads, size_t num_prefetched_files) {
+	std::lock_guard<std::mutex> lock(instance_mutex);
+	if (!instance) {
+		instance = std::make_shared<file_handle_pool>(max_open_files, num_opener_threads, num_prefetched_files);
+	}
+}
+
+std::shared_ptr<file_handle_pool> file_handle_pool::get_instance() {
+	std::lock_guard<std::mutex> lock(instance_mutex);
+	if (!instance) {
+		instance = std::make_shared<file_handle_pool>(DEFAULT_MAX_OPEN_FILES, DEFAULT_NUM_OPENER_THREADS, DEFAULT_NUM_PREFETCHED_FILES);
+	}
+	return instance;
+}
+
+std::shared_ptr<arrow::io::RandomAccessFile> file_handle_pool::open(const Uri & uri) {
+	std::shared_ptr<entry> file_entry;
+	{
+		std::lock_guard<std::mutex> lock(pool_mutex);
+		auto it = prefetched_files.find(uri.toString());
+		if (it != prefetched_files.end()) {
+			file_entry = it->second;
+			file_entry->prefetched = false;
+			prefetched_files.erase(it);
+		}
+	}
+	if (!file_entry) {
+		file_entry = std::make_shared<entry>(uri);
+	}
+
+	// the file is opened right away, so a file that can not be opened fails here and not on its first read
+	acquire(file_entry);
+	release(file_entry);
+	return std::make_shared<pooled_file>(shared_from_this(), file_entry);
+}
+
+void file_handle_pool::prefetch(const std::vector<Uri> & uris) {
+	if (opener_threads.empty()) {
+		return;
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(pool_mutex);
+		for (auto & uri : uris) {
+			std::string key = uri.toString();
+			if (prefetched_files.find(key) != prefetched_files.end()) {
+				continue;
+			}
+			auto file_entry = std::make_shared<entry>(uri);
+			file_entry->prefetched = true;
+			prefetched_files[key] = file_entry;
+			files_to_open.push_back(file_entry);
+		}
+	}
+	pool_cv.notify_all();
+}
+
+size_t file_handle_pool::get_num_open_files() {
+	std::lock_guard<std::mutex> lock(pool_mutex);
+	return num_open;
+}
+
+std::shared_ptr<arrow::io::RandomAccessFile> file_handle_pool::acquire(const std::shared_ptr<entry> & file_entry) {
+	std::shared_ptr<arrow::io::RandomAccessFile> evicted_file;
+	{
+		std::unique_lock<std::mutex> lock(pool_mutex);
+		while (true) {
+			if (file_entry->closed) {
+				throw std::runtime_error("File " + file_entry->uri.toString() + " was already closed");
+			}
+			if (file_entry->status == entry::state::OPEN) {
+				if (file_entry->is_idle) {
+					idle_files.erase(file_entry->idle_position);
+					file_entry->is_idle = false;
+				}
+				file_entry->num_readers++;
+				return file_entry->file;
+			}
+			if (file_entry->status == entry::state::CLOSED) {
+				if (num_open >= max_open_files) {
+					evicted_file = evict_one();
+				}
+				if (num_open < max_open_files) {
+					file_entry->status = entry::state::OPENING;
+					num_open++;
+					break;
+				}
+			}
+			// the file is being opened by an opener thread, or every open file is being read
+			pool_cv.wait(lock);
+		}
+	}
+
+	if (evicted_file) {
+		evicted_file->Close();
+	}
+
+	std::shared_ptr<arrow::io::RandomAccessFile> file;
+	try {
+		file = open_readable(file_entry->uri);
+	} catch (...) {
+		finish_open(file_entry, nullptr, true);
+		throw;
+	}
+	finish_open(file_entry, file, true);
+	return file;
+}
+
+void file_handle_pool::release(const std::shared_ptr<entry> & file_entry) {
+	std::shared_ptr<arrow::io::RandomAccessFile> closed_file;
+	{
+		std::lock_guard<std::mutex> lock(pool_mutex);
+		file_entry->num_readers--;
+		if (file_entry->num_readers == 0) {
+			if (file_entry->closed) {
+				closed_file.swap(file_entry->file);
+				file_entry->status = entry::state::CLOSED;
+				num_open--;
+			} else {
+				idle_files.push_front(file_entry);
+				file_entry->idle_position = idle_files.begin();
+				file_entry->is_idle = true;
+			}
+		}
+	}
+	pool_cv.notify_all();
+
+	if (closed_file) {
+		closed_file->Close();
+	}
+}
+
+void file_handle_pool::close(const std::shared_ptr<entry> & file_entry) {
+	std::shared_ptr<arrow::io::RandomAccessFile> closed_file;
+	{
+		std::lock_guard<std::mutex> lock(pool_mutex);
+		if (file_entry->closed) {
+			return;
+		}
+		file_entry->closed = true;
+
+		// a file being read is closed by its last reader, and a file being opened once it is open
+		if (file_entry->status == entry::state::OPEN && file_entry->num_readers == 0) {
+			if (file_entry->is_idle) {
+				idle_files.erase(file_entry->idle_position);
+				file_entry->is_idle = false;
+			}
+			closed_file.swap(file_entry->file);
+			file_entry->status = entry::state::CLOSED;
+			num_open--;
+		}
+	}
+	pool_cv.notify_all();
+
+	if (closed_file) {
+		closed_file->Close();
+	}
+}
+
+std::shared_ptr<arrow::io::RandomAccessFile> file_handle_pool::evict_one() {
+	if (idle_files.empty()) {
+		return nullptr;
+	}
+
+	std::shared_ptr<entry> file_entry = idle_files.back();
+	idle_files.pop_back();
+	file_entry->is_idle = false;
+	if (file_entry->prefetched) {
+		prefetched_files.erase(file_entry->uri.toString());
+		file_entry->prefetched = false;
+	}
+
+	std::shared_ptr<arrow::io::RandomAccessFile> file;
+	file.swap(file_entry->file);
+	file_entry->status = entry::state::CLOSED;
+	num_open--;
+	return file;
+}
+
+void file_handle_pool::finish_open(const std::shared_ptr<entry> & file_entry, std::shared_ptr<arrow::io::RandomAccessFile> file, bool acquired) {
+	std::shared_ptr<arrow::io::RandomAccessFile> closed_file;
+	{
+		std::lock_guard<std::mutex> lock(pool_mutex);
+		if (file == nullptr) {
+			// a prefetched file that could not be opened is opened again when it is used, which reports the error
+			if (file_entry->prefetched) {
+				prefetched_files.erase(file_entry->uri.toString());
+				file_entry->prefetched = false;
+			}
+			file_entry->status = entry::state::CLOSED;
+			num_open--;
+		} else if (acquired) {
+			file_entry->file = file;
+			file_entry->status = entry::state::OPEN;
+			file_entry->num_readers++;
+		} else if (file_entry->closed) {
+			closed_file = file;
+			file_entry->status = entry::state::CLOSED;
+			num_open--;
+		} else {
+			file_entry->file = file;
+			file_entry->status = entry::state::OPEN;
+			idle_files.push_front(file_entry);
+			file_entry->idle_position = idle_files.begin();
+			file_entry->is_idle = true;
+		}
+	}
+	pool_cv.notify_all();
+
+	if (closed_file) {
+		closed_file->Close();
+	}
+}
+
+void file_handle_pool::run_opener() {
+	while (true) {
+		std::shared_ptr<entry> file_entry;
+		{
+			std::unique_lock<std::mutex> lock(pool_mutex);
+			pool_cv.wait(lock, [this] { return shutting_down || !files_to_open.empty(); });
+			if (shutting_down) {
+				return;
+			}
+			file_entry = files_to_open.front();
+			files_to_open.pop_front();
+
+			if (!file_entry->prefetched || file_entry->status != entry::state::CLOSED) {
+				continue;
+			}
+			if (num_open >= max_open_files) {
+				// prefetching never closes other files, this one is opened when it is used
+				prefetched_files.erase(file_entry->uri.toString());
+				file_entry->prefetched = false;
+				continue;
+			}
+			file_entry->status = entry::state::OPENING;
+			num_open++;
+		}
+
+		std::shared_ptr<arrow::io::RandomAccessFile> file;
+		try {
+			file = open_readable(file_entry->uri);
+		} catch (const std::exception &) {
+			file = nullptr;
+		}
+		finish_open(file_entry, file, false);
+	}
+}
+
+}  // namespace io
+}  // namespace ral
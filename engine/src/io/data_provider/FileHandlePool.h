@@ -0,0 +1,104 @@
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include <arrow/io/interfaces.h>
+#include <blazingdb/io/FileSystem/Uri.h>
+
+#include "ExceptionHandling/BlazingThread.h"
+
+namespace ral {
+namespace io {
+
+/**
+ * @brief Bounds how many files the scans keep open at the same time.
+ *
+ * The files handed out by the pool only hold a file descriptor (or a connection to a
+ * remote file system) while they are being read and while they are among the most
+ * recently used ones. When max_open_files are open the least recently used file that
+ * is not being read is closed, and it is opened again the next time it is read. A few
+ * opener threads open the files that are about to be used in the background, so the
+ * latency of opening remote files is not paid in the scan loop.
+ */
+class file_handle_pool : public std::enable_shared_from_this<file_handle_pool> {
+public:
+	/**
+	 * @param max_open_files The most files open at the same time, reads wait when all of them are being read.
+	 * @param num_opener_threads Threads that open prefetched files, 0 disables prefetching.
+	 * @param num_prefetched_files How many of the next files a data provider prefetches.
+	 */
+	file_handle_pool(size_t max_open_files, size_t num_opener_threads, size_t num_prefetched_files);
+	~file_handle_pool();
+
+	static void initialize(size_t max_open_files, size_t num_opener_threads, size_t num_prefetched_files);
+
+	/**
+	 * @brief Returns the pool of the process, with the default limits if initialize was never called.
+	 */
+	static std::shared_ptr<file_handle_pool> get_instance();
+
+	/**
+	 * @brief Opens uri through the pool, waiting for it if it is being prefetched.
+	 * Throws if the file can not be opened.
+	 */
+	std::shared_ptr<arrow::io::RandomAccessFile> open(const Uri & uri);
+
+	/**
+	 * @brief Starts opening these files in the background, when there are handles to spare.
+	 */
+	void prefetch(const std::vector<Uri> & uris);
+
+	size_t get_num_prefetched_files() const { return num_prefetched_files; }
+
+	size_t get_num_open_files();
+
+private:
+	friend class pooled_file;
+
+	struct entry;
+
+	/**
+	 * @brief Gets the file of the entry open, opening it or waiting for a free handle if needed.
+	 * Every call must be matched by a call to release.
+	 */
+	std::shared_ptr<arrow::io::RandomAccessFile> acquire(const std::shared_ptr<entry> & file_entry);
+
+	void release(const std::shared_ptr<entry> & file_entry);
+
+	/**
+	 * @brief Closes the entry for good, once it is not being read anymore.
+	 */
+	void close(const std::shared_ptr<entry> & file_entry);
+
+	/**
+	 * @brief Takes the least recently used idle file out of the pool, the caller closes it.
+	 * Must be called with the mutex locked.
+	 */
+	std::shared_ptr<arrow::io::RandomAccessFile> evict_one();
+
+	void finish_open(const std::shared_ptr<entry> & file_entry, std::shared_ptr<arrow::io::RandomAccessFile> file, bool acquired);
+
+	void run_opener();
+
+	const size_t max_open_files;
+	const size_t num_prefetched_files;
+
+	std::mutex pool_mutex;
+	std::condition_variable pool_cv;
+	size_t num_open = 0; /**< Files open or being opened. */
+	std::list<std::shared_ptr<entry>> idle_files; /**< Open files that are not being read, the most recently used first. */
+	std::map<std::string, std::shared_ptr<entry>> prefetched_files; /**< Prefetched files that were not claimed by open yet, by uri. */
+	std::deque<std::shared_ptr<entry>> files_to_open;
+	bool shutting_down = false;
+	std::vector<BlazingThread> opener_threads;
+};
+
+}  // namespace io
+}  // namespace ral
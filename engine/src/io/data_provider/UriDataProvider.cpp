@@ -8,9 +8,11 @@
  */
 
 #include "UriDataProvider.h"
+#include "FileHandlePool.h"
 #include "Config/BlazingContext.h"
 #include "arrow/status.h"
 #include <blazingdb/io/Util/StringUtil.h>
+#include <algorithm>
 
 using namespace fmt::literals;
 
@@ -19,14 +21,16 @@ namespace io {
 
 uri_data_provider::uri_data_provider(std::vector<Uri> uris, bool ignore_missing_paths)
 	: data_provider(), file_uris(uris), current_file(0), opened_files({}), errors({}),
-	uri_values({}), directory_uris({}), directory_current_file(0), ignore_missing_paths(ignore_missing_paths) {}
+	uri_values({}), directory_uris({}), directory_current_file(0), ignore_missing_paths(ignore_missing_paths),
+	next_file_to_prefetch(0), next_directory_file_to_prefetch(0) {}
 
 uri_data_provider::uri_data_provider(std::vector<Uri> uris,
 	std::vector<std::map<std::string, std::string>> uri_values,
 	bool ignore_missing_paths)
 	: data_provider(), file_uris(uris), current_file(0),
 	opened_files({}), errors({}), uri_values(uri_values), directory_uris({}),
-	  directory_current_file(0), ignore_missing_paths(ignore_missing_paths) {
+	  directory_current_file(0), ignore_missing_paths(ignore_missing_paths),
+	  next_file_to_prefetch(0), next_directory_file_to_prefetch(0) {
 	// thanks to c++11 we no longer have anything interesting to do here :)
 }
 
@@ -49,6 +53,37 @@ bool uri_data_provider::has_next() { return this->current_file < this->file_uris
 void uri_data_provider::reset() {
 	this->current_file = 0;
 	this->directory_current_file = 0;
+	this->next_file_to_prefetch = 0;
+	this->next_directory_file_to_prefetch = 0;
+}
+
+void uri_data_provider::prefetch_next_files() {
+	auto pool = file_handle_pool::get_instance();
+	size_t num_prefetched_files = pool->get_num_prefetched_files();
+	if (num_prefetched_files == 0) {
+		return;
+	}
+
+	// the files of a directory being read come first, then the next uris that are not a pattern
+	std::vector<Uri> uris;
+	if (this->directory_current_file < this->directory_uris.size()) {
+		size_t begin = std::max(this->next_directory_file_to_prefetch, this->directory_current_file + 1);
+		size_t end = std::min(this->directory_current_file + 1 + num_prefetched_files, this->directory_uris.size());
+		for (size_t i = begin; i < end; i++) {
+			uris.push_back(this->directory_uris[i]);
+		}
+		this->next_directory_file_to_prefetch = std::max(begin, end);
+	} else {
+		size_t begin = std::max(this->next_file_to_prefetch, this->current_file + 1);
+		size_t end = std::min(this->current_file + 1 + num_prefetched_files, this->file_uris.size());
+		for (size_t i = begin; i < end; i++) {
+			if (!this->file_uris[i].getPath().hasWildcard()) {
+				uris.push_back(this->file_uris[i]);
+			}
+		}
+		this->next_file_to_prefetch = std::max(begin, end);
+	}
+	pool->prefetch(uris);
 }
 
 /**
@@ -74,9 +109,11 @@ data_handle uri_data_provider::get_next(bool open_file) {
 	// because openReadable doens't  validate it and just return a nullptr
 
 	if(this->directory_uris.size() > 0 && this->directory_current_file < this->directory_uris.size()) {
-		std::shared_ptr<arrow::io::RandomAccessFile> file = open_file ? 
-			BlazingContext::getInstance()->getFileSystemManager()->openReadable(
-				this->directory_uris[this->directory_current_file]) : nullptr;
+		if (open_file) {
+			this->prefetch_next_files();
+		}
+		std::shared_ptr<arrow::io::RandomAccessFile> file = open_file ?
+			file_handle_pool::get_instance()->open(this->directory_uris[this->directory_current_file]) : nullptr;
 
 		data_handle handle;
 		handle.uri = this->directory_uris[this->directory_current_file];
@@ -191,6 +228,7 @@ data_handle uri_data_provider::get_next(bool open_file) {
 
 			this->directory_uris = new_uris;
 			this->directory_current_file = 0;
+			this->next_directory_file_to_prefetch = 0;
 
 			// If this->directory_uris is empty,
 			// the folder is empty, we just skip it
@@ -212,7 +250,8 @@ data_handle uri_data_provider::get_next(bool open_file) {
 			std::shared_ptr<arrow::io::RandomAccessFile> file = nullptr;
             
             if (open_file) {
-                file = BlazingContext::getInstance()->getFileSystemManager()->openReadable(current_uri);
+				this->prefetch_next_files();
+				file = file_handle_pool::get_instance()->open(current_uri);
 				this->opened_files.push_back(file);
 			}
             
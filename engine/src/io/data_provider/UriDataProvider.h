@@ -20,6 +20,7 @@ namespace ral {
 namespace io {
 /**
  * can generate a series of randomaccessfiles from uris that are provided
+ * the files are opened through the file_handle_pool, so they only hold a handle while they are in use
  * when it goes out of scope it will close any files it opened
  * this last point is debatable in terms of if this is the desired functionality
  */
@@ -92,6 +93,16 @@ private:
 	std::vector<Uri> directory_uris;
 	size_t directory_current_file;
 	bool ignore_missing_paths;
+
+	/**
+	 * Starts opening the next few files in the background, through the file handle pool
+	 */
+	void prefetch_next_files();
+	/**
+	 * stores the index of the first file that was not prefetched yet, of file_uris and of directory_uris
+	 */
+	size_t next_file_to_prefetch;
+	size_t next_directory_file_to_prefetch;
 };
 
 } /* namespace io */
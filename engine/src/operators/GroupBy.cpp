@@ -20,6 +20,8 @@
 #include <cudf/filling.hpp>
 #include <cudf/scalar/scalar_factories.hpp>
 #include <cudf/reduction.hpp>
+#include <cudf/unary.hpp>
+#include <cudf/column/column_factories.hpp>
 
 namespace ral {
 namespace operators {
@@ -406,5 +408,63 @@ std::unique_ptr<ral::frame::BlazingTable> compute_aggregations_with_groupby(
 	return std::make_unique<BlazingTable>(std::move(output_table), output_names);
 }
 
+bool can_compute_partial_aggregations_per_row(const std::vector<AggregateKind> & aggregation_types) {
+	for (auto aggregation_type : aggregation_types) {
+		if (aggregation_type != AggregateKind::SUM && aggregation_type != AggregateKind::SUM0 &&
+			aggregation_type != AggregateKind::MIN && aggregation_type != AggregateKind::MAX &&
+			aggregation_type != AggregateKind::COUNT_VALID && aggregation_type != AggregateKind::COUNT_ALL) {
+			return false;
+		}
+	}
+	return true;
+}
+
+std::unique_ptr<ral::frame::BlazingTable> compute_partial_aggregations_per_row(
+		const ral::frame::BlazingTableView & table, const std::vector<std::string> & aggregation_input_expressions, const std::vector<AggregateKind> & aggregation_types,
+		const std::vector<int> & group_column_indices, const std::vector<cudf::data_type> & output_types, const std::vector<std::string> & output_names) {
+
+	RAL_EXPECTS(output_types.size() == group_column_indices.size() + aggregation_types.size(), "In compute_partial_aggregations_per_row: wrong number of output types");
+
+	std::vector< std::unique_ptr<cudf::column> > output_columns;
+	for (size_t i = 0; i < group_column_indices.size(); i++){
+		output_columns.push_back(std::make_unique<cudf::column>(table.view().column(group_column_indices[i])));
+	}
+
+	for (size_t i = 0; i < aggregation_types.size(); i++){
+		cudf::data_type output_type = output_types[group_column_indices.size() + i];
+
+		std::unique_ptr<cudf::column> partial;
+		if(aggregation_types[i] == AggregateKind::COUNT_ALL) {
+			// a row counts as one
+			std::unique_ptr<cudf::scalar> one = get_scalar_from_string("1", output_type);
+			partial = cudf::make_column_from_scalar(*one, table.num_rows());
+		} else {
+			std::vector<std::unique_ptr<ral::frame::BlazingColumn>> aggregation_input_scope_holder;
+			CudfColumnView aggregation_input;
+			if(is_var_column(aggregation_input_expressions[i]) || is_number(aggregation_input_expressions[i])) {
+				aggregation_input = table.view().column(get_index(aggregation_input_expressions[i]));
+			} else {
+				aggregation_input_scope_holder = ral::processor::evaluate_expressions(table.view(), {aggregation_input_expressions[i]});
+				aggregation_input = aggregation_input_scope_holder[0]->view();
+			}
+
+			if (aggregation_types[i] == AggregateKind::COUNT_VALID) {
+				// a row counts as one if its value is not null
+				std::unique_ptr<cudf::column> valid = cudf::is_valid(aggregation_input);
+				partial = cudf::cast(valid->view(), output_type);
+			} else if (aggregation_types[i] == AggregateKind::SUM0 && aggregation_input.null_count() > 0) {
+				std::unique_ptr<cudf::scalar> zero = get_scalar_from_string("0", aggregation_input.type());
+				std::unique_ptr<cudf::column> replaced = cudf::replace_nulls(aggregation_input, *zero);
+				partial = cudf::cast(replaced->view(), output_type);
+			} else {
+				partial = cudf::cast(aggregation_input, output_type);
+			}
+		}
+		output_columns.push_back(std::move(partial));
+	}
+
+	return std::make_unique<ral::frame::BlazingTable>(std::make_unique<CudfTable>(std::move(output_columns)), output_names);
+}
+
 }  // namespace operators
 }  // namespace ral
@@ -53,5 +53,15 @@ namespace operators {
 		const ral::frame::BlazingTableView & table, const std::vector<std::string> & aggregation_input_expressions, const std::vector<AggregateKind> & aggregation_types,
 		const std::vector<std::string> & aggregation_column_assigned_aliases, const std::vector<int> & group_column_indices);
 
+	// Returns true if compute_partial_aggregations_per_row supports all these aggregations
+	bool can_compute_partial_aggregations_per_row(const std::vector<AggregateKind> & aggregation_types);
+
+	// Builds the partial aggregation of every row on its own, as if each row was its own group. The output has the group
+	// columns followed by the aggregation columns, with the given types and names, so that it can be merged together with
+	// outputs of compute_aggregations_with_groupby. It is used to skip the partial aggregation when it barely reduces the rows
+	std::unique_ptr<ral::frame::BlazingTable> compute_partial_aggregations_per_row(
+		const ral::frame::BlazingTableView & table, const std::vector<std::string> & aggregation_input_expressions, const std::vector<AggregateKind> & aggregation_types,
+		const std::vector<int> & group_column_indices, const std::vector<cudf::data_type> & output_types, const std::vector<std::string> & output_names);
+
 }  // namespace operators
 }  // namespace ral
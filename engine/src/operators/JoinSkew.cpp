@@ -0,0 +1,118 @@
+#include "JoinSkew.h"
+#include "OrderBy.h"
+#include "utilities/CommonOperations.h"
+#include <cudf/concatenate.hpp>
+#include <cudf/copying.hpp>
+#include <cudf/groupby.hpp>
+#include <cudf/join.hpp>
+#include <cudf/partitioning.hpp>
+#include <cudf/stream_compaction.hpp>
+#include <numeric>
+#include <random>
+
+namespace ral {
+namespace operators {
+
+namespace {
+
+// Below this many sampled rows the data is too small for skew to matter
+const cudf::size_type MIN_HEAVY_HITTER_SAMPLES = 100;
+
+std::vector<cudf::size_type> all_column_indices(cudf::size_type num_columns) {
+	std::vector<cudf::size_type> indices(num_columns);
+	std::iota(indices.begin(), indices.end(), 0);
+	return indices;
+}
+
+}  // namespace
+
+std::unique_ptr<ral::frame::BlazingTable> sample_join_keys(const ral::frame::BlazingTableView & table,
+	const std::vector<cudf::size_type> & key_indices) {
+	auto table_names = table.names();
+	std::vector<std::string> key_names;
+	for (auto index : key_indices) {
+		key_names.push_back(table_names[index]);
+	}
+
+	auto keys = cudf::drop_nulls(table.view().select(key_indices), all_column_indices(key_indices.size()));
+	std::size_t num_samples = compute_total_samples(keys->num_rows());
+	std::random_device rd;
+	auto samples = cudf::sample(keys->view(), num_samples, cudf::sample_with_replacement::FALSE, rd());
+
+	return std::make_unique<ral::frame::BlazingTable>(std::move(samples), key_names);
+}
+
+std::unique_ptr<ral::frame::BlazingTable> get_heavy_hitters(const ral::frame::BlazingTableView & samples, double threshold) {
+	if (samples.num_rows() < MIN_HEAVY_HITTER_SAMPLES) {
+		return std::make_unique<ral::frame::BlazingTable>(cudf::empty_like(samples.view()), samples.names());
+	}
+
+	cudf::groupby::groupby group_by_obj(samples.view(), cudf::null_policy::EXCLUDE);
+	std::vector<cudf::groupby::aggregation_request> requests(1);
+	requests[0].values = samples.view().column(0);
+	requests[0].aggregations.push_back(cudf::make_count_aggregation(cudf::null_policy::INCLUDE));
+	auto result = group_by_obj.aggregate(requests);
+
+	std::vector<cudf::size_type> counts = ral::utilities::column_to_vector<cudf::size_type>(result.second[0].results[0]->view());
+	double min_count = threshold * samples.num_rows();
+	std::vector<cudf::size_type> heavy_hitter_indices;
+	for (std::size_t i = 0; i < counts.size(); i++) {
+		if (counts[i] > min_count) {
+			heavy_hitter_indices.push_back(i);
+		}
+	}
+
+	auto gather_map = ral::utilities::vector_to_column(heavy_hitter_indices, cudf::data_type{cudf::type_id::INT32});
+	auto heavy_hitters = cudf::gather(result.first->view(), gather_map->view());
+	return std::make_unique<ral::frame::BlazingTable>(std::move(heavy_hitters), samples.names());
+}
+
+double get_heavy_hitter_fraction(const ral::frame::BlazingTableView & samples, const ral::frame::BlazingTableView & heavy_hitters) {
+	if (samples.num_rows() == 0 || heavy_hitters.num_rows() == 0) {
+		return 0;
+	}
+
+	std::vector<cudf::size_type> sample_columns = all_column_indices(samples.num_columns());
+	auto heavy_rows = cudf::left_semi_join(samples.view(), heavy_hitters.view(), sample_columns,
+		all_column_indices(heavy_hitters.num_columns()), sample_columns);
+	return static_cast<double>(heavy_rows->num_rows()) / samples.num_rows();
+}
+
+std::vector<std::unique_ptr<ral::frame::BlazingTable>> skew_aware_hash_partition(const ral::frame::BlazingTableView & table,
+	const std::vector<cudf::size_type> & key_indices, const ral::frame::BlazingTableView & heavy_hitters,
+	int num_partitions, bool split_heavy_hitters, int split_offset) {
+	std::vector<cudf::size_type> table_columns = all_column_indices(table.num_columns());
+	std::vector<cudf::size_type> heavy_hitter_columns = all_column_indices(heavy_hitters.num_columns());
+	auto heavy_rows = cudf::left_semi_join(table.view(), heavy_hitters.view(), key_indices, heavy_hitter_columns, table_columns);
+	auto regular_rows = cudf::left_anti_join(table.view(), heavy_hitters.view(), key_indices, heavy_hitter_columns, table_columns);
+
+	std::unique_ptr<cudf::table> hashed_data;
+	std::vector<cudf::table_view> regular_partitions;
+	if (regular_rows->num_rows() > 0) {
+		std::vector<cudf::size_type> hashed_data_offsets;
+		std::tie(hashed_data, hashed_data_offsets) = cudf::hash_partition(regular_rows->view(), key_indices, num_partitions);
+		// the offsets returned by hash_partition will always start at 0, which is a value we want to ignore for cudf::split
+		std::vector<cudf::size_type> split_indexes(hashed_data_offsets.begin() + 1, hashed_data_offsets.end());
+		regular_partitions = cudf::split(hashed_data->view(), split_indexes);
+	} else {
+		regular_partitions.assign(num_partitions, regular_rows->view());
+	}
+
+	cudf::size_type num_heavy_rows = heavy_rows->num_rows();
+	std::vector<std::unique_ptr<ral::frame::BlazingTable>> partitions;
+	for (int i = 0; i < num_partitions; i++) {
+		cudf::table_view heavy_partition = heavy_rows->view();
+		if (split_heavy_hitters) {
+			int slice = (i + split_offset) % num_partitions;
+			cudf::size_type begin = static_cast<cudf::size_type>(static_cast<int64_t>(num_heavy_rows) * slice / num_partitions);
+			cudf::size_type end = static_cast<cudf::size_type>(static_cast<int64_t>(num_heavy_rows) * (slice + 1) / num_partitions);
+			heavy_partition = cudf::slice(heavy_rows->view(), {begin, end})[0];
+		}
+		auto partition = cudf::concatenate(std::vector<cudf::table_view>{regular_partitions[i], heavy_partition});
+		partitions.push_back(std::make_unique<ral::frame::BlazingTable>(std::move(partition), table.names()));
+	}
+	return partitions;
+}
+
+}  // namespace operators
+}  // namespace ral
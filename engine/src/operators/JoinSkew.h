@@ -0,0 +1,44 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include "execution_graph/logic_controllers/LogicPrimitives.h"
+
+namespace ral {
+namespace operators {
+
+/**
+ * @brief Returns a random sample of the non null keys of a join side, as many rows as the
+ * samples SortAndSampleKernel takes from a batch.
+ */
+std::unique_ptr<ral::frame::BlazingTable> sample_join_keys(const ral::frame::BlazingTableView & table,
+	const std::vector<cudf::size_type> & key_indices);
+
+/**
+ * @brief Returns the distinct keys found in more than `threshold` (a fraction) of the sampled rows.
+ * Nothing is returned for samples too small to tell.
+ */
+std::unique_ptr<ral::frame::BlazingTable> get_heavy_hitters(const ral::frame::BlazingTableView & samples, double threshold);
+
+/**
+ * @brief Returns the fraction of the sampled rows whose key is one of the heavy hitters, 0 when there are none.
+ */
+double get_heavy_hitter_fraction(const ral::frame::BlazingTableView & samples, const ral::frame::BlazingTableView & heavy_hitters);
+
+/**
+ * @brief Hash partitions a batch of one side of a join, except for the rows whose key is a heavy hitter.
+ *
+ * When split_heavy_hitters is true those rows are divided in contiguous slices, one per partition,
+ * otherwise all of them are copied into every partition. Splitting one side and copying the other
+ * one keeps every matching pair of rows in the same partition. The slices are rotated by
+ * split_offset so the batches do not always leave the remainder in the same partition.
+ *
+ * @param heavy_hitters Keys with the common join types, as returned by get_heavy_hitters.
+ * @return One table per partition.
+ */
+std::vector<std::unique_ptr<ral::frame::BlazingTable>> skew_aware_hash_partition(const ral::frame::BlazingTableView & table,
+	const std::vector<cudf::size_type> & key_indices, const ral::frame::BlazingTableView & heavy_hitters,
+	int num_partitions, bool split_heavy_hitters, int split_offset);
+
+}  // namespace operators
+}  // namespace ral
@@ -4,9 +4,12 @@
 #include "communication/CommunicationData.h"
 #include "distribution/primitives.h"
 #include <blazingdb/io/Library/Logging/Logger.h>
+#include <cudf/concatenate.hpp>
 #include <cudf/copying.hpp>
 #include <cudf/sorting.hpp>
 #include <cudf/search.hpp>
+#include <cudf/stream_compaction.hpp>
+#include <cudf/unary.hpp>
 #include <random>
 #include "parser/expression_utils.hpp"
 #include "utilities/CommonOperations.h"
@@ -393,5 +396,81 @@ std::unique_ptr<ral::frame::BlazingTable> merge(std::vector<ral::frame::BlazingT
 	return sortedMerger(partitions_to_merge, sortOrderTypes, sortColIndices);
 }
 
+std::unique_ptr<ral::frame::BlazingTable> get_top_n(const ral::frame::BlazingTableView & table,
+	const ral::frame::BlazingTableView & threshold, const std::string & query_part, cudf::size_type n) {
+	std::vector<cudf::order> sortOrderTypes;
+	std::vector<int> sortColIndices;
+
+	std::tie(sortColIndices, sortOrderTypes) = get_right_sorts_vars(query_part);
+
+	std::vector<cudf::null_order> null_orders(sortOrderTypes.size(), cudf::null_order::AFTER);
+
+	std::unique_ptr<ral::frame::BlazingTable> pruned;
+	ral::frame::BlazingTableView candidates = table;
+	if (threshold.num_rows() > 0) {
+		// With every order flipped, the threshold sorts before a row only when that row sorts strictly before the
+		// threshold in the original order, so the lower bound of each row is 1 for the rows to keep and 0 otherwise
+		std::vector<cudf::order> flippedOrderTypes;
+		for (auto order : sortOrderTypes) {
+			flippedOrderTypes.push_back(order == cudf::order::ASCENDING ? cudf::order::DESCENDING : cudf::order::ASCENDING);
+		}
+		std::unique_ptr<cudf::column> before_threshold = cudf::lower_bound(threshold.view().select(sortColIndices),
+			table.view().select(sortColIndices), flippedOrderTypes, null_orders);
+		std::unique_ptr<cudf::column> mask = cudf::cast(before_threshold->view(), cudf::data_type{cudf::type_id::BOOL8});
+
+		pruned = std::make_unique<ral::frame::BlazingTable>(cudf::apply_boolean_mask(table.view(), mask->view()), table.names());
+		candidates = pruned->toBlazingTableView();
+	}
+
+	std::unique_ptr<cudf::column> sorted_order = cudf::sorted_order(candidates.view().select(sortColIndices), sortOrderTypes, null_orders);
+	cudf::size_type num_rows = std::min(n, candidates.num_rows());
+	cudf::column_view top_n_order = cudf::slice(sorted_order->view(), {0, num_rows})[0];
+
+	return std::make_unique<ral::frame::BlazingTable>(cudf::gather(candidates.view(), top_n_order), table.names());
+}
+
+std::unique_ptr<ral::frame::BlazingTable> merge_top_n(std::vector<ral::frame::BlazingTableView> sorted_tables,
+	const std::string & query_part, cudf::size_type n) {
+	std::unique_ptr<ral::frame::BlazingTable> merged = sorted_tables.size() == 1 ? sorted_tables[0].clone() : merge(sorted_tables, query_part);
+	if (merged->num_rows() <= n) {
+		return merged;
+	}
+
+	return std::make_unique<ral::frame::BlazingTable>(logicalLimit(merged->view(), n), merged->names());
+}
+
+std::vector<cudf::size_type> get_merge_frontier_splits(const std::vector<ral::frame::BlazingTableView> & sorted_tables, const std::string & query_part) {
+	std::vector<cudf::order> sortOrderTypes;
+	std::vector<int> sortColIndices;
+
+	std::tie(sortColIndices, sortOrderTypes) = get_right_sorts_vars(query_part);
+
+	// Same null order used by sortedMerger
+	std::vector<cudf::null_order> null_orders(sortOrderTypes.size(), cudf::null_order::AFTER);
+
+	std::vector<cudf::table_view> last_rows;
+	for (auto & table : sorted_tables) {
+		RAL_EXPECTS(table.num_rows() > 0, "Sorted tables to merge can not be empty");
+
+		cudf::table_view keys = table.view().select(sortColIndices);
+		last_rows.push_back(cudf::slice(keys, {keys.num_rows() - 1, keys.num_rows()})[0]);
+	}
+
+	// Tournament over the last rows, the winner is the frontier
+	std::unique_ptr<cudf::table> tails = cudf::concatenate(last_rows);
+	std::unique_ptr<cudf::column> tails_order = cudf::sorted_order(tails->view(), sortOrderTypes, null_orders);
+	cudf::size_type winner = ral::utilities::column_to_vector<cudf::size_type>(tails_order->view())[0];
+	cudf::table_view frontier = cudf::slice(tails->view(), {winner, winner + 1})[0];
+
+	std::vector<cudf::size_type> splits(sorted_tables.size());
+	for (std::size_t i = 0; i < sorted_tables.size(); i++) {
+		cudf::table_view keys = sorted_tables[i].view().select(sortColIndices);
+		auto split = cudf::upper_bound(keys, frontier, sortOrderTypes, null_orders);
+		splits[i] = ral::utilities::column_to_vector<cudf::size_type>(split->view())[0];
+	}
+
+	return splits;
+}
+
 }  // namespace operators
 }  // namespace ral
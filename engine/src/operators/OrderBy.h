@@ -47,5 +47,36 @@ std::tuple<std::unique_ptr<ral::frame::BlazingTable>, bool, int64_t> limit_table
 
 std::unique_ptr<ral::frame::BlazingTable> merge(std::vector<ral::frame::BlazingTableView> partitions_to_merge, const std::string & query_part);
 
+/**
+ * @brief Sorts a table and keeps only its first n rows.
+ *
+ * @param table The table to sort.
+ * @param threshold A single row table with the same schema, or an empty table. When it has a row, only the rows that sort
+ * strictly before it are sorted, the rest can not be part of the top n.
+ * @param query_part The logical sort expression.
+ * @param n The number of rows to keep.
+ */
+std::unique_ptr<ral::frame::BlazingTable> get_top_n(const ral::frame::BlazingTableView & table,
+	const ral::frame::BlazingTableView & threshold, const std::string & query_part, cudf::size_type n);
+
+/**
+ * @brief Merges sorted tables and keeps only the first n rows of the result.
+ */
+std::unique_ptr<ral::frame::BlazingTable> merge_top_n(std::vector<ral::frame::BlazingTableView> sorted_tables,
+	const std::string & query_part, cudf::size_type n);
+
+/**
+ * @brief Computes how many rows of every sorted table can be merged before reading more rows from any of them.
+ *
+ * The tables are the heads of sorted runs. The smallest of their last rows is the merge frontier: no row that
+ * has not been read yet from any run can sort before it, so every row up to the frontier can already be merged
+ * and emitted. The table whose last row is the frontier is always consumed entirely.
+ *
+ * @param sorted_tables The heads of the sorted runs, none of them can be empty.
+ * @param query_part The logical sort expression.
+ * @return For every table, the number of rows from its beginning that sort at or before the frontier.
+ */
+std::vector<cudf::size_type> get_merge_frontier_splits(const std::vector<ral::frame::BlazingTableView> & sorted_tables, const std::string & query_part);
+
 }  // namespace operators
 }  // namespace ral
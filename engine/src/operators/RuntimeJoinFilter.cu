@@ -0,0 +1,282 @@
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wunknown-pragmas"
+#include <cudf/binaryop.hpp>
+#include <cudf/column/column_factories.hpp>
+#include <cudf/concatenate.hpp>
+#include <cudf/copying.hpp>
+#include <cudf/hashing.hpp>
+#include <cudf/null_mask.hpp>
+#include <cudf/reduction.hpp>
+#include <cudf/stream_compaction.hpp>
+#include <cudf/unary.hpp>
+#include <cudf/utilities/bit.hpp>
+#include <cudf/utilities/traits.hpp>
+#include <rmm/thrust_rmm_allocator.h>
+#include <thrust/fill.h>
+#include <thrust/for_each.h>
+#include <thrust/iterator/counting_iterator.h>
+#include <thrust/transform.h>
+#pragma GCC diagnostic pop
+
+#include <numeric>
+#include "RuntimeJoinFilter.h"
+#include "utilities/error.hpp"
+
+namespace ral {
+namespace operators {
+
+namespace {
+
+const int BLOOM_NUM_PROBES = 3;
+const std::size_t BLOOM_BITS_PER_KEY = 8;
+const std::size_t BLOOM_MIN_BITS = std::size_t(1) << 16;
+const std::size_t BLOOM_MAX_BITS = std::size_t(1) << 26;
+
+// Double hashing, the i-th probe of a key is h1 + i * h2
+__device__ inline uint32_t bloom_position(uint32_t hash, int i, uint32_t mask) {
+	uint32_t h2 = ((hash >> 16) | (hash << 16)) | 1;
+	return (hash + i * h2) & mask;
+}
+
+std::size_t bloom_num_bits(std::size_t expected_keys) {
+	std::size_t num_bits = BLOOM_MIN_BITS;
+	while (num_bits < expected_keys * BLOOM_BITS_PER_KEY && num_bits < BLOOM_MAX_BITS) {
+		num_bits <<= 1;
+	}
+	return num_bits;
+}
+
+std::unique_ptr<cudf::column> make_bloom(std::size_t num_bits) {
+	auto bloom = cudf::make_numeric_column(cudf::data_type{cudf::type_id::INT32}, num_bits / 32);
+	auto words = bloom->mutable_view();
+	thrust::fill(rmm::exec_policy(0)->on(0), words.begin<int32_t>(), words.end<int32_t>(), 0);
+	return bloom;
+}
+
+// ORs the bits of source into target, source must not be smaller than target.
+// Both sizes are powers of two, so bit b of the larger filter maps to bit
+// (b mod smaller size) of the smaller one.
+void fold_bloom(cudf::mutable_column_view target, const cudf::column_view & source) {
+	const uint32_t * source_words = source.data<uint32_t>();
+	uint32_t * target_words = reinterpret_cast<uint32_t *>(target.data<int32_t>());
+	cudf::size_type num_target_words = target.size();
+	thrust::for_each(rmm::exec_policy(0)->on(0),
+		thrust::make_counting_iterator<cudf::size_type>(0),
+		thrust::make_counting_iterator<cudf::size_type>(source.size()),
+		[source_words, target_words, num_target_words] __device__ (cudf::size_type i) {
+			if (source_words[i] != 0) {
+				atomicOr(target_words + (i & (num_target_words - 1)), source_words[i]);
+			}
+		});
+}
+
+bool supports_bounds(const std::vector<cudf::data_type> & key_types) {
+	return key_types.size() == 1 && key_types[0].id() != cudf::type_id::BOOL8 &&
+		(cudf::is_numeric(key_types[0]) || cudf::is_timestamp(key_types[0]));
+}
+
+// Returns the key columns of a table with the common join types, the casted columns are kept alive in `casted`
+cudf::table_view get_normalized_keys(const cudf::table_view & table, const std::vector<cudf::size_type> & key_indices,
+	const std::vector<cudf::data_type> & key_types, std::vector<std::unique_ptr<cudf::column>> & casted) {
+	RAL_EXPECTS(key_indices.size() == key_types.size(), "In runtime_join_filter: Wrong number of key columns");
+
+	std::vector<cudf::column_view> keys;
+	for (std::size_t i = 0; i < key_indices.size(); i++) {
+		auto key = table.column(key_indices[i]);
+		if (key.type() != key_types[i]) {
+			casted.push_back(cudf::cast(key, key_types[i]));
+			keys.push_back(casted.back()->view());
+		} else {
+			keys.push_back(key);
+		}
+	}
+	return cudf::table_view(keys);
+}
+
+}  // namespace
+
+runtime_join_filter::runtime_join_filter(const std::vector<cudf::data_type> & key_types, std::size_t expected_keys)
+	: key_types{key_types}, has_bounds{supports_bounds(key_types)}, bloom{make_bloom(bloom_num_bits(expected_keys))} {
+}
+
+void runtime_join_filter::add(const ral::frame::BlazingTableView & table, const std::vector<cudf::size_type> & key_indices) {
+	std::vector<std::unique_ptr<cudf::column>> casted;
+	cudf::table_view keys = get_normalized_keys(table.view(), key_indices, key_types, casted);
+
+	// an inner join never matches a null key
+	std::vector<cudf::size_type> all_keys(keys.num_columns());
+	std::iota(all_keys.begin(), all_keys.end(), 0);
+	auto valid_keys = cudf::drop_nulls(keys, all_keys);
+	if (valid_keys->num_rows() == 0) {
+		return;
+	}
+
+	auto hashes = cudf::hash(valid_keys->view());
+	const uint32_t * hash_data = hashes->view().data<uint32_t>();
+	uint32_t * words = reinterpret_cast<uint32_t *>(bloom->mutable_view().data<int32_t>());
+	uint32_t mask = static_cast<uint32_t>(bloom->size()) * 32 - 1;
+	thrust::for_each(rmm::exec_policy(0)->on(0),
+		thrust::make_counting_iterator<cudf::size_type>(0),
+		thrust::make_counting_iterator<cudf::size_type>(valid_keys->num_rows()),
+		[hash_data, words, mask] __device__ (cudf::size_type row) {
+			for (int i = 0; i < BLOOM_NUM_PROBES; i++) {
+				uint32_t position = bloom_position(hash_data[row], i, mask);
+				atomicOr(words + (position >> 5), 1u << (position & 31));
+			}
+		});
+
+	if (has_bounds) {
+		auto min_max = cudf::minmax(valid_keys->view().column(0));
+		std::vector<std::unique_ptr<cudf::column>> batch_bounds;
+		batch_bounds.push_back(cudf::make_column_from_scalar(*min_max.first, 1));
+		batch_bounds.push_back(cudf::make_column_from_scalar(*min_max.second, 1));
+		auto batch_bounds_column = cudf::concatenate(std::vector<cudf::column_view>{batch_bounds[0]->view(), batch_bounds[1]->view()});
+		merge_bounds(batch_bounds_column->view());
+	}
+
+	has_keys = true;
+}
+
+void runtime_join_filter::merge_bloom(const cudf::column_view & other_bloom) {
+	if (other_bloom.size() < bloom->size()) {
+		auto folded = make_bloom(static_cast<std::size_t>(other_bloom.size()) * 32);
+		fold_bloom(folded->mutable_view(), bloom->view());
+		bloom = std::move(folded);
+	}
+	fold_bloom(bloom->mutable_view(), other_bloom);
+}
+
+void runtime_join_filter::merge_bounds(const cudf::column_view & other_bounds) {
+	if (bounds == nullptr) {
+		bounds = std::make_unique<cudf::column>(other_bounds);
+		return;
+	}
+
+	auto all_bounds = cudf::concatenate(std::vector<cudf::column_view>{bounds->view(), other_bounds});
+	auto min_max = cudf::minmax(all_bounds->view());
+	auto min_column = cudf::make_column_from_scalar(*min_max.first, 1);
+	auto max_column = cudf::make_column_from_scalar(*min_max.second, 1);
+	bounds = cudf::concatenate(std::vector<cudf::column_view>{min_column->view(), max_column->view()});
+}
+
+void runtime_join_filter::merge(const runtime_join_filter & other) {
+	if (other.empty()) {
+		return;
+	}
+
+	merge_bloom(other.bloom->view());
+	if (has_bounds && other.bounds != nullptr) {
+		merge_bounds(other.bounds->view());
+	}
+	has_keys = true;
+}
+
+void runtime_join_filter::merge(const ral::frame::BlazingTableView & table) {
+	// nodes with an empty build side send a table without columns
+	if (table.num_columns() == 0) {
+		return;
+	}
+
+	merge_bloom(table.view().column(0));
+	if (has_bounds && table.num_columns() > 1) {
+		merge_bounds(table.view().column(1));
+	}
+	has_keys = true;
+}
+
+std::unique_ptr<ral::frame::BlazingTable> runtime_join_filter::apply(const ral::frame::BlazingTableView & table, const std::vector<cudf::size_type> & key_indices) const {
+	if (empty()) {
+		// nothing can match an empty build side
+		return std::make_unique<ral::frame::BlazingTable>(cudf::empty_like(table.view()), table.names());
+	}
+
+	std::vector<std::unique_ptr<cudf::column>> casted;
+	cudf::table_view keys = get_normalized_keys(table.view(), key_indices, key_types, casted);
+
+	rmm::device_buffer null_mask;
+	if (keys.num_columns() > 0 && cudf::has_nulls(keys)) {
+		null_mask = cudf::bitmask_and(keys);
+	}
+	const cudf::bitmask_type * valids = null_mask.size() > 0 ? static_cast<const cudf::bitmask_type *>(null_mask.data()) : nullptr;
+
+	auto hashes = cudf::hash(keys);
+	const uint32_t * hash_data = hashes->view().data<uint32_t>();
+	const uint32_t * words = bloom->view().data<uint32_t>();
+	uint32_t mask = static_cast<uint32_t>(bloom->size()) * 32 - 1;
+
+	auto keep = cudf::make_numeric_column(cudf::data_type{cudf::type_id::BOOL8}, table.num_rows());
+	auto keep_view = keep->mutable_view();
+	thrust::transform(rmm::exec_policy(0)->on(0),
+		thrust::make_counting_iterator<cudf::size_type>(0),
+		thrust::make_counting_iterator<cudf::size_type>(table.num_rows()),
+		keep_view.begin<bool>(),
+		[hash_data, words, mask, valids] __device__ (cudf::size_type row) {
+			if (valids != nullptr && !cudf::bit_is_set(valids, row)) {
+				return false;
+			}
+			for (int i = 0; i < BLOOM_NUM_PROBES; i++) {
+				uint32_t position = bloom_position(hash_data[row], i, mask);
+				if ((words[position >> 5] & (1u << (position & 31))) == 0) {
+					return false;
+				}
+			}
+			return true;
+		});
+
+	if (has_bounds && bounds != nullptr) {
+		cudf::data_type bool_type{cudf::type_id::BOOL8};
+		auto min_key = cudf::get_element(bounds->view(), 0);
+		auto max_key = cudf::get_element(bounds->view(), 1);
+		auto above_min = cudf::binary_operation(keys.column(0), *min_key, cudf::binary_operator::GREATER_EQUAL, bool_type);
+		auto below_max = cudf::binary_operation(keys.column(0), *max_key, cudf::binary_operator::LESS_EQUAL, bool_type);
+		auto in_bounds = cudf::binary_operation(above_min->view(), below_max->view(), cudf::binary_operator::LOGICAL_AND, bool_type);
+		keep = cudf::binary_operation(keep->view(), in_bounds->view(), cudf::binary_operator::LOGICAL_AND, bool_type);
+	}
+
+	return std::make_unique<ral::frame::BlazingTable>(cudf::apply_boolean_mask(table.view(), keep->view()), table.names());
+}
+
+std::unique_ptr<ral::frame::BlazingTable> runtime_join_filter::to_table() const {
+	std::vector<std::unique_ptr<cudf::column>> columns;
+	std::vector<std::string> names{"bloom"};
+	columns.push_back(std::make_unique<cudf::column>(bloom->view()));
+	if (has_bounds && bounds != nullptr) {
+		// every column of a table has the same size, the maximum is repeated to fill it
+		auto min_key = cudf::get_element(bounds->view(), 0);
+		auto max_key = cudf::get_element(bounds->view(), 1);
+		auto min_column = cudf::make_column_from_scalar(*min_key, 1);
+		auto max_column = cudf::make_column_from_scalar(*max_key, bloom->size() - 1);
+		columns.push_back(cudf::concatenate(std::vector<cudf::column_view>{min_column->view(), max_column->view()}));
+		names.push_back("bounds");
+	}
+	return std::make_unique<ral::frame::BlazingTable>(std::make_unique<cudf::table>(std::move(columns)), names);
+}
+
+std::size_t runtime_join_filter::size_in_bytes() const {
+	return static_cast<std::size_t>(bloom->size()) * sizeof(int32_t);
+}
+
+void runtime_join_filter_set::add(std::shared_ptr<runtime_join_filter> filter, const std::vector<cudf::size_type> & key_indices) {
+	std::lock_guard<std::mutex> lock(mutex);
+	filters.emplace_back(std::move(filter), key_indices);
+}
+
+void runtime_join_filter_set::apply(std::unique_ptr<ral::frame::BlazingTable> & table) {
+	std::vector<std::pair<std::shared_ptr<runtime_join_filter>, std::vector<cudf::size_type>>> current_filters;
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		current_filters = filters;
+	}
+	if (current_filters.empty() || table->num_rows() == 0) {
+		return;
+	}
+
+	auto filtered = current_filters[0].first->apply(table->toBlazingTableView(), current_filters[0].second);
+	for (std::size_t i = 1; i < current_filters.size() && filtered->num_rows() > 0; i++) {
+		filtered = current_filters[i].first->apply(filtered->toBlazingTableView(), current_filters[i].second);
+	}
+	table = std::move(filtered);
+}
+
+}  // namespace operators
+}  // namespace ral
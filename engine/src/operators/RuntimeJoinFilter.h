@@ -0,0 +1,93 @@
+#pragma once
+
+#include <memory>
+#include <mutex>
+#include <vector>
+#include <cudf/column/column.hpp>
+#include "execution_graph/logic_controllers/LogicPrimitives.h"
+
+namespace ral {
+namespace operators {
+
+/**
+ * @brief Filter built from the join keys of the build side of an inner join.
+ *
+ * It holds a bloom filter over the hash of all the key columns and, when the
+ * join is on a single numeric or timestamp key, the minimum and maximum key
+ * seen. apply() removes the probe rows that cannot have a match; rows without
+ * a match may be kept, rows with a match are never removed.
+ *
+ * Keys are cast to the common join types before they are hashed, so both
+ * sides must be described with the same key_types.
+ */
+class runtime_join_filter {
+public:
+	/**
+	 * @param key_types Common types of the join key columns.
+	 * @param expected_keys Estimated number of keys of the build side, used to size the bloom filter.
+	 */
+	runtime_join_filter(const std::vector<cudf::data_type> & key_types, std::size_t expected_keys);
+
+	/**
+	 * @brief Adds the keys of a build side batch. Rows with null keys are ignored.
+	 */
+	void add(const ral::frame::BlazingTableView & table, const std::vector<cudf::size_type> & key_indices);
+
+	/**
+	 * @brief Combines a filter built from other batches, the result keeps the rows either filter keeps.
+	 */
+	void merge(const runtime_join_filter & other);
+
+	/**
+	 * @brief Combines a filter built in another node, received as the output of to_table().
+	 */
+	void merge(const ral::frame::BlazingTableView & table);
+
+	/**
+	 * @brief Returns the rows of a probe side batch whose keys may have a match.
+	 */
+	std::unique_ptr<ral::frame::BlazingTable> apply(const ral::frame::BlazingTableView & table, const std::vector<cudf::size_type> & key_indices) const;
+
+	/**
+	 * @brief Packs the filter into a table so it can be sent to other nodes.
+	 * The first column holds the bloom words, the second one (if any) holds
+	 * the minimum key in its first row and the maximum key in the others.
+	 */
+	std::unique_ptr<ral::frame::BlazingTable> to_table() const;
+
+	bool empty() const { return !has_keys; }
+
+	std::size_t size_in_bytes() const;
+
+private:
+	void merge_bloom(const cudf::column_view & other_bloom);
+	void merge_bounds(const cudf::column_view & other_bounds);
+
+	std::vector<cudf::data_type> key_types;
+	bool has_bounds;
+	bool has_keys = false;
+	std::unique_ptr<cudf::column> bloom; /**< INT32 column, one bit per slot. The number of bits is a power of two. */
+	std::unique_ptr<cudf::column> bounds; /**< Two rows with the minimum and the maximum key, null until the first key is added. */
+};
+
+/**
+ * @brief Set of runtime join filters registered on a kernel, each one with
+ * the indices of the key columns in the output of that kernel.
+ */
+class runtime_join_filter_set {
+public:
+	void add(std::shared_ptr<runtime_join_filter> filter, const std::vector<cudf::size_type> & key_indices);
+
+	/**
+	 * @brief Replaces the table with its rows that pass every registered filter.
+	 * The table is left untouched when no filter is registered or an exception is thrown.
+	 */
+	void apply(std::unique_ptr<ral::frame::BlazingTable> & table);
+
+private:
+	std::mutex mutex;
+	std::vector<std::pair<std::shared_ptr<runtime_join_filter>, std::vector<cudf::size_type>>> filters;
+};
+
+}  // namespace operators
+}  // namespace ral
@@ -1,4 +1,5 @@
 #include "expression_tree.hpp"
+#include <algorithm>
 #include <cassert>
 #include <limits.h>
 
@@ -6,12 +7,37 @@ namespace ral {
 namespace parser {
 namespace detail {
 
-constexpr char lexer::VARIABLE_REGEX_STR[];
-constexpr char lexer::NULL_REGEX_STR[];
-constexpr char lexer::BOOLEAN_REGEX_STR[];
-constexpr char lexer::NUMBER_REGEX_STR[];
-constexpr char lexer::TIMESTAMP_REGEX_STR[];
-constexpr char lexer::STRING_REGEX_STR[];
+namespace {
+
+inline bool is_digit(char ch) { return ch >= '0' && ch <= '9'; }
+
+inline bool is_line_terminator(char ch) { return ch == '\n' || ch == '\r'; }
+
+// Returns the number of consecutive digits at the beginning of [begin, end)
+inline size_t count_digits(const char * begin, const char * end) {
+  const char * it = begin;
+  while (it != end && is_digit(*it)) ++it;
+  return it - begin;
+}
+
+inline size_t match_keyword(const char * begin, const char * end, const char * keyword, size_t length) {
+  return static_cast<size_t>(end - begin) >= length && std::equal(keyword, keyword + length, begin) ? length : 0;
+}
+
+// Matches exactly count digits followed by separator, separator is not matched if it is '\0'
+inline bool match_digits(const char *& it, const char * end, size_t count, char separator) {
+  if (static_cast<size_t>(end - it) < count + (separator != '\0') || count_digits(it, it + count) != count) {
+    return false;
+  }
+  it += count;
+  if (separator != '\0') {
+    if (*it != separator) return false;
+    ++it;
+  }
+  return true;
+}
+
+} // namespace
 
 lexer::lexer(const std::string & str)
             : text_(str)
@@ -22,90 +48,143 @@ lexer::lexer(const std::string & str)
 
 void lexer::advance(size_t offset) { pos_ += offset; }
 
-lexer::token lexer::next_token() {
-  if (pos_ >= text_.size()) {
-    return {lexer::token_type::EOF_, ""};
+lexer::token lexer::make_token(token_type type, size_t length) {
+  token ret{type, text_.substr(pos_, length)};
+  advance(length);
+  assert(pos_ <= text_.length());
+  return ret;
+}
+
+size_t lexer::match_variable(const char * begin, const char * end) {
+  if (begin == end || *begin != '$') {
+    return 0;
   }
+  size_t digits = count_digits(begin + 1, end);
+  return digits > 0 ? digits + 1 : 0;
+}
 
-  // Discard whitespaces
-  while (text_[pos_] == ' ') advance();
+size_t lexer::match_null(const char * begin, const char * end) {
+  return match_keyword(begin, end, "null", 4);
+}
+
+size_t lexer::match_boolean(const char * begin, const char * end) {
+  size_t length = match_keyword(begin, end, "true", 4);
+  return length > 0 ? length : match_keyword(begin, end, "false", 5);
+}
 
-  if (text_[pos_] == '(') {
-    advance();
-    assert(pos_ <= text_.length());
-    return {lexer::token_type::ParenthesisOpen, "("};
+size_t lexer::match_number(const char * begin, const char * end) {
+  const char * it = begin;
+  if (it != end && (*it == '-' || *it == '+')) ++it;
+
+  // The mantissa always ends with a digit, a trailing dot is not part of the number
+  size_t integer_digits = count_digits(it, end);
+  it += integer_digits;
+  if (it != end && *it == '.' && count_digits(it + 1, end) > 0) {
+    it += 1 + count_digits(it + 1, end);
+  } else if (integer_digits == 0) {
+    return 0;
   }
 
-  if (text_[pos_] == ')') {
-    advance();
-    assert(pos_ <= text_.length());
-    return {lexer::token_type::ParenthesisClose, ")"};
+  if (it != end && (*it == 'e' || *it == 'E')) {
+    const char * exponent = it + 1;
+    if (exponent != end && (*exponent == '-' || *exponent == '+')) ++exponent;
+    size_t exponent_digits = count_digits(exponent, end);
+    if (exponent_digits > 0) {
+      it = exponent + exponent_digits;
+    }
   }
 
-  if (text_[pos_] == ',') {
-    advance();
-    assert(pos_ <= text_.length());
-    return {lexer::token_type::Comma, ","};
+  return it - begin;
+}
+
+size_t lexer::match_timestamp(const char * begin, const char * end) {
+  const char * it = begin;
+  if (!match_digits(it, end, 4, '-') || !match_digits(it, end, 2, '-') || !match_digits(it, end, 2, '\0')) {
+    return 0;
   }
 
-  if (text_[pos_] == ':') {
-    advance();
-    assert(pos_ <= text_.length());
-    return {lexer::token_type::Colon, ":"};
+  const char * time = it;
+  if (time != end && (*time == ' ' || *time == 'T')) {
+    ++time;
+    if (match_digits(time, end, 2, ':') && match_digits(time, end, 2, ':') && match_digits(time, end, 2, '\0')) {
+      it = time;
+    }
   }
 
-  std::smatch match;
-  std::string remainder = text_.substr(pos_);
-  if (std::regex_search(remainder, match, variable_regex)) {
-    advance(match.length());
-    assert(pos_ <= text_.length());
-    return {lexer::token_type::Variable, match.str()};
+  return it - begin;
+}
+
+size_t lexer::match_string(const char * begin, const char * end) {
+  if (begin == end || (*begin != '"' && *begin != '\'')) {
+    return 0;
+  }
+
+  const char quote = *begin;
+  for (const char * it = begin + 1; it != end; ++it) {
+    if (*it == quote) {
+      return it + 1 - begin;
+    }
+    if (is_line_terminator(*it)) {
+      return 0;
+    }
+    if (*it == '\\') {
+      ++it;
+      if (it == end || is_line_terminator(*it)) {
+        return 0;
+      }
+    }
   }
 
-  if (std::regex_search(remainder, match, null_regex)) {
-    advance(match.length());
-    assert(pos_ <= text_.length());
-    return {lexer::token_type::Null, match.str()};
+  return 0;
+}
+
+lexer::token lexer::next_token() {
+  // Discard whitespaces
+  while (pos_ < text_.size() && text_[pos_] == ' ') advance();
+
+  if (pos_ >= text_.size()) {
+    return {lexer::token_type::EOF_, ""};
   }
 
-  if (std::regex_search(remainder, match, boolean_regex)) {
-    advance(match.length());
-    assert(pos_ <= text_.length());
-    return {lexer::token_type::Boolean, match.str()};
+  switch (text_[pos_]) {
+  case '(': return make_token(lexer::token_type::ParenthesisOpen, 1);
+  case ')': return make_token(lexer::token_type::ParenthesisClose, 1);
+  case ',': return make_token(lexer::token_type::Comma, 1);
+  case ':': return make_token(lexer::token_type::Colon, 1);
   }
 
-  if (std::regex_search(remainder, match, timestamp_regex)) {
-    advance(match.length());
-    assert(pos_ <= text_.length());
-    return {lexer::token_type::Timestamp, match.str()};
+  const char * begin = text_.data() + pos_;
+  const char * end = text_.data() + text_.size();
+  size_t length;
+
+  if ((length = match_variable(begin, end)) > 0) {
+    return make_token(lexer::token_type::Variable, length);
   }
 
-  if (std::regex_search(remainder, match, number_regex)) {
-    advance(match.length());
-    assert(pos_ <= text_.length());
-    return {lexer::token_type::Number, match.str()};
+  if ((length = match_null(begin, end)) > 0) {
+    return make_token(lexer::token_type::Null, length);
   }
 
-  if (std::regex_search(remainder, match, string_regex)) {
-    advance(match.length());
-    assert(pos_ <= text_.length());
-    return {lexer::token_type::String, match.str()};
+  if ((length = match_boolean(begin, end)) > 0) {
+    return make_token(lexer::token_type::Boolean, length);
   }
 
-  size_t len = 0;
-  char ch;
-  do {
-    ch = text_[pos_ + len];
+  if ((length = match_timestamp(begin, end)) > 0) {
+    return make_token(lexer::token_type::Timestamp, length);
+  }
 
-    if (ch == '(' || ch == ')' || ch == ',' || ch == ':')
-        break;
-  } while ((pos_ + (++len)) < text_.length());
+  if ((length = match_number(begin, end)) > 0) {
+    return make_token(lexer::token_type::Number, length);
+  }
 
-  std::string value = text_.substr(pos_, len);
+  if ((length = match_string(begin, end)) > 0) {
+    return make_token(lexer::token_type::String, length);
+  }
 
-  advance(len);
+  const char * it = begin;
+  while (it != end && *it != '(' && *it != ')' && *it != ',' && *it != ':') ++it;
 
-  return {lexer::token_type::Identifier, value};
+  return make_token(lexer::token_type::Identifier, it - begin);
 }
 
 expr_parser::expr_parser(const std::string & expr_str) : lexer_{expr_str} {}
@@ -6,7 +6,6 @@
 #include <iostream>
 #include <string>
 #include <vector>
-#include <regex>
 #include <cudf/types.hpp>
 
 #include "CalciteExpressionParsing.h"
@@ -249,13 +248,6 @@ private:
 class lexer
 {
 public:
-    constexpr static char VARIABLE_REGEX_STR[] = R"(\$\d+)";
-    constexpr static char NULL_REGEX_STR[] = R"(null)";
-    constexpr static char BOOLEAN_REGEX_STR[] = R"(true|false)";
-    constexpr static char NUMBER_REGEX_STR[] = R"([-+]?\d*\.?\d+([eE][-+]?\d+)?)";
-    constexpr static char TIMESTAMP_REGEX_STR[] = R"(\d{4}-\d{2}-\d{2}(?:[ T]\d{2}:\d{2}:\d{2})?)";
-    constexpr static char STRING_REGEX_STR[] = R"((["'])(?:(?!\1|\\).|\\.)*?\1)";
-
     enum class token_type
     {
         ParenthesisOpen,
@@ -283,18 +275,29 @@ public:
 
     token next_token() ;
 
+    // Each matcher returns the length of the token of its kind found at the
+    // beginning of [begin, end), or 0 if the text doesn't start with one.
+    // The grammar of every token is:
+    //   variable  : \$\d+
+    //   null      : null
+    //   boolean   : true|false
+    //   number    : [-+]?\d*\.?\d+([eE][-+]?\d+)?
+    //   timestamp : \d{4}-\d{2}-\d{2}(?:[ T]\d{2}:\d{2}:\d{2})?
+    //   string    : (["'])(?:(?!\1|\\).|\\.)*?\1
+    static size_t match_variable(const char * begin, const char * end);
+    static size_t match_null(const char * begin, const char * end);
+    static size_t match_boolean(const char * begin, const char * end);
+    static size_t match_number(const char * begin, const char * end);
+    static size_t match_timestamp(const char * begin, const char * end);
+    static size_t match_string(const char * begin, const char * end);
+
 private:
     void advance(size_t offset = 1);
 
+    token make_token(token_type type, size_t length);
+
     std::string text_;
     size_t pos_;
-
-    std::regex variable_regex{"^" + std::string(lexer::VARIABLE_REGEX_STR)};
-    std::regex null_regex{"^" + std::string(lexer::NULL_REGEX_STR)};
-    std::regex boolean_regex{"^" + std::string(lexer::BOOLEAN_REGEX_STR)};
-    std::regex number_regex{"^" + std::string(lexer::NUMBER_REGEX_STR)};
-    std::regex timestamp_regex{"^" + std::string(lexer::TIMESTAMP_REGEX_STR)};
-    std::regex string_regex{"^" + std::string(lexer::STRING_REGEX_STR)};
 };
 
 cudf::data_type infer_type_from_literal_token(const lexer::token & token);
@@ -352,6 +355,13 @@ public:
         return true;
     }
 
+    parse_tree clone() const {
+        assert(!!this->root_);
+        parse_tree ret;
+        ret.root_.reset(this->root_->clone());
+        return ret;
+    }
+
     void print() const {
         assert(!!this->root_);
         detail::print_helper(this->root_.get(), 0);
@@ -454,6 +454,10 @@ std::vector<int> get_projections(const std::string & query_part) {
 
 bool is_union(std::string query_part) { return (query_part.find(LOGICAL_UNION_TEXT) != std::string::npos); }
 
+bool is_distinct(std::string query_part) { return (query_part.find(LOGICAL_DISTINCT_TEXT) != std::string::npos); }
+
+bool is_distinct_partition(std::string query_part) { return (query_part.find(LOGICAL_DISTINCT_PARTITION_TEXT) != std::string::npos); }
+
 bool is_project(std::string query_part) { return (query_part.find(LOGICAL_PROJECT_TEXT) != std::string::npos); }
 
 bool is_logical_scan(std::string query_part) { return (query_part.find(LOGICAL_SCAN_TEXT) != std::string::npos); }
@@ -480,6 +484,8 @@ bool is_sort_and_sample(std::string query_part) { return (query_part.find(LOGICA
 
 bool is_single_node_partition(std::string query_part) { return (query_part.find(LOGICAL_SINGLE_NODE_PARTITION_TEXT) != std::string::npos); }
 
+bool is_top_n(std::string query_part) { return (query_part.find(LOGICAL_TOP_N_TEXT) != std::string::npos); }
+
 bool is_join(const std::string & query) { return (query.find(LOGICAL_JOIN_TEXT) != std::string::npos); }
 
 bool is_pairwise_join(const std::string & query) { return (query.find(LOGICAL_PARTWISE_JOIN_TEXT) != std::string::npos); }
@@ -498,6 +504,10 @@ bool is_window_function(std::string query_part) { return (query_part.find("OVER"
 
 bool is_window_compute(std::string query_part) { return (query_part.find(LOGICAL_COMPUTE_WINDOW_TEXT) != std::string::npos); }
 
+bool is_window_partition(std::string query_part) { return (query_part.find(LOGICAL_WINDOW_PARTITION_TEXT) != std::string::npos); }
+
+bool is_window_sort(std::string query_part) { return (query_part.find(LOGICAL_WINDOW_SORT_TEXT) != std::string::npos); }
+
 bool window_expression_contains_partition_by(std::string query_part) { return (query_part.find("PARTITION") != std::string::npos); }
 
 bool window_expression_contains_order_by(std::string query_part) { return (query_part.find("ORDER BY") != std::string::npos); }
@@ -546,6 +556,78 @@ bool window_expression_contains_multiple_diff_over_clauses(std::string logical_p
 	return false;
 }
 
+// input: PARTITION BY $2, $4 ORDER BY $1 ROWS BETWEEN 1 PRECEDING AND 1 FOLLOWING
+// output: PARTITION BY $2, $4
+static std::string get_partition_by_from_over_expression(const std::string & over_expression) {
+	std::string partition_by = over_expression.substr(0, over_expression.find(" ORDER BY"));
+	return partition_by.substr(0, partition_by.find(" ROWS"));
+}
+
+// input: LogicalProject(min_keys=[MIN($0) OVER (PARTITION BY $2 ORDER BY $1)],
+//                       max_keys=[MAX($0) OVER (PARTITION BY $1 ORDER BY $1)])
+// output: true
+bool window_expression_contains_multiple_diff_partition_by(std::string logical_plan) {
+	std::string query_part = get_query_part(logical_plan);
+	std::vector<std::string> project_expressions = get_expressions_from_expression_list(query_part);
+
+	std::vector<std::string> partition_by_expressions;
+	for (size_t i = 0; i < project_expressions.size(); ++i) {
+		if (is_window_function(project_expressions[i])) {
+			partition_by_expressions.push_back(get_partition_by_from_over_expression(get_over_expression(project_expressions[i])));
+		}
+	}
+
+	for (size_t i = 1; i < partition_by_expressions.size(); ++i) {
+		if (partition_by_expressions[0] != partition_by_expressions[i]) {
+			return true;
+		}
+	}
+
+	return false;
+}
+
+// input: LogicalComputeWindow(min_keys=[MIN($0) OVER (PARTITION BY $2 ORDER BY $1)], n_name=[$1],
+//                             sum_keys=[CASE(>(COUNT($0) OVER (PARTITION BY $2), 0), $SUM0($0) OVER (PARTITION BY $2), null:INTEGER)],
+//                             max_keys=[MAX($0) OVER (PARTITION BY $2 ORDER BY $1)])
+// output: [ < LogicalComputeWindow(min_keys=[MIN($0) OVER (PARTITION BY $2 ORDER BY $1)], max_keys=[MAX($0) OVER (PARTITION BY $2 ORDER BY $1)]), [0, 3] >,
+//           < LogicalComputeWindow(sum_keys=[CASE(>(COUNT($0) OVER (PARTITION BY $2), 0), $SUM0($0) OVER (PARTITION BY $2), null:INTEGER)]), [1, 2] > ]
+std::vector<std::pair<std::string, std::vector<std::size_t>>> get_window_expressions_by_over_clause(const std::string & logical_plan) {
+	std::string query_part = get_query_part(logical_plan);
+	std::vector<std::string> project_expressions = get_expressions_from_expression_list(query_part);
+
+	std::vector<std::string> over_expressions;
+	std::vector<std::vector<std::string>> grouped_expressions;
+	std::vector<std::pair<std::string, std::vector<std::size_t>>> groups;
+	std::size_t window_column = 0;
+	for (size_t i = 0; i < project_expressions.size(); ++i) {
+		if (!is_window_function(project_expressions[i])) {
+			continue;
+		}
+
+		std::string over_expression = get_over_expression(project_expressions[i]);
+		std::size_t group = std::find(over_expressions.begin(), over_expressions.end(), over_expression) - over_expressions.begin();
+		if (group == over_expressions.size()) {
+			over_expressions.push_back(over_expression);
+			grouped_expressions.emplace_back();
+			groups.emplace_back();
+		}
+		grouped_expressions[group].push_back(project_expressions[i]);
+
+		// due to `sum` or `avg` window aggregation two columns are computed
+		std::size_t num_window_columns = (is_sum_window_function(project_expressions[i]) || is_avg_window_function(project_expressions[i])) ? 2 : 1;
+		for (std::size_t j = 0; j < num_window_columns; ++j) {
+			groups[group].second.push_back(window_column++);
+		}
+	}
+
+	std::string plan_name = logical_plan.substr(0, logical_plan.find("("));
+	for (size_t group = 0; group < groups.size(); ++group) {
+		groups[group].first = plan_name + "(" + StringUtil::combine(grouped_expressions[group], ", ") + ")";
+	}
+
+	return groups;
+}
+
 // Due to `sum` window aggregation the OVER clause is repeated two times from Calcite
 // something like:
 // CASE(>(COUNT($0) OVER (PARTITION BY $1), 0), $SUM0($0) OVER (PARTITION BY $1), null:INTEGER)
@@ -115,6 +115,8 @@ const std::string LOGICAL_JOIN_TEXT = "LogicalJoin";
 const std::string LOGICAL_PARTWISE_JOIN_TEXT = "PartwiseJoin";
 const std::string LOGICAL_JOIN_PARTITION_TEXT = "JoinPartition";
 const std::string LOGICAL_UNION_TEXT = "LogicalUnion";
+const std::string LOGICAL_DISTINCT_TEXT = "LogicalDistinct";
+const std::string LOGICAL_DISTINCT_PARTITION_TEXT = "DistinctPartition";
 const std::string LOGICAL_SCAN_TEXT = "LogicalTableScan";
 const std::string BINDABLE_SCAN_TEXT = "BindableTableScan";
 const std::string LOGICAL_AGGREGATE_TEXT = "LogicalAggregate";  // this is the base Aggregate that gets replaced
@@ -128,13 +130,18 @@ const std::string LOGICAL_MERGE_TEXT = "LogicalMerge";
 const std::string LOGICAL_PARTITION_TEXT = "LogicalPartition";
 const std::string LOGICAL_SORT_AND_SAMPLE_TEXT = "Logical_SortAndSample";
 const std::string LOGICAL_SINGLE_NODE_PARTITION_TEXT = "LogicalSingleNodePartition";
+const std::string LOGICAL_TOP_N_TEXT = "LogicalTopN";
 const std::string LOGICAL_FILTER_TEXT = "LogicalFilter";
 const std::string LOGICAL_COMPUTE_WINDOW_TEXT = "LogicalComputeWindow";
+const std::string LOGICAL_WINDOW_PARTITION_TEXT = "LogicalWindowPartition";
+const std::string LOGICAL_WINDOW_SORT_TEXT = "LogicalWindowSort";
 const std::string ASCENDING_ORDER_SORT_TEXT = "ASC";
 const std::string DESCENDING_ORDER_SORT_TEXT = "DESC";
 
 
 bool is_union(std::string query_part);
+bool is_distinct(std::string query_part);
+bool is_distinct_partition(std::string query_part);
 bool is_project(std::string query_part);
 bool is_logical_scan(std::string query_part);
 bool is_bindable_scan(std::string query_part);
@@ -147,6 +154,7 @@ bool is_merge(std::string query_part);
 bool is_partition(std::string query_part);
 bool is_sort_and_sample(std::string query_part);
 bool is_single_node_partition(std::string query_part);
+bool is_top_n(std::string query_part);
 bool is_join(const std::string & query);
 bool is_pairwise_join(const std::string & query);
 bool is_join_partition(const std::string & query);
@@ -159,6 +167,8 @@ bool is_aggregate_partition(std::string query_part); // to be deprecated
 bool is_aggregate_and_sample(std::string query_part); // to be deprecated
 bool is_window_function(std::string query_part);
 bool is_window_compute(std::string query_part);
+bool is_window_partition(std::string query_part);
+bool is_window_sort(std::string query_part);
 
 bool window_expression_contains_partition_by(std::string query_part);
 
@@ -176,6 +186,13 @@ bool is_last_value_window(std::string expression);
 
 bool window_expression_contains_multiple_diff_over_clauses(std::string query_part);
 
+bool window_expression_contains_multiple_diff_partition_by(std::string query_part);
+
+// Groups the window functions of a logical plan by their OVER clause, in order of first appearance. Every group is
+// returned as a logical plan with only its window functions, together with the positions of the window columns
+// they compute among all the window columns of the original plan
+std::vector<std::pair<std::string, std::vector<std::size_t>>> get_window_expressions_by_over_clause(const std::string & logical_plan);
+
 bool is_sum_window_function(std::string expression);
 
 bool is_avg_window_function(std::string expression);
@@ -0,0 +1,424 @@
+#include "flat_expression_tree.hpp"
+#include <functional>
+
+namespace ral {
+namespace parser {
+
+namespace {
+
+inline size_t hash_combine(size_t seed, size_t value) {
+  return seed ^ (value + 0x9e3779b97f4a7c15ULL + (seed << 6) + (seed >> 2));
+}
+
+// Same grammar as detail::expr_parser, but the nodes are added directly to a flat_tree
+class flat_expr_parser {
+public:
+  flat_expr_parser(const std::string & expr_str, flat_tree & tree) : lexer_{expr_str}, tree_{tree} {}
+
+  flat_tree::node_id parse() {
+    token_ = lexer_.next_token();
+
+    return expr();
+  }
+
+private:
+  using lexer = detail::lexer;
+
+  bool accept(lexer::token_type type) {
+    if (token_.type == type) {
+      token_ = lexer_.next_token();
+      return true;
+    }
+
+    return false;
+  }
+
+  flat_tree::node_id expr() {
+    auto ret = term();
+    if (ret == flat_tree::NULL_NODE) {
+      ret = func();
+    }
+
+    RAL_EXPECTS(ret != flat_tree::NULL_NODE, "Couldn't parse calcite expression");
+
+    return ret;
+  }
+
+  flat_tree::node_id term() {
+    lexer::token variable_token = token_;
+    if (accept(lexer::token_type::Variable)) {
+      return tree_.add_variable(variable_token.value);
+    }
+
+    return literal();
+  }
+
+  flat_tree::node_id func() {
+    lexer::token func_name_token = token_;
+    if (!accept(lexer::token_type::Identifier)) {
+      return flat_tree::NULL_NODE;
+    }
+
+    accept(lexer::token_type::ParenthesisOpen);
+
+    // The arguments are collected in a stack shared by all the nested calls to
+    // avoid allocating a vector per function
+    size_t args_begin = args_.size();
+    if (!accept(lexer::token_type::ParenthesisClose)) {
+      args_.push_back(expr());
+      while (accept(lexer::token_type::Comma)) {
+        args_.push_back(expr());
+      }
+      accept(lexer::token_type::ParenthesisClose);
+    }
+
+    std::string func_identifier = std::move(func_name_token.value);
+    if (accept(lexer::token_type::Colon)) {
+      lexer::token return_token = token_;
+      accept(lexer::token_type::Identifier);
+
+      // Just append the return type to the function name for now
+      // Example: CAST():INTEGER => CAST_INTEGER()
+      func_identifier += "_" + return_token.value;
+    }
+
+    auto ret = tree_.add_operator(func_identifier, args_.data() + args_begin, args_.size() - args_begin);
+    args_.resize(args_begin);
+
+    return ret;
+  }
+
+  flat_tree::node_id literal() {
+    lexer::token literal_token = token_;
+    if (accept(lexer::token_type::Null)
+        || accept(lexer::token_type::Boolean)
+        || accept(lexer::token_type::Number)
+        || accept(lexer::token_type::Timestamp)
+        || accept(lexer::token_type::String))
+    {
+      cudf::data_type type;
+      if (accept(lexer::token_type::Colon)) {
+        lexer::token type_token = token_;
+        accept(lexer::token_type::Identifier);
+        type = detail::type_from_type_token(type_token);
+      } else {
+        type = detail::infer_type_from_literal_token(literal_token);
+      }
+
+      return tree_.add_literal(literal_token.value, type);
+    }
+
+    return flat_tree::NULL_NODE;
+  }
+
+  lexer lexer_;
+  lexer::token token_;
+  flat_tree & tree_;
+  std::vector<flat_tree::node_id> args_;
+};
+
+} // namespace
+
+string_pool::string_id string_pool::intern(const std::string & str) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto it = ids_.find(str);
+  if (it != ids_.end()) {
+    return it->second;
+  }
+
+  string_id id = strings_.size();
+  strings_.push_back(str);
+  hashes_.push_back(std::hash<std::string>{}(str));
+  ids_.emplace(str, id);
+  return id;
+}
+
+const std::string & string_pool::get(string_id id) const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return strings_[id];
+}
+
+size_t string_pool::hash(string_id id) const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return hashes_[id];
+}
+
+size_t string_pool::size() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return strings_.size();
+}
+
+constexpr flat_tree::node_id flat_tree::NULL_NODE;
+
+flat_tree::flat_tree() : flat_tree(nullptr) {}
+
+flat_tree::flat_tree(std::shared_ptr<string_pool> pool)
+  : pool_{pool ? std::move(pool) : std::make_shared<string_pool>()}, root_{NULL_NODE} {}
+
+flat_tree flat_tree::build(const std::string & expression, std::shared_ptr<string_pool> pool) {
+  flat_tree tree(std::move(pool));
+  // Every node takes at least two characters of the expression
+  tree.nodes_.reserve(expression.size() / 2);
+  tree.children_.reserve(expression.size() / 2);
+  flat_expr_parser parser(expression, tree);
+  tree.root_ = parser.parse();
+  return tree;
+}
+
+flat_tree flat_tree::from_tree(const node & root, std::shared_ptr<string_pool> pool) {
+  flat_tree tree(std::move(pool));
+
+  std::function<node_id(const node &)> add = [&](const node & n) -> node_id {
+    if (n.type == node_type::LITERAL) {
+      return tree.add_literal(n.value, static_cast<const literal_node &>(n).type());
+    } else if (n.type == node_type::VARIABLE) {
+      return tree.add_variable(n.value);
+    }
+
+    std::vector<node_id> children;
+    children.reserve(n.children.size());
+    for (auto && c : n.children) {
+      children.push_back(add(*c));
+    }
+    return tree.add_operator(n.value, children);
+  };
+
+  tree.root_ = add(root);
+  return tree;
+}
+
+std::unique_ptr<node> flat_tree::to_tree() const {
+  assert(root_ != NULL_NODE);
+  return to_tree(root_);
+}
+
+std::unique_ptr<node> flat_tree::to_tree(node_id id) const {
+  const flat_node & n = nodes_[id];
+  if (n.type == node_type::LITERAL) {
+    return std::unique_ptr<node>(new literal_node(value(id), n.literal_type));
+  } else if (n.type == node_type::VARIABLE) {
+    return std::unique_ptr<node>(new variable_node(value(id)));
+  }
+
+  auto ret = std::unique_ptr<node>(new operator_node(value(id)));
+  ret->children.reserve(n.num_children);
+  for (size_t i = 0; i < n.num_children; i++) {
+    ret->children.push_back(to_tree(child(id, i)));
+  }
+  return ret;
+}
+
+bool flat_tree::equal(node_id id, const flat_tree & other, node_id other_id) const {
+  const flat_node & a = nodes_[id];
+  const flat_node & b = other.nodes_[other_id];
+  if (a.hash != b.hash || a.type != b.type || a.num_children != b.num_children || a.literal_type.id() != b.literal_type.id()) {
+    return false;
+  }
+
+  bool same_value = pool_ == other.pool_ ? a.value == b.value : value(id) == other.value(other_id);
+  if (!same_value) {
+    return false;
+  }
+
+  for (size_t i = 0; i < a.num_children; i++) {
+    if (!equal(child(id, i), other, other.child(other_id, i))) {
+      return false;
+    }
+  }
+  return true;
+}
+
+flat_tree::node_id flat_tree::add_node(flat_node new_node, const node_id * children) {
+  new_node.first_child = children_.size();
+  new_node.hash = hash_combine(static_cast<size_t>(new_node.type), pool_->hash(new_node.value));
+  if (new_node.type == node_type::LITERAL) {
+    new_node.hash = hash_combine(new_node.hash, static_cast<size_t>(new_node.literal_type.id()));
+  }
+  for (size_t i = 0; i < new_node.num_children; i++) {
+    children_.push_back(children[i]);
+    new_node.hash = hash_combine(new_node.hash, nodes_[children[i]].hash);
+  }
+
+  nodes_.push_back(new_node);
+  return nodes_.size() - 1;
+}
+
+flat_tree::node_id flat_tree::add_literal(const std::string & value, cudf::data_type type) {
+  return add_node({node_type::LITERAL, pool_->intern(value), type, 0, 0, 0, 0}, nullptr);
+}
+
+flat_tree::node_id flat_tree::add_variable(const std::string & value) {
+  cudf::size_type index = std::stoi(value.substr(1, value.size() - 1));
+  return add_node({node_type::VARIABLE, pool_->intern(value), cudf::data_type{}, index, 0, 0, 0}, nullptr);
+}
+
+flat_tree::node_id flat_tree::add_operator(const std::string & value, const std::vector<node_id> & children) {
+  return add_operator(value, children.data(), children.size());
+}
+
+flat_tree::node_id flat_tree::add_operator(const std::string & value, const node_id * children, size_t num_children) {
+  flat_node new_node{node_type::OPERATOR, pool_->intern(value), cudf::data_type{}, 0, 0, static_cast<uint32_t>(num_children), 0};
+  return add_node(new_node, children);
+}
+
+flat_tree flat_tree::clone() const {
+  return *this;
+}
+
+void flat_tree::compact() {
+  if (root_ == NULL_NODE) {
+    nodes_.clear();
+    children_.clear();
+    return;
+  }
+
+  flat_tree compacted(pool_);
+  compacted.nodes_.reserve(nodes_.size());
+  compacted.children_.reserve(children_.size());
+  std::vector<node_id> new_ids(nodes_.size(), NULL_NODE);
+  std::vector<node_id> scratch;
+
+  compacted.root_ = compact_helper(root_, compacted, new_ids, scratch);
+  nodes_ = std::move(compacted.nodes_);
+  children_ = std::move(compacted.children_);
+  root_ = compacted.root_;
+}
+
+flat_tree::node_id flat_tree::compact_helper(node_id id, flat_tree & compacted, std::vector<node_id> & new_ids, std::vector<node_id> & scratch) const {
+  if (new_ids[id] != NULL_NODE) {
+    return new_ids[id];
+  }
+
+  // The children are copied before their parent, their new ids are kept in
+  // scratch until all of them are copied
+  flat_node n = nodes_[id];
+  size_t scratch_begin = scratch.size();
+  for (size_t i = 0; i < n.num_children; i++) {
+    node_id new_child = compact_helper(child(id, i), compacted, new_ids, scratch);
+    scratch.push_back(new_child);
+  }
+
+  n.first_child = compacted.children_.size();
+  compacted.children_.insert(compacted.children_.end(), scratch.begin() + scratch_begin, scratch.end());
+  scratch.resize(scratch_begin);
+
+  compacted.nodes_.push_back(n);
+  new_ids[id] = compacted.nodes_.size() - 1;
+  return new_ids[id];
+}
+
+void flat_tree::transform_to_custom_op() {
+  assert(root_ != NULL_NODE);
+  size_t size_before = nodes_.size();
+  std::vector<node_id> scratch;
+  root_ = transform_custom_op(root_, scratch);
+  if (nodes_.size() != size_before) {
+    compact();
+  }
+}
+
+flat_tree::node_id flat_tree::transform_custom_op(node_id id, std::vector<node_id> & scratch) {
+  if (nodes_[id].type != node_type::OPERATOR) {
+    return id;
+  }
+
+  // The transformed children are kept in scratch while the node is rewritten
+  size_t num_children = nodes_[id].num_children;
+  size_t scratch_begin = scratch.size();
+  bool children_changed = false;
+  for (size_t i = 0; i < num_children; i++) {
+    node_id transformed_child = transform_custom_op(child(id, i), scratch);
+    children_changed = children_changed || transformed_child != child(id, i);
+    scratch.push_back(transformed_child);
+  }
+  if (children_changed) {
+    id = add_operator(value(id), scratch.data() + scratch_begin, num_children);
+  }
+
+  node_id ret = id;
+  const std::string & op = value(id);
+  if (op == "CASE") {
+    ret = transform_case(id, 0);
+  } else if (op == "Reinterpret") {
+    assert(num_children == 1);
+    ret = child(id, 0);
+  } else if (op == "ROUND") {
+    assert(num_children == 1 || num_children == 2);
+    if (num_children == 1) {
+      scratch.push_back(add_literal("0", cudf::data_type{cudf::type_id::INT8}));
+      ret = add_operator(op, scratch.data() + scratch_begin, 2);
+    }
+  } else if (StringUtil::beginsWith(op, "CAST")) {
+    assert(num_children == 1);
+    node_id operand = child(id, 0);
+    if (nodes_[operand].type == node_type::LITERAL) {
+      // Special case for calcite expressions like `CAST(4:INTEGER):INTEGER`
+      operator_type cast_op = map_to_operator_type(op);
+      cudf::data_type literal_type = nodes_[operand].literal_type;
+      cudf::data_type new_type(get_output_type(cast_op, literal_type.id()));
+
+      // Ensure that the types are compatible
+      ral::utilities::get_common_type(literal_type, new_type, true);
+
+      ret = add_literal(value(operand), new_type);
+    }
+  }
+
+  scratch.resize(scratch_begin);
+  return ret;
+}
+
+flat_tree::node_id flat_tree::transform_case(node_id id, size_t child_idx) {
+  size_t num_children = nodes_[id].num_children;
+  assert(num_children >= 3 && num_children % 2 != 0);
+  assert(child_idx < num_children);
+
+  if (child_idx == num_children - 1) {
+    return child(id, child_idx);
+  }
+
+  node_id magic_if_not_children[] = {child(id, child_idx), child(id, child_idx + 1)};
+  node_id first_non_magic_children[] = {add_operator("MAGIC_IF_NOT", magic_if_not_children, 2),
+                                        transform_case(id, child_idx + 2)};
+  return add_operator("FIRST_NON_MAGIC", first_non_magic_children, 2);
+}
+
+std::string flat_tree::rebuildExpression() const {
+  assert(root_ != NULL_NODE);
+  std::string ret;
+  rebuild_helper(root_, ret);
+  return ret;
+}
+
+void flat_tree::rebuild_helper(node_id id, std::string & out) const {
+  out += value(id);
+  if (nodes_[id].type != node_type::OPERATOR) {
+    return;
+  }
+
+  out += '(';
+  for (size_t i = 0; i < nodes_[id].num_children; i++) {
+    if (i > 0) {
+      out += ", ";
+    }
+    rebuild_helper(child(id, i), out);
+  }
+  out += ')';
+}
+
+void flat_tree::visit(node_visitor & visitor) const {
+  to_tree()->accept(visitor);
+}
+
+void flat_tree::transform(node_transformer & transformer) {
+  std::unique_ptr<node> root = to_tree();
+  node * transformed_root = root->accept(transformer);
+  if (transformed_root != root.get()) {
+    root.reset(transformed_root);
+  }
+
+  *this = from_tree(*root, pool_);
+}
+
+}  // namespace parser
+}  // namespace ral
@@ -0,0 +1,146 @@
+#pragma once
+
+#include <deque>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "expression_tree.hpp"
+
+namespace ral {
+namespace parser {
+
+/**
+ * @brief Interns the strings held by flat_tree nodes
+ *
+ * A pool is shared by a tree and all its clones, so cloning or rewriting a
+ * tree never copies the operator names and literal values it contains.
+ * Interned strings are never removed and their references stay valid for the
+ * lifetime of the pool.
+ */
+class string_pool {
+public:
+    using string_id = uint32_t;
+
+    string_id intern(const std::string & str);
+
+    const std::string & get(string_id id) const;
+
+    size_t hash(string_id id) const;
+
+    size_t size() const;
+
+private:
+    mutable std::mutex mutex_;
+    std::deque<std::string> strings_;
+    std::deque<size_t> hashes_;
+    std::unordered_map<std::string, string_id> ids_;
+};
+
+/**
+ * @brief Expression tree stored as a flat array of nodes
+ *
+ * Nodes live in a single arena and refer to their children by index, the
+ * children of a node are contiguous in a second array. Nodes are never
+ * modified once added, rewrites append new nodes and leave the old ones
+ * unreachable until compact() is called. Every node stores a structural hash
+ * of its subtree that is computed when the node is added.
+ *
+ * This is an alternative layout for parse_tree, to_tree()/from_tree() convert
+ * between both, and visit()/transform() run the existing node_visitor and
+ * node_transformer implementations through that conversion.
+ */
+class flat_tree {
+public:
+    using node_id = uint32_t;
+
+    static constexpr node_id NULL_NODE = std::numeric_limits<node_id>::max();
+
+    flat_tree();
+    explicit flat_tree(std::shared_ptr<string_pool> pool);
+
+    /**
+     * @brief Parses a calcite expression, same grammar as parse_tree::build
+     */
+    static flat_tree build(const std::string & expression, std::shared_ptr<string_pool> pool = nullptr);
+
+    static flat_tree from_tree(const node & root, std::shared_ptr<string_pool> pool = nullptr);
+
+    std::unique_ptr<node> to_tree() const;
+    std::unique_ptr<node> to_tree(node_id id) const;
+
+    node_id root() const { return root_; }
+    void set_root(node_id id) { root_ = id; }
+
+    node_type type(node_id id) const { return nodes_[id].type; }
+    const std::string & value(node_id id) const { return pool_->get(nodes_[id].value); }
+    string_pool::string_id value_id(node_id id) const { return nodes_[id].value; }
+    cudf::data_type literal_type(node_id id) const { return nodes_[id].literal_type; }
+    cudf::size_type variable_index(node_id id) const { return nodes_[id].variable_index; }
+    size_t num_children(node_id id) const { return nodes_[id].num_children; }
+    node_id child(node_id id, size_t idx) const { return children_[nodes_[id].first_child + idx]; }
+
+    /**
+     * @brief Structural hash of the subtree rooted at id, equal subtrees have
+     * equal hashes across trees and pools
+     */
+    size_t hash(node_id id) const { return nodes_[id].hash; }
+    size_t hash() const { return hash(root_); }
+
+    bool equal(node_id id, const flat_tree & other, node_id other_id) const;
+    bool operator==(const flat_tree & other) const { return equal(root_, other, other.root_); }
+
+    node_id add_literal(const std::string & value, cudf::data_type type);
+    node_id add_variable(const std::string & value);
+    node_id add_operator(const std::string & value, const std::vector<node_id> & children);
+    node_id add_operator(const std::string & value, const node_id * children, size_t num_children);
+
+    // Number of nodes in the arena, including the unreachable ones
+    size_t size() const { return nodes_.size(); }
+
+    const std::shared_ptr<string_pool> & pool() const { return pool_; }
+
+    flat_tree clone() const;
+
+    // Drops the nodes that are not reachable from the root
+    void compact();
+
+    void transform_to_custom_op();
+
+    std::string rebuildExpression() const;
+
+    void visit(node_visitor & visitor) const;
+
+    void transform(node_transformer & transformer);
+
+private:
+    struct flat_node {
+        node_type type;
+        string_pool::string_id value;
+        cudf::data_type literal_type;
+        cudf::size_type variable_index;
+        uint32_t first_child;
+        uint32_t num_children;
+        size_t hash;
+    };
+
+    node_id add_node(flat_node new_node, const node_id * children);
+
+    node_id compact_helper(node_id id, flat_tree & compacted, std::vector<node_id> & new_ids, std::vector<node_id> & scratch) const;
+
+    node_id transform_custom_op(node_id id, std::vector<node_id> & scratch);
+    node_id transform_case(node_id id, size_t child_idx);
+
+    void rebuild_helper(node_id id, std::string & out) const;
+
+    std::shared_ptr<string_pool> pool_;
+    std::vector<flat_node> nodes_;
+    std::vector<node_id> children_;
+    node_id root_;
+};
+
+}  // namespace parser
+}  // namespace ral
@@ -0,0 +1,236 @@
+#include "PartitionPruner.h"
+
+#include <cstdio>
+#include <numeric>
+
+#include <blazingdb/io/Config/BlazingContext.h>
+#include <cudf/utilities/traits.hpp>
+
+#include "SkipDataProcessor.h"
+#include "CalciteExpressionParsing.h"
+#include "parser/expression_tree.hpp"
+#include "parser/expression_utils.hpp"
+
+namespace ral {
+namespace skip_data {
+
+namespace {
+using namespace ral::parser;
+
+enum class match { NO, YES, MAYBE };
+
+// Value of an operand of the filter, numbers and timestamps (in seconds) are compared as doubles
+struct host_value {
+	enum class kind { NUMBER, STRING, UNKNOWN };
+
+	kind value_kind = kind::UNKNOWN;
+	double number = 0;
+	std::string string;
+};
+
+// Days from 1970-01-01 to a date of the proleptic gregorian calendar
+int64_t days_from_civil(int64_t year, int64_t month, int64_t day) {
+	year -= month <= 2;
+	const int64_t era = (year >= 0 ? year : year - 399) / 400;
+	const int64_t year_of_era = year - era * 400;
+	const int64_t day_of_year = (153 * (month + (month > 2 ? -3 : 9)) + 2) / 5 + day - 1;
+	const int64_t day_of_era = year_of_era * 365 + year_of_era / 4 - year_of_era / 100 + day_of_year;
+	return era * 146097 + day_of_era - 719468;
+}
+
+host_value parse_value(const std::string & text, cudf::type_id type) {
+	host_value value;
+	cudf::data_type data_type{type};
+	try {
+		if (type == cudf::type_id::STRING) {
+			value.value_kind = host_value::kind::STRING;
+			value.string = text;
+		} else if (type == cudf::type_id::BOOL8) {
+			value.value_kind = host_value::kind::NUMBER;
+			value.number = (text == "true" || text == "True" || text == "TRUE" || text == "1") ? 1 : 0;
+		} else if (cudf::is_timestamp(data_type)) {
+			int year, month, day, hour = 0, minute = 0;
+			double second = 0;
+			if (std::sscanf(text.c_str(), "%d-%d-%d%*1[ T]%d:%d:%lf", &year, &month, &day, &hour, &minute, &second) >= 3) {
+				value.value_kind = host_value::kind::NUMBER;
+				value.number = days_from_civil(year, month, day) * 86400.0 + hour * 3600 + minute * 60 + second;
+			}
+		} else if (cudf::is_numeric(data_type)) {
+			value.number = std::stod(text);
+			value.value_kind = host_value::kind::NUMBER;
+		}
+	} catch (const std::exception &) {
+		value.value_kind = host_value::kind::UNKNOWN;
+	}
+	return value;
+}
+
+// Evaluates a filter rewritten by the skip data rules, where $2i and $2i+1 are
+// the minimum and the maximum of column i, both being the value of the folder
+struct host_evaluator {
+	const std::vector<host_value> & columns;
+
+	host_value value(const node & n) const {
+		if (n.type == node_type::VARIABLE) {
+			size_t column = static_cast<const variable_node &>(n).index() / 2;
+			return column < columns.size() ? columns[column] : host_value{};
+		} else if (n.type == node_type::LITERAL) {
+			auto & literal = static_cast<const literal_node &>(n);
+			std::string text = literal.value;
+			if (literal.type().id() == cudf::type_id::STRING && text.size() >= 2 && (text.front() == '\'' || text.front() == '"')) {
+				text = text.substr(1, text.size() - 2);
+			}
+			return literal.type().id() == cudf::type_id::EMPTY ? host_value{} : parse_value(text, literal.type().id());
+		} else if ((n.value == "+" || n.value == "-") && n.children.size() == 2) {
+			host_value left = value(*n.children[0]);
+			host_value right = value(*n.children[1]);
+			if (left.value_kind == host_value::kind::NUMBER && right.value_kind == host_value::kind::NUMBER) {
+				left.number = n.value == "+" ? left.number + right.number : left.number - right.number;
+				return left;
+			}
+		}
+		return host_value{};
+	}
+
+	match evaluate(const node & n) const {
+		if (n.type != node_type::OPERATOR) {
+			return match::MAYBE;
+		}
+
+		if (n.value == "AND" || n.value == "OR") {
+			bool is_and = n.value == "AND";
+			match result = is_and ? match::YES : match::NO;
+			for (auto & child : n.children) {
+				match child_match = evaluate(*child);
+				if (child_match == (is_and ? match::NO : match::YES)) {
+					return child_match;
+				}
+				if (child_match == match::MAYBE) {
+					result = match::MAYBE;
+				}
+			}
+			return result;
+		}
+
+		if (n.children.size() != 2) {
+			return match::MAYBE;
+		}
+		host_value left = value(*n.children[0]);
+		host_value right = value(*n.children[1]);
+		if (left.value_kind == host_value::kind::UNKNOWN || left.value_kind != right.value_kind) {
+			return match::MAYBE;
+		}
+		int comparison = left.value_kind == host_value::kind::NUMBER
+			? (left.number < right.number ? -1 : (left.number > right.number ? 1 : 0))
+			: left.string.compare(right.string);
+
+		bool result;
+		if (n.value == "<") {
+			result = comparison < 0;
+		} else if (n.value == "<=") {
+			result = comparison <= 0;
+		} else if (n.value == ">") {
+			result = comparison > 0;
+		} else if (n.value == ">=") {
+			result = comparison >= 0;
+		} else {
+			return match::MAYBE;
+		}
+		return result ? match::YES : match::NO;
+	}
+};
+
+} // namespace
+
+partition_pruner::partition_pruner(const std::string & table_scan, const std::vector<std::string> & column_names, const std::vector<cudf::type_id> & column_types) {
+	filter = get_named_expression(table_scan, "condition");
+	if (filter.empty()) {
+		filter = get_named_expression(table_scan, "filters");
+	}
+	if (filter.empty()) {
+		return;
+	}
+	filter = expand_if_logical_op(replace_calcite_regex(filter));
+
+	std::string projects = get_named_expression(table_scan, "projects");
+	std::vector<int> column_indices;
+	if (projects.empty()) {
+		column_indices.resize(column_names.size());
+		std::iota(column_indices.begin(), column_indices.end(), 0);
+	} else {
+		for (auto & column_index : get_expressions_from_expression_list(projects, true)) {
+			column_indices.push_back(std::stoi(column_index));
+		}
+	}
+	for (int column_index : column_indices) {
+		names.push_back(column_names.at(column_index));
+		types.push_back(column_types.at(column_index));
+	}
+}
+
+bool partition_pruner::may_match(const std::map<std::string, std::string> & partition_values) const {
+	if (filter.empty()) {
+		return true;
+	}
+
+	ral::parser::parse_tree tree;
+	if (!tree.build(filter)) {
+		return true;
+	}
+
+	std::vector<host_value> columns(names.size());
+	for (size_t i = 0; i < names.size(); i++) {
+		auto it = partition_values.find(names[i]);
+		if (it == partition_values.end()) {
+			drop_value(tree, "$" + std::to_string(i));
+		} else {
+			columns[i] = parse_value(it->second, types[i]);
+		}
+	}
+	if (!apply_skip_data_rules(tree)) {
+		return true;
+	}
+
+	return host_evaluator{columns}.evaluate(tree.root()) != match::NO;
+}
+
+std::vector<std::string> list_partition_folders(const Uri & folder_uri, const partition_pruner * pruner) {
+	struct partition_folder {
+		Uri uri;
+		std::string path;
+		std::map<std::string, std::string> values;
+	};
+
+	auto fs = BlazingContext::getInstance()->getFileSystemManager();
+
+	std::vector<std::string> leaf_folders;
+	std::vector<partition_folder> level{{folder_uri, "", {}}};
+	while (!level.empty()) {
+		std::vector<partition_folder> next_level;
+		for (auto & folder : level) {
+			bool has_partitions = false;
+			for (auto & status : fs->list(folder.uri, FileType::DIRECTORY, "*=*")) {
+				std::string name = status.getUri().getPath().getResourceName();
+				size_t separator = name.find('=');
+				if (separator == std::string::npos) {
+					continue;
+				}
+				has_partitions = true;
+
+				partition_folder child{status.getUri(), folder.path.empty() ? name : folder.path + "/" + name, folder.values};
+				child.values[name.substr(0, separator)] = name.substr(separator + 1);
+				if (pruner == nullptr || pruner->may_match(child.values)) {
+					next_level.push_back(std::move(child));
+				}
+			}
+			if (!has_partitions && !folder.path.empty()) {
+				leaf_folders.push_back(folder.path);
+			}
+		}
+		level = std::move(next_level);
+	}
+	return leaf_folders;
+}
+
+} // namespace skip_data
+} // namespace ral
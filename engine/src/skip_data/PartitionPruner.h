@@ -0,0 +1,59 @@
+#ifndef PARTITIONPRUNER_H_
+#define PARTITIONPRUNER_H_
+
+#include <map>
+#include <string>
+#include <vector>
+#include <cudf/types.hpp>
+#include "FileSystem/Uri.h"
+
+namespace ral {
+namespace skip_data {
+
+/**
+ * @brief Decides from the filter of a table scan whether a key=value partition
+ * folder may hold rows that pass it.
+ *
+ * Every column with no known value is dropped from the filter, the same way as
+ * the columns without metadata are dropped when skipping data. A folder is
+ * pruned only when the values of its partition columns make what is left of
+ * the filter false, anything that can not be evaluated on the host keeps it.
+ */
+class partition_pruner {
+public:
+	/**
+	 * @param table_scan The TableScan or BindableTableScan step of the query.
+	 * @param column_names The names of all the columns of the table.
+	 * @param column_types The types of all the columns of the table.
+	 */
+	partition_pruner(const std::string & table_scan, const std::vector<std::string> & column_names, const std::vector<cudf::type_id> & column_types);
+
+	/**
+	 * @brief Whether the filter can prune any folder at all.
+	 */
+	bool has_filter() const { return !filter.empty(); }
+
+	/**
+	 * @param partition_values The values of the partition columns of a folder, by column name.
+	 * Columns of the levels that were not reached yet are left out.
+	 */
+	bool may_match(const std::map<std::string, std::string> & partition_values) const;
+
+private:
+	std::string filter;
+	std::vector<std::string> names; /**< Names of the columns of the filter, $i is names[i]. */
+	std::vector<cudf::type_id> types;
+};
+
+/**
+ * @brief Lists the key=value partition folders under folder_uri level by level.
+ * The folders ruled out by the pruner are not listed nor descended into.
+ *
+ * @return The leaf partition folders, as paths relative to folder_uri like "year=2020/month=1".
+ */
+std::vector<std::string> list_partition_folders(const Uri & folder_uri, const partition_pruner * pruner = nullptr);
+
+} // namespace skip_data
+} // namespace ral
+
+#endif //PARTITIONPRUNER_H_
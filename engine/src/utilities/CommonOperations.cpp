@@ -12,7 +12,10 @@
 #include <cudf/column/column_factories.hpp>
 #include <cudf/strings/strings_column_view.hpp>
 #include <numeric>
+#include <atomic>
+#include <exception>
 #include "execution_graph/logic_controllers/BlazingColumnOwner.h"
+#include "ExceptionHandling/BlazingThread.h"
 
 namespace ral {
 namespace utilities {
@@ -207,5 +210,31 @@ void normalize_types(std::unique_ptr<ral::frame::BlazingTable> & table,  const s
 	table = std::make_unique<ral::frame::BlazingTable>(std::move(columns), table->names());
 }
 
+void run_in_parallel(size_t num_jobs, const std::function<void(size_t)> & job) {
+	size_t num_threads = std::min<size_t>(num_jobs, std::max(BlazingThread::hardware_concurrency(), 1u));
+	std::atomic<size_t> next_job(0);
+	std::vector<BlazingThread> threads(num_threads);
+	for (auto & thread : threads) {
+		thread = BlazingThread([&next_job, num_jobs, &job]() {
+			for (size_t job_index = next_job++; job_index < num_jobs; job_index = next_job++) {
+				job(job_index);
+			}
+		});
+	}
+
+	// every thread is joined before rethrowing, as they all use this stack frame
+	std::exception_ptr exception;
+	for (auto & thread : threads) {
+		try {
+			thread.join();
+		} catch (...) {
+			exception = std::current_exception();
+		}
+	}
+	if (exception) {
+		std::rethrow_exception(exception);
+	}
+}
+
 }  // namespace utilities
 }  // namespace ral
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <functional>
 #include <string>
 #include <vector>
 #include "execution_graph/logic_controllers/LogicPrimitives.h"
@@ -29,6 +30,9 @@ std::vector<cudf::data_type> get_common_types(const std::vector<cudf::data_type>
 void normalize_types(std::unique_ptr<ral::frame::BlazingTable> & table,  const std::vector<cudf::data_type> & types,
 	 		std::vector<cudf::size_type> column_indices = std::vector<cudf::size_type>() );
 
+// Runs every job once, in as many threads as there are cores, and rethrows the exception of a job once all of them are done
+void run_in_parallel(size_t num_jobs, const std::function<void(size_t)> & job);
+
 // This is only for numerics
 template<typename T>
 std::unique_ptr<cudf::column> vector_to_column(std::vector<T> vect, cudf::data_type type){
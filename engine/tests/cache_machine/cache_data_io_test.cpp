@@ -0,0 +1,122 @@
+#include "tests/utilities/BlazingUnitTest.h"
+
+#include <numeric>
+
+#include <cudf/concatenate.hpp>
+#include <cudf/copying.hpp>
+
+#include <cudf_test/column_wrapper.hpp>
+#include <cudf_test/table_utilities.hpp>
+
+#include "execution_graph/logic_controllers/CacheData.h"
+#include "execution_graph/logic_controllers/LogicalProject.h"
+#include "io/data_parser/DataParser.h"
+
+namespace {
+
+const cudf::size_type ROWS_PER_ROW_GROUP = 10;
+
+/**
+ * A parser over a table in memory that is split in row groups of ROWS_PER_ROW_GROUP rows,
+ * it records the columns and row groups of every batch it parses.
+ */
+class row_group_parser : public ral::io::data_parser {
+public:
+	row_group_parser(cudf::table_view table) : table(table) {}
+
+	std::unique_ptr<ral::frame::BlazingTable> parse_batch(ral::io::data_handle /*handle*/,
+		const ral::io::Schema & schema,
+		std::vector<int> column_indices,
+		std::vector<cudf::size_type> row_groups) override {
+		parsed_column_indices.push_back(column_indices);
+		parsed_row_groups.push_back(row_groups);
+
+		std::vector<cudf::table_view> pieces;
+		for (cudf::size_type row_group : row_groups) {
+			std::vector<cudf::size_type> bounds{row_group * ROWS_PER_ROW_GROUP, (row_group + 1) * ROWS_PER_ROW_GROUP};
+			pieces.push_back(cudf::slice(table.select(column_indices), bounds)[0]);
+		}
+		std::vector<std::string> names;
+		for (int column_index : column_indices) {
+			names.push_back(schema.get_name(column_index));
+		}
+		return std::make_unique<ral::frame::BlazingTable>(cudf::concatenate(pieces), names);
+	}
+
+	void parse_schema(std::shared_ptr<arrow::io::RandomAccessFile> /*file*/, ral::io::Schema & /*schema*/) override {}
+
+	ral::io::DataType type() const override { return ral::io::DataType::PARQUET; }
+
+	std::vector<std::vector<int>> parsed_column_indices;
+	std::vector<std::vector<cudf::size_type>> parsed_row_groups;
+
+private:
+	cudf::table_view table;
+};
+
+} // namespace
+
+/**
+ * The scan input of a filtered Parquet scan with late materialization. The table has the columns
+ * a = 0..29, b = 100..129 and c = 200..229 in three row groups of 10 rows, the filter keeps b < 115.
+ */
+struct CacheDataIOTest : public BlazingUnitTest {
+	CacheDataIOTest()
+		: a(make_sequence(0)), b(make_sequence(100)), c(make_sequence(200)),
+		schema({"a", "b", "c"}, {cudf::type_id::INT32, cudf::type_id::INT32, cudf::type_id::INT32}) {
+		parser = std::make_shared<row_group_parser>(cudf::table_view{{a, b, c}});
+		filter_programs = std::make_shared<ral::processor::expression_program_cache>(std::vector<std::string>{"<($0, 115)"});
+	}
+
+	static cudf::test::fixed_width_column_wrapper<int32_t> make_sequence(int32_t first) {
+		std::vector<int32_t> values(3 * ROWS_PER_ROW_GROUP);
+		std::iota(values.begin(), values.end(), first);
+		return cudf::test::fixed_width_column_wrapper<int32_t>(values.begin(), values.end());
+	}
+
+	// the filter reads b, which is at position filter_position of the projections
+	std::unique_ptr<ral::frame::BlazingTable> decache(std::vector<int> row_group_ids, std::vector<int> projections, int filter_position) {
+		ral::cache::CacheDataIO input(ral::io::data_handle(), parser, schema, schema, row_group_ids, projections);
+		input.set_late_materialization_filter(filter_programs, {filter_position});
+		return input.decache();
+	}
+
+	cudf::test::fixed_width_column_wrapper<int32_t> a, b, c;
+	ral::io::Schema schema;
+	std::shared_ptr<row_group_parser> parser;
+	std::shared_ptr<ral::processor::expression_program_cache> filter_programs;
+};
+
+TEST_F(CacheDataIOTest, loads_the_other_columns_only_for_the_rows_that_pass) {
+	auto table = decache({0, 1}, {2, 0, 1}, 2);
+
+	ASSERT_EQ(parser->parsed_column_indices.size(), 2);
+	EXPECT_EQ(parser->parsed_column_indices[0], std::vector<int>({1}));
+	EXPECT_EQ(parser->parsed_column_indices[1], std::vector<int>({2, 0}));
+	EXPECT_EQ(parser->parsed_row_groups[1], std::vector<cudf::size_type>({0, 1}));
+
+	std::vector<int32_t> expected_a(15);
+	std::iota(expected_a.begin(), expected_a.end(), 0);
+	std::vector<int32_t> expected_b(15);
+	std::iota(expected_b.begin(), expected_b.end(), 100);
+	std::vector<int32_t> expected_c(15);
+	std::iota(expected_c.begin(), expected_c.end(), 200);
+	cudf::test::fixed_width_column_wrapper<int32_t> expected_a_column(expected_a.begin(), expected_a.end());
+	cudf::test::fixed_width_column_wrapper<int32_t> expected_b_column(expected_b.begin(), expected_b.end());
+	cudf::test::fixed_width_column_wrapper<int32_t> expected_c_column(expected_c.begin(), expected_c.end());
+
+	EXPECT_EQ(table->names(), std::vector<std::string>({"c", "a", "b"}));
+	cudf::test::expect_tables_equal(cudf::table_view{{expected_c_column, expected_a_column, expected_b_column}}, table->view());
+}
+
+TEST_F(CacheDataIOTest, skips_the_other_columns_of_a_row_group_where_no_row_passes) {
+	auto table = decache({2}, {0, 1, 2}, 1);
+
+	ASSERT_EQ(parser->parsed_column_indices.size(), 1);
+	EXPECT_EQ(parser->parsed_column_indices[0], std::vector<int>({1}));
+	EXPECT_EQ(parser->parsed_row_groups[0], std::vector<cudf::size_type>({2}));
+
+	EXPECT_EQ(table->num_rows(), 0);
+	EXPECT_EQ(table->names(), std::vector<std::string>({"a", "b", "c"}));
+	EXPECT_EQ(table->get_schema(), std::vector<cudf::data_type>(3, cudf::data_type{cudf::type_id::INT32}));
+}
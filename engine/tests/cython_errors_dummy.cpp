@@ -12,6 +12,7 @@ PyObject *InitializeError_ = nullptr,
 		 		 *RegisterFileSystemS3Error_ = nullptr,
 				 *RegisterFileSystemLocalError_ = nullptr,
          *InferFolderPartitionMetadataError_ = nullptr,
+         *PrunePartitionsError_ = nullptr,
 				 *GetProductDetailsError_ = nullptr,
 				 *GetFreeMemoryError_ = nullptr,
 				 *ResetMaxMemoryUsedError_ = nullptr,
@@ -0,0 +1,125 @@
+#include "tests/utilities/BlazingUnitTest.h"
+
+#include <set>
+#include <tuple>
+
+#include <cudf/sorting.hpp>
+
+#include "cudf_test/column_wrapper.hpp"
+#include "cudf_test/table_utilities.hpp"
+
+#include "execution_graph/Context.h"
+#include "execution_graph/logic_controllers/taskflow/graph.h"
+#include "execution_graph/logic_controllers/taskflow/executor.h"
+#include "execution_graph/logic_controllers/BatchUnionProcessing.h"
+#include "utilities/CommonOperations.h"
+
+using blazingdb::transport::Node;
+using ral::cache::kstatus;
+using ral::cache::CacheMachine;
+using ral::frame::BlazingTable;
+using ral::frame::BlazingTableView;
+using Context = blazingdb::manager::Context;
+
+/**
+ * Unit Tests for the DistinctKernel
+ * The pieces of its buckets are limited by MAX_DISTINCT_STATE_PIECE_BYTE_SIZE to a few rows, so every
+ * bucket holds its distinct rows in several pieces.
+ */
+struct DistinctTest : public ::testing::Test {
+	virtual void SetUp() override {
+		BlazingRMMInitialize("pool_memory_resource", 32*1024*1024, 256*1024*1024);
+		float host_memory_quota=0.75; //default value
+		blazing_host_memory_resource::getInstance().initialize(host_memory_quota);
+		ral::memory::set_allocation_pools(4000000, 10,
+										4000000, 10, false,nullptr);
+		int executor_threads = 10;
+		ral::execution::executor::init_executor(executor_threads, 0.8);
+	}
+
+	virtual void TearDown() override {
+		ral::memory::empty_pools();
+		BlazingRMMFinalize();
+	}
+};
+
+namespace {
+
+// a row as (key is valid, key, value), the NULL keys are stored as 0 so they are all equal and sort first
+using row = std::tuple<bool, int64_t, int32_t>;
+
+// a batch of num_rows rows with a NULL or one of 60 keys and one of 2 values, most of them repeated in the
+// batch and in the other batches
+std::unique_ptr<BlazingTable> make_batch(int batch_id, int num_rows, std::set<row> & distinct_rows) {
+	std::vector<int64_t> keys(num_rows);
+	std::vector<bool> valids(num_rows);
+	std::vector<int32_t> values(num_rows);
+	for (int i = 0; i < num_rows; i++) {
+		valids[i] = (i + batch_id) % 11 != 0;
+		keys[i] = valids[i] ? (i * 7 + batch_id * 13) % 60 : 0;
+		values[i] = i % 2;
+		distinct_rows.insert(row{valids[i], keys[i], values[i]});
+	}
+	cudf::test::fixed_width_column_wrapper<int64_t> key_column(keys.begin(), keys.end(), valids.begin());
+	cudf::test::fixed_width_column_wrapper<int32_t> value_column(values.begin(), values.end());
+	auto table = std::make_unique<cudf::table>(cudf::table_view{{key_column, value_column}});
+	return std::make_unique<BlazingTable>(std::move(table), std::vector<std::string>{"key", "value"});
+}
+
+} // namespace
+
+TEST_F(DistinctTest, duplicates_across_batches_and_buckets) {
+	std::map<std::string, std::string> config_options;
+	config_options["MAX_DISTINCT_STATE_PIECE_BYTE_SIZE"] = "200";
+	std::vector<Node> nodes;
+	Node master_node;
+	std::shared_ptr<Context> context = std::make_shared<Context>(0, nodes, master_node, "", config_options);
+
+	std::size_t kernel_id = 1;
+	std::shared_ptr<ral::cache::graph> graph = std::make_shared<ral::cache::graph>();
+	std::shared_ptr<ral::batch::DistinctKernel> distinct_kernel = std::make_shared<ral::batch::DistinctKernel>(
+		kernel_id, "LogicalUnion(all=[false])", context, graph);
+	graph->add_node(distinct_kernel);
+
+	auto input_cache = std::make_shared<CacheMachine>(context, "");
+	auto output_cache = std::make_shared<CacheMachine>(context, "");
+	distinct_kernel->input_.register_cache(std::to_string(kernel_id), input_cache);
+	distinct_kernel->output_.register_cache(std::to_string(kernel_id), output_cache);
+
+	std::set<row> distinct_rows;
+	for (int batch_id = 0; batch_id < 8; batch_id++) {
+		input_cache->addToCache(make_batch(batch_id, 300, distinct_rows));
+	}
+	// a batch with the same rows as the first one adds no new row
+	input_cache->addToCache(make_batch(0, 300, distinct_rows));
+	input_cache->finish();
+
+	EXPECT_EQ(kstatus::proceed, distinct_kernel->run());
+	output_cache->finish();
+
+	std::vector<std::unique_ptr<BlazingTable>> results;
+	std::vector<BlazingTableView> result_views;
+	for (auto & cache_data : output_cache->pull_all_cache_data()) {
+		results.push_back(cache_data->decache());
+		result_views.push_back(results.back()->toBlazingTableView());
+	}
+	ASSERT_FALSE(results.empty());
+	auto result = ral::utilities::concatTables(result_views);
+	EXPECT_EQ(result->names(), std::vector<std::string>({"key", "value"}));
+
+	std::vector<int64_t> expected_keys;
+	std::vector<bool> expected_valids;
+	std::vector<int32_t> expected_values;
+	for (auto & distinct_row : distinct_rows) {
+		expected_valids.push_back(std::get<0>(distinct_row));
+		expected_keys.push_back(std::get<1>(distinct_row));
+		expected_values.push_back(std::get<2>(distinct_row));
+	}
+	cudf::test::fixed_width_column_wrapper<int64_t> expected_key_column(expected_keys.begin(), expected_keys.end(), expected_valids.begin());
+	cudf::test::fixed_width_column_wrapper<int32_t> expected_value_column(expected_values.begin(), expected_values.end());
+
+	// every distinct row once, NULL keys included, sorted with the NULLs first
+	ASSERT_EQ(result->num_rows(), distinct_rows.size());
+	cudf::test::expect_tables_equivalent(cudf::table_view{{expected_key_column, expected_value_column}},
+		cudf::sort(result->view())->view());
+}
@@ -0,0 +1,124 @@
+#include "tests/utilities/BlazingUnitTest.h"
+
+#include <cudf/join.hpp>
+#include <cudf/sorting.hpp>
+
+#include "cudf_test/column_wrapper.hpp"
+#include "cudf_test/table_utilities.hpp"
+
+#include "execution_graph/Context.h"
+#include "execution_graph/logic_controllers/taskflow/graph.h"
+#include "execution_graph/logic_controllers/taskflow/executor.h"
+#include "execution_graph/logic_controllers/BatchJoinProcessing.h"
+#include "utilities/CommonOperations.h"
+
+using blazingdb::transport::Node;
+using ral::cache::kstatus;
+using ral::cache::CacheMachine;
+using ral::frame::BlazingTable;
+using ral::frame::BlazingTableView;
+using Context = blazingdb::manager::Context;
+
+/**
+ * Unit Tests for the partitioned join of the PartwiseJoin kernel
+ * Both inputs are bigger than NUM_BYTES_PER_JOIN_BUCKET, so the kernel hash partitions
+ * every set of both sides into buckets and joins the buckets pairwise.
+ */
+struct PartitionedJoinTest : public ::testing::Test {
+	virtual void SetUp() override {
+		BlazingRMMInitialize("pool_memory_resource", 32*1024*1024, 256*1024*1024);
+		float host_memory_quota=0.75; //default value
+		blazing_host_memory_resource::getInstance().initialize(host_memory_quota);
+		ral::memory::set_allocation_pools(4000000, 10,
+										4000000, 10, false,nullptr);
+		int executor_threads = 10;
+		ral::execution::executor::init_executor(executor_threads, 0.8);
+	}
+
+	virtual void TearDown() override {
+		ral::memory::empty_pools();
+		BlazingRMMFinalize();
+	}
+};
+
+namespace {
+
+// a table of num_rows rows with keys first_key, first_key + 1, ... modulo num_keys and a payload column
+std::unique_ptr<BlazingTable> make_batch(int64_t first_key, int64_t num_rows, int64_t num_keys, const std::string & prefix) {
+	std::vector<int64_t> keys(num_rows);
+	std::vector<int64_t> payload(num_rows);
+	for (int64_t i = 0; i < num_rows; i++) {
+		keys[i] = (first_key + i) % num_keys;
+		payload[i] = first_key + i;
+	}
+	cudf::test::fixed_width_column_wrapper<int64_t> key_column(keys.begin(), keys.end());
+	cudf::test::fixed_width_column_wrapper<int64_t> payload_column(payload.begin(), payload.end());
+	auto table = std::make_unique<cudf::table>(cudf::table_view{{key_column, payload_column}});
+	return std::make_unique<BlazingTable>(std::move(table), std::vector<std::string>{prefix + "_key", prefix + "_payload"});
+}
+
+std::unique_ptr<cudf::table> concat_batches(const std::vector<std::unique_ptr<BlazingTable>> & batches) {
+	std::vector<BlazingTableView> views;
+	for (auto & batch : batches) {
+		views.push_back(batch->toBlazingTableView());
+	}
+	return ral::utilities::concatTables(views)->releaseCudfTable();
+}
+
+} // namespace
+
+TEST_F(PartitionedJoinTest, joins_every_bucket_pair_once) {
+	std::map<std::string, std::string> config_options;
+	config_options["NUM_BYTES_PER_JOIN_BUCKET"] = "4000";
+	config_options["RUNTIME_JOIN_FILTER_MAX_BUILD_BYTES"] = "0";
+	std::vector<Node> nodes;
+	Node master_node;
+	std::shared_ptr<Context> context = std::make_shared<Context>(0, nodes, master_node, "", config_options);
+
+	std::size_t kernel_id = 1;
+	std::shared_ptr<ral::cache::graph> graph = std::make_shared<ral::cache::graph>();
+	std::shared_ptr<ral::batch::PartwiseJoin> join_kernel = std::make_shared<ral::batch::PartwiseJoin>(
+		kernel_id, "LogicalJoin(condition=[=($0, $2)], joinType=[inner])", context, graph);
+	graph->add_node(join_kernel);
+
+	auto left_cache = std::make_shared<CacheMachine>(context, "");
+	auto right_cache = std::make_shared<CacheMachine>(context, "");
+	auto output_cache = std::make_shared<CacheMachine>(context, "");
+	join_kernel->input_.register_cache("input_a", left_cache);
+	join_kernel->input_.register_cache("input_b", right_cache);
+	join_kernel->output_.register_cache(std::to_string(kernel_id), output_cache);
+
+	// 1000 left rows over 50 keys against 200 right rows with keys 0 to 199, every left row matches one right row
+	std::vector<std::unique_ptr<BlazingTable>> left_batches, right_batches;
+	for (int64_t batch = 0; batch < 4; batch++) {
+		left_batches.push_back(make_batch(batch * 250, 250, 50, "l"));
+		left_cache->addToCache(make_batch(batch * 250, 250, 50, "l"));
+	}
+	for (int64_t batch = 0; batch < 2; batch++) {
+		right_batches.push_back(make_batch(batch * 100, 100, 200, "r"));
+		right_cache->addToCache(make_batch(batch * 100, 100, 200, "r"));
+	}
+	// the inputs are finished, so the kernel knows the size of both sides up front
+	left_cache->finish();
+	right_cache->finish();
+
+	EXPECT_EQ(kstatus::proceed, join_kernel->run());
+	output_cache->finish();
+
+	auto left = concat_batches(left_batches);
+	auto right = concat_batches(right_batches);
+	std::vector<std::pair<cudf::size_type, cudf::size_type>> columns_in_common;
+	auto expected = cudf::inner_join(left->view(), right->view(), {0}, {0}, columns_in_common);
+	ASSERT_EQ(expected->num_rows(), 1000);
+
+	std::vector<std::unique_ptr<BlazingTable>> results;
+	for (auto & cache_data : output_cache->pull_all_cache_data()) {
+		results.push_back(cache_data->decache());
+	}
+	ASSERT_FALSE(results.empty());
+	EXPECT_EQ(results[0]->names(), std::vector<std::string>({"l_key", "l_payload", "r_key", "r_payload"}));
+	auto result = concat_batches(results);
+
+	// a bucket pair joined twice, or a partition added twice to its bucket, would duplicate rows
+	cudf::test::expect_tables_equal(cudf::sort(expected->view())->view(), cudf::sort(result->view())->view());
+}
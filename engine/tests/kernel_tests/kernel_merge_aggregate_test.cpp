@@ -0,0 +1,120 @@
+#include "tests/utilities/BlazingUnitTest.h"
+
+#include <numeric>
+
+#include <cudf/sorting.hpp>
+
+#include "cudf_test/column_wrapper.hpp"
+#include "cudf_test/table_utilities.hpp"
+
+#include "execution_graph/Context.h"
+#include "execution_graph/logic_controllers/taskflow/graph.h"
+#include "execution_graph/logic_controllers/taskflow/executor.h"
+#include "execution_graph/logic_controllers/BatchAggregationProcessing.h"
+#include "utilities/CommonOperations.h"
+
+using blazingdb::transport::Node;
+using ral::cache::kstatus;
+using ral::cache::CacheMachine;
+using ral::frame::BlazingTable;
+using ral::frame::BlazingTableView;
+using Context = blazingdb::manager::Context;
+
+/**
+ * Unit Tests for the MergeAggregateKernel
+ * The input partials are the output of ComputeAggregateKernel for
+ * LogicalAggregate(group=[{0}], C=[COUNT($1)]), so their COUNT column is INT32, while the counts
+ * merged into the running state are summed into INT64.
+ */
+struct MergeAggregateTest : public ::testing::Test {
+	virtual void SetUp() override {
+		BlazingRMMInitialize("pool_memory_resource", 32*1024*1024, 256*1024*1024);
+		float host_memory_quota=0.75; //default value
+		blazing_host_memory_resource::getInstance().initialize(host_memory_quota);
+		ral::memory::set_allocation_pools(4000000, 10,
+										4000000, 10, false,nullptr);
+		int executor_threads = 10;
+		ral::execution::executor::init_executor(executor_threads, 0.8);
+	}
+
+	virtual void TearDown() override {
+		ral::memory::empty_pools();
+		BlazingRMMFinalize();
+	}
+};
+
+namespace {
+
+// a partial aggregate where each of the keys 0 to num_keys - 1 was counted once
+std::unique_ptr<BlazingTable> make_partial(int64_t num_keys) {
+	std::vector<int64_t> keys(num_keys);
+	std::vector<int32_t> counts(num_keys, 1);
+	std::iota(keys.begin(), keys.end(), 0);
+	cudf::test::fixed_width_column_wrapper<int64_t> key_column(keys.begin(), keys.end());
+	cudf::test::fixed_width_column_wrapper<int32_t> count_column(counts.begin(), counts.end());
+	auto table = std::make_unique<cudf::table>(cudf::table_view{{key_column, count_column}});
+	return std::make_unique<BlazingTable>(std::move(table), std::vector<std::string>{"key", "C"});
+}
+
+// runs the kernel over num_partials partials and returns its output sorted by key
+std::unique_ptr<cudf::table> merge(int num_partials, int64_t num_keys, const std::string & max_state_byte_size) {
+	std::map<std::string, std::string> config_options;
+	config_options["MAX_AGGREGATE_MERGE_STATE_BYTE_SIZE"] = max_state_byte_size;
+	std::vector<Node> nodes;
+	Node master_node;
+	std::shared_ptr<Context> context = std::make_shared<Context>(0, nodes, master_node, "", config_options);
+
+	std::size_t kernel_id = 1;
+	std::shared_ptr<ral::cache::graph> graph = std::make_shared<ral::cache::graph>();
+	std::shared_ptr<ral::batch::MergeAggregateKernel> merge_kernel = std::make_shared<ral::batch::MergeAggregateKernel>(
+		kernel_id, "LogicalAggregate(group=[{0}], C=[COUNT($1)])", context, graph);
+	graph->add_node(merge_kernel);
+
+	auto input_cache = std::make_shared<CacheMachine>(context, "");
+	auto output_cache = std::make_shared<CacheMachine>(context, "");
+	merge_kernel->input_.register_cache(std::to_string(kernel_id), input_cache);
+	merge_kernel->output_.register_cache(std::to_string(kernel_id), output_cache);
+
+	for (int i = 0; i < num_partials; i++) {
+		input_cache->addToCache(make_partial(num_keys));
+	}
+	input_cache->finish();
+
+	EXPECT_EQ(kstatus::proceed, merge_kernel->run());
+	output_cache->finish();
+
+	std::vector<std::unique_ptr<BlazingTable>> results;
+	for (auto & cache_data : output_cache->pull_all_cache_data()) {
+		results.push_back(cache_data->decache());
+	}
+	std::vector<BlazingTableView> views;
+	for (auto & result : results) {
+		views.push_back(result->toBlazingTableView());
+	}
+	return cudf::sort(ral::utilities::concatTables(views)->view());
+}
+
+std::unique_ptr<cudf::table> expected_counts(int64_t num_keys, int64_t count) {
+	std::vector<int64_t> keys(num_keys);
+	std::vector<int64_t> counts(num_keys, count);
+	std::iota(keys.begin(), keys.end(), 0);
+	cudf::test::fixed_width_column_wrapper<int64_t> key_column(keys.begin(), keys.end());
+	cudf::test::fixed_width_column_wrapper<int64_t> count_column(counts.begin(), counts.end());
+	return std::make_unique<cudf::table>(cudf::table_view{{key_column, count_column}});
+}
+
+} // namespace
+
+TEST_F(MergeAggregateTest, merges_int32_partial_counts_into_the_int64_state) {
+	// the partials take 120 bytes, so every 9 of them are merged into a 160 bytes state, which fits in half the budget
+	auto result = merge(30, 10, "1000");
+
+	cudf::test::expect_tables_equal(expected_counts(10, 30)->view(), result->view());
+}
+
+TEST_F(MergeAggregateTest, merges_the_spill_partitions_once_the_state_is_too_big) {
+	// the first partial is already over the budget, its state does not fit in half of it and is partitioned
+	auto result = merge(5, 100, "1000");
+
+	cudf::test::expect_tables_equal(expected_counts(100, 5)->view(), result->view());
+}
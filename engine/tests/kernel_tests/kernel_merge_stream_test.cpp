@@ -0,0 +1,119 @@
+#include "tests/utilities/BlazingUnitTest.h"
+
+#include <algorithm>
+
+#include <cudf/sorting.hpp>
+
+#include "cudf_test/column_wrapper.hpp"
+#include "cudf_test/table_utilities.hpp"
+
+#include "execution_graph/Context.h"
+#include "execution_graph/logic_controllers/taskflow/graph.h"
+#include "execution_graph/logic_controllers/taskflow/executor.h"
+#include "execution_graph/logic_controllers/BatchOrderByProcessing.h"
+#include "utilities/CommonOperations.h"
+
+using blazingdb::transport::Node;
+using ral::cache::kstatus;
+using ral::cache::CacheMachine;
+using ral::frame::BlazingTable;
+using ral::frame::BlazingTableView;
+using Context = blazingdb::manager::Context;
+
+/**
+ * Unit Tests for the streamed merge of the MergeStreamKernel
+ * The sorted runs of the partition take more than MAX_MERGE_STREAM_BYTE_SIZE, so they are merged
+ * window by window and every merged window is output as soon as the windows before it are.
+ */
+struct MergeStreamTest : public ::testing::Test {
+	virtual void SetUp() override {
+		BlazingRMMInitialize("pool_memory_resource", 32*1024*1024, 256*1024*1024);
+		float host_memory_quota=0.75; //default value
+		blazing_host_memory_resource::getInstance().initialize(host_memory_quota);
+		ral::memory::set_allocation_pools(4000000, 10,
+										4000000, 10, false,nullptr);
+		int executor_threads = 10;
+		ral::execution::executor::init_executor(executor_threads, 0.8);
+	}
+
+	virtual void TearDown() override {
+		ral::memory::empty_pools();
+		BlazingRMMFinalize();
+	}
+};
+
+namespace {
+
+// a sorted run of num_rows keys first_key, first_key + step, ... where every row has a payload unique to the run
+std::unique_ptr<BlazingTable> make_run(int64_t run_id, int64_t num_rows, int64_t first_key, int64_t step) {
+	std::vector<int64_t> keys(num_rows);
+	std::vector<int64_t> payload(num_rows);
+	for (int64_t i = 0; i < num_rows; i++) {
+		keys[i] = first_key + i * step;
+		payload[i] = run_id * 1000000 + i;
+	}
+	cudf::test::fixed_width_column_wrapper<int64_t> key_column(keys.begin(), keys.end());
+	cudf::test::fixed_width_column_wrapper<int64_t> payload_column(payload.begin(), payload.end());
+	auto table = std::make_unique<cudf::table>(cudf::table_view{{key_column, payload_column}});
+	return std::make_unique<BlazingTable>(std::move(table), std::vector<std::string>{"key", "payload"});
+}
+
+std::unique_ptr<cudf::table> concat_batches(const std::vector<std::unique_ptr<BlazingTable>> & batches) {
+	std::vector<BlazingTableView> views;
+	for (auto & batch : batches) {
+		views.push_back(batch->toBlazingTableView());
+	}
+	return ral::utilities::concatTables(views)->releaseCudfTable();
+}
+
+} // namespace
+
+TEST_F(MergeStreamTest, streamed_merge_is_ordered_and_complete) {
+	std::map<std::string, std::string> config_options;
+	config_options["MAX_MERGE_STREAM_BYTE_SIZE"] = "1000";
+	std::vector<Node> nodes;
+	Node master_node;
+	std::shared_ptr<Context> context = std::make_shared<Context>(0, nodes, master_node, "", config_options);
+
+	std::size_t kernel_id = 1;
+	std::shared_ptr<ral::cache::graph> graph = std::make_shared<ral::cache::graph>();
+	std::shared_ptr<ral::batch::MergeStreamKernel> merge_kernel = std::make_shared<ral::batch::MergeStreamKernel>(
+		kernel_id, "LogicalMerge(sort0=[$0], dir0=[ASC])", context, graph);
+	graph->add_node(merge_kernel);
+
+	auto input_cache = std::make_shared<CacheMachine>(context, "");
+	auto output_cache = std::make_shared<CacheMachine>(context, "");
+	merge_kernel->input_.register_cache("input_0", input_cache);
+	merge_kernel->output_.register_cache(std::to_string(kernel_id), output_cache);
+
+	// the windows take at least 1024 rows of every run: the even and odd keys overlap all along, the long run
+	// spans all of them in many windows, and the short run repeats keys of the others
+	std::vector<std::unique_ptr<BlazingTable>> runs;
+	runs.push_back(make_run(0, 3000, 0, 2));
+	runs.push_back(make_run(1, 2500, 1, 2));
+	runs.push_back(make_run(2, 12000, 0, 1));
+	runs.push_back(make_run(3, 10, 100, 0));
+	for (auto & run : runs) {
+		input_cache->addToCache(run->toBlazingTableView().clone());
+	}
+	input_cache->finish();
+
+	EXPECT_EQ(kstatus::proceed, merge_kernel->run());
+	output_cache->finish();
+
+	std::vector<std::unique_ptr<BlazingTable>> results;
+	for (auto & cache_data : output_cache->pull_all_cache_data()) {
+		results.push_back(cache_data->decache());
+	}
+	ASSERT_GT(results.size(), 1);
+	auto result = concat_batches(results);
+	auto expected = concat_batches(runs);
+	ASSERT_EQ(result->num_rows(), expected->num_rows());
+
+	// the batches are output in order, so their keys never go down
+	std::vector<int64_t> keys = ral::utilities::column_to_vector<int64_t>(result->get_column(0).view());
+	EXPECT_TRUE(std::is_sorted(keys.begin(), keys.end()));
+
+	// and no row is lost or output twice
+	cudf::test::expect_tables_equal(cudf::sort(expected->view())->view(), cudf::sort(result->view())->view());
+}
@@ -172,6 +172,126 @@ std::shared_ptr<Context> make_single_context(std::string logicalPlan) {
 	return context;
 }
 
+TEST_F(PhysicalPlanGeneratorTest, union_distinct_single_node)
+{
+	//	Query
+	//	select n_nationkey from nation union select r_regionkey from region
+
+	std::string logicalPlan =
+	R"raw(
+	{
+		"expr": "LogicalUnion(all=[false])",
+		"children": [
+			{
+				"expr": "BindableTableScan(table=[[main, nation]], projects=[[0]], aliases=[[n_nationkey]])",
+				"children": []
+			},
+			{
+				"expr": "BindableTableScan(table=[[main, region]], projects=[[0]], aliases=[[r_regionkey]])",
+				"children": []
+			}
+		]
+	}
+	)raw";
+
+	std::shared_ptr<Context> context = make_single_context(logicalPlan);
+	ral::batch::tree_processor tree{{}, context->clone(), {}, {}, {}, {}, true};
+
+	std::istringstream input(logicalPlan);
+	boost::property_tree::ptree p_tree;
+	boost::property_tree::read_json(input, p_tree);
+	tree.transform_json_tree(p_tree);
+
+	std::string jsonCompare =
+	R"raw(
+	{
+		"expr": "LogicalDistinct(group=[{*}])",
+		"children": [
+			{
+				"expr": "LogicalUnion(all=[true])",
+				"children": [
+					{
+						"expr": "BindableTableScan(table=[[main, nation]], projects=[[0]], aliases=[[n_nationkey]])",
+						"children": []
+					},
+					{
+						"expr": "BindableTableScan(table=[[main, region]], projects=[[0]], aliases=[[r_regionkey]])",
+						"children": []
+					}
+				]
+			}
+		]
+	}
+	)raw";
+
+	std::istringstream inputcmp(jsonCompare);
+	boost::property_tree::ptree p_tree_cmp;
+	boost::property_tree::read_json(inputcmp, p_tree_cmp);
+
+	ASSERT_EQ(p_tree, p_tree_cmp);
+}
+
+TEST_F(PhysicalPlanGeneratorTest, union_distinct_distributed)
+{
+	std::string logicalPlan =
+	R"raw(
+	{
+		"expr": "LogicalUnion(all=[false])",
+		"children": [
+			{
+				"expr": "BindableTableScan(table=[[main, nation]], projects=[[0]], aliases=[[n_nationkey]])",
+				"children": []
+			},
+			{
+				"expr": "BindableTableScan(table=[[main, region]], projects=[[0]], aliases=[[r_regionkey]])",
+				"children": []
+			}
+		]
+	}
+	)raw";
+
+	Context context(0, {}, {}, logicalPlan, {});
+	ral::batch::tree_processor tree{{}, context.clone(), {}, {}, {}, {}, true};
+
+	std::istringstream input(logicalPlan);
+	boost::property_tree::ptree p_tree;
+	boost::property_tree::read_json(input, p_tree);
+	tree.transform_json_tree(p_tree);
+
+	std::string jsonCompare =
+	R"raw(
+	{
+		"expr": "LogicalDistinct(group=[{*}])",
+		"children": [
+			{
+				"expr": "DistinctPartition(group=[{*}])",
+				"children": [
+					{
+						"expr": "LogicalUnion(all=[true])",
+						"children": [
+							{
+								"expr": "BindableTableScan(table=[[main, nation]], projects=[[0]], aliases=[[n_nationkey]])",
+								"children": []
+							},
+							{
+								"expr": "BindableTableScan(table=[[main, region]], projects=[[0]], aliases=[[r_regionkey]])",
+								"children": []
+							}
+						]
+					}
+				]
+			}
+		]
+	}
+	)raw";
+
+	std::istringstream inputcmp(jsonCompare);
+	boost::property_tree::ptree p_tree_cmp;
+	boost::property_tree::read_json(inputcmp, p_tree_cmp);
+
+	ASSERT_EQ(p_tree, p_tree_cmp);
+}
+
 // All test using `wf_` are related to window functions
 TEST_F(PhysicalPlanGeneratorTest, wf_one_patition_by_single_node)
 {
@@ -212,21 +332,11 @@ TEST_F(PhysicalPlanGeneratorTest, wf_one_patition_by_single_node)
 				"expr": "LogicalComputeWindow(product_name=[$1], min_ids=[MIN($0) OVER (PARTITION BY $1)])",
 				"children": [
 					{
-						"expr": "LogicalMerge(product_name=[$1], min_ids=[MIN($0) OVER (PARTITION BY $1)])",
+						"expr": "LogicalWindowSort(product_name=[$1], min_ids=[MIN($0) OVER (PARTITION BY $1)])",
 						"children": [
 							{
-								"expr": "LogicalSingleNodePartition(product_name=[$1], min_ids=[MIN($0) OVER (PARTITION BY $1)])",
-								"children": [
-									{
-										"expr" : "Logical_SortAndSample(product_name=[$1], min_ids=[MIN($0) OVER (PARTITION BY $1)])",
-										"children" : [
-											{
-												"expr" : "BindableTableScan(table=[[main, product]], projects=[[0, 1]], aliases=[[min_ids, id_client, product_name]])",
-												"children" : []
-											}
-										]
-									}
-								]
+								"expr" : "BindableTableScan(table=[[main, product]], projects=[[0, 1]], aliases=[[min_ids, id_client, product_name]])",
+								"children" : []
 							}
 						]
 					}
@@ -282,21 +392,11 @@ TEST_F(PhysicalPlanGeneratorTest, wf_multiple_patition_by_single_node)
 				"expr": "LogicalComputeWindow(product_name=[$1], min_ids=[MIN($0) OVER (PARTITION BY $1, $2)])",
 				"children": [
 					{
-						"expr": "LogicalMerge(product_name=[$1], min_ids=[MIN($0) OVER (PARTITION BY $1, $2)])",
+						"expr": "LogicalWindowSort(product_name=[$1], min_ids=[MIN($0) OVER (PARTITION BY $1, $2)])",
 						"children": [
 							{
-								"expr": "LogicalSingleNodePartition(product_name=[$1], min_ids=[MIN($0) OVER (PARTITION BY $1, $2)])",
-								"children": [
-									{
-										"expr" : "Logical_SortAndSample(product_name=[$1], min_ids=[MIN($0) OVER (PARTITION BY $1, $2)])",
-										"children" : [
-											{
-												"expr" : "BindableTableScan(table=[[main, product]], projects=[[0, 1, 2]], aliases=[[min_ids, id_client, product_name, product_region]])",
-												"children" : []
-											}
-										]
-									}
-								]
+								"expr" : "BindableTableScan(table=[[main, product]], projects=[[0, 1, 2]], aliases=[[min_ids, id_client, product_name, product_region]])",
+								"children" : []
 							}
 						]
 					}
@@ -352,21 +452,11 @@ TEST_F(PhysicalPlanGeneratorTest, wf_one_patition_by_one_order_by_single_node)
 				"expr": "LogicalComputeWindow(product_name=[$1], max_ids=[MAX($0) OVER (PARTITION BY $1 ORDER BY $2)])",
 				"children": [
 					{
-						"expr": "LogicalMerge(product_name=[$1], max_ids=[MAX($0) OVER (PARTITION BY $1 ORDER BY $2)])",
+						"expr": "LogicalWindowSort(product_name=[$1], max_ids=[MAX($0) OVER (PARTITION BY $1 ORDER BY $2)])",
 						"children": [
 							{
-								"expr": "LogicalSingleNodePartition(product_name=[$1], max_ids=[MAX($0) OVER (PARTITION BY $1 ORDER BY $2)])",
-								"children": [
-									{
-										"expr" : "Logical_SortAndSample(product_name=[$1], max_ids=[MAX($0) OVER (PARTITION BY $1 ORDER BY $2)])",
-										"children" : [
-											{
-												"expr" : "BindableTableScan(table=[[main, product]], projects=[[0, 1, 2]], aliases=[[max_ids, id_client, product_name, product_region]])",
-												"children" : []
-											}
-										]
-									}
-								]
+								"expr" : "BindableTableScan(table=[[main, product]], projects=[[0, 1, 2]], aliases=[[max_ids, id_client, product_name, product_region]])",
+								"children" : []
 							}
 						]
 					}
@@ -422,21 +512,11 @@ TEST_F(PhysicalPlanGeneratorTest, wf_multiple_patition_by_multiple_order_by_sing
 				"expr": "LogicalComputeWindow(product_name=[$1], max_ids=[MAX($0) OVER (PARTITION BY $1, $2 ORDER BY $3, $4 DESC)])",
 				"children": [
 					{
-						"expr": "LogicalMerge(product_name=[$1], max_ids=[MAX($0) OVER (PARTITION BY $1, $2 ORDER BY $3, $4 DESC)])",
+						"expr": "LogicalWindowSort(product_name=[$1], max_ids=[MAX($0) OVER (PARTITION BY $1, $2 ORDER BY $3, $4 DESC)])",
 						"children": [
 							{
-								"expr": "LogicalSingleNodePartition(product_name=[$1], max_ids=[MAX($0) OVER (PARTITION BY $1, $2 ORDER BY $3, $4 DESC)])",
-								"children": [
-									{
-										"expr" : "Logical_SortAndSample(product_name=[$1], max_ids=[MAX($0) OVER (PARTITION BY $1, $2 ORDER BY $3, $4 DESC)])",
-										"children" : [
-											{
-												"expr" : "BindableTableScan(table=[[main, product]], projects=[[0, 1, 2, 3, 4]], aliases=[[max_ids, id_client, product_name, product_region, product_country, product_price]])",
-												"children" : []
-											}
-										]
-									}
-								]
+								"expr" : "BindableTableScan(table=[[main, product]], projects=[[0, 1, 2, 3, 4]], aliases=[[max_ids, id_client, product_name, product_region, product_country, product_price]])",
+								"children" : []
 							}
 						]
 					}
@@ -494,21 +574,11 @@ TEST_F(PhysicalPlanGeneratorTest, wf_multiple_equal_over_clauses_single_node)
 				"expr": "LogicalComputeWindow(min_keys=[MIN($0) OVER (PARTITION BY $2 ORDER BY $1)], max_keys=[MAX($0) OVER (PARTITION BY $2 ORDER BY $1)])",
 				"children": [
 					{
-						"expr": "LogicalMerge(min_keys=[MIN($0) OVER (PARTITION BY $2 ORDER BY $1)], max_keys=[MAX($0) OVER (PARTITION BY $2 ORDER BY $1)])",
+						"expr": "LogicalWindowSort(min_keys=[MIN($0) OVER (PARTITION BY $2 ORDER BY $1)], max_keys=[MAX($0) OVER (PARTITION BY $2 ORDER BY $1)])",
 						"children": [
 							{
-								"expr": "LogicalSingleNodePartition(min_keys=[MIN($0) OVER (PARTITION BY $2 ORDER BY $1)], max_keys=[MAX($0) OVER (PARTITION BY $2 ORDER BY $1)])",
-								"children": [
-									{
-										"expr": "Logical_SortAndSample(min_keys=[MIN($0) OVER (PARTITION BY $2 ORDER BY $1)], max_keys=[MAX($0) OVER (PARTITION BY $2 ORDER BY $1)])",
-										"children": [
-											{
-												"expr": "BindableTableScan(table=[[main, nation]])",
-												"children": []
-											}
-										]
-									}
-								]
+								"expr": "BindableTableScan(table=[[main, nation]])",
+								"children": []
 							}
 						]
 					}
@@ -566,19 +636,14 @@ TEST_F(PhysicalPlanGeneratorTest, wf_multiple_equal_over_clauses_distributed)
 				"expr": "LogicalComputeWindow(min_keys=[MIN($0) OVER (PARTITION BY $2 ORDER BY $1)], max_keys=[MAX($0) OVER (PARTITION BY $2 ORDER BY $1)])",
 				"children": [
 					{
-						"expr": "LogicalMerge(min_keys=[MIN($0) OVER (PARTITION BY $2 ORDER BY $1)], max_keys=[MAX($0) OVER (PARTITION BY $2 ORDER BY $1)])",
+						"expr": "LogicalWindowSort(min_keys=[MIN($0) OVER (PARTITION BY $2 ORDER BY $1)], max_keys=[MAX($0) OVER (PARTITION BY $2 ORDER BY $1)])",
 						"children": [
 							{
-								"expr": "LogicalPartition(min_keys=[MIN($0) OVER (PARTITION BY $2 ORDER BY $1)], max_keys=[MAX($0) OVER (PARTITION BY $2 ORDER BY $1)])",
+								"expr": "LogicalWindowPartition(min_keys=[MIN($0) OVER (PARTITION BY $2 ORDER BY $1)], max_keys=[MAX($0) OVER (PARTITION BY $2 ORDER BY $1)])",
 								"children": [
 									{
-										"expr": "Logical_SortAndSample(min_keys=[MIN($0) OVER (PARTITION BY $2 ORDER BY $1)], max_keys=[MAX($0) OVER (PARTITION BY $2 ORDER BY $1)])",
-										"children": [
-											{
-												"expr": "BindableTableScan(table=[[main, nation]])",
-												"children": []
-											}
-										]
+										"expr": "BindableTableScan(table=[[main, nation]])",
+										"children": []
 									}
 								]
 							}
@@ -632,6 +697,68 @@ TEST_F(PhysicalPlanGeneratorTest, wf_multiple_diff_over_clauses_single_node)
 	}
 }
 
+TEST_F(PhysicalPlanGeneratorTest, wf_same_partition_by_diff_order_by_single_node)
+{
+	//	Query
+	//	select min(n_nationkey) over (partition by n_regionkey order by n_name) min_keys,
+	//				lag(n_nationkey, 1) over (partition by n_regionkey order by n_nationkey desc) lag_keys,
+	//				n_name from nation
+	//
+	//	Optimized Plan
+	//	LogicalProject(min_keys=[MIN($0) OVER (PARTITION BY $2 ORDER BY $1)], lag_keys=[LAG($0, 1) OVER (PARTITION BY $2 ORDER BY $0 DESC)], n_name=[$1])
+	//			LogicalTableScan(table=[[main, nation]])
+
+	std::string logicalPlan =
+	R"raw(
+	{
+		"expr": "LogicalProject(min_keys=[MIN($0) OVER (PARTITION BY $2 ORDER BY $1)], lag_keys=[LAG($0, 1) OVER (PARTITION BY $2 ORDER BY $0 DESC)], n_name=[$1])",
+		"children": [
+			{
+				"expr": "BindableTableScan(table=[[main, nation]])",
+				"children": []
+			}
+		]
+	}
+	)raw";
+
+	std::shared_ptr<Context> context = make_single_context(logicalPlan);
+	ral::batch::tree_processor tree{{}, context->clone(), {}, {}, {}, {}, true};
+
+	std::istringstream input(logicalPlan);
+	boost::property_tree::ptree p_tree;
+	boost::property_tree::read_json(input, p_tree);
+	tree.transform_json_tree(p_tree);
+
+	std::string jsonCompare =
+	R"raw(
+	{
+		"expr": "LogicalProject(min_keys=[MIN($0) OVER (PARTITION BY $2 ORDER BY $1)], lag_keys=[LAG($0, 1) OVER (PARTITION BY $2 ORDER BY $0 DESC)], n_name=[$1])",
+		"children": [
+			{
+				"expr": "LogicalComputeWindow(min_keys=[MIN($0) OVER (PARTITION BY $2 ORDER BY $1)], lag_keys=[LAG($0, 1) OVER (PARTITION BY $2 ORDER BY $0 DESC)], n_name=[$1])",
+				"children": [
+					{
+						"expr": "LogicalWindowSort(min_keys=[MIN($0) OVER (PARTITION BY $2 ORDER BY $1)], lag_keys=[LAG($0, 1) OVER (PARTITION BY $2 ORDER BY $0 DESC)], n_name=[$1])",
+						"children": [
+							{
+								"expr": "BindableTableScan(table=[[main, nation]])",
+								"children": []
+							}
+						]
+					}
+				]
+			}
+		]
+	}
+	)raw";
+
+	std::istringstream inputcmp(jsonCompare);
+	boost::property_tree::ptree p_tree_cmp;
+	boost::property_tree::read_json(inputcmp, p_tree_cmp);
+
+	ASSERT_EQ(p_tree, p_tree_cmp);
+}
+
 TEST_F(PhysicalPlanGeneratorTest, wf_bounding_rows_single_node)
 {
 	//	Query
@@ -672,21 +799,11 @@ TEST_F(PhysicalPlanGeneratorTest, wf_bounding_rows_single_node)
 				"expr": "LogicalComputeWindow(min_val=[MIN($0) OVER (PARTITION BY $2 ORDER BY $1 ROWS BETWEEN 1 PRECEDING AND 1 FOLLOWING)], n_nationkey=[$0])",
 				"children": [
 					{
-						"expr": "LogicalMerge(min_val=[MIN($0) OVER (PARTITION BY $2 ORDER BY $1 ROWS BETWEEN 1 PRECEDING AND 1 FOLLOWING)], n_nationkey=[$0])",
+						"expr": "LogicalWindowSort(min_val=[MIN($0) OVER (PARTITION BY $2 ORDER BY $1 ROWS BETWEEN 1 PRECEDING AND 1 FOLLOWING)], n_nationkey=[$0])",
 						"children": [
 							{
-								"expr": "LogicalSingleNodePartition(min_val=[MIN($0) OVER (PARTITION BY $2 ORDER BY $1 ROWS BETWEEN 1 PRECEDING AND 1 FOLLOWING)], n_nationkey=[$0])",
-								"children": [
-									{
-										"expr": "Logical_SortAndSample(min_val=[MIN($0) OVER (PARTITION BY $2 ORDER BY $1 ROWS BETWEEN 1 PRECEDING AND 1 FOLLOWING)], n_nationkey=[$0])",
-										"children": [
-											{
-												"expr": "BindableTableScan(table=[[main, nation]], projects=[[0, 1, 2]], aliases=[[min_val, n_nationkey]])",
-												"children": []
-											}
-										]
-									}
-								]
+								"expr": "BindableTableScan(table=[[main, nation]], projects=[[0, 1, 2]], aliases=[[min_val, n_nationkey]])",
+								"children": []
 							}
 						]
 					}
@@ -743,19 +860,14 @@ TEST_F(PhysicalPlanGeneratorTest, wf_bounding_rows_distributed)
 				"expr": "LogicalComputeWindow(min_val=[MIN($0) OVER (PARTITION BY $2 ORDER BY $1 ROWS BETWEEN 1 PRECEDING AND 1 FOLLOWING)], n_nationkey=[$0])",
 				"children": [
 					{
-						"expr": "LogicalMerge(min_val=[MIN($0) OVER (PARTITION BY $2 ORDER BY $1 ROWS BETWEEN 1 PRECEDING AND 1 FOLLOWING)], n_nationkey=[$0])",
+						"expr": "LogicalWindowSort(min_val=[MIN($0) OVER (PARTITION BY $2 ORDER BY $1 ROWS BETWEEN 1 PRECEDING AND 1 FOLLOWING)], n_nationkey=[$0])",
 						"children": [
 							{
-								"expr": "LogicalPartition(min_val=[MIN($0) OVER (PARTITION BY $2 ORDER BY $1 ROWS BETWEEN 1 PRECEDING AND 1 FOLLOWING)], n_nationkey=[$0])",
+								"expr": "LogicalWindowPartition(min_val=[MIN($0) OVER (PARTITION BY $2 ORDER BY $1 ROWS BETWEEN 1 PRECEDING AND 1 FOLLOWING)], n_nationkey=[$0])",
 								"children": [
 									{
-										"expr": "Logical_SortAndSample(min_val=[MIN($0) OVER (PARTITION BY $2 ORDER BY $1 ROWS BETWEEN 1 PRECEDING AND 1 FOLLOWING)], n_nationkey=[$0])",
-										"children": [
-											{
-												"expr": "BindableTableScan(table=[[main, nation]], projects=[[0, 1, 2]], aliases=[[min_val, n_nationkey]])",
-												"children": []
-											}
-										]
+										"expr": "BindableTableScan(table=[[main, nation]], projects=[[0, 1, 2]], aliases=[[min_val, n_nationkey]])",
+										"children": []
 									}
 								]
 							}
@@ -813,19 +925,124 @@ TEST_F(PhysicalPlanGeneratorTest, wf_sum_agg_single_node)
 				"expr": "LogicalComputeWindow(sum_keys=[CASE(>(COUNT($0) OVER (PARTITION BY $0), 0), $SUM0($0) OVER (PARTITION BY $0), null:INTEGER)], n_name=[$1])",
 				"children": [
 					{
-						"expr": "LogicalMerge(sum_keys=[CASE(>(COUNT($0) OVER (PARTITION BY $0), 0), $SUM0($0) OVER (PARTITION BY $0), null:INTEGER)], n_name=[$1])",
+						"expr": "LogicalWindowSort(sum_keys=[CASE(>(COUNT($0) OVER (PARTITION BY $0), 0), $SUM0($0) OVER (PARTITION BY $0), null:INTEGER)], n_name=[$1])",
+						"children": [
+							{
+								"expr": "BindableTableScan(table=[[main, nation]], projects=[[0, 1]], aliases=[[sum_keys, n_name]])",
+								"children": []
+							}
+						]
+					}
+				]
+			}
+		]
+	}
+	)raw";
+
+	std::istringstream inputcmp(jsonCompare);
+	boost::property_tree::ptree p_tree_cmp;
+	boost::property_tree::read_json(inputcmp, p_tree_cmp);
+
+	ASSERT_EQ(p_tree, p_tree_cmp);
+}
+
+TEST_F(PhysicalPlanGeneratorTest, top_n_single_node)
+{
+	//	Query
+	//	select n_nationkey, n_name from nation order by n_name desc limit 10
+	//
+	//	Optimized Plan
+	//	LogicalSort(sort0=[$1], dir0=[DESC], fetch=[10])
+	//			BindableTableScan(table=[[main, nation]], projects=[[0, 1]], aliases=[[n_nationkey, n_name]])
+
+	std::string logicalPlan =
+	R"raw(
+	{
+		"expr": "LogicalSort(sort0=[$1], dir0=[DESC], fetch=[10])",
+		"children": [
+			{
+				"expr": "BindableTableScan(table=[[main, nation]], projects=[[0, 1]], aliases=[[n_nationkey, n_name]])",
+				"children": []
+			}
+		]
+	}
+	)raw";
+
+	std::shared_ptr<Context> context = make_single_context(logicalPlan);
+	ral::batch::tree_processor tree{{}, context->clone(), {}, {}, {}, {}, true};
+
+	std::istringstream input(logicalPlan);
+	boost::property_tree::ptree p_tree;
+	boost::property_tree::read_json(input, p_tree);
+	tree.transform_json_tree(p_tree);
+
+	std::string jsonCompare =
+	R"raw(
+	{
+		"expr": "LogicalTopN(sort0=[$1], dir0=[DESC], fetch=[10])",
+		"children": [
+			{
+				"expr": "BindableTableScan(table=[[main, nation]], projects=[[0, 1]], aliases=[[n_nationkey, n_name]])",
+				"children": []
+			}
+		]
+	}
+	)raw";
+
+	std::istringstream inputcmp(jsonCompare);
+	boost::property_tree::ptree p_tree_cmp;
+	boost::property_tree::read_json(inputcmp, p_tree_cmp);
+
+	ASSERT_EQ(p_tree, p_tree_cmp);
+}
+
+TEST_F(PhysicalPlanGeneratorTest, sort_with_limit_over_top_n_rows_single_node)
+{
+	//	Query
+	//	select n_nationkey, n_name from nation order by n_name limit 1000000
+	//
+	//	Optimized Plan
+	//	LogicalSort(sort0=[$1], dir0=[ASC], fetch=[1000000])
+	//			BindableTableScan(table=[[main, nation]], projects=[[0, 1]], aliases=[[n_nationkey, n_name]])
+
+	std::string logicalPlan =
+	R"raw(
+	{
+		"expr": "LogicalSort(sort0=[$1], dir0=[ASC], fetch=[1000000])",
+		"children": [
+			{
+				"expr": "BindableTableScan(table=[[main, nation]], projects=[[0, 1]], aliases=[[n_nationkey, n_name]])",
+				"children": []
+			}
+		]
+	}
+	)raw";
+
+	std::shared_ptr<Context> context = make_single_context(logicalPlan);
+	ral::batch::tree_processor tree{{}, context->clone(), {}, {}, {}, {}, true};
+
+	std::istringstream input(logicalPlan);
+	boost::property_tree::ptree p_tree;
+	boost::property_tree::read_json(input, p_tree);
+	tree.transform_json_tree(p_tree);
+
+	std::string jsonCompare =
+	R"raw(
+	{
+		"expr": "LogicalLimit(sort0=[$1], dir0=[ASC], fetch=[1000000])",
+		"children": [
+			{
+				"expr": "LogicalMerge(sort0=[$1], dir0=[ASC], fetch=[1000000])",
+				"children": [
+					{
+						"expr": "LogicalSingleNodePartition(sort0=[$1], dir0=[ASC], fetch=[1000000])",
 						"children": [
 							{
-								"expr": "LogicalSingleNodePartition(sum_keys=[CASE(>(COUNT($0) OVER (PARTITION BY $0), 0), $SUM0($0) OVER (PARTITION BY $0), null:INTEGER)], n_name=[$1])",
+								"expr": "Logical_SortAndSample(sort0=[$1], dir0=[ASC], fetch=[1000000])",
 								"children": [
 									{
-										"expr": "Logical_SortAndSample(sum_keys=[CASE(>(COUNT($0) OVER (PARTITION BY $0), 0), $SUM0($0) OVER (PARTITION BY $0), null:INTEGER)], n_name=[$1])",
-										"children": [
-											{
-												"expr": "BindableTableScan(table=[[main, nation]], projects=[[0, 1]], aliases=[[sum_keys, n_name]])",
-												"children": []
-											}
-										]
+										"expr": "BindableTableScan(table=[[main, nation]], projects=[[0, 1]], aliases=[[n_nationkey, n_name]])",
+										"children": []
 									}
 								]
 							}
@@ -1,8 +1,12 @@
 //#include "gtest/gtest.h"
 
+#include <map>
+
 #include <cudf/sorting.hpp>
 
 #include <operators/GroupBy.h>
+#include "execution_graph/logic_controllers/BatchAggregationProcessing.h"
+#include "utilities/CommonOperations.h"
 #include <cudf_test/column_wrapper.hpp>
 #include <cudf_test/base_fixture.hpp>
 #include <cudf_test/type_lists.hpp>
@@ -174,3 +178,129 @@ using T = TypeParam;
 	cudf::test::expect_tables_equivalent(result->view(), expect_table);										
 
 }
+
+TYPED_TEST(AggregationTest, PartialAggregationsPerRowMergeLikeGroupby) {
+
+ 	using T = TypeParam;
+
+	cudf::test::fixed_width_column_wrapper<T> key{{   5,  4,  3, 5, 8,  5, 6, 5}, {1, 1, 1, 1, 1, 1, 1, 0}};
+	cudf::test::fixed_width_column_wrapper<T> value{{10, 40, 70, 5, 2, 10, 11, 55}, {1, 1, 0, 1, 1, 1, 1, 0}};
+
+	std::vector<std::string> column_names{"A", "B"};
+	ral::frame::BlazingTableView table(CudfTableView{{key, value}}, column_names);
+
+	std::vector<AggregateKind> aggregation_types{AggregateKind::SUM, AggregateKind::COUNT_VALID,
+				AggregateKind::MIN, AggregateKind::MAX, AggregateKind::COUNT_ALL, AggregateKind::SUM0};
+
+	std::vector<std::string> aggregation_input_expressions{"$1", "$1", "$1", "$1", "", "$1"};
+	std::vector<std::string> aggregation_column_assigned_aliases{"agg0", "agg1", "agg2", "agg3", "agg4", "agg5"};
+	std::vector<int> group_column_indices{0};
+	EXPECT_TRUE(ral::operators::can_compute_partial_aggregations_per_row(aggregation_types));
+
+	std::unique_ptr<ral::frame::BlazingTable> aggregated = ral::operators::compute_aggregations_with_groupby(
+		table, aggregation_input_expressions, aggregation_types, aggregation_column_assigned_aliases, group_column_indices);
+	std::unique_ptr<ral::frame::BlazingTable> per_row = ral::operators::compute_partial_aggregations_per_row(
+		table, aggregation_input_expressions, aggregation_types, group_column_indices, aggregated->get_schema(), aggregated->names());
+	EXPECT_EQ(per_row->num_rows(), table.num_rows());
+	EXPECT_EQ(per_row->names(), aggregated->names());
+
+	// merging the per row partials must give the same result as merging the aggregated ones
+	std::vector<int> mod_group_column_indices;
+	std::vector<std::string> mod_aggregation_input_expressions, mod_aggregation_column_assigned_aliases;
+	std::vector<AggregateKind> mod_aggregation_types;
+	std::tie(mod_group_column_indices, mod_aggregation_input_expressions, mod_aggregation_types,
+		mod_aggregation_column_assigned_aliases) = ral::operators::modGroupByParametersPostComputeAggregations(
+		group_column_indices, aggregation_types, aggregated->names());
+
+	std::unique_ptr<ral::frame::BlazingTable> merged_aggregated = ral::operators::compute_aggregations_with_groupby(
+		aggregated->toBlazingTableView(), mod_aggregation_input_expressions, mod_aggregation_types, mod_aggregation_column_assigned_aliases, mod_group_column_indices);
+	std::unique_ptr<ral::frame::BlazingTable> merged_per_row = ral::operators::compute_aggregations_with_groupby(
+		per_row->toBlazingTableView(), mod_aggregation_input_expressions, mod_aggregation_types, mod_aggregation_column_assigned_aliases, mod_group_column_indices);
+
+	std::unique_ptr<cudf::table> sorted_result = cudf::sort_by_key(merged_per_row->view(), merged_per_row->view().select({0}));
+	std::unique_ptr<cudf::table> sorted_expected = cudf::sort_by_key(merged_aggregated->view(), merged_aggregated->view().select({0}));
+
+	cudf::test::expect_tables_equivalent(sorted_result->view(), sorted_expected->view());
+}
+
+struct AggregationReductionTest : public BlazingUnitTest {};
+
+// Reduces the partial aggregations without group by of every node the way DistributeAggregateKernel does, and checks
+// that the master ends up with what gathering all the partials into it at once gives
+TEST_F(AggregationReductionTest, ReductionAcrossNodesMatchesFlatGather) {
+	std::vector<AggregateKind> aggregation_types{AggregateKind::SUM, AggregateKind::COUNT_VALID,
+				AggregateKind::MIN, AggregateKind::MAX, AggregateKind::COUNT_ALL};
+	std::vector<std::string> aggregation_input_expressions{"$0", "$0", "$0", "$0", ""};
+	std::vector<std::string> aggregation_column_assigned_aliases{"agg0", "agg1", "agg2", "agg3", "agg4"};
+
+	for (int num_nodes : {1, 2, 3, 5, 8}) {
+		// every third node has no input, the others have a null and three values of their own
+		std::vector<std::unique_ptr<ral::frame::BlazingTable>> partials;
+		for (int node = 0; node < num_nodes; node++) {
+			std::vector<int64_t> values;
+			std::vector<bool> valids;
+			if (node % 3 != 1) {
+				values = {node * 10 + 1, node * 10 + 2, 0, node * 10 + 3};
+				valids = {true, true, false, true};
+			}
+			cudf::test::fixed_width_column_wrapper<int64_t> column(values.begin(), values.end(), valids.begin());
+			ral::frame::BlazingTableView input(CudfTableView{{column}}, {"A"});
+			partials.push_back(ral::operators::compute_aggregations_without_groupby(
+				input, aggregation_input_expressions, aggregation_types, aggregation_column_assigned_aliases));
+		}
+
+		std::vector<cudf::size_type> columns_to_hash;
+		std::vector<std::string> mod_input_expressions, mod_aliases;
+		std::vector<AggregateKind> mod_types;
+		std::tie(columns_to_hash, mod_input_expressions, mod_types, mod_aliases) =
+			ral::operators::modGroupByParametersPostComputeAggregations({}, aggregation_types, partials[0]->names());
+		auto merge = [&](const std::vector<ral::frame::BlazingTableView> & tables) {
+			auto concatenated = ral::utilities::concatTables(tables);
+			return ral::operators::compute_aggregations_without_groupby(
+				concatenated->toBlazingTableView(), mod_input_expressions, mod_types, mod_aliases);
+		};
+
+		std::vector<ral::frame::BlazingTableView> partial_views;
+		for (auto & partial : partials) {
+			partial_views.push_back(partial->toBlazingTableView());
+		}
+		auto flat_gather = merge(partial_views);
+
+		for (bool tree_reduction : {true, false}) {
+			SCOPED_TRACE(std::to_string(num_nodes) + " nodes, tree reduction " + std::to_string(tree_reduction));
+
+			// a node only sends to lower ranks, so going down from the highest rank every message is sent before it is received
+			std::map<int, std::pair<int, std::unique_ptr<ral::frame::BlazingTable>>> messages; // sender rank -> target rank, partial
+			std::unique_ptr<ral::frame::BlazingTable> reduced;
+			for (int rank = num_nodes - 1; rank >= 0; rank--) {
+				reduced = merge({partials[rank]->toBlazingTableView()});
+
+				std::vector<int> receive_ranks;
+				int send_rank;
+				std::tie(receive_ranks, send_rank) = ral::batch::get_aggregation_reduction_peers(rank, num_nodes, tree_reduction);
+				for (int receive_rank : receive_ranks) {
+					auto message = messages.find(receive_rank);
+					ASSERT_NE(message, messages.end());
+					EXPECT_EQ(message->second.first, rank);
+					reduced = merge({reduced->toBlazingTableView(), message->second.second->toBlazingTableView()});
+					messages.erase(message);
+				}
+
+				if (rank == 0) {
+					EXPECT_EQ(send_rank, -1);
+					if (tree_reduction) {
+						EXPECT_LE(1 << receive_ranks.size(), 2 * num_nodes - 1); // at most ceil(log2(num_nodes)) messages
+					}
+				} else {
+					ASSERT_GE(send_rank, 0);
+					ASSERT_LT(send_rank, rank);
+					messages[rank] = std::make_pair(send_rank, std::move(reduced));
+				}
+			}
+
+			EXPECT_TRUE(messages.empty());
+			EXPECT_EQ(reduced->names(), flat_gather->names());
+			cudf::test::expect_tables_equivalent(flat_gather->view(), reduced->view());
+		}
+	}
+}
@@ -212,3 +212,33 @@ TEST_F(LogicalFilterWithStringsTest, IneqWithNulls)
 
   cudf::test::expect_tables_equal(expected_table_view, out_table->view());
 }
+
+struct LateMaterializationFilterTest : public BlazingUnitTest {};
+
+TEST_F(LateMaterializationFilterTest, remapped_filter_matches_the_full_table)
+{
+  cudf::test::fixed_width_column_wrapper<int32_t> col1({1, 2, 3, 4, 5});
+  cudf::test::fixed_width_column_wrapper<int32_t> col2({10, 8, 6, 4, 2});
+  cudf::test::fixed_width_column_wrapper<int32_t> col3({7, 7, 1, 1, 7});
+  cudf::test::fixed_width_column_wrapper<int32_t> col4({5, 4, 3, 2, 1});
+
+  cudf::table_view in_table_view ({col1, col2, col3, col4});
+  std::vector<std::string> column_names{"col1", "col2", "col3", "col4"};
+
+  std::string condition = "AND(>($3, 1), =($2, 7))";
+  std::vector<int> filter_columns = ral::processor::get_filter_column_indices(condition);
+  EXPECT_EQ(filter_columns, std::vector<int>({2, 3}));
+
+  std::string remapped_condition = ral::processor::remap_filter_columns(condition, filter_columns);
+  EXPECT_EQ(remapped_condition, "AND(>($1, 1), =($0, 7))");
+
+  ral::frame::BlazingTableView filter_table_view{in_table_view.select({2, 3}), {"col3", "col4"}};
+  ral::processor::expression_program_cache programs({remapped_condition});
+  auto bool_values = ral::processor::evaluate_filter(filter_table_view, programs);
+  auto out_table = ral::processor::applyBooleanFilter(ral::frame::BlazingTableView{in_table_view, column_names}, bool_values->view());
+
+  auto expected_table = ral::processor::process_filter(ral::frame::BlazingTableView{in_table_view, column_names},
+                                                       "LogicalFilter(condition=[" + condition + "])", nullptr);
+
+  cudf::test::expect_tables_equal(expected_table->view(), out_table->view());
+}
@@ -0,0 +1,216 @@
+#include <cmath>
+
+#include "Interpreter/interpreter_cpu.h"
+#include "tests/utilities/BlazingUnitTest.h"
+
+using namespace interops;
+
+namespace {
+
+template <typename T>
+struct host_column {
+	host_column(std::vector<T> values, std::vector<bool> valids = {}) : values(std::move(values)) {
+		if (!valids.empty()) {
+			null_mask.resize((valids.size() + 31) / 32, 0);
+			for (size_t i = 0; i < valids.size(); i++) {
+				null_mask[i / 32] |= static_cast<cudf::bitmask_type>(valids[i]) << (i % 32);
+			}
+		}
+	}
+
+	host_column_view view(cudf::type_id type) const {
+		return {cudf::data_type{type}, values.data(), null_mask.empty() ? nullptr : null_mask.data()};
+	}
+
+	std::vector<T> values;
+	std::vector<cudf::bitmask_type> null_mask;
+};
+
+template <typename T>
+struct host_output {
+	host_output(cudf::type_id type, size_t size) : type{type}, values(size), null_mask((size + 31) / 32) {}
+
+	host_mutable_column_view view() { return {cudf::data_type{type}, values.data(), null_mask.data()}; }
+
+	bool valid(size_t i) const { return (null_mask[i / 32] >> (i % 32)) & 1; }
+
+	cudf::type_id type;
+	std::vector<T> values;
+	std::vector<cudf::bitmask_type> null_mask;
+};
+
+} // namespace
+
+struct InterpreterCpuTest : public BlazingUnitTest {
+	interpreter_plan make_plan(cudf::size_type num_inputs, const std::vector<std::string> & expressions) {
+		std::map<column_index_type, column_index_type> col_idx_map;
+		for (cudf::size_type i = 0; i < num_inputs; i++) {
+			col_idx_map.insert({i, i});
+		}
+
+		interpreter_plan plan;
+		plan.num_inputs = num_inputs;
+		for (auto & expression : expressions) {
+			ral::parser::parse_tree tree;
+			tree.build(expression);
+			tree.transform_to_custom_op();
+			add_expression_to_plan(tree, col_idx_map, plan);
+		}
+		optimize_plan(plan);
+		return plan;
+	}
+};
+
+TEST_F(InterpreterCpuTest, arithmetic_with_nulls) {
+	host_column<int32_t> col0({1, 2, 3, 4, 5, 6}, {1, 1, 0, 1, 1, 1});
+	host_column<double> col1({0.5, 1.5, 2.5, 3.5, 4.5, 5.5}, {1, 0, 1, 1, 1, 1});
+
+	interpreter_plan plan = make_plan(2, {"+($0, *($1, 2))", "-($0, 10)", "*($0, $0)"});
+
+	host_output<double> out0(cudf::type_id::FLOAT64, 6);
+	host_output<int64_t> out1(cudf::type_id::INT64, 6);
+	host_output<int32_t> out2(cudf::type_id::INT32, 6);
+	perform_interpreter_operation_cpu({out0.view(), out1.view(), out2.view()},
+		{col0.view(cudf::type_id::INT32), col1.view(cudf::type_id::FLOAT64)}, plan, 6);
+
+	std::vector<bool> expected_valids0{1, 0, 0, 1, 1, 1};
+	for (size_t i = 0; i < 6; i++) {
+		EXPECT_EQ(out0.valid(i), expected_valids0[i]);
+		if (expected_valids0[i]) {
+			EXPECT_DOUBLE_EQ(out0.values[i], col0.values[i] + col1.values[i] * 2);
+		}
+
+		EXPECT_EQ(out1.valid(i), i != 2);
+		EXPECT_EQ(out2.valid(i), i != 2);
+		if (i != 2) {
+			EXPECT_EQ(out1.values[i], col0.values[i] - 10);
+			EXPECT_EQ(out2.values[i], col0.values[i] * col0.values[i]);
+		}
+	}
+}
+
+TEST_F(InterpreterCpuTest, division_and_modulo_by_zero) {
+	host_column<int64_t> col0({7, 8, 9, -9});
+	host_column<int64_t> col1({2, 0, 4, 4});
+
+	interpreter_plan plan = make_plan(2, {"/($0, $1)", "MOD($0, $1)", "/(CAST_DOUBLE($0), $1)"});
+
+	host_output<int64_t> out0(cudf::type_id::INT64, 4);
+	host_output<int64_t> out1(cudf::type_id::INT64, 4);
+	host_output<double> out2(cudf::type_id::FLOAT64, 4);
+	perform_interpreter_operation_cpu({out0.view(), out1.view(), out2.view()},
+		{col0.view(cudf::type_id::INT64), col1.view(cudf::type_id::INT64)}, plan, 4);
+
+	EXPECT_EQ(out0.values[0], 3);
+	EXPECT_FALSE(out0.valid(1));
+	EXPECT_EQ(out0.values[3], -2);
+
+	EXPECT_EQ(out1.values[0], 1);
+	EXPECT_FALSE(out1.valid(1));
+	EXPECT_EQ(out1.values[3], -1);
+
+	EXPECT_DOUBLE_EQ(out2.values[0], 3.5);
+	EXPECT_FALSE(out2.valid(1));
+	EXPECT_DOUBLE_EQ(out2.values[3], -2.25);
+}
+
+TEST_F(InterpreterCpuTest, case_and_logical_operators) {
+	host_column<int32_t> col0({1, 5, 3, 8}, {1, 1, 1, 0});
+	host_column<int32_t> col1({10, 20, 30, 40});
+
+	interpreter_plan plan = make_plan(2, {"CASE(>($0, 2), $0, $1)", "AND(>($0, 2), <($1, 35))", "IS_NULL($0)"});
+
+	host_output<int32_t> out0(cudf::type_id::INT32, 4);
+	host_output<int8_t> out1(cudf::type_id::BOOL8, 4);
+	host_output<int8_t> out2(cudf::type_id::BOOL8, 4);
+	perform_interpreter_operation_cpu({out0.view(), out1.view(), out2.view()},
+		{col0.view(cudf::type_id::INT32), col1.view(cudf::type_id::INT32)}, plan, 4);
+
+	EXPECT_EQ(out0.values[0], 10);
+	EXPECT_EQ(out0.values[1], 5);
+	EXPECT_EQ(out0.values[2], 3);
+	EXPECT_EQ(out0.values[3], 40);
+	for (size_t i = 0; i < 4; i++) {
+		EXPECT_TRUE(out0.valid(i));
+	}
+
+	EXPECT_EQ(out1.values[0], 0);
+	EXPECT_EQ(out1.values[1], 1);
+	EXPECT_EQ(out1.values[2], 1);
+	EXPECT_FALSE(out1.valid(3));
+
+	EXPECT_EQ(out2.values, (std::vector<int8_t>{0, 0, 0, 1}));
+	EXPECT_TRUE(out2.valid(3));
+}
+
+TEST_F(InterpreterCpuTest, timestamps) {
+	// 2020-02-29 13:45:30, 1970-01-02 01:00:00
+	host_column<int64_t> col0({1582983930, 90000});
+	host_column<int32_t> col1({18321, 1}); // 2020-02-29, 1970-01-02
+
+	interpreter_plan plan = make_plan(2, {"BL_YEAR($0)", "BL_MONTH($0)", "BL_DAY($0)", "BL_HOUR($0)", "BL_MINUTE($0)", "BL_SECOND($0)", "BL_DOW($0)", "=(CAST_DATE($0), $1)"});
+
+	std::vector<host_output<int64_t>> outputs(7, host_output<int64_t>(cudf::type_id::INT64, 2));
+	host_output<int8_t> equal(cudf::type_id::BOOL8, 2);
+	std::vector<host_mutable_column_view> out_views;
+	for (auto & output : outputs) {
+		out_views.push_back(output.view());
+	}
+	out_views.push_back(equal.view());
+
+	perform_interpreter_operation_cpu(out_views,
+		{col0.view(cudf::type_id::TIMESTAMP_SECONDS), col1.view(cudf::type_id::TIMESTAMP_DAYS)}, plan, 2);
+
+	std::vector<std::vector<int64_t>> expected{{2020, 1970}, {2, 1}, {29, 2}, {13, 1}, {45, 0}, {30, 0}, {6, 5}};
+	for (size_t i = 0; i < outputs.size(); i++) {
+		EXPECT_EQ(outputs[i].values, expected[i]);
+	}
+	EXPECT_EQ(equal.values, (std::vector<int8_t>{1, 1}));
+}
+
+TEST_F(InterpreterCpuTest, multiple_tiles_and_threads) {
+	const cudf::size_type num_rows = 100003;
+	std::vector<int64_t> values(num_rows);
+	std::vector<bool> valids(num_rows);
+	for (cudf::size_type i = 0; i < num_rows; i++) {
+		values[i] = i;
+		valids[i] = i % 7 != 0;
+	}
+	host_column<int64_t> col0(values, valids);
+
+	interpreter_plan plan = make_plan(1, {"+(*($0, 3), 1)"});
+
+	host_output<int64_t> single(cudf::type_id::INT64, num_rows);
+	host_output<int64_t> multi(cudf::type_id::INT64, num_rows);
+	perform_interpreter_operation_cpu({single.view()}, {col0.view(cudf::type_id::INT64)}, plan, num_rows, 1);
+	perform_interpreter_operation_cpu({multi.view()}, {col0.view(cudf::type_id::INT64)}, plan, num_rows, 4);
+
+	EXPECT_EQ(single.null_mask, multi.null_mask);
+	for (cudf::size_type i = 0; i < num_rows; i++) {
+		ASSERT_EQ(multi.valid(i), valids[i]);
+		if (valids[i]) {
+			ASSERT_EQ(single.values[i], values[i] * 3 + 1);
+			ASSERT_EQ(multi.values[i], values[i] * 3 + 1);
+		}
+	}
+}
+
+TEST_F(InterpreterCpuTest, plans_with_many_positions) {
+	std::vector<int64_t> values{1, 2, 3};
+	std::vector<host_column<int64_t>> columns(100, host_column<int64_t>(values));
+	std::vector<host_column_view> input_views;
+	std::string expression = "$0";
+	for (int i = 0; i < 100; i++) {
+		input_views.push_back(columns[i].view(cudf::type_id::INT64));
+		if (i > 0) {
+			expression = "+(" + expression + ", $" + std::to_string(i) + ")";
+		}
+	}
+
+	interpreter_plan plan = make_plan(100, {expression});
+	EXPECT_GE(plan.max_position(), MAX_PLAN_POSITIONS);
+
+	host_output<int64_t> out(cudf::type_id::INT64, 3);
+	perform_interpreter_operation_cpu({out.view()}, input_views, plan, 3);
+	EXPECT_EQ(out.values, (std::vector<int64_t>{100, 200, 300}));
+}
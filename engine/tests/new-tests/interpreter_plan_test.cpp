@@ -0,0 +1,252 @@
+#include <algorithm>
+#include <numeric>
+#include <set>
+
+#include "Interpreter/interpreter_plan.h"
+#include "tests/utilities/BlazingUnitTest.h"
+
+using namespace interops;
+
+struct InterpreterPlanTest : public BlazingUnitTest {
+	interpreter_plan make_plan(cudf::size_type num_inputs, const std::vector<std::string> & expressions) {
+		std::map<column_index_type, column_index_type> col_idx_map;
+		for (cudf::size_type i = 0; i < num_inputs; i++) {
+			col_idx_map.insert({i, i});
+		}
+
+		interpreter_plan plan;
+		plan.num_inputs = num_inputs;
+		for (auto & expression : expressions) {
+			ral::parser::parse_tree tree;
+			tree.build(expression);
+			tree.transform_to_custom_op();
+			add_expression_to_plan(tree, col_idx_map, plan);
+		}
+		return plan;
+	}
+
+	// Checks that every operand is either an input or a position written by a
+	// previous operation
+	void check_plan(const interpreter_plan & plan) {
+		std::set<column_index_type> written;
+		for (cudf::size_type i = 0; i < plan.num_inputs; i++) {
+			written.insert(i);
+		}
+
+		for (size_t i = 0; i < plan.operators.size(); i++) {
+			for (auto position : {plan.left_inputs[i], plan.right_inputs[i]}) {
+				if (position >= 0) {
+					EXPECT_TRUE(written.count(position) > 0);
+				}
+			}
+			EXPECT_GE(plan.outputs[i], plan.num_inputs);
+			written.insert(plan.outputs[i]);
+		}
+
+		for (auto position : plan.final_output_positions) {
+			EXPECT_TRUE(written.count(position) > 0);
+		}
+	}
+
+	// Evaluates a plan of arithmetic operations over a single row
+	std::vector<double> evaluate(const interpreter_plan & plan, const std::vector<double> & row) {
+		std::map<column_index_type, double> values;
+		for (cudf::size_type i = 0; i < plan.num_inputs; i++) {
+			values[i] = row[i];
+		}
+
+		auto operand = [&](column_index_type position, const plan_literal & literal) {
+			return position == SCALAR_INDEX ? std::stod(literal.value) : values.at(position);
+		};
+
+		for (size_t i = 0; i < plan.operators.size(); i++) {
+			double left = operand(plan.left_inputs[i], plan.left_literals[i]);
+			double right = operand(plan.right_inputs[i], plan.right_literals[i]);
+			switch (plan.operators[i]) {
+			case operator_type::BLZ_ADD: values[plan.outputs[i]] = left + right; break;
+			case operator_type::BLZ_SUB: values[plan.outputs[i]] = left - right; break;
+			case operator_type::BLZ_MUL: values[plan.outputs[i]] = left * right; break;
+			default: ADD_FAILURE() << "Unexpected operator";
+			}
+		}
+
+		std::vector<double> results;
+		for (auto position : plan.final_output_positions) {
+			results.push_back(values.at(position));
+		}
+		return results;
+	}
+
+	void expect_same_results(const interpreter_plan & expected, const interpreter_plan & plan) {
+		std::vector<double> row;
+		for (cudf::size_type i = 0; i < expected.num_inputs; i++) {
+			row.push_back(i * 3 + 1);
+		}
+		EXPECT_EQ(evaluate(expected, row), evaluate(plan, row));
+	}
+};
+
+TEST_F(InterpreterPlanTest, add_expression_to_plan) {
+	interpreter_plan plan = make_plan(2, {"+(*($0, $1), 5)"});
+
+	ASSERT_EQ(plan.operators.size(), 2);
+	EXPECT_EQ(plan.operators[0], operator_type::BLZ_MUL);
+	EXPECT_EQ(plan.left_inputs[0], 0);
+	EXPECT_EQ(plan.right_inputs[0], 1);
+	EXPECT_EQ(plan.operators[1], operator_type::BLZ_ADD);
+	EXPECT_EQ(plan.left_inputs[1], plan.outputs[0]);
+	EXPECT_EQ(plan.right_inputs[1], SCALAR_INDEX);
+	EXPECT_EQ(plan.right_literals[1].value, "5");
+	EXPECT_EQ(plan.final_output_positions, std::vector<column_index_type>{plan.outputs[1]});
+}
+
+TEST_F(InterpreterPlanTest, common_subexpressions_are_evaluated_once) {
+	interpreter_plan original = make_plan(2, {"*($0, -(1, $1))", "+(*($0, -(1, $1)), $1)", "*($0, -(1, $1))"});
+	interpreter_plan plan = original;
+	optimize_plan(plan);
+	check_plan(plan);
+	expect_same_results(original, plan);
+
+	// -(1, $1), *($0, ...) and +(..., $1)
+	ASSERT_EQ(plan.operators.size(), 3);
+	ASSERT_EQ(plan.final_output_positions.size(), 3);
+	EXPECT_EQ(plan.final_output_positions[0], plan.final_output_positions[2]);
+	EXPECT_EQ(plan.left_inputs[2], plan.final_output_positions[0]);
+}
+
+TEST_F(InterpreterPlanTest, constant_folding) {
+	interpreter_plan plan = make_plan(1, {"+($0, *(2, 3))", ">($0, -(/(10, 4), 2.5))", "AND(=(1, 1), >($0, 0))"});
+	optimize_plan(plan);
+	check_plan(plan);
+
+	ASSERT_EQ(plan.operators.size(), 4);
+
+	EXPECT_EQ(plan.operators[0], operator_type::BLZ_ADD);
+	EXPECT_EQ(plan.right_inputs[0], SCALAR_INDEX);
+	EXPECT_EQ(plan.right_literals[0].value, "6");
+
+	// integer division as the interpreter does it: 10 / 4 = 2
+	EXPECT_EQ(plan.operators[1], operator_type::BLZ_GREATER);
+	EXPECT_EQ(plan.right_inputs[1], SCALAR_INDEX);
+	EXPECT_EQ(std::stod(plan.right_literals[1].value), -0.5);
+	EXPECT_TRUE(is_type_float(plan.right_literals[1].type.id()));
+
+	EXPECT_EQ(plan.operators[3], operator_type::BLZ_LOGICAL_AND);
+	EXPECT_EQ(plan.left_inputs[3], SCALAR_INDEX);
+	EXPECT_EQ(plan.left_literals[3].value, "true");
+}
+
+TEST_F(InterpreterPlanTest, division_by_zero_is_not_folded) {
+	interpreter_plan plan = make_plan(1, {"+($0, /(1, 0))"});
+	optimize_plan(plan);
+	check_plan(plan);
+
+	ASSERT_EQ(plan.operators.size(), 2);
+	EXPECT_EQ(plan.operators[0], operator_type::BLZ_DIV);
+	EXPECT_EQ(plan.left_inputs[0], SCALAR_INDEX);
+	EXPECT_EQ(plan.right_inputs[0], SCALAR_INDEX);
+}
+
+TEST_F(InterpreterPlanTest, values_the_result_type_can_not_hold_are_not_folded) {
+	// 100 * 100 overflows the type of its literals, while the interpreter computes it in int64
+	interpreter_plan plan = make_plan(1, {"+($0, *(100, 100))"});
+	optimize_plan(plan);
+	check_plan(plan);
+
+	ASSERT_FALSE(plan.operators.empty());
+	for (size_t i = 0; i < plan.operators.size(); i++) {
+		if (plan.right_inputs[i] == SCALAR_INDEX && plan.operators[i] == operator_type::BLZ_ADD) {
+			EXPECT_EQ(plan.right_literals[i].value, "10000");
+		}
+	}
+	expect_same_results(make_plan(1, {"+($0, *(100, 100))"}), plan);
+}
+
+TEST_F(InterpreterPlanTest, positions_are_reused) {
+	std::string expression = "$0";
+	for (int i = 0; i < 100; i++) {
+		expression = "+(" + expression + ", *($1, " + std::to_string(i + 1) + "))";
+	}
+
+	interpreter_plan original = make_plan(2, {expression});
+	EXPECT_GE(original.max_position(), 200);
+
+	interpreter_plan plan = original;
+	optimize_plan(plan);
+	check_plan(plan);
+	expect_same_results(original, plan);
+	EXPECT_EQ(plan.operators.size(), 200);
+	EXPECT_LT(plan.max_position(), 5);
+}
+
+TEST_F(InterpreterPlanTest, rand_is_not_merged) {
+	interpreter_plan plan = make_plan(1, {"+($0, BLZ_RND())", "+($0, BLZ_RND())"});
+	optimize_plan(plan);
+	check_plan(plan);
+
+	ASSERT_EQ(plan.operators.size(), 4);
+	EXPECT_NE(plan.final_output_positions[0], plan.final_output_positions[1]);
+}
+
+TEST_F(InterpreterPlanTest, unused_operations_are_removed) {
+	interpreter_plan plan = make_plan(2, {"+($0, $1)", "-($0, $1)"});
+	plan.final_output_positions = {plan.final_output_positions[1]};
+	optimize_plan(plan);
+	check_plan(plan);
+
+	ASSERT_EQ(plan.operators.size(), 1);
+	EXPECT_EQ(plan.operators[0], operator_type::BLZ_SUB);
+}
+
+TEST_F(InterpreterPlanTest, split_plan) {
+	std::vector<std::string> expressions;
+	for (int i = 0; i < 50; i++) {
+		expressions.push_back("+(*($" + std::to_string(i) + ", $" + std::to_string(i + 50) + "), $100)");
+	}
+	expressions.push_back("+($0, 1)");
+
+	interpreter_plan plan = make_plan(101, expressions);
+	auto sub_plans = split_plan(plan);
+	ASSERT_GT(sub_plans.size(), 1);
+
+	std::vector<double> row;
+	for (cudf::size_type i = 0; i < plan.num_inputs; i++) {
+		row.push_back(i * 3 + 1);
+	}
+	std::vector<double> expected_results = evaluate(plan, row);
+
+	std::vector<size_t> covered;
+	for (auto & sub_plan : sub_plans) {
+		check_plan(sub_plan.plan);
+
+		std::vector<double> sub_row;
+		for (auto idx : sub_plan.input_indices) {
+			sub_row.push_back(row[idx]);
+		}
+		std::vector<double> results = evaluate(sub_plan.plan, sub_row);
+		for (size_t i = 0; i < results.size(); i++) {
+			EXPECT_EQ(results[i], expected_results[sub_plan.final_output_indices[i]]);
+		}
+
+		EXPECT_LT(sub_plan.plan.max_position(), MAX_PLAN_POSITIONS);
+		EXPECT_EQ(sub_plan.plan.num_inputs, sub_plan.input_indices.size());
+		EXPECT_EQ(sub_plan.plan.final_output_positions.size(), sub_plan.final_output_indices.size());
+		covered.insert(covered.end(), sub_plan.final_output_indices.begin(), sub_plan.final_output_indices.end());
+	}
+
+	std::sort(covered.begin(), covered.end());
+	std::vector<size_t> expected(expressions.size());
+	std::iota(expected.begin(), expected.end(), 0);
+	EXPECT_EQ(covered, expected);
+}
+
+TEST_F(InterpreterPlanTest, split_plan_keeps_small_plans) {
+	interpreter_plan plan = make_plan(3, {"+($0, $2)", "*($0, $2)"});
+	auto sub_plans = split_plan(plan);
+
+	ASSERT_EQ(sub_plans.size(), 1);
+	EXPECT_EQ(sub_plans[0].input_indices, (std::vector<cudf::size_type>{0, 2}));
+	EXPECT_EQ(sub_plans[0].final_output_indices, (std::vector<size_t>{0, 1}));
+	EXPECT_EQ(sub_plans[0].plan.left_inputs[0], 0);
+	EXPECT_EQ(sub_plans[0].plan.right_inputs[0], 1);
+}
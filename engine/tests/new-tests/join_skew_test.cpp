@@ -0,0 +1,176 @@
+#include <algorithm>
+#include <cmath>
+#include <random>
+
+#include <cudf/concatenate.hpp>
+#include <cudf/copying.hpp>
+#include <cudf/join.hpp>
+#include <cudf/partitioning.hpp>
+#include <cudf/sorting.hpp>
+
+#include "cudf_test/column_wrapper.hpp"
+#include "cudf_test/table_utilities.hpp"
+#include "operators/JoinSkew.h"
+#include "utilities/CommonOperations.h"
+#include "tests/utilities/BlazingUnitTest.h"
+
+using ral::frame::BlazingTable;
+using ral::frame::BlazingTableView;
+
+namespace {
+
+std::vector<int64_t> zipf_keys(std::size_t num_rows, int64_t num_keys, double exponent, std::mt19937 & generator) {
+	std::vector<double> cdf(num_keys);
+	double total = 0;
+	for (int64_t k = 0; k < num_keys; k++) {
+		total += 1.0 / std::pow(k + 1, exponent);
+		cdf[k] = total;
+	}
+
+	std::uniform_real_distribution<double> distribution(0, total);
+	std::vector<int64_t> keys(num_rows);
+	for (auto & key : keys) {
+		key = std::lower_bound(cdf.begin(), cdf.end(), distribution(generator)) - cdf.begin();
+	}
+	return keys;
+}
+
+std::unique_ptr<BlazingTable> make_table(const std::vector<int64_t> & keys, int64_t payload_offset) {
+	std::vector<int64_t> payload(keys.size());
+	std::iota(payload.begin(), payload.end(), payload_offset);
+	cudf::test::fixed_width_column_wrapper<int64_t> key_column(keys.begin(), keys.end());
+	cudf::test::fixed_width_column_wrapper<int64_t> payload_column(payload.begin(), payload.end());
+	return std::make_unique<BlazingTable>(cudf::table_view({key_column, payload_column}), std::vector<std::string>{"key", "payload"});
+}
+
+std::vector<std::unique_ptr<BlazingTable>> standard_hash_partition(const BlazingTableView & table, int num_nodes) {
+	std::unique_ptr<cudf::table> hashed_data;
+	std::vector<cudf::size_type> offsets;
+	std::tie(hashed_data, offsets) = cudf::hash_partition(table.view(), {0}, num_nodes);
+	std::vector<cudf::size_type> split_indexes(offsets.begin() + 1, offsets.end());
+
+	std::vector<std::unique_ptr<BlazingTable>> partitions;
+	for (auto & partition : cudf::split(hashed_data->view(), split_indexes)) {
+		partitions.push_back(std::make_unique<BlazingTable>(partition, table.names()));
+	}
+	return partitions;
+}
+
+// Every node holds one batch of each side. Partitions them, "sends" partition i to node i and joins what every node
+// received. Returns the union of the join results, sorted, and the number of left rows of the busiest node
+std::pair<std::unique_ptr<cudf::table>, cudf::size_type> simulate_distributed_join(
+	const std::vector<std::unique_ptr<BlazingTable>> & left_batches,
+	const std::vector<std::unique_ptr<BlazingTable>> & right_batches,
+	const BlazingTable * heavy_hitters) {
+	int num_nodes = left_batches.size();
+	std::vector<std::vector<std::unique_ptr<BlazingTable>>> left_received(num_nodes), right_received(num_nodes);
+
+	for (int node = 0; node < num_nodes; node++) {
+		std::vector<std::unique_ptr<BlazingTable>> left_partitions, right_partitions;
+		if (heavy_hitters != nullptr) {
+			left_partitions = ral::operators::skew_aware_hash_partition(left_batches[node]->toBlazingTableView(), {0},
+				heavy_hitters->toBlazingTableView(), num_nodes, true, node);
+			right_partitions = ral::operators::skew_aware_hash_partition(right_batches[node]->toBlazingTableView(), {0},
+				heavy_hitters->toBlazingTableView(), num_nodes, false, node);
+		} else {
+			left_partitions = standard_hash_partition(left_batches[node]->toBlazingTableView(), num_nodes);
+			right_partitions = standard_hash_partition(right_batches[node]->toBlazingTableView(), num_nodes);
+		}
+		for (int target = 0; target < num_nodes; target++) {
+			left_received[target].push_back(std::move(left_partitions[target]));
+			right_received[target].push_back(std::move(right_partitions[target]));
+		}
+	}
+
+	cudf::size_type max_left_rows = 0;
+	std::vector<std::unique_ptr<cudf::table>> node_results;
+	for (int node = 0; node < num_nodes; node++) {
+		std::vector<BlazingTableView> left_views, right_views;
+		for (int i = 0; i < num_nodes; i++) {
+			left_views.push_back(left_received[node][i]->toBlazingTableView());
+			right_views.push_back(right_received[node][i]->toBlazingTableView());
+		}
+		auto left = ral::utilities::concatTables(left_views);
+		auto right = ral::utilities::concatTables(right_views);
+		max_left_rows = std::max(max_left_rows, left->num_rows());
+
+		std::vector<std::pair<cudf::size_type, cudf::size_type>> columns_in_common;
+		node_results.push_back(cudf::inner_join(left->view(), right->view(), {0}, {0}, columns_in_common));
+	}
+
+	std::vector<cudf::table_view> result_views;
+	for (auto & result : node_results) {
+		result_views.push_back(result->view());
+	}
+	auto result = cudf::concatenate(result_views);
+	return {cudf::sort(result->view()), max_left_rows};
+}
+
+} // namespace
+
+struct JoinSkewTest : public BlazingUnitTest {};
+
+TEST_F(JoinSkewTest, heavy_hitters) {
+	std::vector<int64_t> keys(1000);
+	for (std::size_t i = 0; i < keys.size(); i++) {
+		keys[i] = i % 4 == 0 ? 7 : (i % 10 == 1 ? 3 : i);
+	}
+	auto table = make_table(keys, 0);
+
+	auto samples = ral::operators::sample_join_keys(table->toBlazingTableView(), {0});
+	EXPECT_EQ(samples->num_columns(), 1);
+	EXPECT_EQ(samples->num_rows(), 100);
+
+	auto all_rows = table->toBlazingTableView().clone();
+	auto heavy_hitters = ral::operators::get_heavy_hitters(BlazingTableView(all_rows->view().select({0}), {"key"}), 0.05);
+	auto sorted = cudf::sort(heavy_hitters->view());
+	cudf::test::fixed_width_column_wrapper<int64_t> expected{3, 7};
+	cudf::test::expect_tables_equal(sorted->view(), cudf::table_view({expected}));
+
+	// 250 rows with key 7 and 100 with key 3
+	BlazingTableView all_keys(all_rows->view().select({0}), {"key"});
+	EXPECT_DOUBLE_EQ(ral::operators::get_heavy_hitter_fraction(all_keys, heavy_hitters->toBlazingTableView()), 0.35);
+	EXPECT_DOUBLE_EQ(ral::operators::get_heavy_hitter_fraction(all_keys,
+		BlazingTableView(cudf::empty_like(heavy_hitters->view())->view(), {"key"})), 0);
+
+	// too few samples to tell
+	EXPECT_EQ(ral::operators::get_heavy_hitters(BlazingTableView(cudf::slice(all_rows->view().select({0}), {0, 50})[0], {"key"}), 0.05)->num_rows(), 0);
+}
+
+TEST_F(JoinSkewTest, zipf_keys_are_spread) {
+	const int num_nodes = 8;
+	const std::size_t left_rows_per_node = 500000;
+	const int64_t num_keys = 100000;
+	std::mt19937 generator(42);
+
+	std::vector<std::unique_ptr<BlazingTable>> left_batches, right_batches;
+	for (int node = 0; node < num_nodes; node++) {
+		left_batches.push_back(make_table(zipf_keys(left_rows_per_node, num_keys, 1.1, generator), node * left_rows_per_node));
+
+		// every key once on the right side, spread across the nodes
+		std::vector<int64_t> right_keys;
+		for (int64_t key = node; key < num_keys; key += num_nodes) {
+			right_keys.push_back(key);
+		}
+		right_batches.push_back(make_table(right_keys, node * num_keys));
+	}
+
+	std::vector<std::unique_ptr<BlazingTable>> samples;
+	std::vector<BlazingTableView> sample_views;
+	for (auto & batch : left_batches) {
+		samples.push_back(ral::operators::sample_join_keys(batch->toBlazingTableView(), {0}));
+		sample_views.push_back(samples.back()->toBlazingTableView());
+	}
+	auto all_samples = ral::utilities::concatTables(sample_views);
+	auto heavy_hitters = ral::operators::get_heavy_hitters(all_samples->toBlazingTableView(), 0.05);
+	ASSERT_GT(heavy_hitters->num_rows(), 0);
+	// the most frequent key alone takes about 11% of the rows
+	auto heavy_keys = ral::utilities::column_to_vector<int64_t>(heavy_hitters->view().column(0));
+	EXPECT_NE(std::find(heavy_keys.begin(), heavy_keys.end(), 0), heavy_keys.end());
+
+	auto standard = simulate_distributed_join(left_batches, right_batches, nullptr);
+	auto skew_aware = simulate_distributed_join(left_batches, right_batches, heavy_hitters.get());
+
+	cudf::test::expect_tables_equal(standard.first->view(), skew_aware.first->view());
+	EXPECT_LT(skew_aware.second, standard.second);
+}
@@ -3,6 +3,7 @@
 #include "cudf_test/column_wrapper.hpp"
 #include "cudf_test/table_utilities.hpp"
 #include "cudf_test/type_lists.hpp"
+#include <cudf/copying.hpp>
 
 #include "execution_graph/logic_controllers/LogicalProject.h"
 
@@ -512,3 +513,108 @@ TYPED_TEST(ProjectRoundTest, test_round)
 
     cudf::test::expect_tables_equal(expect_cudf_table_view, out_table->view());
 }
+
+struct ProjectProgramTest : public BlazingUnitTest {};
+
+TEST_F(ProjectProgramTest, test_program_reused_across_batches)
+{
+    std::vector<std::string> names({"A", "B"});
+    std::vector<std::string> expressions;
+    std::vector<std::string> out_column_names;
+    std::tie(expressions, out_column_names) = ral::processor::get_project_expressions_and_names(
+        "LogicalProject(EXPR$0=[+($0, $1)], EXPR$1=[$1], EXPR$2=[5])");
+    ral::processor::expression_program_cache programs(expressions);
+
+    cudf::test::fixed_width_column_wrapper<int32_t> col1_batch1{{1, 2, 3}};
+    cudf::test::fixed_width_column_wrapper<int32_t> col2_batch1{{10, 20, 30}};
+    CudfTableView batch1_view{{col1_batch1, col2_batch1}};
+    auto out_batch1 = ral::processor::process_project(
+        std::make_unique<ral::frame::BlazingTable>(std::make_unique<CudfTable>(batch1_view), names), out_column_names, programs);
+
+    auto program = programs.get(batch1_view);
+    EXPECT_TRUE(program->is_compiled());
+
+    cudf::test::fixed_width_column_wrapper<int32_t> col1_batch2{{4, 5, 6, 7, 8}};
+    cudf::test::fixed_width_column_wrapper<int32_t> col2_batch2{{40, 50, 60, 70, 80}};
+    CudfTableView batch2_view{{col1_batch2, col2_batch2}};
+    auto out_batch2 = ral::processor::process_project(
+        std::make_unique<ral::frame::BlazingTable>(std::make_unique<CudfTable>(batch2_view), names), out_column_names, programs);
+
+    EXPECT_EQ(program, programs.get(batch2_view));
+    EXPECT_EQ(out_column_names, out_batch2->names());
+
+    cudf::test::fixed_width_column_wrapper<int32_t> expect_col1_batch1{{11, 22, 33}};
+    cudf::test::fixed_width_column_wrapper<int32_t> expect_col2_batch1{{10, 20, 30}};
+    cudf::test::fixed_width_column_wrapper<int32_t> expect_col3_batch1{{5, 5, 5}};
+    cudf::test::expect_tables_equal(CudfTableView{{expect_col1_batch1, expect_col2_batch1, expect_col3_batch1}}, out_batch1->view());
+
+    cudf::test::fixed_width_column_wrapper<int32_t> expect_col1_batch2{{44, 55, 66, 77, 88}};
+    cudf::test::fixed_width_column_wrapper<int32_t> expect_col2_batch2{{40, 50, 60, 70, 80}};
+    cudf::test::fixed_width_column_wrapper<int32_t> expect_col3_batch2{{5, 5, 5, 5, 5}};
+    cudf::test::expect_tables_equal(CudfTableView{{expect_col1_batch2, expect_col2_batch2, expect_col3_batch2}}, out_batch2->view());
+}
+
+TEST_F(ProjectProgramTest, test_program_per_schema)
+{
+    std::vector<std::string> names({"A"});
+    ral::processor::expression_program_cache programs({"*($0, 2)"});
+
+    cudf::test::fixed_width_column_wrapper<int32_t> int_col{{1, 2, 3}};
+    cudf::test::fixed_width_column_wrapper<double> double_col{{1.5, 2.5}};
+    CudfTableView int_view{{int_col}};
+    CudfTableView double_view{{double_col}};
+
+    auto int_program = programs.get(int_view);
+    auto double_program = programs.get(double_view);
+    EXPECT_NE(int_program, double_program);
+    EXPECT_TRUE(int_program->matches(int_view));
+    EXPECT_FALSE(int_program->matches(double_view));
+
+    auto out_double = ral::processor::process_project(
+        std::make_unique<ral::frame::BlazingTable>(std::make_unique<CudfTable>(double_view), names), names, programs);
+
+    cudf::test::fixed_width_column_wrapper<double> expect_col{{3.0, 5.0}};
+    cudf::test::expect_tables_equal(CudfTableView{{expect_col}}, out_double->view());
+}
+
+TEST_F(ProjectProgramTest, test_program_with_string_functions_is_not_compiled)
+{
+    cudf::test::strings_column_wrapper col1{{"foo", "bar"}};
+    CudfTableView in_table_view{{col1}};
+
+    ral::processor::expression_program_cache programs({"UPPER($0)"});
+    auto program = programs.get(in_table_view);
+
+    for (int i = 0; i < 2; i++) {
+        auto out_columns = program->evaluate(in_table_view);
+
+        cudf::test::strings_column_wrapper expected_col1{{"FOO", "BAR"}};
+        cudf::test::expect_columns_equal(expected_col1, out_columns[0]->view());
+    }
+
+    // Columns evaluated outside of the interpreter belong to each batch
+    EXPECT_FALSE(program->is_compiled());
+}
+
+TEST_F(ProjectProgramTest, test_small_batches_evaluated_on_cpu_match_gpu)
+{
+    std::vector<std::string> names({"A", "B"});
+    std::vector<std::string> expressions({"+($0, $1)", "*($0, 2.5)", ">($1, 20)", "IS NULL($0)"});
+
+    cudf::test::fixed_width_column_wrapper<int32_t> col1{{1, 2, 3, 4, 5, 6, 7, 8, 9, 10}, {1, 0, 1, 1, 0, 1, 1, 1, 0, 1}};
+    cudf::test::fixed_width_column_wrapper<int64_t> col2{{10, 20, 30, 40, 50, 60, 70, 80, 90, 100}, {1, 1, 0, 1, 1, 1, 0, 1, 1, 1}};
+    CudfTableView table_view{{col1, col2}};
+
+    // a slice whose null masks do not start at bit 0
+    for (auto && view : {table_view, cudf::slice(table_view, {3, 10})[0]}) {
+        ral::processor::expression_program_cache cpu_programs(expressions, view.num_rows());
+        ral::processor::expression_program_cache gpu_programs(expressions, 0);
+
+        for (int i = 0; i < 2; i++) {
+            auto cpu_out = std::make_unique<ral::frame::BlazingTable>(cpu_programs.get(view)->evaluate(view), expressions);
+            auto gpu_out = std::make_unique<ral::frame::BlazingTable>(gpu_programs.get(view)->evaluate(view), expressions);
+
+            cudf::test::expect_tables_equal(gpu_out->view(), cpu_out->view());
+        }
+    }
+}
@@ -0,0 +1,101 @@
+#include <algorithm>
+#include <cudf/sorting.hpp>
+
+#include "cudf_test/column_utilities.hpp"
+#include "cudf_test/column_wrapper.hpp"
+#include "cudf_test/table_utilities.hpp"
+#include "operators/RuntimeJoinFilter.h"
+#include "utilities/CommonOperations.h"
+#include "tests/utilities/BlazingUnitTest.h"
+
+using ral::frame::BlazingTableView;
+using ral::operators::runtime_join_filter;
+
+namespace {
+
+std::vector<int64_t> sorted_values(const cudf::column_view & column) {
+	auto sorted = cudf::sort(cudf::table_view({column}));
+	return ral::utilities::column_to_vector<int64_t>(sorted->view().column(0));
+}
+
+} // namespace
+
+struct RuntimeJoinFilterTest : public BlazingUnitTest {};
+
+TEST_F(RuntimeJoinFilterTest, keeps_matching_rows_and_drops_out_of_bounds_and_nulls) {
+	// build keys are INT32, the common join type is INT64
+	cudf::test::fixed_width_column_wrapper<int32_t> build_keys{{1, 5, 9, 100, 7}, {1, 1, 1, 1, 0}};
+	cudf::test::fixed_width_column_wrapper<int32_t> build_payload{10, 50, 90, 1000, 70};
+	cudf::table_view build_view({build_keys, build_payload});
+
+	runtime_join_filter filter({cudf::data_type{cudf::type_id::INT64}}, 5);
+	filter.add(BlazingTableView(build_view, {"key", "payload"}), {0});
+
+	std::vector<int64_t> probe_values(300);
+	std::vector<bool> probe_valids(300);
+	for (int64_t i = 0; i < 300; i++) {
+		probe_values[i] = i - 50;
+		probe_valids[i] = probe_values[i] != 9;
+	}
+	cudf::test::fixed_width_column_wrapper<int64_t> probe_keys(probe_values.begin(), probe_values.end(), probe_valids.begin());
+	cudf::table_view probe_view({probe_keys});
+
+	auto filtered = filter.apply(BlazingTableView(probe_view, {"key"}), {0});
+	std::vector<int64_t> kept = sorted_values(filtered->view().column(0));
+
+	EXPECT_EQ(filtered->view().column(0).null_count(), 0);
+	for (int64_t key : std::vector<int64_t>{1, 5, 100}) {
+		EXPECT_TRUE(std::find(kept.begin(), kept.end(), key) != kept.end()) << key;
+	}
+	// 7 was a null key on the build side and 9 a null on the probe side, bloom false positives are allowed for 7
+	EXPECT_TRUE(std::find(kept.begin(), kept.end(), 9) == kept.end());
+	EXPECT_GE(kept.front(), 1);
+	EXPECT_LE(kept.back(), 100);
+	EXPECT_LT(kept.size(), 20);
+}
+
+TEST_F(RuntimeJoinFilterTest, merge_filters_of_different_sizes) {
+	cudf::data_type key_type{cudf::type_id::INT64};
+	cudf::test::fixed_width_column_wrapper<int64_t> keys_a{3, 4, 1000};
+	cudf::test::fixed_width_column_wrapper<int64_t> keys_b{-20, 70};
+	cudf::table_view view_a({keys_a});
+	cudf::table_view view_b({keys_b});
+
+	runtime_join_filter filter_a({key_type}, 10000000);
+	filter_a.add(BlazingTableView(view_a, {"key"}), {0});
+	runtime_join_filter filter_b({key_type}, 10);
+	filter_b.add(BlazingTableView(view_b, {"key"}), {0});
+
+	// as received from another node
+	auto serialized_b = filter_b.to_table();
+	filter_a.merge(serialized_b->toBlazingTableView());
+	EXPECT_EQ(filter_a.size_in_bytes(), filter_b.size_in_bytes());
+
+	cudf::test::fixed_width_column_wrapper<int64_t> probe_keys{-21, -20, 3, 4, 70, 1000, 1001};
+	cudf::table_view probe_view({probe_keys});
+	auto filtered = filter_a.apply(BlazingTableView(probe_view, {"key"}), {0});
+	std::vector<int64_t> kept = sorted_values(filtered->view().column(0));
+
+	EXPECT_EQ(kept, (std::vector<int64_t>{-20, 3, 4, 70, 1000}));
+}
+
+TEST_F(RuntimeJoinFilterTest, multiple_keys_and_empty_build_side) {
+	std::vector<cudf::data_type> key_types{cudf::data_type{cudf::type_id::INT32}, cudf::data_type{cudf::type_id::STRING}};
+	cudf::test::fixed_width_column_wrapper<int32_t> build_ints{1, 2};
+	cudf::test::strings_column_wrapper build_strings{"a", "b"};
+	cudf::table_view build_view({build_ints, build_strings});
+
+	cudf::test::fixed_width_column_wrapper<int32_t> probe_ints{1, 2, 1, 2};
+	cudf::test::strings_column_wrapper probe_strings{"a", "b", "b", "a"};
+	cudf::table_view probe_view({probe_ints, probe_strings});
+
+	runtime_join_filter empty_filter(key_types, 2);
+	EXPECT_TRUE(empty_filter.empty());
+	EXPECT_EQ(empty_filter.apply(BlazingTableView(probe_view, {"i", "s"}), {0, 1})->num_rows(), 0);
+
+	runtime_join_filter filter(key_types, 2);
+	filter.add(BlazingTableView(build_view, {"i", "s"}), {0, 1});
+	auto filtered = filter.apply(BlazingTableView(probe_view, {"i", "s"}), {0, 1});
+	EXPECT_GE(filtered->num_rows(), 2);
+	EXPECT_LE(filtered->num_rows(), 4);
+}
@@ -40,6 +40,33 @@ TEST_F(ExpressionUtilsTest, expression_contains_multiple_diff_over_clauses) {
 	EXPECT_EQ(result_2, true);
 }
 
+TEST_F(ExpressionUtilsTest, expression_contains_multiple_diff_partition_by) {
+
+	std::string query_part_1 = "LogicalProject(max_prices=[MAX($0) OVER (PARTITION BY $2 ORDER BY $0, $1)], min_prices=[MIN($0) OVER (PARTITION BY $2 ORDER BY $0)])";
+	bool result_1 = window_expression_contains_multiple_diff_partition_by(query_part_1);
+
+	std::string query_part_2 = "LogicalProject(max_prices=[MAX($0) OVER (PARTITION BY $2)], min_prices=[MIN($0) OVER (PARTITION BY $3)])";
+	bool result_2 = window_expression_contains_multiple_diff_partition_by(query_part_2);
+
+	EXPECT_EQ(result_1, false);
+	EXPECT_EQ(result_2, true);
+}
+
+TEST_F(ExpressionUtilsTest, getting_window_expressions_by_over_clause) {
+
+	std::string query_part = "LogicalProject(min_keys=[MIN($0) OVER (PARTITION BY $2 ORDER BY $1)], n_name=[$1], "
+		"sum_keys=[CASE(>(COUNT($0) OVER (PARTITION BY $2), 0), $SUM0($0) OVER (PARTITION BY $2), null:INTEGER)], "
+		"max_keys=[MAX($0) OVER (PARTITION BY $2 ORDER BY $1)])";
+	std::vector<std::pair<std::string, std::vector<std::size_t>>> result = get_window_expressions_by_over_clause(query_part);
+
+	ASSERT_EQ(result.size(), 2);
+	EXPECT_EQ(result[0].first, "LogicalProject(min_keys=[MIN($0) OVER (PARTITION BY $2 ORDER BY $1)], max_keys=[MAX($0) OVER (PARTITION BY $2 ORDER BY $1)])");
+	EXPECT_EQ(result[0].second, std::vector<std::size_t>({0, 3}));
+	// `sum` computes two window columns
+	EXPECT_EQ(result[1].first, "LogicalProject(sum_keys=[CASE(>(COUNT($0) OVER (PARTITION BY $2), 0), $SUM0($0) OVER (PARTITION BY $2), null:INTEGER)])");
+	EXPECT_EQ(result[1].second, std::vector<std::size_t>({1, 2}));
+}
+
 TEST_F(ExpressionUtilsTest, removing_over_expression) {
 
 	std::string query_part_1 = "max_prices=[MAX($0) OVER (PARTITION BY $2, $4)]";
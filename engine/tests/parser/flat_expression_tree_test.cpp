@@ -0,0 +1,149 @@
+#include "parser/flat_expression_tree.hpp"
+#include <gtest/gtest.h>
+
+using namespace ral::parser;
+
+namespace {
+
+// Project and filter expressions as calcite generates them for TPC-H queries
+const std::vector<std::string> tpch_expressions{
+	// Q1
+	"*(*($5, -(1, $6)), +(1, $7))",
+	"AND(<=($10, -(1998-12-01, 7776000000:INTERVAL DAY)), IS_NOT_NULL($4))",
+	// Q3
+	"*($5, -(1, $6))",
+	"AND(=($6, 'BUILDING'), <($12, 1995-03-15), >($20, 1995-03-15))",
+	// Q6
+	"AND(>=($10, 1994-01-01), <($10, 1995-01-01), >=($6, 0.05), <=($6, 0.07), <($4, 24))",
+	// Q12
+	"CASE(OR(=($5, '1-URGENT'), =($5, '2-HIGH')), 1, 0)",
+	"CASE(AND(<>($5, '1-URGENT'), <>($5, '2-HIGH')), 1, 0)",
+	// Q14
+	"CASE(LIKE($4, 'PROMO%'), *($5, -(1, $6)), 0:DOUBLE)",
+	"/(*(100.00:DOUBLE, CAST($0):DOUBLE), CAST($1):DOUBLE)",
+	// Q19
+	"OR(AND(=($1, 'Brand#12'), >=($4, 1), <=($4, +(1, 10)), >=(CAST($2):INTEGER, 1), <=(CAST($2):INTEGER, 5)), "
+	"AND(=($1, 'Brand#23'), >=($4, 10), <=($4, +(10, 10)), >=(CAST($2):INTEGER, 1), <=(CAST($2):INTEGER, 10)), "
+	"AND(=($1, 'Brand#34'), >=($4, 20), <=($4, +(20, 10)), >=(CAST($2):INTEGER, 1), <=(CAST($2):INTEGER, 15)))",
+	// Custom ops
+	"ROUND(+($0, CAST(4:INTEGER):BIGINT))",
+	"Reinterpret(+($0, CASE(<($0, 5), CASE(<($0, 2), 0, 1), 2)))",
+};
+
+struct counting_visitor : public node_visitor {
+	void visit(const operad_node & /*node*/) override { operands++; }
+	void visit(const operator_node & /*node*/) override { operators++; }
+
+	size_t operands = 0;
+	size_t operators = 0;
+};
+
+} // namespace
+
+struct FlatExpressionTreeTest : public ::testing::Test {};
+
+TEST_F(FlatExpressionTreeTest, build_matches_parse_tree) {
+	for (auto & expression : tpch_expressions) {
+		parse_tree tree;
+		tree.build(expression);
+		flat_tree flat = flat_tree::build(expression);
+
+		EXPECT_EQ(flat.rebuildExpression(), tree.rebuildExpression());
+		EXPECT_TRUE(flat == flat_tree::from_tree(tree.root()));
+		EXPECT_EQ(detail::rebuild_helper(flat.to_tree().get()), tree.rebuildExpression());
+	}
+}
+
+TEST_F(FlatExpressionTreeTest, transform_to_custom_op_matches_parse_tree) {
+	for (auto & expression : tpch_expressions) {
+		parse_tree tree;
+		tree.build(expression);
+		tree.transform_to_custom_op();
+
+		flat_tree flat = flat_tree::build(expression);
+		flat.transform_to_custom_op();
+
+		EXPECT_EQ(flat.rebuildExpression(), tree.rebuildExpression());
+		EXPECT_TRUE(flat == flat_tree::from_tree(tree.root()));
+	}
+}
+
+TEST_F(FlatExpressionTreeTest, literal_types) {
+	flat_tree flat = flat_tree::build("+(CAST(4:INTEGER):BIGINT, 2.5)");
+	flat.transform_to_custom_op();
+
+	auto root = flat.root();
+	ASSERT_EQ(flat.num_children(root), 2);
+	EXPECT_EQ(flat.type(flat.child(root, 0)), node_type::LITERAL);
+	EXPECT_EQ(flat.literal_type(flat.child(root, 0)).id(), cudf::type_id::INT64);
+	EXPECT_EQ(flat.literal_type(flat.child(root, 1)).id(), cudf::type_id::FLOAT32);
+
+	flat_tree variables = flat_tree::build("*($12, $3)");
+	EXPECT_EQ(variables.variable_index(variables.child(variables.root(), 0)), 12);
+	EXPECT_EQ(variables.variable_index(variables.child(variables.root(), 1)), 3);
+}
+
+TEST_F(FlatExpressionTreeTest, structural_hash) {
+	auto pool = std::make_shared<string_pool>();
+	flat_tree a = flat_tree::build("+(*($0, $1), 1)", pool);
+	flat_tree b = flat_tree::build("+(*($0, $1), 1)");
+	flat_tree c = flat_tree::build("+(*($0, $1), 1.0)", pool);
+	flat_tree d = flat_tree::build("+(*($1, $0), 1)", pool);
+	flat_tree e = flat_tree::build("+(1, *($0, $1))", pool);
+
+	EXPECT_EQ(a.hash(), b.hash());
+	EXPECT_TRUE(a == b);
+	EXPECT_FALSE(a == c);
+	EXPECT_NE(a.hash(), d.hash());
+	EXPECT_NE(a.hash(), e.hash());
+
+	// The subtree *($0, $1) is shared by a and e
+	EXPECT_EQ(a.hash(a.child(a.root(), 0)), e.hash(e.child(e.root(), 1)));
+	EXPECT_TRUE(a.equal(a.child(a.root(), 0), e, e.child(e.root(), 1)));
+}
+
+TEST_F(FlatExpressionTreeTest, strings_are_interned) {
+	auto pool = std::make_shared<string_pool>();
+	flat_tree a = flat_tree::build("+(+($0, $0), +($0, 1))", pool);
+	EXPECT_EQ(pool->size(), 3);
+
+	flat_tree b = a.clone();
+	b.transform_to_custom_op();
+	flat_tree::build("+($0, 1)", pool);
+	EXPECT_EQ(pool->size(), 3);
+	EXPECT_EQ(a.value_id(a.root()), b.value_id(b.root()));
+}
+
+TEST_F(FlatExpressionTreeTest, clone_is_independent) {
+	flat_tree a = flat_tree::build("CASE(<($0, 5), *($0, 2), $0)");
+	flat_tree b = a.clone();
+	b.transform_to_custom_op();
+
+	EXPECT_EQ(a.rebuildExpression(), "CASE(<($0, 5), *($0, 2), $0)");
+	EXPECT_EQ(b.rebuildExpression(), "FIRST_NON_MAGIC(MAGIC_IF_NOT(<($0, 5), *($0, 2)), $0)");
+}
+
+TEST_F(FlatExpressionTreeTest, compact) {
+	flat_tree flat = flat_tree::build("+($0, 1)");
+	auto variable = flat.child(flat.root(), 0);
+	auto literal = flat.add_literal("3", cudf::data_type{cudf::type_id::INT32});
+	flat.set_root(flat.add_operator("*", std::vector<flat_tree::node_id>{variable, literal}));
+	EXPECT_EQ(flat.size(), 5);
+
+	flat.compact();
+	EXPECT_EQ(flat.size(), 3);
+	EXPECT_EQ(flat.rebuildExpression(), "*($0, 3)");
+}
+
+TEST_F(FlatExpressionTreeTest, compatibility_with_visitors_and_transformers) {
+	flat_tree flat = flat_tree::build("CASE(<($0, 5), *($0, 2), $0)");
+
+	counting_visitor visitor;
+	flat.visit(visitor);
+	EXPECT_EQ(visitor.operands, 5);
+	EXPECT_EQ(visitor.operators, 3);
+
+	detail::custom_op_transformer transformer;
+	flat.transform(transformer);
+	EXPECT_EQ(flat.rebuildExpression(), "FIRST_NON_MAGIC(MAGIC_IF_NOT(<($0, 5), *($0, 2)), $0)");
+}
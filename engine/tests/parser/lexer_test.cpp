@@ -0,0 +1,127 @@
+#include "parser/expression_tree.hpp"
+#include <gtest/gtest.h>
+#include <random>
+#include <regex>
+
+using ral::parser::detail::lexer;
+
+namespace {
+
+// The regular expressions the lexer used to be implemented with, the hand
+// written matchers must accept exactly the same prefixes
+const std::regex variable_regex{R"(^\$\d+)"};
+const std::regex null_regex{R"(^null)"};
+const std::regex boolean_regex{R"(^(?:true|false))"};
+const std::regex number_regex{R"(^[-+]?\d*\.?\d+([eE][-+]?\d+)?)"};
+const std::regex timestamp_regex{R"(^\d{4}-\d{2}-\d{2}(?:[ T]\d{2}:\d{2}:\d{2})?)"};
+const std::regex string_regex{R"(^(["'])(?:(?!\1|\\).|\\.)*?\1)"};
+
+size_t regex_match_length(const std::string & text, const std::regex & regex) {
+	std::smatch match;
+	return std::regex_search(text, match, regex) ? match.length() : 0;
+}
+
+size_t matcher_length(const std::string & text, size_t (*matcher)(const char *, const char *)) {
+	return matcher(text.data(), text.data() + text.size());
+}
+
+std::string random_text(std::mt19937 & generator, const std::string & alphabet, size_t max_length) {
+	std::uniform_int_distribution<size_t> length_distribution(0, max_length);
+	std::uniform_int_distribution<size_t> char_distribution(0, alphabet.size() - 1);
+
+	std::string text(length_distribution(generator), ' ');
+	for (auto & ch : text) {
+		ch = alphabet[char_distribution(generator)];
+	}
+	return text;
+}
+
+std::vector<lexer::token> tokenize(const std::string & text) {
+	lexer lex(text);
+	std::vector<lexer::token> tokens;
+	for (auto token = lex.next_token(); token.type != lexer::token_type::EOF_; token = lex.next_token()) {
+		tokens.push_back(token);
+	}
+	return tokens;
+}
+
+} // namespace
+
+struct LexerTest : public ::testing::Test {
+	void check_matchers(const std::string & alphabet, size_t max_length, size_t iterations) {
+		std::mt19937 generator(42);
+		for (size_t i = 0; i < iterations; i++) {
+			std::string text = random_text(generator, alphabet, max_length);
+			ASSERT_EQ(matcher_length(text, lexer::match_variable), regex_match_length(text, variable_regex)) << text;
+			ASSERT_EQ(matcher_length(text, lexer::match_null), regex_match_length(text, null_regex)) << text;
+			ASSERT_EQ(matcher_length(text, lexer::match_boolean), regex_match_length(text, boolean_regex)) << text;
+			ASSERT_EQ(matcher_length(text, lexer::match_number), regex_match_length(text, number_regex)) << text;
+			ASSERT_EQ(matcher_length(text, lexer::match_timestamp), regex_match_length(text, timestamp_regex)) << text;
+			ASSERT_EQ(matcher_length(text, lexer::match_string), regex_match_length(text, string_regex)) << text;
+		}
+	}
+};
+
+TEST_F(LexerTest, matchers_agree_with_regex_on_numbers) {
+	check_matchers("0123456789.eE-+ a", 12, 20000);
+}
+
+TEST_F(LexerTest, matchers_agree_with_regex_on_timestamps) {
+	check_matchers("0123456789-: T", 24, 20000);
+}
+
+TEST_F(LexerTest, matchers_agree_with_regex_on_strings) {
+	check_matchers("\"'\\a\n ", 10, 20000);
+}
+
+TEST_F(LexerTest, matchers_agree_with_regex_on_keywords) {
+	check_matchers("$0123nultrefas", 8, 20000);
+}
+
+TEST_F(LexerTest, matchers_agree_with_regex_on_edge_cases) {
+	std::vector<std::string> texts{"", "$", "$12a", "-", ".", "1.", "-.5", "1e", "1e+", "2.5E-3x", "+7",
+		"2020-01-01", "2020-01-01 10:11:12", "2020-01-01T10:11", "2020-1-01", "''", "'a\\'b'", "\"a'b\"",
+		"'abc", "'a\\", "nul", "nullable", "tru", "falsey"};
+	for (auto & text : texts) {
+		EXPECT_EQ(matcher_length(text, lexer::match_variable), regex_match_length(text, variable_regex)) << text;
+		EXPECT_EQ(matcher_length(text, lexer::match_null), regex_match_length(text, null_regex)) << text;
+		EXPECT_EQ(matcher_length(text, lexer::match_boolean), regex_match_length(text, boolean_regex)) << text;
+		EXPECT_EQ(matcher_length(text, lexer::match_number), regex_match_length(text, number_regex)) << text;
+		EXPECT_EQ(matcher_length(text, lexer::match_timestamp), regex_match_length(text, timestamp_regex)) << text;
+		EXPECT_EQ(matcher_length(text, lexer::match_string), regex_match_length(text, string_regex)) << text;
+	}
+}
+
+TEST_F(LexerTest, tokens) {
+	auto tokens = tokenize("CASE(>($0, -1.5e3), CAST('it''s'):VARCHAR, null, true, 2020-01-01 10:00:00, \"a\\\"b\")");
+
+	std::vector<std::pair<lexer::token_type, std::string>> expected{
+		{lexer::token_type::Identifier, "CASE"}, {lexer::token_type::ParenthesisOpen, "("},
+		{lexer::token_type::Identifier, ">"}, {lexer::token_type::ParenthesisOpen, "("},
+		{lexer::token_type::Variable, "$0"}, {lexer::token_type::Comma, ","},
+		{lexer::token_type::Number, "-1.5e3"}, {lexer::token_type::ParenthesisClose, ")"},
+		{lexer::token_type::Comma, ","}, {lexer::token_type::Identifier, "CAST"},
+		{lexer::token_type::ParenthesisOpen, "("}, {lexer::token_type::String, "'it'"},
+		{lexer::token_type::String, "'s'"}, {lexer::token_type::ParenthesisClose, ")"},
+		{lexer::token_type::Colon, ":"}, {lexer::token_type::Identifier, "VARCHAR"},
+		{lexer::token_type::Comma, ","}, {lexer::token_type::Null, "null"},
+		{lexer::token_type::Comma, ","}, {lexer::token_type::Boolean, "true"},
+		{lexer::token_type::Comma, ","}, {lexer::token_type::Timestamp, "2020-01-01 10:00:00"},
+		{lexer::token_type::Comma, ","}, {lexer::token_type::String, "\"a\\\"b\""},
+		{lexer::token_type::ParenthesisClose, ")"}};
+
+	ASSERT_EQ(tokens.size(), expected.size());
+	for (size_t i = 0; i < tokens.size(); i++) {
+		EXPECT_EQ(tokens[i].type, expected[i].first) << i;
+		EXPECT_EQ(tokens[i].value, expected[i].second) << i;
+	}
+}
+
+TEST_F(LexerTest, long_expression) {
+	std::string expression = "$0";
+	for (int i = 0; i < 2000; i++) {
+		expression = "+(" + expression + ", CASE(>($" + std::to_string(i) + ", 1.5), 'abc', 2020-01-01))";
+	}
+
+	EXPECT_EQ(tokenize(expression).size(), 1 + 2000 * 17);
+}
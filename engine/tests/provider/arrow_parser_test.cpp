@@ -0,0 +1,99 @@
+#include <algorithm>
+#include <arrow/api.h>
+#include <cudf_test/column_wrapper.hpp>
+#include <cudf_test/table_utilities.hpp>
+#include "tests/utilities/BlazingUnitTest.h"
+#include "io/data_parser/ArrowParser.h"
+
+using ral::io::arrow_parser;
+
+namespace {
+
+// ids that are null every 3 rows, names and flags
+std::shared_ptr<arrow::Table> make_table(int64_t num_rows = 20) {
+	arrow::Int64Builder ids;
+	arrow::StringBuilder names;
+	arrow::BooleanBuilder flags;
+	for (int64_t i = 0; i < num_rows; i++) {
+		if (i % 3 == 0) {
+			EXPECT_TRUE(ids.AppendNull().ok());
+		} else {
+			EXPECT_TRUE(ids.Append(i).ok());
+		}
+		EXPECT_TRUE(names.Append("name" + std::to_string(i)).ok());
+		EXPECT_TRUE(flags.Append(i % 2 == 0).ok());
+	}
+	auto schema = arrow::schema({arrow::field("id", arrow::int64()), arrow::field("name", arrow::utf8()), arrow::field("flag", arrow::boolean())});
+	return arrow::Table::Make(schema, {ids.Finish().ValueOrDie(), names.Finish().ValueOrDie(), flags.Finish().ValueOrDie()});
+}
+
+} // namespace
+
+struct ArrowParserTest : public BlazingUnitTest {};
+
+TEST_F(ArrowParserTest, wraps_the_table_in_a_host_table) {
+	arrow_parser parser(make_table());
+
+	auto host_tables = parser.get_host_tables({0, 1}, 0);
+
+	ASSERT_EQ(host_tables.size(), 1);
+	EXPECT_EQ(host_tables[0]->num_rows(), 20);
+	EXPECT_EQ(host_tables[0]->names(), std::vector<std::string>({"id", "name"}));
+	auto table = host_tables[0]->get_gpu_table();
+	EXPECT_EQ(table->num_rows(), 20);
+	EXPECT_EQ(table->view().column(0).null_count(), 7);
+}
+
+TEST_F(ArrowParserTest, slices_that_do_not_start_on_a_byte_are_rebased) {
+	// a slice of 4 rows starting at row 5, its null mask and string offsets do not start at 0
+	auto table = make_table()->Slice(5, 4);
+	arrow_parser parser(table);
+
+	auto host_tables = parser.get_host_tables({0, 1, 2}, 0);
+
+	ASSERT_EQ(host_tables.size(), 1);
+	auto gpu_table = host_tables[0]->get_gpu_table();
+	cudf::test::fixed_width_column_wrapper<int64_t> expected_ids({5, 0, 7, 8}, {1, 0, 1, 1});
+	cudf::test::strings_column_wrapper expected_names({"name5", "name6", "name7", "name8"});
+	cudf::test::fixed_width_column_wrapper<bool> expected_flags({false, true, false, true});
+	cudf::test::expect_tables_equal(cudf::table_view{{expected_ids, expected_names, expected_flags}}, gpu_table->view());
+}
+
+TEST_F(ArrowParserTest, splits_big_tables_into_tables_of_whole_bytes_of_rows) {
+	arrow_parser parser(make_table(500));
+
+	// the 500 rows take about 9.5KB, so a table of 2000 bytes gets 105 rows, rounded up to 128
+	auto host_tables = parser.get_host_tables({0, 1, 2}, 2000);
+	ASSERT_EQ(host_tables.size(), 4);
+
+	// the tables after the first one start past row 0 on a byte, so their null masks point into the one of the whole table
+	for (size_t table_index = 0; table_index < host_tables.size(); table_index++) {
+		int64_t first_row = table_index * 128;
+		int64_t num_rows = std::min<int64_t>(128, 500 - first_row);
+		std::vector<int64_t> ids;
+		std::vector<bool> valid_ids;
+		std::vector<std::string> names;
+		std::vector<bool> flags;
+		int null_count = 0;
+		for (int64_t i = first_row; i < first_row + num_rows; i++) {
+			ids.push_back(i);
+			valid_ids.push_back(i % 3 != 0);
+			null_count += i % 3 == 0 ? 1 : 0;
+			names.push_back("name" + std::to_string(i));
+			flags.push_back(i % 2 == 0);
+		}
+		cudf::test::fixed_width_column_wrapper<int64_t> expected_ids(ids.begin(), ids.end(), valid_ids.begin());
+		cudf::test::strings_column_wrapper expected_names(names.begin(), names.end());
+		cudf::test::fixed_width_column_wrapper<bool> expected_flags(flags.begin(), flags.end());
+
+		EXPECT_EQ(host_tables[table_index]->num_rows(), num_rows);
+		EXPECT_EQ(host_tables[table_index]->names(), std::vector<std::string>({"id", "name", "flag"}));
+		auto gpu_table = host_tables[table_index]->get_gpu_table();
+		EXPECT_EQ(gpu_table->view().column(0).null_count(), null_count);
+		cudf::test::expect_tables_equal(cudf::table_view{{expected_ids, expected_names, expected_flags}}, gpu_table->view());
+	}
+
+	auto empty_tables = arrow_parser(make_table()->Slice(0, 0)).get_host_tables({0, 1}, 0);
+	ASSERT_EQ(empty_tables.size(), 1);
+	EXPECT_EQ(empty_tables[0]->get_gpu_table()->num_rows(), 0);
+}
@@ -0,0 +1,93 @@
+#include <fstream>
+#include <arrow/io/file.h>
+#include "tests/utilities/BlazingUnitTest.h"
+#include "io/data_parser/CSVChunkPlanner.h"
+
+using ral::io::csv_chunk_planner;
+using ral::io::csv_file_chunks;
+
+namespace {
+
+std::shared_ptr<arrow::io::RandomAccessFile> write_csv(const std::string & filename, const std::string & content) {
+	std::ofstream outfile(filename, std::ofstream::out | std::ofstream::binary);
+	outfile << content;
+	outfile.close();
+	return arrow::io::ReadableFile::Open(filename).ValueOrDie();
+}
+
+std::string read_range(const std::string & content, std::pair<int64_t, int64_t> range) {
+	return content.substr(range.first, range.second - range.first);
+}
+
+} // namespace
+
+struct CsvChunkPlannerTest : public BlazingUnitTest {};
+
+TEST_F(CsvChunkPlannerTest, chunks_start_on_records) {
+	std::string content = "id,name\n1,aaaa\n2,bbbb\n3,cccc\n4,dddd\n";
+	auto file = write_csv("/tmp/csv_chunk_planner_records.csv", content);
+
+	csv_file_chunks chunks = csv_chunk_planner('\n', '"', ',', true, 10).plan_file(file);
+
+	EXPECT_EQ(chunks.header, "id,name\n");
+	ASSERT_EQ(chunks.ranges.size(), 3);
+	EXPECT_EQ(read_range(content, chunks.ranges[0]), "1,aaaa\n2,bbbb\n");
+	EXPECT_EQ(read_range(content, chunks.ranges[1]), "3,cccc\n");
+	EXPECT_EQ(read_range(content, chunks.ranges[2]), "4,dddd\n");
+}
+
+TEST_F(CsvChunkPlannerTest, quoted_line_terminators_do_not_split) {
+	std::string content = "1,\"a\nb,\"\"c\nd\"\n2,\"e\"\n3,f\n";
+	auto file = write_csv("/tmp/csv_chunk_planner_quotes.csv", content);
+
+	csv_chunk_planner planner('\n', '"', ',', false, 4);
+	csv_file_chunks chunks = planner.plan_file(file);
+
+	EXPECT_EQ(chunks.header, "");
+	ASSERT_EQ(chunks.ranges.size(), 3);
+	EXPECT_EQ(read_range(content, chunks.ranges[0]), "1,\"a\nb,\"\"c\nd\"\n");
+	EXPECT_EQ(read_range(content, chunks.ranges[1]), "2,\"e\"\n");
+	EXPECT_EQ(read_range(content, chunks.ranges[2]), "3,f\n");
+
+	// a split point right after a record boundary keeps it
+	EXPECT_EQ(planner.find_record_start(file, 14, content.size()), 14);
+	EXPECT_EQ(planner.find_record_start(file, 3, content.size()), 14);
+}
+
+TEST_F(CsvChunkPlannerTest, plans_files_without_data_and_without_trailing_terminator) {
+	auto header_only = write_csv("/tmp/csv_chunk_planner_header_only.csv", "a,b\n");
+	std::string content = "a,b\n1,2\n3,4";
+	auto no_terminator = write_csv("/tmp/csv_chunk_planner_no_terminator.csv", content);
+
+	std::vector<csv_file_chunks> plans = csv_chunk_planner('\n', '"', ',', true, 3).plan_files({header_only, no_terminator});
+
+	ASSERT_EQ(plans.size(), 2);
+	EXPECT_EQ(plans[0].header, "a,b\n");
+	ASSERT_EQ(plans[0].ranges.size(), 1);
+	EXPECT_EQ(plans[0].ranges[0].first, plans[0].ranges[0].second);
+
+	EXPECT_EQ(plans[1].header, "a,b\n");
+	ASSERT_EQ(plans[1].ranges.size(), 2);
+	EXPECT_EQ(read_range(content, plans[1].ranges[0]), "1,2\n");
+	EXPECT_EQ(read_range(content, plans[1].ranges[1]), "3,4");
+}
+
+TEST_F(CsvChunkPlannerTest, json_lines_split_on_every_line) {
+	std::string content = "{\"a\":1,\"b\":\"x,\\\"y\"}\n{\"a\":2,\"b\":\"\\\"\"}\n{\"a\":3,\"b\":\"z\"}\n";
+	auto file = write_csv("/tmp/csv_chunk_planner_lines.json", content);
+
+	csv_file_chunks chunks = csv_chunk_planner('\n', '\0', ',', false, 8).plan_file(file);
+
+	EXPECT_EQ(chunks.header, "");
+	ASSERT_EQ(chunks.ranges.size(), 3);
+	EXPECT_EQ(read_range(content, chunks.ranges[0]), "{\"a\":1,\"b\":\"x,\\\"y\"}\n");
+	EXPECT_EQ(read_range(content, chunks.ranges[1]), "{\"a\":2,\"b\":\"\\\"\"}\n");
+	EXPECT_EQ(read_range(content, chunks.ranges[2]), "{\"a\":3,\"b\":\"z\"}\n");
+
+	auto chunk_file = ral::io::read_csv_chunks(chunks, file, {0, 2});
+	int64_t size = chunk_file->GetSize().ValueOrDie();
+	auto buffer = chunk_file->ReadAt(0, size).ValueOrDie();
+	EXPECT_EQ(buffer->ToString(), read_range(content, chunks.ranges[0]) + read_range(content, chunks.ranges[2]));
+
+	EXPECT_EQ(ral::io::read_csv_chunks(chunks, file, {}), nullptr);
+}
@@ -0,0 +1,103 @@
+#include <fstream>
+#include "tests/utilities/BlazingUnitTest.h"
+#include "io/data_provider/FileHandlePool.h"
+#include "io/data_provider/UriDataProvider.h"
+
+using ral::io::file_handle_pool;
+
+namespace {
+
+std::vector<Uri> write_files(const std::string & prefix, size_t num_files) {
+	std::vector<Uri> uris;
+	for (size_t i = 0; i < num_files; i++) {
+		std::string filename = prefix + std::to_string(i) + ".txt";
+		std::ofstream outfile(filename, std::ofstream::out | std::ofstream::binary);
+		outfile << "file " << i;
+		uris.push_back(Uri{filename});
+	}
+	return uris;
+}
+
+std::string read_all(std::shared_ptr<arrow::io::RandomAccessFile> file) {
+	int64_t size = file->GetSize().ValueOrDie();
+	std::string content(size, '\0');
+	file->ReadAt(0, size, &content[0]).ValueOrDie();
+	return content;
+}
+
+} // namespace
+
+struct FileHandlePoolTest : public BlazingUnitTest {};
+
+TEST_F(FileHandlePoolTest, open_files_stay_within_the_limit) {
+	auto uris = write_files("/tmp/file_handle_pool_limit_", 20);
+	auto pool = std::make_shared<file_handle_pool>(4, 0, 0);
+
+	std::vector<std::shared_ptr<arrow::io::RandomAccessFile>> files;
+	for (auto & uri : uris) {
+		files.push_back(pool->open(uri));
+		EXPECT_LE(pool->get_num_open_files(), 4);
+	}
+
+	// the files closed by the pool are opened again when they are read
+	for (size_t i = 0; i < files.size(); i++) {
+		EXPECT_EQ(read_all(files[i]), "file " + std::to_string(i));
+		EXPECT_LE(pool->get_num_open_files(), 4);
+	}
+
+	for (auto & file : files) {
+		file->Close();
+	}
+	EXPECT_EQ(pool->get_num_open_files(), 0);
+	EXPECT_FALSE(files[0]->ReadAt(0, 1).ok());
+}
+
+TEST_F(FileHandlePoolTest, sequential_reads_keep_their_position) {
+	auto uris = write_files("/tmp/file_handle_pool_position_", 3);
+	auto pool = std::make_shared<file_handle_pool>(1, 0, 0);
+
+	auto first = pool->open(uris[0]);
+	auto second = pool->open(uris[1]);
+	char buffer[4];
+	ASSERT_EQ(first->Read(3, buffer).ValueOrDie(), 3);
+	ASSERT_EQ(second->Read(4, buffer).ValueOrDie(), 4);
+	ASSERT_EQ(first->Read(3, buffer).ValueOrDie(), 3);
+	EXPECT_EQ(std::string(buffer, 3), "e 0");
+	EXPECT_EQ(first->Tell().ValueOrDie(), 6);
+}
+
+TEST_F(FileHandlePoolTest, prefetched_files_are_opened_in_the_background) {
+	auto uris = write_files("/tmp/file_handle_pool_prefetch_", 8);
+	auto pool = std::make_shared<file_handle_pool>(4, 2, 4);
+
+	pool->prefetch(uris);
+	std::vector<std::shared_ptr<arrow::io::RandomAccessFile>> files;
+	for (size_t i = 0; i < uris.size(); i++) {
+		files.push_back(pool->open(uris[i]));
+		EXPECT_LE(pool->get_num_open_files(), 4);
+	}
+	for (size_t i = 0; i < files.size(); i++) {
+		EXPECT_EQ(read_all(files[i]), "file " + std::to_string(i));
+	}
+}
+
+TEST_F(FileHandlePoolTest, missing_files_fail_when_opened) {
+	auto pool = std::make_shared<file_handle_pool>(4, 2, 4);
+	pool->prefetch({Uri{"/tmp/file_handle_pool_missing.txt"}});
+	EXPECT_ANY_THROW(pool->open(Uri{"/tmp/file_handle_pool_missing.txt"}));
+	EXPECT_EQ(pool->get_num_open_files(), 0);
+}
+
+TEST_F(FileHandlePoolTest, provider_reads_every_file) {
+	auto uris = write_files("/tmp/file_handle_pool_provider_", 30);
+	ral::io::uri_data_provider provider(uris);
+
+	size_t num_files = 0;
+	while (provider.has_next()) {
+		auto handle = provider.get_next(true);
+		ASSERT_NE(handle.file_handle, nullptr);
+		EXPECT_EQ(read_all(handle.file_handle), "file " + std::to_string(num_files));
+		num_files++;
+	}
+	EXPECT_EQ(num_files, uris.size());
+}
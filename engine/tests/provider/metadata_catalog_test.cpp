@@ -0,0 +1,218 @@
+#include <fstream>
+
+#include <dirent.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <utime.h>
+
+#include <arrow/io/file.h>
+#include <cudf_test/column_wrapper.hpp>
+#include <cudf_test/table_utilities.hpp>
+#include "tests/utilities/BlazingUnitTest.h"
+#include "io/MetadataCatalog.h"
+
+using ral::io::metadata_catalog;
+using ral::io::row_group_stats;
+
+namespace {
+
+/**
+ * A Parquet parser that makes up what it reads from the footer and counts how many times it is read.
+ */
+class footer_parser : public ral::io::data_parser {
+public:
+	void parse_schema(std::shared_ptr<arrow::io::RandomAccessFile> /*file*/, ral::io::Schema & schema) override {
+		num_schema_reads++;
+		schema.add_column("a", cudf::type_id::INT64, 0, true);
+		schema.add_column("t", cudf::type_id::TIMESTAMP_MILLISECONDS, 1, true);
+	}
+
+	std::vector<row_group_stats> get_row_group_stats(std::shared_ptr<arrow::io::RandomAccessFile> /*file*/) override {
+		num_stats_reads++;
+		return {{10, 80, {{"a", 80}, {"t", 80}}}, {5, 40, {{"a", 40}, {"t", 40}}}};
+	}
+
+	std::unique_ptr<ral::frame::BlazingTable> get_metadata(
+		std::vector<std::shared_ptr<arrow::io::RandomAccessFile>> /*files*/, int offset) override {
+		num_metadata_reads++;
+		return make_metadata(offset);
+	}
+
+	ral::io::DataType type() const override { return ral::io::DataType::PARQUET; }
+
+	// the min/max metadata of the two row groups of a file
+	static std::unique_ptr<ral::frame::BlazingTable> make_metadata(int32_t file_handle_index) {
+		cudf::test::fixed_width_column_wrapper<int32_t> file_handle_indices({file_handle_index, file_handle_index});
+		cudf::test::fixed_width_column_wrapper<int32_t> row_group_indices({0, 1});
+		cudf::test::fixed_width_column_wrapper<int64_t> min_a({0, 10});
+		cudf::test::fixed_width_column_wrapper<int64_t> max_a({9, 14});
+		cudf::test::fixed_width_column_wrapper<cudf::timestamp_ms, cudf::timestamp_ms::rep> min_t({1000, 5000});
+		cudf::test::fixed_width_column_wrapper<cudf::timestamp_ms, cudf::timestamp_ms::rep> max_t({4000, 9000});
+		auto table = std::make_unique<cudf::table>(cudf::table_view{{file_handle_indices, row_group_indices, min_a, max_a, min_t, max_t}});
+		std::vector<std::string> names{"file_handle_index", "row_group_index", "min_0_a", "max_0_a", "min_1_t", "max_1_t"};
+		return std::make_unique<ral::frame::BlazingTable>(std::move(table), names);
+	}
+
+	int num_schema_reads = 0;
+	int num_stats_reads = 0;
+	int num_metadata_reads = 0;
+};
+
+void write_file(const std::string & path, const std::string & content) {
+	std::ofstream(path, std::ofstream::binary | std::ofstream::trunc) << content;
+}
+
+// sets the modification time of a file, in seconds
+void set_modification_time(const std::string & path, time_t modification_time) {
+	struct utimbuf times{modification_time, modification_time};
+	ASSERT_EQ(utime(path.c_str(), &times), 0);
+}
+
+void expect_same_stats(const std::vector<row_group_stats> & expected, const std::vector<row_group_stats> & actual) {
+	ASSERT_EQ(expected.size(), actual.size());
+	for (size_t i = 0; i < expected.size(); i++) {
+		EXPECT_EQ(expected[i].num_rows, actual[i].num_rows);
+		EXPECT_EQ(expected[i].num_bytes, actual[i].num_bytes);
+		EXPECT_EQ(expected[i].column_bytes, actual[i].column_bytes);
+	}
+}
+
+} // namespace
+
+struct MetadataCatalogTest : public BlazingUnitTest {
+	void SetUp() override {
+		BlazingUnitTest::SetUp();
+		char directory_template[] = "/tmp/metadata_catalog_test_XXXXXX";
+		ASSERT_NE(mkdtemp(directory_template), nullptr);
+		directory = directory_template;
+		data_path = directory + ".data";
+		write_file(data_path, "some data");
+		set_modification_time(data_path, 1000000);
+	}
+
+	void TearDown() override {
+		remove_entries();
+		rmdir(directory.c_str());
+		std::remove(data_path.c_str());
+		BlazingUnitTest::TearDown();
+	}
+
+	ral::io::data_handle make_handle() {
+		ral::io::data_handle handle;
+		handle.file_handle = arrow::io::ReadableFile::Open(data_path).ValueOrDie();
+		handle.uri = Uri{data_path};
+		return handle;
+	}
+
+	std::vector<std::string> list_entries() {
+		std::vector<std::string> entries;
+		DIR * dir = opendir(directory.c_str());
+		for (struct dirent * entry = readdir(dir); entry != nullptr; entry = readdir(dir)) {
+			std::string name = entry->d_name;
+			if (name != "." && name != "..") {
+				entries.push_back(directory + "/" + name);
+			}
+		}
+		closedir(dir);
+		return entries;
+	}
+
+	void remove_entries() {
+		for (auto & entry : list_entries()) {
+			std::remove(entry.c_str());
+		}
+	}
+
+	std::string directory;
+	std::string data_path;
+	footer_parser parser;
+};
+
+TEST_F(MetadataCatalogTest, schemas_and_row_group_stats_are_read_once) {
+	metadata_catalog catalog(directory);
+	ASSERT_TRUE(catalog.is_enabled());
+	std::string parser_key = metadata_catalog::get_parser_key(ral::io::DataType::PARQUET, {});
+
+	ral::io::Schema schema;
+	catalog.parse_schema(parser, parser_key, make_handle(), schema);
+	ral::io::Schema cached_schema;
+	catalog.parse_schema(parser, parser_key, make_handle(), cached_schema);
+	EXPECT_EQ(parser.num_schema_reads, 1);
+	EXPECT_EQ(cached_schema.get_names(), std::vector<std::string>({"a", "t"}));
+	EXPECT_EQ(cached_schema.get_dtypes(), std::vector<cudf::type_id>({cudf::type_id::INT64, cudf::type_id::TIMESTAMP_MILLISECONDS}));
+
+	auto stats = catalog.get_row_group_stats(parser, make_handle());
+	auto cached_stats = catalog.get_row_group_stats(parser, make_handle());
+	EXPECT_EQ(parser.num_stats_reads, 1);
+	expect_same_stats(stats, cached_stats);
+}
+
+TEST_F(MetadataCatalogTest, metadata_keeps_its_types_and_points_to_the_file) {
+	metadata_catalog catalog(directory);
+
+	auto metadata = catalog.get_metadata(parser, {make_handle()}, 0);
+	auto cached_metadata = catalog.get_metadata(parser, {make_handle()}, 3);
+	EXPECT_EQ(parser.num_metadata_reads, 1);
+
+	// the timestamps come back with their resolution, and the file handle index with the new offset
+	cudf::test::expect_tables_equivalent(footer_parser::make_metadata(0)->view(), metadata->view());
+	cudf::test::expect_tables_equivalent(footer_parser::make_metadata(3)->view(), cached_metadata->view());
+	EXPECT_EQ(cached_metadata->names(), metadata->names());
+}
+
+TEST_F(MetadataCatalogTest, truncated_entries_are_read_from_the_file_again) {
+	metadata_catalog catalog(directory);
+	auto stats = catalog.get_row_group_stats(parser, make_handle());
+	catalog.get_metadata(parser, {make_handle()}, 0);
+
+	for (auto & entry : list_entries()) {
+		std::ifstream entry_file(entry, std::ios::binary);
+		std::string data((std::istreambuf_iterator<char>(entry_file)), std::istreambuf_iterator<char>());
+		entry_file.close();
+		write_file(entry, data.substr(0, data.size() - 5));
+	}
+
+	expect_same_stats(stats, catalog.get_row_group_stats(parser, make_handle()));
+	auto metadata = catalog.get_metadata(parser, {make_handle()}, 0);
+	// the metadata is read again, but the stats it needs were already read again just before
+	EXPECT_EQ(parser.num_stats_reads, 2);
+	EXPECT_EQ(parser.num_metadata_reads, 2);
+	cudf::test::expect_tables_equivalent(footer_parser::make_metadata(0)->view(), metadata->view());
+}
+
+TEST_F(MetadataCatalogTest, entries_are_dropped_when_the_file_changes) {
+	metadata_catalog catalog(directory);
+	catalog.get_row_group_stats(parser, make_handle());
+	catalog.get_row_group_stats(parser, make_handle());
+	EXPECT_EQ(parser.num_stats_reads, 1);
+
+	// same size, newer modification time
+	write_file(data_path, "more data");
+	set_modification_time(data_path, 2000000);
+	catalog.get_row_group_stats(parser, make_handle());
+	EXPECT_EQ(parser.num_stats_reads, 2);
+
+	// same modification time, another size
+	write_file(data_path, "some more data");
+	set_modification_time(data_path, 2000000);
+	catalog.get_row_group_stats(parser, make_handle());
+	EXPECT_EQ(parser.num_stats_reads, 3);
+
+	catalog.get_row_group_stats(parser, make_handle());
+	EXPECT_EQ(parser.num_stats_reads, 3);
+}
+
+TEST_F(MetadataCatalogTest, directories_other_users_can_write_to_are_not_used) {
+	EXPECT_FALSE(metadata_catalog("").is_enabled());
+
+	ASSERT_EQ(chmod(directory.c_str(), 0777), 0);
+	EXPECT_FALSE(metadata_catalog(directory).is_enabled());
+
+	// a new directory is created only accessible by the user
+	std::string new_directory = directory + "/catalog";
+	EXPECT_TRUE(metadata_catalog(new_directory).is_enabled());
+	struct stat status;
+	ASSERT_EQ(stat(new_directory.c_str(), &status), 0);
+	EXPECT_EQ(status.st_mode & 0777, 0700);
+	rmdir(new_directory.c_str());
+}
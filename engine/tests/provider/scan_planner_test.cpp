@@ -0,0 +1,116 @@
+#include "tests/utilities/BlazingUnitTest.h"
+#include "io/ScanPlanner.h"
+
+using ral::io::row_group_info;
+using ral::io::row_group_stats;
+using ral::io::scan_task;
+
+struct ScanPlannerTest : public BlazingUnitTest {};
+
+TEST_F(ScanPlannerTest, estimates_the_loaded_size_of_the_scanned_columns) {
+	ral::io::Schema schema;
+	schema.add_column("id", cudf::type_id::INT64, 0);
+	schema.add_column("name", cudf::type_id::STRING, 1);
+	schema.add_column("price", cudf::type_id::FLOAT32, 2);
+
+	std::vector<row_group_stats> row_groups = {
+		{100, 5000, {{"id", 800}, {"name", 3000}, {"price", 400}}},
+		{0, 700, {}},
+	};
+
+	std::vector<row_group_info> info = ral::io::get_row_group_info(row_groups, schema, {0, 1});
+
+	ASSERT_EQ(info.size(), 2);
+	EXPECT_EQ(info[0].index, 0);
+	EXPECT_EQ(info[0].num_rows, 100);
+	EXPECT_EQ(info[0].num_bytes, 100 * 8 + 3000 + 101 * sizeof(cudf::size_type));
+	EXPECT_EQ(info[1].index, 1);
+	EXPECT_EQ(info[1].num_rows, 0);
+	EXPECT_EQ(info[1].num_bytes, 700);
+}
+
+TEST_F(ScanPlannerTest, packs_small_row_groups_across_files) {
+	std::vector<std::vector<row_group_info>> files_row_groups = {
+		{{0, 10, 100}, {1, 10, 100}},
+		{{0, 10, 100}},
+		{{0, 10, 100}, {1, 10, 100}, {2, 10, 100}},
+	};
+
+	std::vector<scan_task> tasks = ral::io::plan_scan_tasks(files_row_groups, {}, 300);
+
+	ASSERT_EQ(tasks.size(), 2);
+	ASSERT_EQ(tasks[0].pieces.size(), 2);
+	EXPECT_EQ(tasks[0].num_bytes, 300);
+	EXPECT_EQ(tasks[0].pieces[0].file_index, 0);
+	EXPECT_EQ(tasks[0].pieces[0].row_group_ids, std::vector<int>({0, 1}));
+	EXPECT_EQ(tasks[0].pieces[1].file_index, 1);
+	EXPECT_EQ(tasks[0].pieces[1].num_rows, 10);
+	ASSERT_EQ(tasks[1].pieces.size(), 1);
+	EXPECT_EQ(tasks[1].pieces[0].file_index, 2);
+	EXPECT_EQ(tasks[1].pieces[0].row_group_ids, std::vector<int>({0, 1, 2}));
+}
+
+TEST_F(ScanPlannerTest, splits_big_files_by_row_group) {
+	std::vector<std::vector<row_group_info>> files_row_groups = {
+		{{0, 10, 200}, {1, 10, 500}, {2, 10, 100}, {3, 10, 100}},
+	};
+
+	std::vector<scan_task> tasks = ral::io::plan_scan_tasks(files_row_groups, {}, 300);
+
+	ASSERT_EQ(tasks.size(), 3);
+	EXPECT_EQ(tasks[0].pieces[0].row_group_ids, std::vector<int>({0}));
+	EXPECT_EQ(tasks[1].pieces[0].row_group_ids, std::vector<int>({1}));
+	EXPECT_EQ(tasks[1].num_bytes, 500);
+	EXPECT_EQ(tasks[2].pieces[0].row_group_ids, std::vector<int>({2, 3}));
+}
+
+TEST_F(ScanPlannerTest, keeps_the_selected_row_groups) {
+	std::vector<std::vector<row_group_info>> files_row_groups = {
+		{{0, 10, 100}, {1, 10, 100}, {2, 10, 100}},
+		{{0, 10, 100}, {1, 10, 100}},
+	};
+	std::vector<std::vector<int>> selected_row_groups = {{0, 2}, {}};
+
+	std::vector<scan_task> tasks = ral::io::plan_scan_tasks(files_row_groups, selected_row_groups, 1000);
+
+	ASSERT_EQ(tasks.size(), 1);
+	ASSERT_EQ(tasks[0].pieces.size(), 2);
+	EXPECT_EQ(tasks[0].pieces[0].row_group_ids, std::vector<int>({0, 2}));
+	EXPECT_EQ(tasks[0].pieces[1].row_group_ids, std::vector<int>({0, 1}));
+	EXPECT_EQ(tasks[0].num_bytes, 400);
+}
+
+TEST_F(ScanPlannerTest, files_without_row_group_info_are_read_whole) {
+	std::vector<std::vector<row_group_info>> files_row_groups = {
+		{{0, 10, 100}},
+		{},
+		{{0, 10, 100}},
+	};
+
+	std::vector<scan_task> tasks = ral::io::plan_scan_tasks(files_row_groups, {}, 1000);
+
+	ASSERT_EQ(tasks.size(), 3);
+	EXPECT_EQ(tasks[1].pieces[0].file_index, 1);
+	EXPECT_TRUE(tasks[1].pieces[0].row_group_ids.empty());
+	EXPECT_EQ(tasks[2].pieces[0].file_index, 2);
+}
+
+TEST_F(ScanPlannerTest, stops_planning_once_max_rows_are_planned) {
+	std::vector<std::vector<row_group_info>> files_row_groups = {
+		{{0, 10, 100}, {1, 10, 100}},
+		{{0, 10, 100}},
+	};
+
+	std::vector<scan_task> tasks = ral::io::plan_scan_tasks(files_row_groups, {}, 100, 15);
+
+	ASSERT_EQ(tasks.size(), 2);
+	EXPECT_EQ(tasks[0].pieces[0].row_group_ids, std::vector<int>({0}));
+	EXPECT_EQ(tasks[1].pieces[0].row_group_ids, std::vector<int>({1}));
+
+	// the row count of stripes is not known, so they are all planned
+	std::vector<std::vector<row_group_info>> files_stripes = {
+		{{0, 0, 100}, {1, 0, 100}},
+	};
+	tasks = ral::io::plan_scan_tasks(files_stripes, {}, 100, 15);
+	EXPECT_EQ(tasks.size(), 2);
+}
@@ -0,0 +1,72 @@
+#include <algorithm>
+#include <fstream>
+#include <gtest/gtest.h>
+#include "FileSystem/LocalFileSystem.h"
+#include "skip_data/PartitionPruner.h"
+
+using ral::skip_data::partition_pruner;
+
+namespace {
+
+const std::vector<std::string> column_names{"a", "b", "year", "month"};
+const std::vector<cudf::type_id> column_types{cudf::type_id::INT64, cudf::type_id::STRING, cudf::type_id::INT32, cudf::type_id::INT32};
+
+const std::string year_and_month_scan = "BindableTableScan(table=[[main, t]], filters=[[AND(=($2, 2020), >=($3, 6))]], "
+	"projects=[[0, 1, 2, 3]], aliases=[[a, b, year, month]])";
+
+} // namespace
+
+struct PartitionPrunerTest : public ::testing::Test {};
+
+TEST_F(PartitionPrunerTest, prunes_each_level) {
+	partition_pruner pruner(year_and_month_scan, column_names, column_types);
+
+	ASSERT_TRUE(pruner.has_filter());
+	EXPECT_TRUE(pruner.may_match({{"year", "2020"}}));
+	EXPECT_FALSE(pruner.may_match({{"year", "2019"}}));
+	EXPECT_FALSE(pruner.may_match({{"year", "2020"}, {"month", "5"}}));
+	EXPECT_TRUE(pruner.may_match({{"year", "2020"}, {"month", "7"}}));
+}
+
+TEST_F(PartitionPrunerTest, keeps_what_can_not_be_evaluated) {
+	partition_pruner or_pruner("BindableTableScan(table=[[main, t]], filters=[[OR(=($2, 2020), >($0, 5))]], "
+		"aliases=[[a, b, year, month]])", column_names, column_types);
+	EXPECT_TRUE(or_pruner.may_match({{"year", "2019"}}));
+
+	partition_pruner no_filter("BindableTableScan(table=[[main, t]], projects=[[0]], aliases=[[a]])", column_names, column_types);
+	EXPECT_FALSE(no_filter.has_filter());
+	EXPECT_TRUE(no_filter.may_match({{"year", "2019"}}));
+}
+
+TEST_F(PartitionPrunerTest, strings_and_dates) {
+	partition_pruner string_pruner("BindableTableScan(table=[[main, t]], filters=[[=($0, 'x')]], projects=[[1]], aliases=[[b]])",
+		column_names, column_types);
+	EXPECT_TRUE(string_pruner.may_match({{"b", "x"}}));
+	EXPECT_FALSE(string_pruner.may_match({{"b", "y"}}));
+
+	partition_pruner date_pruner("BindableTableScan(table=[[main, t]], filters=[[>=($0, 2020-01-02)]], projects=[[0]], aliases=[[dt]])",
+		{"dt"}, {cudf::type_id::TIMESTAMP_DAYS});
+	EXPECT_FALSE(date_pruner.may_match({{"dt", "2020-01-01"}}));
+	EXPECT_TRUE(date_pruner.may_match({{"dt", "2020-01-03"}}));
+	EXPECT_TRUE(date_pruner.may_match({{"dt", "__HIVE_DEFAULT_PARTITION__"}}));
+}
+
+TEST_F(PartitionPrunerTest, lists_only_matching_folders) {
+	const std::string base_folder = "/tmp/partition_pruner_test";
+	LocalFileSystem localFileSystem(Path("/"));
+	localFileSystem.remove(Uri{base_folder});
+	for (auto folder : {"year=2019/month=7", "year=2020/month=5", "year=2020/month=7"}) {
+		localFileSystem.makeDirectory(Uri{base_folder + "/" + folder});
+		std::ofstream(base_folder + "/" + folder + "/0.parquet") << "";
+	}
+
+	std::vector<std::string> all_folders = ral::skip_data::list_partition_folders(Uri{base_folder});
+	std::sort(all_folders.begin(), all_folders.end());
+	EXPECT_EQ(all_folders, std::vector<std::string>({"year=2019/month=7", "year=2020/month=5", "year=2020/month=7"}));
+
+	partition_pruner pruner(year_and_month_scan, column_names, column_types);
+	std::vector<std::string> folders = ral::skip_data::list_partition_folders(Uri{base_folder}, &pruner);
+	EXPECT_EQ(folders, std::vector<std::string>({"year=2020/month=7"}));
+
+	localFileSystem.remove(Uri{base_folder});
+}
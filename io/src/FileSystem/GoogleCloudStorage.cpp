@@ -5,6 +5,7 @@
 
 #include "GoogleCloudStorage.h"
 
+#include "ReadAheadFile.h"
 #include "private/GoogleCloudStorage_p.h"
 
 GoogleCloudStorage::GoogleCloudStorage(const FileSystemConnection & fileSystemConnection, const Path & root)
@@ -79,7 +80,8 @@ bool GoogleCloudStorage::truncateFile(const Uri & uri, const long long length) c
 std::shared_ptr<arrow::io::RandomAccessFile> GoogleCloudStorage::openReadable(const Uri & uri) const {
 	std::shared_ptr<GoogleCloudStorageReadableFile> file;
 	this->pimpl->openReadable(uri, &file);
-	return std::static_pointer_cast<arrow::io::RandomAccessFile>(file);
+	// every read of an object is a request, so the small reads of the file readers are buffered and merged
+	return std::make_shared<ReadAheadFile>(file);
 }
 
 std::shared_ptr<arrow::io::OutputStream> GoogleCloudStorage::openWriteable(const Uri & uri) const {
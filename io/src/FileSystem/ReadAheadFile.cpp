@@ -0,0 +1,389 @@
+/*
+ * Copyright 2021 BlazingDB, Inc.
+ */
+
+#include "ReadAheadFile.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <thread>
+
+#include <arrow/memory_pool.h>
+
+namespace {
+
+/**
+ * The threads that run the reads of the wrapped files, shared by all the read ahead files so the
+ * number of threads does not grow with the number of open files and reads.
+ */
+class LoadPool {
+public:
+	static LoadPool & getInstance() {
+		// never destroyed, as the files closed at exit may still wait for their loads
+		static LoadPool * pool = new LoadPool(32);
+		return *pool;
+	}
+
+	template <typename T>
+	std::future<T> submit(std::function<T()> load) {
+		auto task = std::make_shared<std::packaged_task<T()>>(std::move(load));
+		std::future<T> result = task->get_future();
+		{
+			std::lock_guard<std::mutex> lock(this->mutex);
+			this->tasks.emplace_back([task]() { (*task)(); });
+		}
+		this->condition.notify_one();
+		return result;
+	}
+
+private:
+	LoadPool(int numThreads) {
+		for(int i = 0; i < numThreads; i++) {
+			std::thread([this]() { this->work(); }).detach();
+		}
+	}
+
+	void work() {
+		while(true) {
+			std::function<void()> task;
+			{
+				std::unique_lock<std::mutex> lock(this->mutex);
+				this->condition.wait(lock, [this] { return !this->tasks.empty(); });
+				task = std::move(this->tasks.front());
+				this->tasks.pop_front();
+			}
+			task();
+		}
+	}
+
+	std::mutex mutex;
+	std::condition_variable condition;
+	std::deque<std::function<void()>> tasks;
+};
+
+}  // namespace
+
+std::atomic<int64_t> ReadAheadFile::totalBufferedBytes(0);
+
+ReadAheadFile::ReadSlot::ReadSlot(ReadAheadFile & file) : file(file) {
+	std::unique_lock<std::mutex> lock(file.readSlotsMutex);
+	file.readSlotsCondition.wait(lock, [&file] { return file.readsInFlight < file.options.maxReadsInFlight; });
+	file.readsInFlight++;
+}
+
+ReadAheadFile::ReadSlot::~ReadSlot() {
+	{
+		std::lock_guard<std::mutex> lock(file.readSlotsMutex);
+		file.readsInFlight--;
+	}
+	file.readSlotsCondition.notify_one();
+}
+
+ReadAheadFile::ReadAheadFile(std::shared_ptr<arrow::io::RandomAccessFile> file, ReadAheadOptions options)
+	: file(file), options(options), bufferedBytes(0), size(-1), readsInFlight(0), position(0), isClosed(false) {
+	this->options.readAheadSize = std::max<int64_t>(this->options.readAheadSize, 1);
+	this->options.rangeSizeLimit = std::max<int64_t>(this->options.rangeSizeLimit, 1);
+	this->options.maxReadsInFlight = std::max(this->options.maxReadsInFlight, 1);
+}
+
+ReadAheadFile::~ReadAheadFile() { this->Close(); }
+
+int64_t ReadAheadFile::getTotalBufferedBytes() { return totalBufferedBytes; }
+
+arrow::Status ReadAheadFile::willNeed(std::vector<std::pair<int64_t, int64_t>> ranges) {
+	if(this->isClosed) {
+		return arrow::Status::Invalid("Operation on closed file");
+	}
+	ARROW_ASSIGN_OR_RAISE(int64_t fileSize, this->GetSize());
+
+	std::sort(ranges.begin(), ranges.end());
+	std::vector<std::pair<int64_t, int64_t>> merged;  // [begin, end) of the ranges once merged
+	for(auto & range : ranges) {
+		int64_t begin = std::max<int64_t>(range.first, 0);
+		int64_t end = std::min(range.first + range.second, fileSize);
+		if(end <= begin || end - begin >= this->options.rangeSizeLimit) {
+			continue;  // the large ranges are read unbuffered anyway
+		}
+
+		if(!merged.empty() && begin - merged.back().second <= this->options.holeSizeLimit &&
+			std::max(end, merged.back().second) - merged.back().first <= this->options.rangeSizeLimit) {
+			merged.back().second = std::max(end, merged.back().second);
+		} else {
+			merged.emplace_back(begin, end);
+		}
+	}
+
+	std::lock_guard<std::mutex> lock(this->windowsMutex);
+	for(auto & range : merged) {
+		bool loaded = std::any_of(this->windows.begin(), this->windows.end(), [&range](const Window & window) {
+			return window.offset <= range.first && range.second <= window.offset + window.length;
+		});
+		if(!loaded && this->canLoadAhead(range.second - range.first)) {
+			this->loadWindow(range.first, range.second - range.first);
+		}
+	}
+	this->dropWindows();
+	return arrow::Status::OK();
+}
+
+arrow::Status ReadAheadFile::Close() {
+	std::vector<WindowData> loads;
+	{
+		std::lock_guard<std::mutex> lock(this->windowsMutex);
+		if(this->isClosed) {
+			return arrow::Status::OK();
+		}
+		this->isClosed = true;
+		this->windows.clear();
+		this->addBufferedBytes(-this->bufferedBytes);
+		loads.swap(this->pendingLoads);
+	}
+
+	// the loads read from the wrapped file, so it is closed once they are done
+	for(auto & load : loads) {
+		load.wait();
+	}
+	return this->file->Close();
+}
+
+arrow::Result<int64_t> ReadAheadFile::GetSize() {
+	std::lock_guard<std::mutex> lock(this->windowsMutex);
+	if(this->size < 0) {
+		ARROW_ASSIGN_OR_RAISE(this->size, this->file->GetSize());
+	}
+	return this->size;
+}
+
+arrow::Result<int64_t> ReadAheadFile::Read(int64_t nbytes, void * out) {
+	ARROW_ASSIGN_OR_RAISE(int64_t bytesRead, this->ReadAt(this->position, nbytes, out));
+	this->position += bytesRead;
+	return bytesRead;
+}
+
+arrow::Result<std::shared_ptr<arrow::Buffer>> ReadAheadFile::Read(int64_t nbytes) {
+	ARROW_ASSIGN_OR_RAISE(auto buffer, this->ReadAt(this->position, nbytes));
+	this->position += buffer->size();
+	return buffer;
+}
+
+arrow::Result<int64_t> ReadAheadFile::ReadAt(int64_t position, int64_t nbytes, void * out) {
+	if(nbytes >= this->options.rangeSizeLimit) {
+		if(this->isClosed) {
+			return arrow::Status::Invalid("Operation on closed file");
+		}
+		ARROW_ASSIGN_OR_RAISE(int64_t fileSize, this->GetSize());
+		return this->readUnbuffered(position, std::min(nbytes, fileSize - position), out);
+	}
+
+	ARROW_ASSIGN_OR_RAISE(auto buffer, this->ReadAt(position, nbytes));
+	if(buffer->size() > 0) {
+		std::memcpy(out, buffer->data(), buffer->size());
+	}
+	return buffer->size();
+}
+
+arrow::Result<std::shared_ptr<arrow::Buffer>> ReadAheadFile::ReadAt(int64_t position, int64_t nbytes) {
+	if(this->isClosed) {
+		return arrow::Status::Invalid("Operation on closed file");
+	}
+	if(position < 0 || nbytes < 0) {
+		return arrow::Status::Invalid("Negative position or number of bytes to read");
+	}
+	ARROW_ASSIGN_OR_RAISE(int64_t fileSize, this->GetSize());
+	nbytes = std::max<int64_t>(std::min(nbytes, fileSize - position), 0);
+
+	if(nbytes >= this->options.rangeSizeLimit) {
+		ARROW_ASSIGN_OR_RAISE(std::shared_ptr<arrow::ResizableBuffer> buffer, arrow::AllocateResizableBuffer(nbytes));
+		ARROW_ASSIGN_OR_RAISE(int64_t bytesRead, this->readUnbuffered(position, nbytes, buffer->mutable_data()));
+		ARROW_RETURN_NOT_OK(buffer->Resize(bytesRead));
+		return std::static_pointer_cast<arrow::Buffer>(buffer);
+	}
+	if(nbytes == 0) {
+		return std::make_shared<arrow::Buffer>(static_cast<const uint8_t *>(nullptr), 0);
+	}
+
+	std::vector<std::pair<int64_t, WindowData>> pieces = this->getWindows(position, nbytes, fileSize);
+	std::vector<std::shared_ptr<arrow::Buffer>> pieceBuffers;
+	for(auto & piece : pieces) {
+		const auto & pieceBuffer = piece.second.get();
+		if(!pieceBuffer.ok()) {
+			return pieceBuffer.status();
+		}
+		pieceBuffers.push_back(pieceBuffer.ValueOrDie());
+	}
+
+	// the windows are shorter than asked for when the file is shorter than its size said
+	if(pieces.size() == 1) {
+		int64_t offsetInWindow = position - pieces[0].first;
+		int64_t available = std::max<int64_t>(std::min(nbytes, pieceBuffers[0]->size() - offsetInWindow), 0);
+		if(available == 0) {
+			return std::make_shared<arrow::Buffer>(static_cast<const uint8_t *>(nullptr), 0);
+		}
+		return arrow::SliceBuffer(pieceBuffers[0], offsetInWindow, available);
+	}
+
+	ARROW_ASSIGN_OR_RAISE(std::shared_ptr<arrow::ResizableBuffer> buffer, arrow::AllocateResizableBuffer(nbytes));
+	int64_t bytesRead = 0;
+	for(size_t i = 0; i < pieces.size() && bytesRead < nbytes; i++) {
+		int64_t offsetInWindow = position + bytesRead - pieces[i].first;
+		int64_t length = std::min(nbytes - bytesRead, pieceBuffers[i]->size() - offsetInWindow);
+		if(length <= 0) {
+			break;
+		}
+		std::memcpy(buffer->mutable_data() + bytesRead, pieceBuffers[i]->data() + offsetInWindow, length);
+		bytesRead += length;
+	}
+	ARROW_RETURN_NOT_OK(buffer->Resize(bytesRead));
+	return std::static_pointer_cast<arrow::Buffer>(buffer);
+}
+
+bool ReadAheadFile::supports_zero_copy() const { return false; }
+
+arrow::Status ReadAheadFile::Seek(int64_t position) {
+	if(this->isClosed) {
+		return arrow::Status::Invalid("Operation on closed file");
+	}
+	this->position = position;
+	return arrow::Status::OK();
+}
+
+arrow::Result<int64_t> ReadAheadFile::Tell() const { return this->position; }
+
+bool ReadAheadFile::closed() const { return this->isClosed; }
+
+std::vector<std::pair<int64_t, ReadAheadFile::WindowData>> ReadAheadFile::getWindows(int64_t position, int64_t nbytes, int64_t fileSize) {
+	std::lock_guard<std::mutex> lock(this->windowsMutex);
+
+	// the windows that failed to load are loaded again
+	for(auto window = this->windows.begin(); window != this->windows.end();) {
+		if(window->data.wait_for(std::chrono::seconds(0)) == std::future_status::ready && !window->data.get().ok()) {
+			this->addBufferedBytes(-window->length);
+			window = this->windows.erase(window);
+		} else {
+			++window;
+		}
+	}
+
+	// a read can be served by several consecutive windows, as a sequential read crosses from a window to the next
+	std::vector<std::list<Window>::iterator> chain;
+	for(int64_t covered = position; covered < position + nbytes;) {
+		auto next = this->windows.end();
+		for(auto window = this->windows.begin(); window != this->windows.end(); ++window) {
+			if(window->offset <= covered && covered < window->offset + window->length &&
+				(next == this->windows.end() || window->offset + window->length > next->offset + next->length)) {
+				next = window;
+			}
+		}
+		if(next == this->windows.end()) {
+			chain.clear();
+			break;
+		}
+		chain.push_back(next);
+		covered = next->offset + next->length;
+	}
+
+	if(chain.empty()) {
+		int64_t offset = position;
+		int64_t length = std::max(nbytes, this->options.readAheadSize);
+		if(position + nbytes == fileSize) {
+			// footers are read backwards from the end of the file, so the bytes before the read are loaded too
+			offset = std::max<int64_t>(fileSize - length, 0);
+		}
+		chain.push_back(this->loadWindow(offset, std::min(length, fileSize - offset)));
+	}
+
+	std::vector<std::pair<int64_t, WindowData>> pieces;
+	for(auto window : chain) {
+		pieces.emplace_back(window->offset, window->data);
+		this->windows.splice(this->windows.begin(), this->windows, window);
+	}
+
+	// a read past the middle of its last window is taken as sequential, so the next window is loaded ahead
+	auto last = chain.back();
+	int64_t windowEnd = last->offset + last->length;
+	if(position + nbytes > last->offset + last->length / 2 && windowEnd < fileSize) {
+		bool loaded = std::any_of(this->windows.begin(), this->windows.end(), [windowEnd](const Window & window) {
+			return window.offset <= windowEnd && windowEnd < window.offset + window.length;
+		});
+		int64_t length = std::min(this->options.readAheadSize, fileSize - windowEnd);
+		if(!loaded && this->canLoadAhead(length)) {
+			this->loadWindow(windowEnd, length);
+		}
+	}
+
+	this->dropWindows();
+	return pieces;
+}
+
+std::list<ReadAheadFile::Window>::iterator ReadAheadFile::loadWindow(int64_t offset, int64_t length) {
+	WindowData data = LoadPool::getInstance().submit<arrow::Result<std::shared_ptr<arrow::Buffer>>>([this, offset, length]() -> arrow::Result<std::shared_ptr<arrow::Buffer>> {
+		ReadSlot slot(*this);
+		try {
+			return this->file->ReadAt(offset, length);
+		} catch(const std::exception & e) {
+			return arrow::Status::IOError(e.what());
+		}
+	}).share();
+
+	// the loads that are done are forgotten, the others are waited for when the file is closed
+	this->pendingLoads.erase(std::remove_if(this->pendingLoads.begin(), this->pendingLoads.end(), [](const WindowData & load) {
+		return load.wait_for(std::chrono::seconds(0)) == std::future_status::ready;
+	}), this->pendingLoads.end());
+	this->pendingLoads.push_back(data);
+
+	this->windows.push_front(Window{offset, length, data});
+	this->addBufferedBytes(length);
+	return this->windows.begin();
+}
+
+void ReadAheadFile::dropWindows() {
+	while((this->bufferedBytes > this->options.maxBufferedBytes || totalBufferedBytes > this->options.maxTotalBufferedBytes) &&
+		  this->windows.size() > 1) {
+		this->addBufferedBytes(-this->windows.back().length);
+		this->windows.pop_back();
+	}
+}
+
+bool ReadAheadFile::canLoadAhead(int64_t length) const {
+	return totalBufferedBytes + length <= this->options.maxTotalBufferedBytes;
+}
+
+void ReadAheadFile::addBufferedBytes(int64_t length) {
+	this->bufferedBytes += length;
+	totalBufferedBytes += length;
+}
+
+arrow::Result<int64_t> ReadAheadFile::readUnbuffered(int64_t position, int64_t nbytes, void * out) {
+	std::vector<std::future<arrow::Result<int64_t>>> pieces;
+	for(int64_t offset = 0; offset < nbytes; offset += this->options.rangeSizeLimit) {
+		int64_t length = std::min(this->options.rangeSizeLimit, nbytes - offset);
+		uint8_t * pieceOut = static_cast<uint8_t *>(out) + offset;
+		pieces.push_back(LoadPool::getInstance().submit<arrow::Result<int64_t>>([this, position, offset, length, pieceOut]() -> arrow::Result<int64_t> {
+			ReadSlot slot(*this);
+			try {
+				return this->file->ReadAt(position + offset, length, pieceOut);
+			} catch(const std::exception & e) {
+				return arrow::Status::IOError(e.what());
+			}
+		}));
+	}
+
+	int64_t bytesRead = 0;
+	arrow::Status status = arrow::Status::OK();
+	for(auto & piece : pieces) {
+		arrow::Result<int64_t> result = piece.get();
+		if(result.ok()) {
+			bytesRead += result.ValueOrDie();
+		} else {
+			status = result.status();
+		}
+	}
+	if(!status.ok()) {
+		return status;
+	}
+	return bytesRead;
+}
@@ -0,0 +1,142 @@
+/*
+ * Copyright 2021 BlazingDB, Inc.
+ */
+
+#ifndef SRC_FILESYSTEM_READAHEADFILE_H_
+#define SRC_FILESYSTEM_READAHEADFILE_H_
+
+#include <atomic>
+#include <condition_variable>
+#include <future>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+#include "arrow/buffer.h"
+#include "arrow/io/interfaces.h"
+#include "arrow/status.h"
+
+struct ReadAheadOptions {
+	int64_t holeSizeLimit = 8 * 1024;				 // ranges closer than this are read together
+	int64_t rangeSizeLimit = 32 * 1024 * 1024;		 // ranges are not merged past this size, and larger reads are not buffered
+	int64_t readAheadSize = 4 * 1024 * 1024;		 // least number of bytes loaded when a read misses the buffered windows
+	int64_t maxBufferedBytes = 64 * 1024 * 1024;	 // the least recently used windows are dropped past this size
+	int64_t maxTotalBufferedBytes = 1024 * 1024 * 1024;  // the same, for the windows of all the open files
+	int maxReadsInFlight = 8;						 // reads issued to the wrapped file at the same time
+};
+
+/**
+ * Wraps a remote file (HDFS, GCS) so the many small reads of the file readers do not turn
+ * into as many round trips. Every read that misses loads a whole window of readAheadSize bytes
+ * (the last bytes of the file for a read that ends at the end of the file, as footers are read
+ * backwards) and a sequential read loads the next window in the background. The ranges given to
+ * willNeed (the column chunks a Parquet reader is about to read) are merged when they are close and
+ * loaded in parallel. The loads of all the files run on a shared pool of threads, and no more is
+ * loaded ahead once the windows of all the files take maxTotalBufferedBytes. ReadAt is thread safe.
+ */
+class ReadAheadFile : public arrow::io::RandomAccessFile {
+public:
+	ReadAheadFile(std::shared_ptr<arrow::io::RandomAccessFile> file, ReadAheadOptions options = ReadAheadOptions());
+	~ReadAheadFile();
+
+	/**
+	 * Starts loading these (offset, length) ranges in the background, merging the ones that are close.
+	 */
+	arrow::Status willNeed(std::vector<std::pair<int64_t, int64_t>> ranges);
+
+	/**
+	 * Returns the bytes of the windows of all the open files.
+	 */
+	static int64_t getTotalBufferedBytes();
+
+	arrow::Status Close() override;
+
+	arrow::Result<int64_t> GetSize() override;
+
+	arrow::Result<int64_t> Read(int64_t nbytes, void * out) override;
+
+	arrow::Result<std::shared_ptr<arrow::Buffer>> Read(int64_t nbytes) override;
+
+	arrow::Result<int64_t> ReadAt(int64_t position, int64_t nbytes, void * out) override;
+
+	arrow::Result<std::shared_ptr<arrow::Buffer>> ReadAt(int64_t position, int64_t nbytes) override;
+
+	bool supports_zero_copy() const override;
+
+	arrow::Status Seek(int64_t position) override;
+	arrow::Result<int64_t> Tell() const override;
+
+	bool closed() const override;
+
+private:
+	using WindowData = std::shared_future<arrow::Result<std::shared_ptr<arrow::Buffer>>>;
+
+	struct Window {
+		int64_t offset;
+		int64_t length;
+		WindowData data;
+	};
+
+	/**
+	 * Returns the offset and the data of the windows that hold [position, position + nbytes), loading a new one if there are none.
+	 */
+	std::vector<std::pair<int64_t, WindowData>> getWindows(int64_t position, int64_t nbytes, int64_t fileSize);
+
+	/**
+	 * Starts loading a window, must be called with the mutex locked.
+	 */
+	std::list<Window>::iterator loadWindow(int64_t offset, int64_t length);
+
+	/**
+	 * Drops the least recently used windows past maxBufferedBytes or maxTotalBufferedBytes, must be called with the mutex locked.
+	 */
+	void dropWindows();
+
+	/**
+	 * Whether a window of this length can be loaded ahead without going past maxTotalBufferedBytes.
+	 */
+	bool canLoadAhead(int64_t length) const;
+
+	/**
+	 * Adds to the bytes of the windows of this file and of all the files, must be called with the mutex locked.
+	 */
+	void addBufferedBytes(int64_t length);
+
+	/**
+	 * Reads straight from the wrapped file, in pieces of rangeSizeLimit bytes that are read in parallel.
+	 */
+	arrow::Result<int64_t> readUnbuffered(int64_t position, int64_t nbytes, void * out);
+
+	/**
+	 * Holds one of the maxReadsInFlight reads of the wrapped file while it is alive.
+	 */
+	struct ReadSlot {
+		ReadSlot(ReadAheadFile & file);
+		~ReadSlot();
+		ReadAheadFile & file;
+	};
+
+	std::shared_ptr<arrow::io::RandomAccessFile> file;
+	ReadAheadOptions options;
+
+	std::mutex windowsMutex;
+	std::list<Window> windows;  // the most recently used first
+	int64_t bufferedBytes;
+	std::vector<WindowData> pendingLoads;  // loads that may still be running, even of dropped windows
+	int64_t size;
+
+	std::mutex readSlotsMutex;
+	std::condition_variable readSlotsCondition;
+	int readsInFlight;
+
+	int64_t position;
+	std::atomic<bool> isClosed;
+
+	static std::atomic<int64_t> totalBufferedBytes;
+
+	ARROW_DISALLOW_COPY_AND_ASSIGN(ReadAheadFile);
+};
+
+#endif /* SRC_FILESYSTEM_READAHEADFILE_H_ */
@@ -11,6 +11,7 @@
 #include "arrow/buffer.h"
 #include "arrow/status.h"
 
+#include "FileSystem/ReadAheadFile.h"
 #include "Util/StringUtil.h"
 
 HadoopFileSystem::Private::Private(const FileSystemConnection & fileSystemConnection, const Path & root)
@@ -134,9 +135,9 @@ FileStatus HadoopFileSystem::Private::getFileStatus(const Uri & uri) const {
 	const Uri uriWithRoot(uri.getScheme(), uri.getAuthority(), this->root + uri.getPath().toString());
 	const Path path = uriWithRoot.getPath();
 
-	arrow::io::FileStatistics stat_buf;
+	arrow::io::HdfsPathInfo stat_buf;
 
-	const arrow::Status result = this->hdfs->Stat(path.toString(), &stat_buf);
+	const arrow::Status result = this->hdfs->GetPathInfo(path.toString(), &stat_buf);
 
 	if(result.ok()) {
 		FileType fileType;
@@ -149,7 +150,8 @@ FileStatus HadoopFileSystem::Private::getFileStatus(const Uri & uri) const {
 		default: fileType = FileType::UNDEFINED; break;
 		}
 
-		return FileStatus(uri, fileType, stat_buf.size);
+		// last_modified_time is in seconds
+		return FileStatus(uri, fileType, stat_buf.size, stat_buf.last_modified_time * 1000ull);
 	} else {
 		// TODO percy error handling
 	}
@@ -523,8 +525,12 @@ std::shared_ptr<arrow::io::RandomAccessFile> HadoopFileSystem::Private::openRead
 	arrow::Status stat = this->hdfs->OpenReadable(path.toString(), &in_file);
 
 	// TODO check stat and thrown FileSystemException
+	if(in_file == nullptr) {
+		return in_file;
+	}
 
-	return in_file;
+	// every read of libhdfs is a round trip, so the small reads of the file readers are buffered and merged
+	return std::make_shared<ReadAheadFile>(in_file);
 }
 
 std::shared_ptr<arrow::io::OutputStream> HadoopFileSystem::Private::openWriteable(const Uri & uri) const {
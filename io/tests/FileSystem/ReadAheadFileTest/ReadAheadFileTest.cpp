@@ -0,0 +1,182 @@
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <thread>
+
+#include "gtest/gtest.h"
+
+#include <arrow/io/file.h>
+
+#include "FileSystem/ReadAheadFile.h"
+
+// Local file that takes a while to serve every read, like a remote one
+class LatencyFile : public arrow::io::RandomAccessFile {
+public:
+	LatencyFile(std::shared_ptr<arrow::io::RandomAccessFile> file) : file(file), numReads(0), readsInFlight(0), maxReadsInFlight(0) {}
+
+	arrow::Status Close() override { return file->Close(); }
+	bool closed() const override { return file->closed(); }
+	arrow::Result<int64_t> GetSize() override { return file->GetSize(); }
+	arrow::Result<int64_t> Read(int64_t nbytes, void * out) override { return file->Read(nbytes, out); }
+	arrow::Result<std::shared_ptr<arrow::Buffer>> Read(int64_t nbytes) override { return file->Read(nbytes); }
+	bool supports_zero_copy() const override { return false; }
+	arrow::Status Seek(int64_t position) override { return file->Seek(position); }
+	arrow::Result<int64_t> Tell() const override { return file->Tell(); }
+
+	arrow::Result<int64_t> ReadAt(int64_t position, int64_t nbytes, void * out) override {
+		startRead();
+		auto result = file->ReadAt(position, nbytes, out);
+		readsInFlight--;
+		return result;
+	}
+
+	arrow::Result<std::shared_ptr<arrow::Buffer>> ReadAt(int64_t position, int64_t nbytes) override {
+		startRead();
+		auto result = file->ReadAt(position, nbytes);
+		readsInFlight--;
+		return result;
+	}
+
+	std::shared_ptr<arrow::io::RandomAccessFile> file;
+	std::atomic<int> numReads;
+	std::atomic<int> readsInFlight;
+	std::atomic<int> maxReadsInFlight;
+
+private:
+	void startRead() {
+		numReads++;
+		int inFlight = ++readsInFlight;
+		int maxInFlight = maxReadsInFlight;
+		while(inFlight > maxInFlight && !maxReadsInFlight.compare_exchange_weak(maxInFlight, inFlight)) {
+		}
+		std::this_thread::sleep_for(std::chrono::milliseconds(5));
+	}
+};
+
+class ReadAheadFileTest : public testing::Test {
+protected:
+	virtual void SetUp() {
+		for(int i = 0; i < 100000; i++) {
+			content.push_back('a' + (i * 7) % 26);
+		}
+		const std::string fileName = "/tmp/ReadAheadFileTest.bin";
+		std::ofstream(fileName, std::ofstream::binary) << content;
+		latencyFile = std::make_shared<LatencyFile>(arrow::io::ReadableFile::Open(fileName).ValueOrDie());
+
+		options.holeSizeLimit = 100;
+		options.rangeSizeLimit = 20000;
+		options.readAheadSize = 4096;
+		options.maxBufferedBytes = 30000;
+		options.maxReadsInFlight = 3;
+	}
+
+	std::string read(ReadAheadFile & file, int64_t position, int64_t nbytes) {
+		std::string out(nbytes, '\0');
+		int64_t bytesRead = file.ReadAt(position, nbytes, &out[0]).ValueOrDie();
+		out.resize(bytesRead);
+		return out;
+	}
+
+	std::string content;
+	std::shared_ptr<LatencyFile> latencyFile;
+	ReadAheadOptions options;
+};
+
+TEST_F(ReadAheadFileTest, FooterIsReadOnce) {
+	ReadAheadFile file(latencyFile, options);
+
+	EXPECT_EQ(read(file, content.size() - 8, 8), content.substr(content.size() - 8));
+	EXPECT_EQ(read(file, content.size() - 1000, 992), content.substr(content.size() - 1000, 992));
+	EXPECT_EQ(latencyFile->numReads, 1);
+}
+
+TEST_F(ReadAheadFileTest, SequentialReadsAreBuffered) {
+	ReadAheadFile file(latencyFile, options);
+
+	for(int64_t position = 0; position < 40000; position += 100) {
+		ASSERT_EQ(read(file, position, 100), content.substr(position, 100));
+	}
+	EXPECT_LE(latencyFile->numReads, 12);
+}
+
+TEST_F(ReadAheadFileTest, NearbyRangesAreMerged) {
+	ReadAheadFile file(latencyFile, options);
+
+	ASSERT_TRUE(file.willNeed({{50000, 10}, {50050, 10}, {50100, 10}, {60000, 10}}).ok());
+	EXPECT_EQ(read(file, 50100, 10), content.substr(50100, 10));
+	EXPECT_EQ(read(file, 60000, 10), content.substr(60000, 10));
+	EXPECT_EQ(read(file, 50000, 10), content.substr(50000, 10));
+	EXPECT_LE(latencyFile->numReads, 4);
+}
+
+TEST_F(ReadAheadFileTest, LargeReadsAreSplit) {
+	ReadAheadFile file(latencyFile, options);
+
+	EXPECT_EQ(read(file, 10, 50000), content.substr(10, 50000));
+	EXPECT_EQ(latencyFile->numReads, 3);
+	EXPECT_EQ(read(file, content.size() - 5, 100), content.substr(content.size() - 5));
+}
+
+TEST_F(ReadAheadFileTest, BufferBudgetIsShared) {
+	options.maxTotalBufferedBytes = ReadAheadFile::getTotalBufferedBytes() + 10000;
+	auto otherLatencyFile = std::make_shared<LatencyFile>(latencyFile->file);
+	ReadAheadFile file(latencyFile, options);
+	ReadAheadFile otherFile(otherLatencyFile, options);
+
+	// every read loads a window of 4096 bytes, the windows of both files fit two of them and every file keeps one
+	for(int64_t position : {0, 30000, 60000}) {
+		EXPECT_EQ(read(file, position, 100), content.substr(position, 100));
+	}
+	for(int64_t position : {0, 30000, 60000}) {
+		EXPECT_EQ(read(otherFile, position, 100), content.substr(position, 100));
+	}
+	EXPECT_EQ(ReadAheadFile::getTotalBufferedBytes(), options.maxTotalBufferedBytes - 10000 + 3 * 4096);
+
+	// no more is loaded ahead past the budget, so nearby ranges are left to be loaded when they are read
+	ASSERT_TRUE(otherFile.willNeed({{80000, 10}}).ok());
+	EXPECT_EQ(otherLatencyFile->numReads, 3);
+
+	ASSERT_TRUE(file.Close().ok());
+	EXPECT_EQ(ReadAheadFile::getTotalBufferedBytes(), options.maxTotalBufferedBytes - 10000 + 4096);
+}
+
+TEST_F(ReadAheadFileTest, ConcurrentReads) {
+	ReadAheadFile file(latencyFile, options);
+
+	std::atomic<int> failures(0);
+	std::vector<std::thread> threads;
+	for(int t = 0; t < 8; t++) {
+		threads.emplace_back([&, t]() {
+			for(int i = 0; i < 100; i++) {
+				int64_t position = (i * 977 + t * 131) % 99000;
+				if(read(file, position, 200) != content.substr(position, 200)) {
+					failures++;
+				}
+				auto buffer = file.ReadAt(position, 30).ValueOrDie();
+				if(buffer->ToString() != content.substr(position, 30)) {
+					failures++;
+				}
+			}
+		});
+	}
+	for(auto & thread : threads) {
+		thread.join();
+	}
+
+	EXPECT_EQ(failures, 0);
+	EXPECT_LE(latencyFile->maxReadsInFlight, options.maxReadsInFlight);
+}
+
+TEST_F(ReadAheadFileTest, ClosedFileFailsReads) {
+	ReadAheadFile file(latencyFile, options);
+
+	ASSERT_TRUE(file.Seek(3).ok());
+	char out[4];
+	ASSERT_EQ(file.Read(4, out).ValueOrDie(), 4);
+	EXPECT_EQ(std::string(out, 4), content.substr(3, 4));
+	EXPECT_EQ(file.Tell().ValueOrDie(), 7);
+
+	ASSERT_TRUE(file.Close().ok());
+	EXPECT_TRUE(latencyFile->closed());
+	EXPECT_FALSE(file.ReadAt(0, 1).ok());
+}
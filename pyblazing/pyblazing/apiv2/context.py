@@ -451,6 +451,29 @@ def modifyAlgebraForDataframesWithOnlyWantedColumns(
     return algebra
 
 
+def is_arrow_zero_copy_supported(schema):
+    """
+    Whether the engine can scan the buffers of an Arrow table with this
+    schema without converting it to a cudf DataFrame first.
+    """
+    for field in schema:
+        field_type = field.type
+        if not (
+            (
+                pyarrow.types.is_integer(field_type)
+                or pyarrow.types.is_float32(field_type)
+                or pyarrow.types.is_float64(field_type)
+                or pyarrow.types.is_boolean(field_type)
+                or pyarrow.types.is_date64(field_type)
+                or pyarrow.types.is_duration(field_type)
+                or pyarrow.types.is_string(field_type)
+            )
+            or (pyarrow.types.is_timestamp(field_type) and field_type.tz is None)
+        ):
+            return False
+    return True
+
+
 def get_uri_values(files, partitions, base_folder):
     if base_folder[-1] != "/":
         base_folder = base_folder + "/"
@@ -909,7 +932,7 @@ def kwargs_validation(kwargs, bc_api_str):
             "skiprows",
             "num_rows",
             "use_index",
-            "max_bytes_chunk_read",  # Used for reading CSV files in chunks
+            "max_bytes_chunk_read",  # Used for reading CSV and JSON lines files in chunks
             "local_files",
             "get_metadata",
         ]
@@ -1030,6 +1053,9 @@ class BlazingTable(object):
         self.slices = None
         # metadata, this is computed in create table, after call get_metadata
         self.metadata = metadata
+        # base folder of the key=value partition folders, None if the table
+        # is not partitioned by folders
+        self.partition_location = None
         # row_groups_ids, vector<vector<int>> one vector of
         # row_groups per file
         self.row_groups_ids = row_groups_ids
@@ -1040,7 +1066,7 @@ class BlazingTable(object):
         self.column_names = []
         self.column_types = []
 
-        if self.fileType == DataType.CUDF:
+        if self.fileType == DataType.CUDF or self.fileType == DataType.ARROW:
             self.column_names = [x for x in self.input._data.keys()]
             data_values = self.input._data.values()
             self.column_types = [cio.np_to_cudf_types_int(x.dtype) for x in data_values]
@@ -1053,6 +1079,39 @@ class BlazingTable(object):
         # are different that the names in actual files
         self.file_column_names = self.column_names
 
+    def filterFiles(self, kept_indices):
+        """Returns a copy of the table with only the files at the given
+        indices, in the same order"""
+        import copy
+
+        if len(kept_indices) == len(self.files):
+            return self
+
+        table = copy.copy(self)
+        table.files = [self.files[i] for i in kept_indices]
+        if len(self.uri_values) == len(self.files):
+            table.uri_values = [self.uri_values[i] for i in kept_indices]
+        if self.row_groups_ids is not None and len(self.row_groups_ids) == len(
+            self.files
+        ):
+            table.row_groups_ids = [self.row_groups_ids[i] for i in kept_indices]
+        table.slices = None
+
+        if self.has_metadata():
+            # the metadata refers to the files by their index
+            new_indices = np.full(len(self.files), -1, dtype=np.int64)
+            new_indices[kept_indices] = np.arange(len(kept_indices))
+            metadata = self.metadata[
+                self.metadata["file_handle_index"].isin(kept_indices)
+            ]
+            file_handle_index = metadata["file_handle_index"]
+            metadata["file_handle_index"] = cudf.Series(
+                new_indices[file_handle_index.to_array()],
+                index=metadata.index,
+            ).astype(file_handle_index.dtype)
+            table.metadata = metadata
+        return table
+
     def has_metadata(self):
         if isinstance(self.metadata, dask_cudf.core.DataFrame):
             return not self.metadata.compute().empty
@@ -1196,11 +1255,28 @@ def load_config_options_from_env(user_config_options: dict):
     default_values = {
         "JOIN_PARTITION_SIZE_THRESHOLD": 400000000,
         "MAX_JOIN_SCATTER_MEM_OVERHEAD": 500000000,
+        "RUNTIME_JOIN_FILTER_MAX_BUILD_BYTES": 256000000,
+        "JOIN_SKEW_HEAVY_HITTER_THRESHOLD": 0.05,
+        "NUM_BYTES_PER_JOIN_BUCKET": 400000000,
+        "MAX_AGGREGATE_MERGE_STATE_BYTE_SIZE": 400000000,
+        "PARTIAL_AGGREGATION_MIN_REDUCTION": 0.1,
+        "AGGREGATION_TREE_REDUCTION": True,
+        "MAX_DISTINCT_STATE_PIECE_BYTE_SIZE": 400000000,
         "MAX_NUM_ORDER_BY_PARTITIONS_PER_NODE": 8,
         "NUM_BYTES_PER_ORDER_BY_PARTITION": 400000000,
         "MAX_DATA_LOAD_CONCAT_CACHE_BYTE_SIZE": 400000000,
+        "NUM_BYTES_PER_SCAN_TASK": 400000000,
+        "MAX_LIMIT_SCAN_TASKS_IN_FLIGHT": 4,
+        "ENABLE_LATE_MATERIALIZATION": True,
+        "INTERPRETER_CPU_MAX_ROWS": 2048,
+        "MAX_OPEN_FILE_HANDLES": 512,
+        "NUM_FILE_OPENER_THREADS": 4,
+        "NUM_PREFETCHED_FILES": 8,
+        "METADATA_CATALOG_DIRECTORY": "",
         "FLOW_CONTROL_BYTES_THRESHOLD": 18446744073709551615,  # see https://en.cppreference.com/w/cpp/types/numeric_limits/max
         "MAX_ORDER_BY_SAMPLES_PER_NODE": 10000,
+        "MAX_MERGE_STREAM_BYTE_SIZE": 400000000,
+        "MAX_ORDER_BY_TOP_N_ROWS": 100000,
         "BLAZING_PROCESSING_DEVICE_MEM_CONSUMPTION_THRESHOLD": 0.9,
         "BLAZING_DEVICE_MEM_CONSUMPTION_THRESHOLD": 0.6,
         "BLAZ_HOST_MEM_CONSUMPTION_THRESHOLD": 0.75,
@@ -1313,6 +1389,56 @@ class BlazingContext(object):
                     the nodes, instead of doing a standard hash based
                     partitioning shuffle. Value is in bytes.
                     default: 500000000
+            RUNTIME_JOIN_FILTER_MAX_BUILD_BYTES : The max size in bytes of
+                    the build side of an inner join for which a bloom and
+                    min/max filter of its keys is built and pushed down to the
+                    scans and filters of the probe side. Set to 0 to disable
+                    runtime join filters.
+                    default: 256000000
+            JOIN_SKEW_HEAVY_HITTER_THRESHOLD : In a distributed join, a key
+                    found in more than this fraction of the sampled rows of
+                    the left table is a heavy hitter. Its left rows are
+                    split across all the nodes and its right rows are copied
+                    to all of them, instead of sending them all to the same
+                    node. Set to 0 to disable.
+                    default: 0.05
+            NUM_BYTES_PER_JOIN_BUCKET : When both sides of a join are
+                    estimated to be larger than this, they are hash
+                    partitioned into buckets of about this size, which can
+                    spill to host memory or disk, and each left bucket is
+                    only joined with its matching right bucket. Set to 0 to
+                    disable.
+                    default: 400000000
+            MAX_AGGREGATE_MERGE_STATE_BYTE_SIZE : The final phase of an
+                    aggregation merges the partial results into a running
+                    state every time this many bytes of them have arrived.
+                    If the merged state is larger than half of this, it is
+                    hash partitioned on the group keys into caches that can
+                    spill, and each partition is merged on its own at the
+                    end. Decrease this number if running into OOM issues
+                    with GROUP BYs that have many groups.
+                    default: 400000000
+            PARTIAL_AGGREGATION_MIN_REDUCTION : The fraction of rows that
+                    the partial aggregation of a GROUP BY has to remove over
+                    its first batches to keep running. Below it, the group
+                    keys are considered nearly unique and the next batches
+                    are sent to be merged without being aggregated first.
+                    Set to 0 to always aggregate.
+                    default: 0.1
+            AGGREGATION_TREE_REDUCTION : For aggregations without GROUP BY,
+                    every node first merges its own partial results. If True,
+                    those are then merged pairwise across the nodes in a tree
+                    so the master node receives log2(number of nodes) of
+                    them. If False, every node sends its partial result
+                    straight to the master node.
+                    default: True
+            MAX_DISTINCT_STATE_PIECE_BYTE_SIZE : UNION (without ALL) keeps
+                    the distinct rows seen so far in hash buckets that can
+                    spill to host memory or disk. Every bucket is split in
+                    pieces of up to this size, and new rows are compared
+                    against one piece at a time. Decrease this number if
+                    running into OOM issues with large UNIONs.
+                    default: 400000000
             MAX_NUM_ORDER_BY_PARTITIONS_PER_NODE : The maximum number of
                     partitions that will be made for an order by.
                     Increse this number if running into OOM issues when
@@ -1326,9 +1452,73 @@ class BlazingContext(object):
             MAX_DATA_LOAD_CONCAT_CACHE_BYTE_SIZE : The max size in bytes to
                     concatenate the batches read from the scan kernels
                     default: 400000000
+            NUM_BYTES_PER_SCAN_TASK : Parquet and ORC scans group the row
+                    groups (or stripes) of all the files into tasks that load
+                    about this many bytes each, instead of making one task
+                    per file. Set to 0 to make one task per file. Scans of
+                    in-memory Arrow tables are split into tasks of about this
+                    many bytes too, or one task per record batch when 0.
+                    default: 400000000
+            MAX_LIMIT_SCAN_TASKS_IN_FLIGHT : When a LIMIT is pushed down to
+                    a scan, the scan keeps at most this many of its tasks
+                    loading at the same time, and stops creating tasks once
+                    it has output enough rows.
+                    default: 4
+            ENABLE_LATE_MATERIALIZATION : When a filter is pushed down to
+                    a Parquet scan, every row group is loaded in two steps.
+                    First only the columns of the filter are loaded and the
+                    filter is evaluated. The other columns are then loaded
+                    only if some row passes, and only the rows that pass are
+                    kept. Set to False to load all the columns at once.
+                    default: True
+            INTERPRETER_CPU_MAX_ROWS : Filters and projections of batches
+                    with up to this many rows evaluate their expressions on
+                    the CPU instead of launching a GPU kernel, when all the
+                    columns and operators of the expressions are supported
+                    by the CPU interpreter. Set to 0 to always use the GPU.
+                    default: 2048
+            MAX_OPEN_FILE_HANDLES : The max number of files the scans keep
+                    open at the same time. The least recently used files are
+                    closed past this limit and opened again when they are
+                    read, so scans over many files stay within the limits of
+                    the OS and of the remote file systems.
+                    NOTE: This parameter only works when used in the
+                    BlazingContext
+                    default: 512
+            NUM_FILE_OPENER_THREADS : The number of threads that open the
+                    next files of a scan in the background. Set to 0 to open
+                    every file when it is scanned.
+                    NOTE: This parameter only works when used in the
+                    BlazingContext
+                    default: 4
+            NUM_PREFETCHED_FILES : How many of the next files of a scan are
+                    opened in the background.
+                    NOTE: This parameter only works when used in the
+                    BlazingContext
+                    default: 8
+            METADATA_CATALOG_DIRECTORY : Where the schemas, row group stats
+                    and min/max metadata read from the footers of the files are
+                    kept, so creating tables and planning scans over the same
+                    files does not read their footers again. An entry is only
+                    used while the file keeps the same size and modification
+                    time. The directory is created only accessible by the
+                    user, and one that other users can write to is not used.
+                    An empty string disables the catalog.
+                    NOTE: This parameter only works when used in the
+                    BlazingContext
+                    default: "" (disabled)
             MAX_ORDER_BY_SAMPLES_PER_NODE : The max number order by samples
                     to capture per node
                     default: 10000
+            MAX_MERGE_STREAM_BYTE_SIZE : The max size in bytes of an order by
+                    partition that is merged in a single task. Larger
+                    partitions are merged as a stream, holding only a window
+                    of every sorted batch in GPU memory at a time
+                    default: 400000000
+            MAX_ORDER_BY_TOP_N_ROWS : The max LIMIT of an ORDER BY ... LIMIT
+                    query that is computed keeping only the top rows of every
+                    batch, instead of sorting and partitioning all the data
+                    default: 100000
             BLAZING_PROCESSING_DEVICE_MEM_CONSUMPTION_THRESHOLD : The percent
                     (as a decimal) of total GPU memory that the memory
                     that the task executor will be allowed to consume.
@@ -2233,7 +2423,9 @@ class BlazingContext(object):
             input = cudf.DataFrame.from_pandas(input)
 
         if isinstance(input, pyarrow.Table):
-            if self.dask_client is not None:
+            if self.dask_client is not None or not is_arrow_zero_copy_supported(
+                input.schema
+            ):
                 input = cudf.DataFrame.from_arrow(input)
             else:
                 table = BlazingTable(table_name, input, DataType.ARROW)
@@ -2323,6 +2515,8 @@ class BlazingContext(object):
                 local_files=local_files,
                 mapping_files=parsed_mapping_files,
             )
+            if is_hive_input or user_partitions is not None:
+                table.partition_location = hive_schema["location"]
 
             if is_hive_input:
                 # table.column_names are the official schema column_names
@@ -2723,6 +2917,45 @@ class BlazingContext(object):
 
         return (all_sliced_files, all_sliced_uri_values, all_sliced_row_groups_ids)
 
+    def _prune_partition_folders(self, current_table, scan_table_query):
+        """Restricts a table partitioned by folders to the files of the
+        partitions that may hold rows that pass the filter of its table scan.
+        The partitions are evaluated on the partition values of the files, so
+        nothing is listed again."""
+        if (
+            "filters=" not in scan_table_query
+            and "condition=" not in scan_table_query
+        ):
+            return current_table
+
+        if len(current_table.uri_values) != len(current_table.files):
+            return current_table
+
+        partition_indices = {}
+        partitions = []
+        file_partitions = []
+        for uri_value in current_table.uri_values:
+            key = tuple((col_name, str(col_value)) for col_name, col_value in uri_value)
+            if key not in partition_indices:
+                partition_indices[key] = len(partitions)
+                partitions.append(key)
+            file_partitions.append(partition_indices[key])
+
+        try:
+            kept_partitions = set(
+                cio.prunePartitionsCaller(partitions, current_table, scan_table_query)
+            )
+        except cio.PrunePartitionsError as e:
+            print(">>>>>>>> ", e)
+            return current_table
+
+        kept_indices = [
+            file_index
+            for file_index, partition in enumerate(file_partitions)
+            if partition in kept_partitions
+        ]
+        return current_table.filterFiles(kept_indices)
+
     def _optimize_skip_data_getSlices(self, current_table, scan_table_query):
         nodeFilesList = []
 
@@ -3011,6 +3244,13 @@ class BlazingContext(object):
                 or ftype == DataType.JSON
                 or ftype == DataType.CSV
             ):
+                if (
+                    query_table.partition_location is not None
+                    and query_table.local_files is False
+                ):
+                    query_table = self._prune_partition_folders(
+                        query_table, table_scans[table_idx]
+                    )
                 if query_table.has_metadata():
                     currentTableNodes = self._optimize_skip_data_getSlices(
                         query_table, table_scans[table_idx]